@@ -20,6 +20,8 @@
 #define BITBOARD_INDEX_H_
 
 
+#include <cassert>
+#include <string>
 #include "BaseTypeTemplate.h"
 
 namespace libChess
@@ -137,7 +137,7 @@ namespace libChess
 	inline const baseTypes::BitMap& BitMapMoveGenerator::getPawnAttack( const baseTypes::tSquare& from, const baseTypes::eTurn color )
 	{
 		assert(from < baseTypes::squareNumber);
-		assert(color < baseTypes::colorNumber);
+		assert(color < baseTypes::turnNumber);
 		return _pawnsAttackBitmap[ color ][ from ];
 	}
 	
@@ -0,0 +1,97 @@
+/*
+	This file is part of Vajolet.
+	Copyright (C) 2013-2018 Marco Belli
+
+    Vajolet is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Vajolet is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#include <cassert>
+#include <utility>
+#include "BitMapMoveGenerator.h"
+#include "Cuckoo.h"
+
+namespace libChess
+{
+	/*! \brief fill the tables with all the reversible moves
+	*
+	*	every move is inserted in one of its two slots, kicking out the previous entry to its other slot,
+	*	until an empty slot is found
+	*/
+	void Cuckoo::init(void)
+	{
+		_keys.fill( 0 );
+		_moves.fill( Move::NOMOVE );
+
+		unsigned int count = 0;
+		for( const auto piece : { baseTypes::whiteKing, baseTypes::whiteQueens, baseTypes::whiteRooks, baseTypes::whiteBishops, baseTypes::whiteKnights,
+			baseTypes::blackKing, baseTypes::blackQueens, baseTypes::blackRooks, baseTypes::blackBishops, baseTypes::blackKnights } )
+		{
+			for( baseTypes::tSquare from = baseTypes::A1; from < baseTypes::squareNumber; ++from )
+			{
+				baseTypes::BitMap attacks;
+				if( baseTypes::isKing( piece ) )
+				{
+					attacks = BitMapMoveGenerator::getKingMoves( from );
+				}
+				else if( baseTypes::isQueen( piece ) )
+				{
+					attacks = BitMapMoveGenerator::getQueenPseudoMoves( from );
+				}
+				else if( baseTypes::isRook( piece ) )
+				{
+					attacks = BitMapMoveGenerator::getRookPseudoMoves( from );
+				}
+				else if( baseTypes::isBishop( piece ) )
+				{
+					attacks = BitMapMoveGenerator::getBishopPseudoMoves( from );
+				}
+				else
+				{
+					attacks = BitMapMoveGenerator::getKnightMoves( from );
+				}
+
+				for( const auto to : attacks )
+				{
+					if( to <= from )
+					{
+						continue;
+					}
+					Move m( from, to );
+					uint64_t key = getMoveKey( piece, from, to ).getKey();
+					unsigned int i = _h1( key );
+					while( true )
+					{
+						std::swap( _keys[ i ], key );
+						std::swap( _moves[ i ], m );
+						if( m == Move::NOMOVE )
+						{
+							break;
+						}
+						// move the evicted entry to its alternative slot
+						i = ( i == _h1( key ) ) ? _h2( key ) : _h1( key );
+					}
+					++count;
+				}
+			}
+		}
+		assert( count == reversibleMoves );
+		(void)count;
+	}
+
+	//---------------------------------
+	//	global static Cuckoo
+	//---------------------------------
+	std::array< uint64_t, Cuckoo::tableSize > Cuckoo::_keys;
+	std::array< Move, Cuckoo::tableSize > Cuckoo::_moves;
+}
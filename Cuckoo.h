@@ -0,0 +1,107 @@
+/*
+	This file is part of Vajolet.
+	Copyright (C) 2013-2018 Marco Belli
+
+    Vajolet is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Vajolet is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#ifndef CUCKOO_H_
+#define CUCKOO_H_
+
+#include <array>
+#include <cstdint>
+#include "HashKeys.h"
+#include "Move.h"
+
+namespace libChess
+{
+	/*!	\brief cuckoo tables of the reversible moves
+
+		every reversible move of a piece ( not a pawn ) between two squares is stored with the key difference
+		it produces, the xor of the keys of the piece on the two squares and of the side key.
+		the key difference between two positions is found in the table only if a single reversible move
+		connects them, so the upcoming repetitions can be detected without generating moves.
+		HashKey::init and BitMapMoveGenerator::init shall be called before init
+	 */
+	class Cuckoo
+	{
+	public:
+		/*****************************************************************
+		*	static methods
+		******************************************************************/
+		static void init(void);
+		static bool probe( const HashKey& moveKey, Move& m );
+		static HashKey getMoveKey( const baseTypes::bitboardIndex piece, const baseTypes::tSquare from, const baseTypes::tSquare to );
+
+		/*****************************************************************
+		*	static members
+		******************************************************************/
+		static const unsigned int tableSize = 8192;
+		static const unsigned int reversibleMoves = 3668;	// number of reversible moves of both colors, the tables contain every one of them
+
+	private:
+		/*****************************************************************
+		*	static methods
+		******************************************************************/
+		static unsigned int _h1( const uint64_t key );
+		static unsigned int _h2( const uint64_t key );
+
+		/*****************************************************************
+		*	static members
+		******************************************************************/
+		static std::array< uint64_t, tableSize > _keys;
+		static std::array< Move, tableSize > _moves;
+	};
+
+	inline unsigned int Cuckoo::_h1( const uint64_t key )
+	{
+		return key & ( tableSize - 1 );
+	}
+
+	inline unsigned int Cuckoo::_h2( const uint64_t key )
+	{
+		return ( key >> 16 ) & ( tableSize - 1 );
+	}
+
+	/*! \brief key difference produced by a reversible move
+	*
+	*/
+	inline HashKey Cuckoo::getMoveKey( const baseTypes::bitboardIndex piece, const baseTypes::tSquare from, const baseTypes::tSquare to )
+	{
+		return HashKey().movePiece( piece, from, to ).changeSide();
+	}
+
+	/*! \brief look for a key difference in the tables
+	*
+	*	return true and the move connecting the two positions if the key is found.
+	*	the move has no direction, from is always the lower square
+	*/
+	inline bool Cuckoo::probe( const HashKey& moveKey, Move& m )
+	{
+		const uint64_t key = moveKey.getKey();
+		unsigned int i = _h1( key );
+		if( _keys[ i ] != key )
+		{
+			i = _h2( key );
+			if( _keys[ i ] != key )
+			{
+				return false;
+			}
+		}
+		m = _moves[ i ];
+		return true;
+	}
+}
+
+#endif /* CUCKOO_H_ */
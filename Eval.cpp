@@ -0,0 +1,135 @@
+/*
+	This file is part of Vajolet.
+	Copyright (C) 2013-2018 Marco Belli
+
+    Vajolet is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Vajolet is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#include <algorithm>
+#include <cassert>
+#include "Eval.h"
+#include "KPKBitbase.h"
+#include "Nnue.h"
+#include "Position.h"
+
+namespace libChess
+{
+	/*! \brief return the game phase, from 0 ( endgame ) to maxPhase ( opening )
+	*
+	*/
+	Score Eval::getPhase( const Position& pos )
+	{
+		const simdScore& nonPawnMaterial = pos.getActualStateConst().getNonPawnMaterialValue();
+		const Score npm = std::max( endgameLimit, std::min( midgameLimit, nonPawnMaterial[0] + nonPawnMaterial[2] ) );
+		return ( ( npm - endgameLimit ) * maxPhase ) / ( midgameLimit - endgameLimit );
+	}
+
+	/*! \brief the parameters used by evaluate
+	*
+	*/
+	Eval::Parameters Eval::getParameters()
+	{
+		return {{
+			Position::getPieceValue( baseTypes::whiteQueens ),
+			Position::getPieceValue( baseTypes::whiteRooks ),
+			Position::getPieceValue( baseTypes::whiteBishops ),
+			Position::getPieceValue( baseTypes::whiteKnights ),
+			Position::getPieceValue( baseTypes::whitePawns ),
+			simdScore{ tempo, tempo, 0, 0 }
+		}};
+	}
+
+	const char* Eval::getParameterName( const unsigned int parameter )
+	{
+		static const char* const names[ parametersNumber ] = { "queen", "rook", "bishop", "knight", "pawn", "tempo" };
+		assert( parameter < parametersNumber );
+		return names[ parameter ];
+	}
+
+	/*! \brief coefficients of the parameters in the classical evaluation of the position
+	*
+	*	the king and pawn vs king endings and the nnue evaluation aren't linear, they aren't described by the trace
+	*/
+	Eval::Trace Eval::getTrace( const Position& pos )
+	{
+		Trace trace;
+		trace.phase = getPhase( pos );
+		trace.whiteTurn = pos.isWhiteTurn();
+		const baseTypes::bitboardIndex pieces[ tempoValue ] = { baseTypes::whiteQueens, baseTypes::whiteRooks, baseTypes::whiteBishops, baseTypes::whiteKnights, baseTypes::whitePawns };
+		for( unsigned int i = 0; i < tempoValue; ++i )
+		{
+			trace.coefficients[ i ] = (int)pos.getPieceCount( pieces[ i ] ) - (int)pos.getPieceCount( pieces[ i ] + baseTypes::blackPieces );
+		}
+		trace.coefficients[ tempoValue ] = trace.whiteTurn ? 1 : -1;
+		return trace;
+	}
+
+	/*! \brief evaluation of a trace with the given parameters, equal to evaluate when the parameters are the actual ones
+	*
+	*/
+	Score Eval::evaluate( const Trace& trace, const Parameters& parameters )
+	{
+		simdScore material = { 0, 0, 0, 0 };
+		for( unsigned int i = 0; i < tempoValue; ++i )
+		{
+			material += parameters[ i ] * (int)trace.coefficients[ i ];
+		}
+		const Score score = ( material[0] * trace.phase + material[1] * ( maxPhase - trace.phase ) ) / maxPhase;
+		const simdScore& t = parameters[ tempoValue ];
+		const Score tempoScore = ( t[0] * trace.phase + t[1] * ( maxPhase - trace.phase ) ) / maxPhase;
+
+		return ( trace.whiteTurn ? score : -score ) + tempoScore;
+	}
+
+	/*! \brief king and pawn vs king evaluation
+	*
+	*	a won position is scored knownWin plus the advancement of the pawn, so that the search push it to promotion
+	*/
+	Score Eval::_evaluateKPK( const Position& pos )
+	{
+		if( !KPKBitbase::probe( pos ) )
+		{
+			return 0;
+		}
+
+		const bool whiteStrong = pos.getBitmap( baseTypes::whitePawns ).isNotEmpty();
+		const baseTypes::tSquare pawn = pos.getSquareOfThePiece( whiteStrong ? baseTypes::whitePawns : baseTypes::blackPawns );
+		const Score rank = whiteStrong ? baseTypes::getRank( pawn ) : 7 - baseTypes::getRank( pawn );
+		const Score score = knownWin + 20 * rank;
+
+		return ( whiteStrong == pos.isWhiteTurn() ) ? score : -score;
+	}
+
+	/*! \brief evaluate the position from the point of view of the side to move
+	*
+	*/
+	Score Eval::evaluate( const Position& pos )
+	{
+		if( KPKBitbase::isKPK( pos ) )
+		{
+			return _evaluateKPK( pos );
+		}
+
+		if( Nnue::isLoaded() )
+		{
+			return std::clamp( Nnue::evaluate( pos ), -knownWin + 1, knownWin - 1 );
+		}
+
+		const simdScore& material = pos.getActualStateConst().getMaterialValue();
+		const Score phase = getPhase( pos );
+		const Score score = ( material[0] * phase + material[1] * ( maxPhase - phase ) ) / maxPhase;
+
+		return ( pos.isWhiteTurn() ? score : -score ) + tempo;
+	}
+}
@@ -0,0 +1,95 @@
+/*
+	This file is part of Vajolet.
+	Copyright (C) 2013-2018 Marco Belli
+
+    Vajolet is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Vajolet is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#ifndef EVAL_H_
+#define EVAL_H_
+
+#include <array>
+#include <cstdint>
+#include "Score.h"
+
+namespace libChess
+{
+	// forward declaration
+	class Position;
+
+	/*!	\brief static evaluation of the position
+
+		the evaluation is the material balance read from the GameState, interpolated between opening and endgame
+		using the non pawn material left on the board. king and pawn vs king endings are scored with the bitbase.
+		When a network is loaded the evaluation is the nnue one, kept below the known win scores.
+		the score is returned from the point of view of the side to move
+	 */
+	class Eval
+	{
+	public:
+		/*****************************************************************
+		*	enums
+		******************************************************************/
+		enum eParameter
+		{
+			queenValue,
+			rookValue,
+			bishopValue,
+			knightValue,
+			pawnValue,
+			tempoValue,
+			parametersNumber
+		};
+
+		using Parameters = std::array< simdScore, parametersNumber >;
+
+		/*!	\brief the evaluation of a position as a linear function of the opening/endgame parameters, used by the tuner
+
+			the coefficients are seen from white, the tempo one is +1 with white to move and -1 with black to move
+		 */
+		struct Trace
+		{
+			Score phase;
+			bool whiteTurn;
+			std::array< int8_t, parametersNumber > coefficients;
+		};
+
+		/*****************************************************************
+		*	static methods
+		******************************************************************/
+		static Score evaluate( const Position& pos );
+		static Score evaluate( const Trace& trace, const Parameters& parameters );
+		static Score getPhase( const Position& pos );
+		static Trace getTrace( const Position& pos );
+		static Parameters getParameters();
+		static const char* getParameterName( const unsigned int parameter );
+
+		/*****************************************************************
+		*	static members
+		******************************************************************/
+		static constexpr Score knownWin = 10000;
+		static constexpr Score tempo = 10;
+		static constexpr Score maxPhase = 256;
+		static constexpr Score midgameLimit = 6800;	// non pawn material of both sides above which the position is a pure opening
+		static constexpr Score endgameLimit = 1600;	// non pawn material of both sides below which the position is a pure endgame
+
+	private:
+		/*****************************************************************
+		*	static methods
+		******************************************************************/
+		static Score _evaluateKPK( const Position& pos );
+	};
+}
+
+#endif /* EVAL_H_ */
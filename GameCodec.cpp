@@ -0,0 +1,271 @@
+/*
+	This file is part of Vajolet.
+	Copyright (C) 2013-2018 Marco Belli
+
+    Vajolet is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Vajolet is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <string>
+#include "GameCodec.h"
+#include "MoveGenerator.h"
+#include "MoveList.h"
+#include "MoveSelector.h"
+#include "PackedPosition.h"
+#include "Position.h"
+
+namespace libChess
+{
+	namespace
+	{
+		/*!	\brief carryless range coder, the output is a byte at a time
+		 */
+		class RangeEncoder
+		{
+		public:
+			explicit RangeEncoder( std::vector< uint8_t >& out ): _out( out ), _low( 0 ), _range( 0xFFFFFFFF ) {}
+
+			void encode( const uint32_t cumulative, const uint32_t frequency, const uint32_t total )
+			{
+				_range /= total;
+				_low += cumulative * _range;
+				_range *= frequency;
+				_normalize();
+			}
+
+			void flush()
+			{
+				for( unsigned int i = 0; i < 4; ++i )
+				{
+					_out.push_back( _low >> 24 );
+					_low <<= 8;
+				}
+			}
+
+		private:
+			std::vector< uint8_t >& _out;
+			uint32_t _low;
+			uint32_t _range;
+
+			void _normalize()
+			{
+				while( ( _low ^ ( _low + _range ) ) < top || ( _range < bottom && ( ( _range = -_low & ( bottom - 1 ) ), true ) ) )
+				{
+					_out.push_back( _low >> 24 );
+					_low <<= 8;
+					_range <<= 8;
+				}
+			}
+
+		public:
+			static constexpr uint32_t top = 1u << 24;
+			static constexpr uint32_t bottom = 1u << 16;
+		};
+
+		class RangeDecoder
+		{
+		public:
+			RangeDecoder( const uint8_t* data, const uint8_t* end ): _data( data ), _end( end ), _low( 0 ), _range( 0xFFFFFFFF ), _code( 0 )
+			{
+				for( unsigned int i = 0; i < 4; ++i )
+				{
+					_code = ( _code << 8 ) | _next();
+				}
+			}
+
+			uint32_t getFrequency( const uint32_t total )
+			{
+				_range /= total;
+				return ( _code - _low ) / _range;
+			}
+
+			void decode( const uint32_t cumulative, const uint32_t frequency )
+			{
+				_low += cumulative * _range;
+				_range *= frequency;
+				while( ( _low ^ ( _low + _range ) ) < RangeEncoder::top || ( _range < RangeEncoder::bottom && ( ( _range = -_low & ( RangeEncoder::bottom - 1 ) ), true ) ) )
+				{
+					_code = ( _code << 8 ) | _next();
+					_low <<= 8;
+					_range <<= 8;
+				}
+			}
+
+		private:
+			const uint8_t* _data;
+			const uint8_t* _end;
+			uint32_t _low;
+			uint32_t _range;
+			uint32_t _code;
+
+			// reading past the end returns zeros, as written by the flush of the encoder
+			uint8_t _next()
+			{
+				return _data < _end ? *_data++ : 0;
+			}
+		};
+
+		void writeVarint( uint32_t value, std::vector< uint8_t >& out )
+		{
+			while( value >= 0x80 )
+			{
+				out.push_back( ( value & 0x7F ) | 0x80 );
+				value >>= 7;
+			}
+			out.push_back( value );
+		}
+
+		bool readVarint( const uint8_t*& data, const uint8_t* end, uint32_t& value )
+		{
+			value = 0;
+			for( unsigned int shift = 0; data < end && shift < 32; shift += 7 )
+			{
+				const uint8_t b = *data++;
+				value |= uint32_t( b & 0x7F ) << shift;
+				if( !( b & 0x80 ) )
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+
+		const std::string startFen = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+	}
+
+	/*! \brief legal moves of the position sorted by packed value, return their number
+	*
+	*/
+	unsigned int GameCodec::_getSortedMoves( const Position& pos, uint16_t* moves )
+	{
+		MoveList< MoveSelector::maxMovePerPosition > ml;
+		MoveGenerator::generateMoves< MoveGenerator::allMg >( pos, ml );
+		const unsigned int n = ml.size();
+		for( unsigned int i = 0; i < n; ++i )
+		{
+			moves[ i ] = ml.get( i ).getPacked();
+		}
+		std::sort( moves, moves + n );
+		return n;
+	}
+
+	/*! \brief index of the move in the sorted legal moves, movesNumber if the move isn't legal
+	*
+	*/
+	unsigned int GameCodec::getMoveIndex( const Position& pos, const Move& m, unsigned int& movesNumber )
+	{
+		std::array< uint16_t, MoveSelector::maxMovePerPosition > moves;
+		movesNumber = _getSortedMoves( pos, moves.data() );
+		const auto it = std::lower_bound( moves.begin(), moves.begin() + movesNumber, m.getPacked() );
+		return ( it != moves.begin() + movesNumber && *it == m.getPacked() ) ? it - moves.begin() : movesNumber;
+	}
+
+	/*! \brief the move with the given index in the sorted legal moves, NOMOVE if the index is out of range
+	*
+	*/
+	Move GameCodec::getMove( const Position& pos, const unsigned int index, unsigned int& movesNumber )
+	{
+		std::array< uint16_t, MoveSelector::maxMovePerPosition > moves;
+		movesNumber = _getSortedMoves( pos, moves.data() );
+		return index < movesNumber ? Move( moves[ index ] ) : Move::NOMOVE;
+	}
+
+	/*! \brief append the encoded game to out
+	*
+	*	pos is the start position of the game, the moves shall be legal. The moves are played to encode them and taken back at the end
+	*/
+	void GameCodec::encode( Position& pos, const std::vector< Move >& moves, const Result result, std::vector< uint8_t >& out )
+	{
+		const bool customStart = pos.getFen() != startFen;
+		out.push_back( ( customStart ? _customStartFlag : 0 ) | ( static_cast< uint8_t >( result ) << _resultShift ) );
+		if( customStart )
+		{
+			const PackedPosition packed( pos );
+			out.insert( out.end(), packed.getData(), packed.getData() + PackedPosition::size );
+		}
+		writeVarint( moves.size(), out );
+
+		RangeEncoder encoder( out );
+		for( const auto& m : moves )
+		{
+			unsigned int movesNumber;
+			const unsigned int index = getMoveIndex( pos, m, movesNumber );
+			assert( index < movesNumber );
+			encoder.encode( index, 1, movesNumber );
+			pos.doMove( m );
+		}
+		encoder.flush();
+
+		for( unsigned int i = 0; i < moves.size(); ++i )
+		{
+			pos.undoMove();
+		}
+	}
+
+	/*! \brief decode a game, replaying its moves on pos
+	*
+	*	return false if the data is truncated or corrupted
+	*/
+	bool GameCodec::decode( const uint8_t* data, const size_t size, Position& pos, std::vector< Move >& moves, Result& result )
+	{
+		moves.clear();
+		const uint8_t* const end = data + size;
+		if( data >= end )
+		{
+			return false;
+		}
+		const uint8_t flags = *data++;
+		result = static_cast< Result >( ( flags >> _resultShift ) & 3 );
+		if( flags & _customStartFlag )
+		{
+			if( end - data < PackedPosition::size || !pos.setupFromFen( PackedPosition( data ).getFen() ) )
+			{
+				return false;
+			}
+			data += PackedPosition::size;
+		}
+		else
+		{
+			pos.setupFromFen( startFen );
+		}
+		uint32_t plies;
+		if( !readVarint( data, end, plies ) )
+		{
+			return false;
+		}
+
+		RangeDecoder decoder( data, end );
+		std::array< uint16_t, MoveSelector::maxMovePerPosition > sorted;
+		for( uint32_t i = 0; i < plies; ++i )
+		{
+			const unsigned int movesNumber = _getSortedMoves( pos, sorted.data() );
+			if( movesNumber == 0 )
+			{
+				return false;
+			}
+			const uint32_t index = decoder.getFrequency( movesNumber );
+			if( index >= movesNumber )
+			{
+				return false;
+			}
+			decoder.decode( index, 1 );
+			const Move m( sorted[ index ] );
+			pos.doMove( m );
+			moves.push_back( m );
+		}
+		return true;
+	}
+}
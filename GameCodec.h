@@ -0,0 +1,73 @@
+/*
+	This file is part of Vajolet.
+	Copyright (C) 2013-2018 Marco Belli
+
+    Vajolet is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Vajolet is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#ifndef GAMECODEC_H_
+#define GAMECODEC_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Move.h"
+
+namespace libChess
+{
+	// forward declaration
+	class Position;
+
+	/*!	\brief compact binary encoding of a game
+
+		every move is stored as its index in the legal moves of the position, sorted by their packed value, and the indexes
+		are range coded with the number of legal moves as alphabet, so that a move takes log2( legal moves ) bits.
+		An encoded game is a flags byte ( bit 0 set when the game doesn't start from the standard position, bits 1-2 the result ),
+		the packed start position when needed, the number of plies as a varint and the range coded moves
+	 */
+	class GameCodec
+	{
+	public:
+		enum class Result : uint8_t
+		{
+			unknown,
+			whiteWins,
+			blackWins,
+			draw
+		};
+
+		/*****************************************************************
+		*	static methods
+		******************************************************************/
+		static void encode( Position& pos, const std::vector< Move >& moves, const Result result, std::vector< uint8_t >& out );
+		static bool decode( const uint8_t* data, const size_t size, Position& pos, std::vector< Move >& moves, Result& result );
+
+		static unsigned int getMoveIndex( const Position& pos, const Move& m, unsigned int& movesNumber );
+		static Move getMove( const Position& pos, const unsigned int index, unsigned int& movesNumber );
+
+	private:
+		/*****************************************************************
+		*	static methods
+		******************************************************************/
+		static unsigned int _getSortedMoves( const Position& pos, uint16_t* moves );
+
+		/*****************************************************************
+		*	static members
+		******************************************************************/
+		static constexpr uint8_t _customStartFlag = 1;
+		static constexpr unsigned int _resultShift = 1;
+	};
+}
+
+#endif /* GAMECODEC_H_ */
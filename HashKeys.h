@@ -54,7 +54,7 @@ public:
 	*	methods
 	******************************************************************/
 	
-	//uint64_t inline getKey(void)const{ return _key; } 
+	uint64_t getKey(void) const{ return _key; }
 	
 	HashKey exclusion(void) const;
 	
@@ -0,0 +1,253 @@
+/*
+	This file is part of Vajolet.
+	Copyright (C) 2013-2018 Marco Belli
+
+    Vajolet is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Vajolet is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+#include "History.h"
+#include "Position.h"
+
+namespace libChess
+{
+	void PieceToHistory::clear()
+	{
+		for( auto& v : _table )
+		{
+			v.fill( 0 );
+		}
+	}
+
+	SearchHistory::SearchHistory()
+	{
+		clear();
+	}
+
+	/*! \brief clear all the tables, to be called before a new game
+	*
+	*/
+	void SearchHistory::clear()
+	{
+		for( auto& k : _killers )
+		{
+			k.fill( Move::NOMOVE );
+		}
+		for( auto& c : _counterMoves )
+		{
+			c.fill( Move::NOMOVE );
+		}
+		for( auto& b : _butterfly )
+		{
+			for( auto& v : b )
+			{
+				v.fill( 0 );
+			}
+		}
+		for( auto& c : _continuation )
+		{
+			for( auto& t : c )
+			{
+				t.clear();
+			}
+		}
+	}
+
+	/*! \brief clear the killers of a ply, usually called for the grandchildren of a node before searching it
+	*
+	*/
+	void SearchHistory::clearKillers( const unsigned int ply )
+	{
+		assert( ply < maxPly );
+		_killers[ ply ].fill( Move::NOMOVE );
+	}
+
+	/*! \brief return the move that refuted the last move played in the position
+	*
+	*/
+	const Move& SearchHistory::getCounterMove( const Position& pos ) const
+	{
+		const Move& previousMove = pos.getActualStateConst().getCurrentMove();
+		if( previousMove == Move::NOMOVE )
+		{
+			return Move::NOMOVE;
+		}
+		const continuationIndex index = _getPlayedMoveIndex( pos, previousMove );
+		return _counterMoves[ index.first ][ index.second ];
+	}
+
+	/*! \brief find the continuation history indexes ( piece, square ) of the last two moves played
+	*
+	*	the search stops at a null move, or when the piece moved two plies ago has been captured.
+	*	return the number of valid indexes
+	*/
+	unsigned int SearchHistory::_getContinuationIndexes( const Position& pos, std::array< continuationIndex, 2 >& indexes )
+	{
+		const unsigned int stateSize = pos.getStateSize();
+		const Move& previousMove = pos.getActualStateConst().getCurrentMove();
+
+		if( previousMove == Move::NOMOVE )
+		{
+			return 0;
+		}
+		indexes[ 0 ] = _getPlayedMoveIndex( pos, previousMove );
+
+		if( stateSize < 2 )
+		{
+			return 1;
+		}
+		const Move& secondPreviousMove = pos.getState( stateSize - 2 ).getCurrentMove();
+		if( secondPreviousMove == Move::NOMOVE )
+		{
+			return 1;
+		}
+		indexes[ 1 ] = _getPlayedMoveIndex( pos, secondPreviousMove );
+		return indexes[ 1 ].second == indexes[ 0 ].second ? 1 : 2;
+	}
+
+	/*! \brief index ( piece, destination square ) of a move already played in the position
+	*
+	*	the destination of a castling move is the square of the rook, so castling is indexed by the king and its final square
+	*/
+	SearchHistory::continuationIndex SearchHistory::_getPlayedMoveIndex( const Position& pos, const Move& m )
+	{
+		baseTypes::tSquare to = m.getTo();
+		if( m.isCastleMove() )
+		{
+			to = getSquareFromFileRank( Move::isKingsideCastle( m.getFrom(), to ) ? baseTypes::G : baseTypes::C, getRank( to ) );
+		}
+		return { pos.getPieceAt( to ), to };
+	}
+
+	/*! \brief return the history score of a quiet move
+	*
+	*	sum of the butterfly history and of the continuation histories of the last two plies
+	*/
+	Score SearchHistory::getQuietScore( const Position& pos, const Move& m ) const
+	{
+		const baseTypes::bitboardIndex piece = pos.getPieceAt( m.getFrom() );
+		const baseTypes::tSquare to = m.getTo();
+
+		Score s = _butterfly[ pos.getActualStateConst().getTurn() ][ m.getFrom() ][ to ];
+
+		std::array< continuationIndex, 2 > indexes;
+		const unsigned int n = _getContinuationIndexes( pos, indexes );
+		for( unsigned int i = 0; i < n; ++i )
+		{
+			s += _continuation[ indexes[ i ].first ][ indexes[ i ].second ].get( piece, to );
+		}
+		return s;
+	}
+
+	/*! \brief calculate the history score of an array of packed quiet moves
+	*
+	*	with AVX2 the scores of 8 moves are calculated at a time gathering the butterfly and continuation entries.
+	*	the result is the same of calling getQuietScore for every move
+	*/
+	void SearchHistory::getQuietScores( const Position& pos, const unsigned short* moves, Score* scores, const unsigned int count ) const
+	{
+		unsigned int i = 0;
+#if defined(__AVX2__)
+		static_assert( sizeof( baseTypes::bitboardIndex ) == sizeof( int ), "the kernel gather the pieces as 32 bits integers" );
+		std::array< continuationIndex, 2 > indexes;
+		const unsigned int n = _getContinuationIndexes( pos, indexes );
+		std::array< const Score*, 2 > continuation = { nullptr, nullptr };
+		for( unsigned int k = 0; k < n; ++k )
+		{
+			continuation[ k ] = _continuation[ indexes[ k ].first ][ indexes[ k ].second ].data();
+		}
+		const Score* butterfly = _butterfly[ pos.getActualStateConst().getTurn() ][ 0 ].data();
+		const int* squares = reinterpret_cast< const int* >( pos.getSquares().data() );
+		const __m256i squareMask = _mm256_set1_epi32( 63 );
+		for( ; i + 8 <= count; i += 8 )
+		{
+			const __m256i packed = _mm256_cvtepu16_epi32( _mm_loadu_si128( reinterpret_cast< const __m128i* >( moves + i ) ) );
+			const __m256i from = _mm256_and_si256( packed, squareMask );
+			const __m256i to = _mm256_and_si256( _mm256_srli_epi32( packed, 6 ), squareMask );
+			const __m256i piece = _mm256_i32gather_epi32( squares, from, 4 );
+			
+			// butterfly index is from * 64 + to, continuation index is piece * 64 + to
+			__m256i s = _mm256_i32gather_epi32( butterfly, _mm256_or_si256( _mm256_slli_epi32( from, 6 ), to ), 4 );
+			const __m256i pieceTo = _mm256_or_si256( _mm256_slli_epi32( piece, 6 ), to );
+			for( unsigned int k = 0; k < n; ++k )
+			{
+				s = _mm256_add_epi32( s, _mm256_i32gather_epi32( continuation[ k ], pieceTo, 4 ) );
+			}
+			_mm256_storeu_si256( reinterpret_cast< __m256i* >( scores + i ), s );
+		}
+#endif
+		for( ; i < count; ++i )
+		{
+			scores[ i ] = getQuietScore( pos, Move( moves[ i ] ) );
+		}
+	}
+
+	inline void SearchHistory::_insertKiller( const unsigned int ply, const Move& m )
+	{
+		assert( ply < maxPly );
+		if( _killers[ ply ][ 0 ] != m )
+		{
+			_killers[ ply ][ 1 ] = _killers[ ply ][ 0 ];
+			_killers[ ply ][ 0 ] = m;
+		}
+	}
+
+	inline void SearchHistory::_updateButterfly( const baseTypes::eTurn turn, const Move& m, const Score bonus )
+	{
+		applyHistoryGravity( _butterfly[ turn ][ m.getFrom() ][ m.getTo() ], bonus, maxButterflyValue );
+	}
+
+	void SearchHistory::_updateQuietScore( const Position& pos, const Move& m, const Score bonus )
+	{
+		_updateButterfly( pos.getActualStateConst().getTurn(), m, bonus );
+
+		std::array< continuationIndex, 2 > indexes;
+		const unsigned int n = _getContinuationIndexes( pos, indexes );
+		for( unsigned int i = 0; i < n; ++i )
+		{
+			_continuation[ indexes[ i ].first ][ indexes[ i ].second ].update( pos.getPieceAt( m.getFrom() ), m.getTo(), bonus );
+		}
+	}
+
+	/*! \brief update killers, counter moves and histories after a quiet move caused a beta cutoff
+	*
+	*	the best move receive a bonus, all the other quiet moves searched before it receive a malus.
+	*	the method shall be called with the position before the best move is played
+	*/
+	void SearchHistory::updateQuietStats( const Position& pos, const unsigned int ply, const Move& bestMove, const Move* quietsSearched, const unsigned int quietsCount, const unsigned int depth )
+	{
+		const Score bonus = statBonus( depth );
+
+		_insertKiller( ply, bestMove );
+
+		const Move& previousMove = pos.getActualStateConst().getCurrentMove();
+		if( previousMove != Move::NOMOVE )
+		{
+			const continuationIndex index = _getPlayedMoveIndex( pos, previousMove );
+			_counterMoves[ index.first ][ index.second ] = bestMove;
+		}
+
+		_updateQuietScore( pos, bestMove, bonus );
+
+		for( unsigned int i = 0; i < quietsCount; ++i )
+		{
+			if( quietsSearched[ i ] != bestMove )
+			{
+				_updateQuietScore( pos, quietsSearched[ i ], -bonus );
+			}
+		}
+	}
+}
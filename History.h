@@ -0,0 +1,164 @@
+/*
+	This file is part of Vajolet.
+	Copyright (C) 2013-2018 Marco Belli
+
+    Vajolet is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Vajolet is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#ifndef HISTORY_H_
+#define HISTORY_H_
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <utility>
+#include "Move.h"
+#include "Score.h"
+#include "BitBoardIndex.h"
+#include "eTurn.h"
+
+namespace libChess
+{
+	// forward declaration
+	class Position;
+
+	/*!	\brief table of history scores indexed by piece and destination square
+
+		the entries are updated with a gravity formula, that keeps them in the range [-maxValue, maxValue]
+	 */
+	class PieceToHistory
+	{
+	public:
+		/*****************************************************************
+		*	methods
+		******************************************************************/
+		void clear();
+		Score get( const baseTypes::bitboardIndex piece, const baseTypes::tSquare to ) const;
+		const Score* data() const;
+		void update( const baseTypes::bitboardIndex piece, const baseTypes::tSquare to, const Score bonus );
+
+		/*****************************************************************
+		*	static members
+		******************************************************************/
+		static const Score maxValue = 29952;
+
+	private:
+		std::array< std::array< Score, baseTypes::squareNumber >, baseTypes::bitboardNumber > _table;
+	};
+
+	/*!	\brief killers, counter moves, butterfly and continuation histories used to sort quiet moves
+
+		every search thread shall own its SearchHistory, the class is big (~4MB) and it should be allocated on the heap
+	 */
+	class SearchHistory
+	{
+	public:
+		/*****************************************************************
+		*	constructors
+		******************************************************************/
+		SearchHistory();
+
+		/*****************************************************************
+		*	methods
+		******************************************************************/
+		void clear();
+		void clearKillers( const unsigned int ply );
+
+		const Move& getKiller( const unsigned int ply, const unsigned int n ) const;
+		const Move& getCounterMove( const Position& pos ) const;
+		Score getQuietScore( const Position& pos, const Move& m ) const;
+		void getQuietScores( const Position& pos, const unsigned short* moves, Score* scores, const unsigned int count ) const;
+
+		void updateQuietStats( const Position& pos, const unsigned int ply, const Move& bestMove, const Move* quietsSearched, const unsigned int quietsCount, const unsigned int depth );
+
+		/*****************************************************************
+		*	static methods
+		******************************************************************/
+		static Score statBonus( const unsigned int depth );
+
+		/*****************************************************************
+		*	static members
+		******************************************************************/
+		static const unsigned int maxPly = 128;
+		static const unsigned int killersNumber = 2;
+		static const Score maxButterflyValue = 10692;
+
+	private:
+		/*****************************************************************
+		*	members
+		******************************************************************/
+		std::array< std::array< Move, killersNumber >, maxPly > _killers;
+		std::array< std::array< Move, baseTypes::squareNumber >, baseTypes::bitboardNumber > _counterMoves;
+		std::array< std::array< std::array< Score, baseTypes::squareNumber >, baseTypes::squareNumber >, baseTypes::turnNumber > _butterfly;
+		std::array< std::array< PieceToHistory, baseTypes::squareNumber >, baseTypes::bitboardNumber > _continuation;
+
+		using continuationIndex = std::pair< baseTypes::bitboardIndex, baseTypes::tSquare >;
+
+		/*****************************************************************
+		*	methods
+		******************************************************************/
+		void _insertKiller( const unsigned int ply, const Move& m );
+		void _updateButterfly( const baseTypes::eTurn turn, const Move& m, const Score bonus );
+		void _updateQuietScore( const Position& pos, const Move& m, const Score bonus );
+		static unsigned int _getContinuationIndexes( const Position& pos, std::array< continuationIndex, 2 >& indexes );
+		static continuationIndex _getPlayedMoveIndex( const Position& pos, const Move& m );
+	};
+
+	/*! \brief apply a bonus to an history entry using the gravity formula
+	*
+	*	big entries grow slowly and are pulled back by maluses quickly, so the entry never exceed maxValue
+	*/
+	inline void applyHistoryGravity( Score& entry, const Score bonus, const Score maxValue )
+	{
+		const Score clampedBonus = std::max( -maxValue, std::min( maxValue, bonus ) );
+		entry += clampedBonus - entry * std::abs( clampedBonus ) / maxValue;
+	}
+
+	inline Score PieceToHistory::get( const baseTypes::bitboardIndex piece, const baseTypes::tSquare to ) const
+	{
+		return _table[ piece ][ to ];
+	}
+
+	/*! \brief return the table as a flat array indexed by piece * squareNumber + to
+	*
+	*/
+	inline const Score* PieceToHistory::data() const
+	{
+		return _table[ 0 ].data();
+	}
+
+	inline void PieceToHistory::update( const baseTypes::bitboardIndex piece, const baseTypes::tSquare to, const Score bonus )
+	{
+		applyHistoryGravity( _table[ piece ][ to ], bonus, maxValue );
+	}
+
+	inline const Move& SearchHistory::getKiller( const unsigned int ply, const unsigned int n ) const
+	{
+		assert( ply < maxPly );
+		assert( n < killersNumber );
+		return _killers[ ply ][ n ];
+	}
+
+	/*! \brief bonus given to the history of a move that caused a cutoff at the given depth
+	*
+	*/
+	inline Score SearchHistory::statBonus( const unsigned int depth )
+	{
+		assert( depth > 0 );
+		const Score d = depth;
+		return d > 17 ? 0 : 32 * d * d + 64 * d - 64;
+	}
+}
+
+#endif /* HISTORY_H_ */
@@ -0,0 +1,225 @@
+/*
+	This file is part of Vajolet.
+	Copyright (C) 2013-2018 Marco Belli
+
+    Vajolet is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Vajolet is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#include <vector>
+#include "KPKBitbase.h"
+#include "BitMapMoveGenerator.h"
+#include "Position.h"
+
+namespace libChess
+{
+	namespace
+	{
+		enum eKPKResult : uint8_t
+		{
+			kpkInvalid = 0,
+			kpkUnknown = 1,
+			kpkDraw = 2,
+			kpkWin = 4
+		};
+
+		/*! \brief position used during the retrograde analysis
+		*
+		*	white has always the pawn, the pawn is always on the a-d files
+		*/
+		struct KPKPosition
+		{
+			baseTypes::eTurn turn;
+			baseTypes::tSquare whiteKing;
+			baseTypes::tSquare blackKing;
+			baseTypes::tSquare pawn;
+			eKPKResult result;
+
+			void init( const unsigned int idx );
+			eKPKResult classify( const std::vector<KPKPosition>& db, unsigned int (*index)( const baseTypes::eTurn, const baseTypes::tSquare, const baseTypes::tSquare, const baseTypes::tSquare ) ) const;
+		};
+
+		/*! \brief decode the index and assign the trivial results
+		*
+		*/
+		void KPKPosition::init( const unsigned int idx )
+		{
+			whiteKing = baseTypes::tSquare( idx & 0x3F );
+			blackKing = baseTypes::tSquare( ( idx >> 6 ) & 0x3F );
+			turn = baseTypes::eTurn( ( idx >> 12 ) & 0x01 );
+			pawn = baseTypes::getSquareFromFileRank( baseTypes::tFile( ( idx >> 13 ) & 0x3 ), baseTypes::tRank( (int)baseTypes::seven - (int)( ( idx >> 15 ) & 0x7 ) ) );
+
+			const baseTypes::tSquare promotionSquare = pawn + baseTypes::north;
+
+			// invalid if the kings are adjacent, two pieces share a square or the side to move can capture the king
+			if( baseTypes::distance( whiteKing, blackKing ) <= 1
+				|| whiteKing == pawn
+				|| blackKing == pawn
+				|| ( baseTypes::isWhiteTurn( turn ) && BitMapMoveGenerator::getPawnAttack( pawn, baseTypes::whiteTurn ).isSquareSet( blackKing ) )
+			)
+			{
+				result = kpkInvalid;
+			}
+			// win if the pawn can be promoted without getting captured
+			else if( baseTypes::isWhiteTurn( turn )
+				&& baseTypes::getRank( pawn ) == baseTypes::seven
+				&& whiteKing != promotionSquare
+				&& ( baseTypes::distance( blackKing, promotionSquare ) > 1 || baseTypes::distance( whiteKing, promotionSquare ) == 1 )
+			)
+			{
+				result = kpkWin;
+			}
+			// draw if it's a stalemate or the black king can capture the undefended pawn
+			else if( baseTypes::isBlackTurn( turn )
+				&& (
+					( BitMapMoveGenerator::getKingMoves( blackKing ) & ~( BitMapMoveGenerator::getKingMoves( whiteKing ) + BitMapMoveGenerator::getPawnAttack( pawn, baseTypes::whiteTurn ) ) ).isEmpty()
+					|| ( BitMapMoveGenerator::getKingMoves( blackKing ) & ~BitMapMoveGenerator::getKingMoves( whiteKing ) ).isSquareSet( pawn )
+				)
+			)
+			{
+				result = kpkDraw;
+			}
+			else
+			{
+				result = kpkUnknown;
+			}
+		}
+
+		/*! \brief classify the position looking at the results of all the child positions
+		*
+		*	white wins if any move reach a winning position, black draws if any move reach a drawn one
+		*/
+		eKPKResult KPKPosition::classify( const std::vector<KPKPosition>& db, unsigned int (*index)( const baseTypes::eTurn, const baseTypes::tSquare, const baseTypes::tSquare, const baseTypes::tSquare ) ) const
+		{
+			const bool whiteToMove = baseTypes::isWhiteTurn( turn );
+			const eKPKResult good = whiteToMove ? kpkWin : kpkDraw;
+			const eKPKResult bad = whiteToMove ? kpkDraw : kpkWin;
+
+			unsigned int r = kpkInvalid;
+			for( const auto sq : BitMapMoveGenerator::getKingMoves( whiteToMove ? whiteKing : blackKing ) )
+			{
+				r |= whiteToMove ? db[ index( baseTypes::blackTurn, blackKing, sq, pawn ) ].result : db[ index( baseTypes::whiteTurn, sq, whiteKing, pawn ) ].result;
+			}
+
+			if( whiteToMove )
+			{
+				const baseTypes::tSquare push = pawn + baseTypes::north;
+				// single push
+				if( baseTypes::getRank( pawn ) < baseTypes::seven )
+				{
+					r |= db[ index( baseTypes::blackTurn, blackKing, whiteKing, push ) ].result;
+				}
+				// double push
+				if( baseTypes::getRank( pawn ) == baseTypes::two && push != whiteKing && push != blackKing )
+				{
+					r |= db[ index( baseTypes::blackTurn, blackKing, whiteKing, push + baseTypes::north ) ].result;
+				}
+			}
+
+			return ( r & good ) ? good : ( ( r & kpkUnknown ) ? kpkUnknown : bad );
+		}
+	}
+
+	std::array< uint32_t, KPKBitbase::maxIndex / 32 > KPKBitbase::_bitbase;
+	HashKey KPKBitbase::_whiteKPKMaterialKey;
+	HashKey KPKBitbase::_blackKPKMaterialKey;
+
+	/*! \brief generate the bitbase by retrograde analysis
+	*
+	*	all the positions are initialized with the trivial results, then the unknown ones
+	*	are classified iteratively until no more results change.
+	*/
+	void KPKBitbase::init(void)
+	{
+		_whiteKPKMaterialKey = HashKey().addPiece( baseTypes::whiteKing, baseTypes::A1 ).addPiece( baseTypes::blackKing, baseTypes::A1 ).addPiece( baseTypes::whitePawns, baseTypes::A1 );
+		_blackKPKMaterialKey = HashKey().addPiece( baseTypes::whiteKing, baseTypes::A1 ).addPiece( baseTypes::blackKing, baseTypes::A1 ).addPiece( baseTypes::blackPawns, baseTypes::A1 );
+
+		std::vector<KPKPosition> db( maxIndex );
+
+		for( unsigned int idx = 0; idx < maxIndex; ++idx )
+		{
+			db[ idx ].init( idx );
+		}
+
+		bool repeat = true;
+		while( repeat )
+		{
+			repeat = false;
+			for( auto& p : db )
+			{
+				if( p.result == kpkUnknown )
+				{
+					p.result = p.classify( db, _index );
+					repeat |= ( p.result != kpkUnknown );
+				}
+			}
+		}
+
+		_bitbase.fill( 0 );
+		for( unsigned int idx = 0; idx < maxIndex; ++idx )
+		{
+			if( db[ idx ].result == kpkWin )
+			{
+				_bitbase[ idx / 32 ] |= 1u << ( idx & 0x1F );
+			}
+		}
+	}
+
+	/*! \brief return true if the position is won by white
+	*
+	*	white has the pawn, squares are normalized so that the pawn lies on the a-d files
+	*/
+	bool KPKBitbase::probe( const baseTypes::eTurn turn, baseTypes::tSquare whiteKing, baseTypes::tSquare whitePawn, baseTypes::tSquare blackKing )
+	{
+		if( baseTypes::getFile( whitePawn ) > baseTypes::D )
+		{
+			whiteKing = baseTypes::tSquare( whiteKing ^ 7 );
+			whitePawn = baseTypes::tSquare( whitePawn ^ 7 );
+			blackKing = baseTypes::tSquare( blackKing ^ 7 );
+		}
+		const unsigned int idx = _index( turn, blackKing, whiteKing, whitePawn );
+		return _bitbase[ idx / 32 ] & ( 1u << ( idx & 0x1F ) );
+	}
+
+	/*! \brief return true if the side owning the pawn wins
+	*
+	*	the position is mirrored vertically when black owns the pawn
+	*/
+	bool KPKBitbase::probe( const Position& pos )
+	{
+		assert( isKPK( pos ) );
+
+		const baseTypes::eTurn turn = pos.getActualStateConst().getTurn();
+
+		if( pos.getBitmap( baseTypes::whitePawns ).isNotEmpty() )
+		{
+			return probe( turn, pos.getSquareOfWhiteKing(), pos.getSquareOfThePiece( baseTypes::whitePawns ), pos.getSquareOfBlackKing() );
+		}
+		return probe(
+			baseTypes::getSwitchedTurn( turn ),
+			baseTypes::tSquare( pos.getSquareOfBlackKing() ^ 56 ),
+			baseTypes::tSquare( pos.getSquareOfThePiece( baseTypes::blackPawns ) ^ 56 ),
+			baseTypes::tSquare( pos.getSquareOfWhiteKing() ^ 56 )
+		);
+	}
+
+	/*! \brief tell whether the position is a king and pawn vs king ending
+	*
+	*	the test is done on the material signature of the position
+	*/
+	bool KPKBitbase::isKPK( const Position& pos )
+	{
+		const HashKey& materialKey = pos.getActualStateConst().getMaterialKey();
+		return materialKey == _whiteKPKMaterialKey || materialKey == _blackKPKMaterialKey;
+	}
+}
@@ -0,0 +1,79 @@
+/*
+	This file is part of Vajolet.
+	Copyright (C) 2013-2018 Marco Belli
+
+    Vajolet is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Vajolet is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#ifndef KPKBITBASE_H_
+#define KPKBITBASE_H_
+
+#include <array>
+#include <cstdint>
+#include "tSquare.h"
+#include "eTurn.h"
+#include "HashKeys.h"
+
+namespace libChess
+{
+	// forward declaration
+	class Position;
+
+	/*!	\brief king and pawn vs king bitbase
+
+		the bitbase is generated at startup by retrograde analysis and store
+		one bit ( win / draw ) for every position with the pawn on the a-d files.
+		HashKey::init and BitMapMoveGenerator::init shall be called before init
+	 */
+	class KPKBitbase
+	{
+	public:
+		/*****************************************************************
+		*	static methods
+		******************************************************************/
+		static void init(void);
+		static bool probe( const baseTypes::eTurn turn, const baseTypes::tSquare whiteKing, const baseTypes::tSquare whitePawn, const baseTypes::tSquare blackKing );
+		static bool probe( const Position& pos );
+		static bool isKPK( const Position& pos );
+
+		/*****************************************************************
+		*	static members
+		******************************************************************/
+		static const unsigned int maxIndex = 2 * 24 * 64 * 64; // turn * pawn squares * white king * black king
+
+	private:
+		/*****************************************************************
+		*	static methods
+		******************************************************************/
+		static unsigned int _index( const baseTypes::eTurn turn, const baseTypes::tSquare blackKing, const baseTypes::tSquare whiteKing, const baseTypes::tSquare pawn );
+
+		/*****************************************************************
+		*	static members
+		******************************************************************/
+		static std::array< uint32_t, maxIndex / 32 > _bitbase;
+		static HashKey _whiteKPKMaterialKey;
+		static HashKey _blackKPKMaterialKey;
+	};
+
+	/*! \brief calculate the bitbase index of a position
+	*
+	*	the pawn is supposed to be white and normalized on the a-d files
+	*/
+	inline unsigned int KPKBitbase::_index( const baseTypes::eTurn turn, const baseTypes::tSquare blackKing, const baseTypes::tSquare whiteKing, const baseTypes::tSquare pawn )
+	{
+		return whiteKing | ( blackKing << 6 ) | ( turn << 12 ) | ( baseTypes::getFile( pawn ) << 13 ) | ( ( (int)baseTypes::seven - (int)baseTypes::getRank( pawn ) ) << 15 );
+	}
+}
+
+#endif /* KPKBITBASE_H_ */
@@ -37,7 +37,7 @@ namespace libChess
 	*
 
 	*/
-	template< baseTypes::bitboardIndex pieceType, MoveGenerator::genType mgType > inline void MoveGenerator::_generatePieceMoves( const Position& pos, const baseTypes::bitboardIndex piece, const baseTypes::tSquare kingSquare, const baseTypes::BitMap& occupiedSquares, const baseTypes::BitMap& target, const GameState& st, MoveList< MoveSelector::maxMovePerPosition >& ml )
+	template< baseTypes::bitboardIndex pieceType, MoveGenerator::genType mgType, class List > inline void MoveGenerator::_generatePieceMoves( const Position& pos, const baseTypes::bitboardIndex piece, const baseTypes::tSquare kingSquare, const baseTypes::BitMap& occupiedSquares, const baseTypes::BitMap& target, const GameState& st, List& ml )
 	{
 		Move m(Move::NOMOVE);
 		
@@ -81,6 +81,15 @@ namespace libChess
 				return;
 			}
 
+			/*
+				a piece that doesn't discover a check can give check only moving to the checking squares
+			*/
+			const bool discoveryChecker = mgType == MoveGenerator::quietChecksMg && st.isDiscoveryCheckers( from );
+			if( mgType == MoveGenerator::quietChecksMg && !discoveryChecker )
+			{
+				moveBitMap &= pos.getCheckingSquare( piece );
+			}
+
 			/*
 				iterate the bitmap and add the moves to the list
 			*/
@@ -89,9 +98,10 @@ namespace libChess
 				
 				if( _checkAllowedMove( from, to, kingSquare, st ) )
 				{
-					if( mgType != MoveGenerator::quietChecksMg || pos.moveGivesCheck( m ) )
+					m.setTo( to );
+					if( !discoveryChecker || pos.moveGivesCheck( m ) )
 					{
-						m.setTo( to );
+						assert( mgType != MoveGenerator::quietChecksMg || pos.moveGivesCheck( m ) );
 						ml.insert(m);
 					}
 				}
@@ -103,10 +113,18 @@ namespace libChess
 	*
 
 	*/
-	template< MoveGenerator::genType mgType > inline void MoveGenerator::_generateKingMoves( const Position& pos, const baseTypes::tSquare kingSquare, const baseTypes::BitMap& target, MoveList< MoveSelector::maxMovePerPosition >& ml )
+	template< MoveGenerator::genType mgType, class List > inline void MoveGenerator::_generateKingMoves( const Position& pos, const baseTypes::tSquare kingSquare, const baseTypes::BitMap& target, List& ml )
 	{
 		Move m(Move::NOMOVE);
 		
+		/*
+		the king can give check only by discovery
+		*/
+		if( mgType == MoveGenerator::quietChecksMg && !pos.getActualStateConst().isDiscoveryCheckers( kingSquare ) )
+		{
+			return;
+		}
+		
 		m.setFrom( kingSquare );
 		/*
 		generate the moves
@@ -121,9 +139,9 @@ namespace libChess
 			if( pos.checkKingAllowedMove( to) )
 			{
 				// todo fare funzione comune??
+				m.setTo( to );
 				if( mgType != MoveGenerator::quietChecksMg || pos.moveGivesCheck( m ) )
 				{
-					m.setTo( to );
 					ml.insert(m);
 				}
 			}
@@ -134,7 +152,7 @@ namespace libChess
 	*
 
 	*/
-	template< MoveGenerator::genType mgType > inline void MoveGenerator::_insertPawn( const baseTypes::BitMap& movesBitmap, const baseTypes::tSquare delta, const baseTypes::tSquare kingSquare, const Position& pos, const GameState& st, MoveList< MoveSelector::maxMovePerPosition >& ml )
+	template< MoveGenerator::genType mgType, class List > inline void MoveGenerator::_insertPawn( const baseTypes::BitMap& movesBitmap, const baseTypes::tSquare delta, const baseTypes::tSquare kingSquare, const Position& pos, const GameState& st, List& ml )
 	{
 		Move m(Move::NOMOVE);
 		
@@ -147,10 +165,10 @@ namespace libChess
 			
 			if( _checkAllowedMove( from, to, kingSquare, st ) )
 			{
+				m.setFrom( from );
+				m.setTo( to );
 				if( mgType != MoveGenerator::quietChecksMg || pos.moveGivesCheck( m ) )
 				{
-					m.setFrom( from );
-					m.setTo( to );
 					ml.insert(m);
 				}
 			}
@@ -161,7 +179,7 @@ namespace libChess
 	*
 
 	*/
-	template< MoveGenerator::genType mgType > inline void MoveGenerator::_insertPromotionPawn( const baseTypes::BitMap& movesBitmap, const baseTypes::tSquare delta, const baseTypes::tSquare kingSquare, const GameState& st, MoveList< MoveSelector::maxMovePerPosition >& ml )
+	template< MoveGenerator::genType mgType, class List > inline void MoveGenerator::_insertPromotionPawn( const baseTypes::BitMap& movesBitmap, const baseTypes::tSquare delta, const baseTypes::tSquare kingSquare, const GameState& st, List& ml )
 	{
 		Move m(Move::NOMOVE);
 		m.setFlag(Move::fpromotion);
@@ -194,7 +212,7 @@ namespace libChess
 	*
 
 	*/
-	inline void MoveGenerator::_generateEnPassantMoves( const Position& pos, const GameState& st, const baseTypes::BitMap& occupiedSquares, const baseTypes::BitMap& nonPromotingPawns, const baseTypes::tSquare kingSquare, MoveList< MoveSelector::maxMovePerPosition >& ml )
+	template< class List > inline void MoveGenerator::_generateEnPassantMoves( const Position& pos, const GameState& st, const baseTypes::BitMap& occupiedSquares, const baseTypes::BitMap& nonPromotingPawns, const baseTypes::tSquare kingSquare, List& ml )
 	{
 		/*
 		if en passant square is iset
@@ -243,7 +261,7 @@ namespace libChess
 	*
 
 	*/
-	template< MoveGenerator::genType mgType > inline void MoveGenerator::_generateCastleMove( const Position& pos, const GameState& st, const baseTypes::eCastle castleType, const bool isKingSideCastle, const baseTypes::eTurn color, const baseTypes::tSquare kingSquare, MoveList< MoveSelector::maxMovePerPosition >& ml )
+	template< MoveGenerator::genType mgType, class List > inline void MoveGenerator::_generateCastleMove( const Position& pos, const GameState& st, const baseTypes::eCastle castleType, const bool isKingSideCastle, const baseTypes::eTurn color, const baseTypes::tSquare kingSquare, List& ml )
 	{
 		/*
 		check wheter the king has the castle right and the paths are free
@@ -279,7 +297,7 @@ namespace libChess
 	*
 
 	*/
-	template< MoveGenerator::genType mgType > void MoveGenerator::generateMoves( const Position& pos, MoveList< MoveSelector::maxMovePerPosition >& ml )
+	template< MoveGenerator::genType mgType, class List > inline void MoveGenerator::_generateMoves( const Position& pos, List& ml )
 	{
 		// initialize constants
 		const GameState& st = pos.getActualStateConst();
@@ -331,9 +349,16 @@ namespace libChess
 		}
 		else if( mgType == MoveGenerator::quietChecksMg )
 		{
+			assert( checkers.isEmpty() );
 			target = ~occupiedSquares;
 			kingTarget = target;
 		}
+		else if( mgType == MoveGenerator::quietPromotionMg )
+		{
+			assert( checkers.isEmpty() );
+			target = ~occupiedSquares;
+			kingTarget = baseTypes::BitMap(0);
+		}
 		else
 		{
 			assert(false);
@@ -363,25 +388,28 @@ namespace libChess
 			return;
 		}
 		
-		//------------------------------------------------------
-		// queen
-		//------------------------------------------------------
-		_generatePieceMoves< baseTypes::Queens, mgType >( pos, ++piece, kingSquare, occupiedSquares, target, st, ml );
-		
-		//------------------------------------------------------
-		// rook
-		//------------------------------------------------------
-		_generatePieceMoves< baseTypes::Rooks, mgType >( pos, ++piece, kingSquare, occupiedSquares, target, st, ml );
-		
-		//------------------------------------------------------
-		// bishop
-		//------------------------------------------------------
-		_generatePieceMoves< baseTypes::Bishops, mgType >( pos, ++piece, kingSquare, occupiedSquares, target, st, ml );
-		
-		//------------------------------------------------------
-		// knight
-		//------------------------------------------------------
-		_generatePieceMoves< baseTypes::Knights, mgType >( pos, ++piece, kingSquare, occupiedSquares, target, st, ml );
+		if( mgType != MoveGenerator::quietPromotionMg )
+		{
+			//------------------------------------------------------
+			// queen
+			//------------------------------------------------------
+			_generatePieceMoves< baseTypes::Queens, mgType >( pos, ++piece, kingSquare, occupiedSquares, target, st, ml );
+			
+			//------------------------------------------------------
+			// rook
+			//------------------------------------------------------
+			_generatePieceMoves< baseTypes::Rooks, mgType >( pos, ++piece, kingSquare, occupiedSquares, target, st, ml );
+			
+			//------------------------------------------------------
+			// bishop
+			//------------------------------------------------------
+			_generatePieceMoves< baseTypes::Bishops, mgType >( pos, ++piece, kingSquare, occupiedSquares, target, st, ml );
+			
+			//------------------------------------------------------
+			// knight
+			//------------------------------------------------------
+			_generatePieceMoves< baseTypes::Knights, mgType >( pos, ++piece, kingSquare, occupiedSquares, target, st, ml );
+		}
 		
 		//------------------------------------------------------
 		// pawns
@@ -395,7 +423,7 @@ namespace libChess
 		const baseTypes::BitMap promotingPawns = pos.getOurBitMap( baseTypes::Pawns ) & seventhRankMask ;
 		const baseTypes::BitMap nonPromotingPawns = pos.getOurBitMap( baseTypes::Pawns ) ^ promotingPawns;
 		
-		if( mgType != MoveGenerator::captureMg && mgType != MoveGenerator::captureEvasionMg )
+		if( mgType != MoveGenerator::captureMg && mgType != MoveGenerator::captureEvasionMg && mgType != MoveGenerator::quietPromotionMg )
 		{
 			//--------------------------------------------------
 			// pawn push
@@ -418,7 +446,7 @@ namespace libChess
 		//--------------------------------------------------
 		// pawn capture
 		//--------------------------------------------------
-		if( mgType != MoveGenerator::quietMg && mgType != MoveGenerator::quietChecksMg && mgType != MoveGenerator::quietEvasionMg )
+		if( mgType != MoveGenerator::quietMg && mgType != MoveGenerator::quietChecksMg && mgType != MoveGenerator::quietEvasionMg && mgType != MoveGenerator::quietPromotionMg )
 		{
 			
 			//left capture
@@ -433,7 +461,7 @@ namespace libChess
 		//------------------------------------------------------
 		// pawns promotions
 		//------------------------------------------------------
-		if( mgType != MoveGenerator::captureMg && mgType != MoveGenerator::captureEvasionMg )
+		if( mgType != MoveGenerator::captureMg && mgType != MoveGenerator::captureEvasionMg && mgType != MoveGenerator::quietChecksMg )
 		{
 			//--------------------------------------------------
 			// pawn push promotion
@@ -442,7 +470,7 @@ namespace libChess
 			_insertPromotionPawn< mgType >( movesBitMap, pawnPush( turn ) , kingSquare, st, ml );
 		}
 		
-		if( mgType != MoveGenerator::quietMg && mgType != MoveGenerator::quietChecksMg && mgType != MoveGenerator::quietEvasionMg )
+		if( mgType != MoveGenerator::quietMg && mgType != MoveGenerator::quietChecksMg && mgType != MoveGenerator::quietEvasionMg && mgType != MoveGenerator::quietPromotionMg )
 		{
 			//left capture promotion
 			baseTypes::BitMap movesBitMap = BitMapMoveGenerator::getPawnGroupCaptureLeft( promotingPawns, turn, opponent & target );
@@ -462,7 +490,7 @@ namespace libChess
 		//------------------------------------------------------
 		// king castle
 		//------------------------------------------------------
-		if( mgType != MoveGenerator::allEvasionMg && mgType != MoveGenerator::captureEvasionMg && mgType != MoveGenerator::quietEvasionMg && mgType!= MoveGenerator::captureMg)
+		if( mgType != MoveGenerator::allEvasionMg && mgType != MoveGenerator::captureEvasionMg && mgType != MoveGenerator::quietEvasionMg && mgType!= MoveGenerator::captureMg && mgType != MoveGenerator::quietPromotionMg )
 		{
 			if( checkers.isEmpty() )
 			{				
@@ -475,23 +503,51 @@ namespace libChess
 		}
 	}
 
-	/*! \brief generate all the legal moves
+	/*! \brief generate the moves and insert them in the list
 	*
-
+	*	List can be a MoveList or any class with an insert( const Move& ) method ( see MoveSelector::GeneratorSink ),
+	*	the moves are passed to insert as soon as they are generated. allMg generate the evasions when in check
 	*/
-	template<> void MoveGenerator::generateMoves< MoveGenerator::allMg >( const Position& pos, MoveList< MoveSelector::maxMovePerPosition >& ml )
+	template< MoveGenerator::genType mgType, class List > void MoveGenerator::generateMoves( const Position& pos, List& ml )
 	{
-		/* if in check generate evasion */
-		if( pos.isInCheck() )
+		if constexpr( mgType == MoveGenerator::allMg )
 		{
-			generateMoves< MoveGenerator::captureEvasionMg >( pos, ml );
-			generateMoves< MoveGenerator::quietEvasionMg >( pos, ml );
+			/* if in check generate evasion */
+			if( pos.isInCheck() )
+			{
+				_generateMoves< MoveGenerator::captureEvasionMg >( pos, ml );
+				_generateMoves< MoveGenerator::quietEvasionMg >( pos, ml );
+			}
+			/* otherwise generate all moves */
+			else
+			{
+				_generateMoves< MoveGenerator::captureMg >( pos, ml );
+				_generateMoves< MoveGenerator::quietMg >( pos, ml );
+			}
 		}
-		/* otherwise generate all moves */
 		else
 		{
-			generateMoves< MoveGenerator::captureMg >( pos, ml );
-			generateMoves< MoveGenerator::quietMg >( pos, ml );
+			_generateMoves< mgType >( pos, ml );
 		}
 	}
+	
+	/*****************************************************************
+	*	explicit instantiations
+	******************************************************************/
+	template void MoveGenerator::generateMoves< MoveGenerator::captureMg >( const Position& pos, MoveList< MoveSelector::maxMovePerPosition >& ml );
+	template void MoveGenerator::generateMoves< MoveGenerator::quietMg >( const Position& pos, MoveList< MoveSelector::maxMovePerPosition >& ml );
+	template void MoveGenerator::generateMoves< MoveGenerator::captureEvasionMg >( const Position& pos, MoveList< MoveSelector::maxMovePerPosition >& ml );
+	template void MoveGenerator::generateMoves< MoveGenerator::quietEvasionMg >( const Position& pos, MoveList< MoveSelector::maxMovePerPosition >& ml );
+	template void MoveGenerator::generateMoves< MoveGenerator::allMg >( const Position& pos, MoveList< MoveSelector::maxMovePerPosition >& ml );
+	template void MoveGenerator::generateMoves< MoveGenerator::quietChecksMg >( const Position& pos, MoveList< MoveSelector::maxMovePerPosition >& ml );
+	template void MoveGenerator::generateMoves< MoveGenerator::quietPromotionMg >( const Position& pos, MoveList< MoveSelector::maxMovePerPosition >& ml );
+	
+	template void MoveGenerator::generateMoves< MoveGenerator::captureMg >( const Position& pos, MoveSelector::GeneratorSink< MoveSelector::mvvLvaScore >& ml );
+	template void MoveGenerator::generateMoves< MoveGenerator::captureEvasionMg >( const Position& pos, MoveSelector::GeneratorSink< MoveSelector::mvvLvaScore >& ml );
+	template void MoveGenerator::generateMoves< MoveGenerator::quietMg >( const Position& pos, MoveSelector::GeneratorSink< MoveSelector::noScore >& ml );
+	template void MoveGenerator::generateMoves< MoveGenerator::quietMg >( const Position& pos, MoveSelector::GeneratorSink< MoveSelector::historyScore >& ml );
+	template void MoveGenerator::generateMoves< MoveGenerator::quietEvasionMg >( const Position& pos, MoveSelector::GeneratorSink< MoveSelector::noScore >& ml );
+	template void MoveGenerator::generateMoves< MoveGenerator::quietEvasionMg >( const Position& pos, MoveSelector::GeneratorSink< MoveSelector::historyScore >& ml );
+	template void MoveGenerator::generateMoves< MoveGenerator::quietChecksMg >( const Position& pos, MoveSelector::GeneratorSink< MoveSelector::noScore >& ml );
+	template void MoveGenerator::generateMoves< MoveGenerator::quietPromotionMg >( const Position& pos, MoveSelector::GeneratorSink< MoveSelector::promotionScore >& ml );
 }
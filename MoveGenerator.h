@@ -57,7 +57,8 @@ namespace libChess
 		{
 			captureMg,			// generate capture moves
 			quietMg,			// generate quiet moves
-			quietChecksMg,		// generate quiet moves giving check
+			quietChecksMg,		// generate quiet moves giving check, promotions excluded
+			quietPromotionMg,	// generate non capture promotions
 			allNonEvasionMg,	// generate all moves while not in check
 			allEvasionMg,		// generate all moves while in check
 			allMg,				// general generate all move
@@ -78,17 +79,18 @@ namespace libChess
 		static bool isPawnPush( const baseTypes::tSquare from, const baseTypes::tSquare to );
 		static bool isPawnDoublePush( const baseTypes::tSquare from, const baseTypes::tSquare to );
 		
-		template< genType mgType > static void generateMoves( const Position& pos, MoveList< MoveSelector::maxMovePerPosition >& ml );
+		template< genType mgType, class List > static void generateMoves( const Position& pos, List& ml );
         
 	private:
+		template< genType mgType, class List > static void _generateMoves( const Position& pos, List& ml );
 		static bool _checkAllowedMove( const baseTypes::tSquare from, const baseTypes::tSquare to, const baseTypes::tSquare kingSquare, const GameState& st );
 		
-		template< baseTypes::bitboardIndex pieceType, genType mgType > static void _generatePieceMoves( const Position& pos, const baseTypes::bitboardIndex piece, const baseTypes::tSquare kingSquare, const baseTypes::BitMap& occupiedSquares, const baseTypes::BitMap& target, const GameState& st, MoveList< MoveSelector::maxMovePerPosition >& ml );
-		template< MoveGenerator::genType mgType > static void _generateKingMoves( const Position& pos, const baseTypes::tSquare kingSquare, const baseTypes::BitMap& target, MoveList< MoveSelector::maxMovePerPosition >& ml );
-		template< MoveGenerator::genType mgType > static void _insertPawn( const baseTypes::BitMap& movesBitmap, const baseTypes::tSquare delta, const baseTypes::tSquare kingSquare, const Position& pos, const GameState& st, MoveList< MoveSelector::maxMovePerPosition >& ml );
-		template< MoveGenerator::genType mgType > static void _insertPromotionPawn( const baseTypes::BitMap& movesBitmap, const baseTypes::tSquare delta, const baseTypes::tSquare kingSquare, const GameState& st, MoveList< MoveSelector::maxMovePerPosition >& ml );
-		template< MoveGenerator::genType mgType > static void _generateCastleMove( const Position& pos, const GameState& st,  const baseTypes::eCastle castleType, const bool isKingSideCastle, const baseTypes::eTurn color, const baseTypes::tSquare kingSquare, MoveList< MoveSelector::maxMovePerPosition >& ml );
-		static void _generateEnPassantMoves( const Position& pos, const GameState& st, const baseTypes::BitMap& occupiedSquares, const baseTypes::BitMap& nonPromotingPawns, const baseTypes::tSquare kingSquare, MoveList< MoveSelector::maxMovePerPosition >& ml );
+		template< baseTypes::bitboardIndex pieceType, genType mgType, class List > static void _generatePieceMoves( const Position& pos, const baseTypes::bitboardIndex piece, const baseTypes::tSquare kingSquare, const baseTypes::BitMap& occupiedSquares, const baseTypes::BitMap& target, const GameState& st, List& ml );
+		template< MoveGenerator::genType mgType, class List > static void _generateKingMoves( const Position& pos, const baseTypes::tSquare kingSquare, const baseTypes::BitMap& target, List& ml );
+		template< MoveGenerator::genType mgType, class List > static void _insertPawn( const baseTypes::BitMap& movesBitmap, const baseTypes::tSquare delta, const baseTypes::tSquare kingSquare, const Position& pos, const GameState& st, List& ml );
+		template< MoveGenerator::genType mgType, class List > static void _insertPromotionPawn( const baseTypes::BitMap& movesBitmap, const baseTypes::tSquare delta, const baseTypes::tSquare kingSquare, const GameState& st, List& ml );
+		template< MoveGenerator::genType mgType, class List > static void _generateCastleMove( const Position& pos, const GameState& st,  const baseTypes::eCastle castleType, const bool isKingSideCastle, const baseTypes::eTurn color, const baseTypes::tSquare kingSquare, List& ml );
+		template< class List > static void _generateEnPassantMoves( const Position& pos, const GameState& st, const baseTypes::BitMap& occupiedSquares, const baseTypes::BitMap& nonPromotingPawns, const baseTypes::tSquare kingSquare, List& ml );
 		
 	};
 	
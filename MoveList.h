@@ -39,8 +39,13 @@
 
 #include <array>
 #include <algorithm>
+#include <limits>
+#if defined(__SSE4_1__)
+#include <smmintrin.h>
+#endif
 
 #include "Move.h"
+#include "Score.h"
 
 namespace libChess
 {
@@ -56,6 +61,7 @@ namespace libChess
 	*	methods
 	******************************************************************/
 		void insert( const Move& m );
+		void insert( const Move& m, const Score s );
 		void reset(void);
 		unsigned int size() const;
 		const Move& get( const unsigned int n ) const;
@@ -65,6 +71,7 @@ namespace libChess
 		const Move& findNextBestMove(void);
 		const Move& getNextMove(void);
 		void ignoreMove( const Move& m );
+		void sortAbove( const Score limit );
 	
 	
 	
@@ -75,6 +82,7 @@ namespace libChess
 		typename std::array<extMove,N >::iterator _moveListEnd = std::array< extMove, N >::begin();
 		typename std::array<extMove,N >::iterator _moveListPosition = std::array< extMove, N >::begin();
 		
+		typename std::array<extMove,N >::iterator _findBestMove(void);
 	};
 	
 	template <std::size_t N>
@@ -84,6 +92,13 @@ namespace libChess
 		*( _moveListEnd++ ) = m;
 	}
 	
+	template <std::size_t N>
+	inline void MoveList<N>::insert( const Move& m, const Score s )
+	{
+		*_moveListEnd = m;
+		( _moveListEnd++ )->setScore( s );
+	}
+	
 	template <std::size_t N>
 	inline void MoveList<N>::reset()
 	{
@@ -122,10 +137,44 @@ namespace libChess
 	{
 		return _moveListPosition;
 	}
+	/*! \brief return the first move with the highest score between actualPosition and end
+	*
+	*	when SSE4.1 is available the scores are extracted 4 at a time from the interleaved extMove array
+	*	and reduced with _mm_max_epi32, the position of the best move is then found with a linear search.
+	*/
+	template <std::size_t N>
+	inline typename std::array<extMove,N >::iterator MoveList<N>::_findBestMove(void)
+	{
+#if defined(__SSE4_1__)
+		static_assert( sizeof( extMove ) == 8, "the simd scan expects the score in the upper 4 bytes of extMove" );
+		if( _moveListEnd - _moveListPosition >= 8 )
+		{
+			auto it = _moveListPosition;
+			__m128i vMax = _mm_set1_epi32( std::numeric_limits< Score >::min() );
+			for( ; _moveListEnd - it >= 4; it += 4 )
+			{
+				// every 128 bit load contains two moves, the scores are the odd 32 bits lanes
+				const __m128 low = _mm_castsi128_ps( _mm_loadu_si128( reinterpret_cast< const __m128i* >( &*it ) ) );
+				const __m128 high = _mm_castsi128_ps( _mm_loadu_si128( reinterpret_cast< const __m128i* >( &*( it + 2 ) ) ) );
+				vMax = _mm_max_epi32( vMax, _mm_castps_si128( _mm_shuffle_ps( low, high, _MM_SHUFFLE( 3, 1, 3, 1 ) ) ) );
+			}
+			vMax = _mm_max_epi32( vMax, _mm_shuffle_epi32( vMax, _MM_SHUFFLE( 1, 0, 3, 2 ) ) );
+			vMax = _mm_max_epi32( vMax, _mm_shuffle_epi32( vMax, _MM_SHUFFLE( 2, 3, 0, 1 ) ) );
+			Score max = _mm_cvtsi128_si32( vMax );
+			for( ; it != _moveListEnd; ++it )
+			{
+				max = std::max( max, it->getScore() );
+			}
+			return std::find_if( _moveListPosition, _moveListEnd, [max]( const extMove& m ){ return m.getScore() == max; } );
+		}
+#endif
+		return std::max_element( _moveListPosition, _moveListEnd );
+	}
+	
 	template <std::size_t N>
 	inline const Move& MoveList<N>::findNextBestMove(void)
 	{
-		const auto max = std::max_element( _moveListPosition, _moveListEnd );
+		const auto max = _findBestMove();
 		if( max != _moveListEnd )
 		{
 			std::swap( *max, *_moveListPosition );
@@ -154,6 +203,35 @@ namespace libChess
 			++_moveListPosition;
 		}
 	}
+	
+	/*! \brief partial insertion sort of the moves between actualPosition and end
+	*
+	*	the moves with score >= limit are sorted in descending order at the beginning of the list,
+	*	the other moves follow in unspecified order. After the sort the moves can be read with getNextMove,
+	*	avoiding the quadratic cost of calling findNextBestMove for every move
+	*/
+	template <std::size_t N>
+	inline void MoveList<N>::sortAbove( const Score limit )
+	{
+		if( _moveListPosition == _moveListEnd )
+		{
+			return;
+		}
+		for( auto sortedEnd = _moveListPosition, p = _moveListPosition + 1; p < _moveListEnd; ++p )
+		{
+			if( p->getScore() >= limit )
+			{
+				const extMove tmp = *p;
+				*p = *++sortedEnd;
+				auto q = sortedEnd;
+				for( ; q != _moveListPosition && ( q - 1 )->getScore() < tmp.getScore(); --q )
+				{
+					*q = *( q - 1 );
+				}
+				*q = tmp;
+			}
+		}
+	}
 }
 
 
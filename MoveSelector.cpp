@@ -26,13 +26,40 @@ namespace libChess
         _stagedGeneratorState = ( eStagedGeneratorState )( _stagedGeneratorState + 1 );
     }
     
-    inline void MoveSelector::_scoreCaptures()
+    /*	\brief tell whether a killer or counter move can be returned
+    *
+    *	the move shall be legal, quiet and not already returned
+    */
+    inline bool MoveSelector::_isValidRefutation( const Move& m ) const
     {
-        // todo check whether to change begin of array from begin to actualPosition (inside the list class)
-        for( auto & m : *_ml )
-        {
-            m.setScore( _pos.getMvvLvaScore( m ) );
-        }
+        return m != Move::NOMOVE
+            && m != _ttMove
+            && !_isRefutation( m )
+            && !_pos.getTheirBitMap().isSquareSet( m.getTo() )
+            && !m.isEnPassantMove()
+            && _pos.isMoveLegal( m );
+    }
+    
+    /*	\brief tell whether the tt move can be returned by the quiescence search selectors
+    *
+    *	the move shall be a legal capture or promotion, or a quiet check when the checks are searched
+    */
+    inline bool MoveSelector::_isValidQuiescentTTMove( const bool withChecks ) const
+    {
+        return _pos.isMoveLegal( _ttMove )
+            && ( _pos.isCaptureMove( _ttMove ) || _ttMove.isPromotionMove() || ( withChecks && _pos.moveGivesCheck( _ttMove ) ) );
+    }
+    
+    /*	\brief generate the captures and the non capture promotions in the same list
+    *
+    */
+    inline void MoveSelector::_generateQuiescentMoves()
+    {
+        _ml = new MoveList< maxMovePerPosition >;
+        GeneratorSink< mvvLvaScore > captureSink( *this );
+        MoveGenerator::generateMoves< MoveGenerator::captureMg >( _pos, captureSink );
+        GeneratorSink< promotionScore > promotionSink( *this );
+        MoveGenerator::generateMoves< MoveGenerator::quietPromotionMg >( _pos, promotionSink );
     }
     
 	const Move& MoveSelector::getNextMove()
@@ -42,28 +69,73 @@ namespace libChess
 			switch( _stagedGeneratorState )
 			{
 				case generateCaptureMoves:
+				{
 					_ml = new MoveList< maxMovePerPosition >;
-					MoveGenerator::generateMoves< MoveGenerator::captureMg >( _pos, *_ml );
-					_ml->ignoreMove( _ttMove );
-                    
-                    _scoreCaptures();
+					GeneratorSink< mvvLvaScore > sink( *this );
+					MoveGenerator::generateMoves< MoveGenerator::captureMg >( _pos, sink );
 
 					_goToNextState();
 					break;
+				}
 				case generateCaptureEvasionMoves:
+				{
 					_ml = new MoveList< maxMovePerPosition >;
-					MoveGenerator::generateMoves< MoveGenerator::captureEvasionMg >( _pos, *_ml );
-					_ml->ignoreMove( _ttMove );
-
 					// todo readd killer moves
-					_scoreCaptures();
+					GeneratorSink< mvvLvaScore > sink( *this );
+					MoveGenerator::generateMoves< MoveGenerator::captureEvasionMg >( _pos, sink );
+
+					_goToNextState();
+					break;
+				}
+				case generateProbCutCaptures:
+				{
+					_ml = new MoveList< maxMovePerPosition >;
+					GeneratorSink< mvvLvaScore > sink( *this );
+					MoveGenerator::generateMoves< MoveGenerator::captureMg >( _pos, sink );
 
 					_goToNextState();
 					break;
+				}
+				case getKillers:
+					if( _history && _killerIndex < SearchHistory::killersNumber )
+					{
+						const Move& m = _history->getKiller( _ply, _killerIndex++ );
+						if( _isValidRefutation( m ) )
+						{
+							_refutations[ _refutationsCount++ ] = m;
+							return m;
+						}
+					}
+					else
+					{
+						_goToNextState();
+					}
+					break;
+				case getCounters:
+					_goToNextState();
+					if( _history )
+					{
+						const Move& m = _history->getCounterMove( _pos );
+						if( _isValidRefutation( m ) )
+						{
+							_refutations[ _refutationsCount++ ] = m;
+							return m;
+						}
+					}
+					break;
 				case generateQuietMoves:
 					_ml->reset();
-					MoveGenerator::generateMoves< MoveGenerator::quietMg >( _pos, *_ml );
-					_ml->ignoreMove( _ttMove );
+					if( _history )
+					{
+						GeneratorSink< historyScore > sink( *this );
+						MoveGenerator::generateMoves< MoveGenerator::quietMg >( _pos, sink );
+						_ml->sortAbove( quietSortLimit );
+					}
+					else
+					{
+						GeneratorSink< noScore > sink( *this );
+						MoveGenerator::generateMoves< MoveGenerator::quietMg >( _pos, sink );
+					}
                     
 					_goToNextState();
 					
@@ -71,11 +143,16 @@ namespace libChess
 				case generateQuietEvasionMoves:
 
 					_ml->reset();
-					MoveGenerator::generateMoves< MoveGenerator::quietEvasionMg >( _pos, *_ml );
-					_ml->ignoreMove( _ttMove );
-
-					//todo readd this line
-					//scoreQuietEvasion();
+					if( _history )
+					{
+						GeneratorSink< historyScore > sink( *this );
+						MoveGenerator::generateMoves< MoveGenerator::quietEvasionMg >( _pos, sink );
+					}
+					else
+					{
+						GeneratorSink< noScore > sink( *this );
+						MoveGenerator::generateMoves< MoveGenerator::quietEvasionMg >( _pos, sink );
+					}
 					_goToNextState();
 				break;
 				
@@ -98,13 +175,79 @@ namespace libChess
 					}
 					else
 					{
-						// todo rimettere _stagedGeneratorState +1 e riunificare i metodi
-						_stagedGeneratorState = generateQuietMoves;
+						_goToNextState();
 					}
 					break;
 				case iterateQuietEvasionMoves:
-				case iterateQuietMoves:
+					if( _history )
+					{
 						return _ml->findNextBestMove();
+					}
+					// without histories the quiet moves are not scored, return them in generation order
+					return _ml->getNextMove();
+					break;
+				case iterateQuietMoves:
+					// the list has been already sorted by generateQuietMoves
+					return _ml->getNextMove();
+					break;
+				case generateQuiescentMoves:
+				case generateQuiescentCaptures:
+					_generateQuiescentMoves();
+					_goToNextState();
+					break;
+				case iterateQuiescentMoves:
+					// last state of the captures only quiescence search
+					return _ml->findNextBestMove();
+					break;
+				case iterateQuiescentCaptures:
+					if( const Move& m = _ml->findNextBestMove(); m != Move::NOMOVE )
+					{
+						return m;
+					}
+					else
+					{
+						_goToNextState();
+					}
+					break;
+				case generateQuietCheks:
+				{
+					_ml->reset();
+					GeneratorSink< noScore > sink( *this );
+					MoveGenerator::generateMoves< MoveGenerator::quietChecksMg >( _pos, sink );
+					_goToNextState();
+					break;
+				}
+				case iterateQuietChecks:
+					return _ml->getNextMove();
+					break;
+				case getQsearchTT:
+				case getQsearchTTquiet:
+				{
+					const bool withChecks = _stagedGeneratorState == getQsearchTTquiet;
+					_goToNextState();
+					if( _isValidQuiescentTTMove( withChecks ) )
+					{
+						return _ttMove;
+					}
+					break;
+				}
+				case iterateProbCutCaptures:
+				{
+					// the state is never left, when the list is exhausted NOMOVE is returned
+					const Move& m = _ml->findNextBestMove();
+					if( m == Move::NOMOVE || _pos.seeGreaterOrEqual( m, _threshold ) )
+					{
+						return m;
+					}
+					break;
+				}
+				case getProbCutTT:
+					_goToNextState();
+
+					if( _pos.isMoveLegal( _ttMove ) && _pos.isCaptureMove( _ttMove ) && _pos.seeGreaterOrEqual( _ttMove, _threshold ) )
+					{
+						return _ttMove;
+					}
 					break;
 				case getTT:
 				case getTTevasion:
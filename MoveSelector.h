@@ -39,6 +39,7 @@
 
 #include "Position.h"
 #include "MoveList.h"
+#include "History.h"
 
 namespace libChess
 {
@@ -48,11 +49,47 @@ namespace libChess
 		public:
             static const unsigned int maxMovePerPosition = 250;
             static const unsigned int maxBadMovePerPosition = 32;
+            // quiet moves with history score lower than quietSortLimit are returned unsorted
+            static const Score quietSortLimit = -4000;
+			// moves generated by the quiescence search selectors
+			enum eQuiescentType
+			{
+				quiescentWithChecks,	// captures, promotions and quiet checks, used at the first ply of the quiescence search
+				quiescentCaptures		// captures and promotions
+			};
 			/*****************************************************************
 			*	constructors
 			******************************************************************/
 			MoveSelector( const Position& pos, const Move& ttMove = Move::NOMOVE );
+			MoveSelector( const Position& pos, const SearchHistory& history, const unsigned int ply, const Move& ttMove = Move::NOMOVE );
+			MoveSelector( const Position& pos, const Score threshold, const Move& ttMove );
+			MoveSelector( const Position& pos, const eQuiescentType type, const Move& ttMove );
 			~MoveSelector();
+			
+			/*****************************************************************
+			*	generator sink
+			******************************************************************/
+			enum eSinkScore
+			{
+				noScore,
+				mvvLvaScore,
+				historyScore,
+				promotionScore
+			};
+			
+			/*!	\brief list passed to MoveGenerator::generateMoves to fill the selector move list
+			
+				every generated move is checked against the tt move and the refutations already returned,
+				scored and written in the list in a single pass
+			 */
+			template< eSinkScore scoreType > class GeneratorSink
+			{
+			public:
+				explicit GeneratorSink( MoveSelector& ms ): _ms( ms ){}
+				void insert( const Move& m );
+			private:
+				MoveSelector& _ms;
+			};
 
 			/*****************************************************************
 			*	Operators
@@ -77,6 +114,14 @@ namespace libChess
 		private:
 			const Position& _pos;
 			const Move& _ttMove;
+			const SearchHistory* _history;
+			const unsigned int _ply;
+			// minimum static exchange evaluation of the captures returned in probCut mode
+			const Score _threshold;
+			// killers and counter move already returned, they shall be removed from the quiet move list
+			std::array< Move, SearchHistory::killersNumber + 1 > _refutations;
+			unsigned int _refutationsCount;
+			unsigned int _killerIndex;
 			// todo is possibile to allocate it only if necessary?
 			MoveList< maxMovePerPosition > *_ml;
 			
@@ -119,10 +164,49 @@ namespace libChess
 			}_stagedGeneratorState;
             
             void _goToNextState();
-            void _scoreCaptures();
+            bool _isValidRefutation( const Move& m ) const;
+            bool _isRefutation( const Move& m ) const;
+            bool _isValidQuiescentTTMove( const bool withChecks ) const;
+            void _generateQuiescentMoves();
+            
+            // score of the non capture promotions: the queen promotion is searched with the good captures, the under promotions last
+            static constexpr Score _promotionScore[ 4 ] = { 800, 0, 0, 0 };
 	};
 	
-	inline MoveSelector::MoveSelector( const Position& pos, const Move& ttMove ):_pos(pos), _ttMove(ttMove), _ml(nullptr)
+	inline bool MoveSelector::_isRefutation( const Move& m ) const
+	{
+		return std::find( _refutations.begin(), _refutations.begin() + _refutationsCount, m ) != _refutations.begin() + _refutationsCount;
+	}
+	
+	template< MoveSelector::eSinkScore scoreType >
+	inline void MoveSelector::GeneratorSink< scoreType >::insert( const Move& m )
+	{
+		if( m == _ms._ttMove )
+		{
+			return;
+		}
+		if( scoreType == mvvLvaScore )
+		{
+			_ms._ml->insert( m, _ms._pos.getMvvLvaScore( m ) );
+		}
+		else if( scoreType == promotionScore )
+		{
+			_ms._ml->insert( m, _promotionScore[ m.getPromotionType() ] );
+		}
+		else if( scoreType == historyScore )
+		{
+			if( !_ms._isRefutation( m ) )
+			{
+				_ms._ml->insert( m, _ms._history->getQuietScore( _ms._pos, m ) );
+			}
+		}
+		else
+		{
+			_ms._ml->insert( m );
+		}
+	}
+	
+	inline MoveSelector::MoveSelector( const Position& pos, const Move& ttMove ):_pos(pos), _ttMove(ttMove), _history(nullptr), _ply(0), _threshold(0), _refutationsCount(0), _killerIndex(0), _ml(nullptr)
 	{	
 		if( pos.isInCheck() )
 		{
@@ -134,6 +218,44 @@ namespace libChess
 		}
 	}
 	
+	/*	\brief construct a move selector that use killers, counter moves and histories to sort the quiet moves
+	*/
+	inline MoveSelector::MoveSelector( const Position& pos, const SearchHistory& history, const unsigned int ply, const Move& ttMove ):_pos(pos), _ttMove(ttMove), _history(&history), _ply(ply), _threshold(0), _refutationsCount(0), _killerIndex(0), _ml(nullptr)
+	{	
+		assert( ply < SearchHistory::maxPly );
+		if( pos.isInCheck() )
+		{
+			_stagedGeneratorState = getTTevasion;
+		}
+		else
+		{
+			_stagedGeneratorState = getTT;
+		}
+	}
+	
+	/*	\brief construct a move selector for ProbCut, that return only the captures with static exchange evaluation at least equal to threshold
+	*/
+	inline MoveSelector::MoveSelector( const Position& pos, const Score threshold, const Move& ttMove ):_pos(pos), _ttMove(ttMove), _history(nullptr), _ply(0), _threshold(threshold), _refutationsCount(0), _killerIndex(0), _ml(nullptr), _stagedGeneratorState(getProbCutTT)
+	{
+		assert( !pos.isInCheck() );
+	}
+	
+	/*	\brief construct a move selector for the quiescence search
+	*
+	*	when in check all the evasions are returned
+	*/
+	inline MoveSelector::MoveSelector( const Position& pos, const eQuiescentType type, const Move& ttMove ):_pos(pos), _ttMove(ttMove), _history(nullptr), _ply(0), _threshold(0), _refutationsCount(0), _killerIndex(0), _ml(nullptr)
+	{
+		if( pos.isInCheck() )
+		{
+			_stagedGeneratorState = getTTevasion;
+		}
+		else
+		{
+			_stagedGeneratorState = type == quiescentWithChecks ? getQsearchTTquiet : getQsearchTT;
+		}
+	}
+	
 	inline MoveSelector::~MoveSelector()
 	{
 		delete _ml;
@@ -0,0 +1,402 @@
+/*
+	This file is part of Vajolet.
+	Copyright (C) 2013-2018 Marco Belli
+
+    Vajolet is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Vajolet is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#include <algorithm>
+#include <fstream>
+#if defined(__AVX2__) || defined(__SSE4_1__)
+#include <immintrin.h>
+#endif
+#include "Nnue.h"
+#include "Position.h"
+
+namespace libChess
+{
+	/*****************************************************************
+	*	static members
+	******************************************************************/
+	std::vector< int16_t > Nnue::_featureBiases;
+	std::vector< int16_t > Nnue::_featureWeights;
+	std::vector< int32_t > Nnue::_hidden1Biases;
+	std::vector< int8_t > Nnue::_hidden1Weights;
+	std::vector< int32_t > Nnue::_hidden2Biases;
+	std::vector< int8_t > Nnue::_hidden2Weights;
+	int32_t Nnue::_outputBias = 0;
+	std::vector< int8_t > Nnue::_outputWeights;
+	unsigned int Nnue::_networkId = 0;
+	unsigned int Nnue::_loadsCount = 0;
+
+	namespace
+	{
+		template< typename T >
+		bool readValues( std::istream& stream, std::vector< T >& values, const size_t size )
+		{
+			values.resize( size );
+			stream.read( reinterpret_cast< char* >( values.data() ), size * sizeof( T ) );
+			return (bool)stream;
+		}
+
+		template< typename T >
+		bool readValue( std::istream& stream, T& value )
+		{
+			stream.read( reinterpret_cast< char* >( &value ), sizeof( T ) );
+			return (bool)stream;
+		}
+
+#if defined(__AVX2__)
+		inline int32_t horizontalSum( const __m256i v )
+		{
+			__m128i sum = _mm_add_epi32( _mm256_castsi256_si128( v ), _mm256_extracti128_si256( v, 1 ) );
+			sum = _mm_add_epi32( sum, _mm_shuffle_epi32( sum, _MM_SHUFFLE( 1, 0, 3, 2 ) ) );
+			sum = _mm_add_epi32( sum, _mm_shuffle_epi32( sum, _MM_SHUFFLE( 2, 3, 0, 1 ) ) );
+			return _mm_cvtsi128_si32( sum );
+		}
+#elif defined(__SSE4_1__)
+		inline int32_t horizontalSum( const __m128i v )
+		{
+			__m128i sum = _mm_add_epi32( v, _mm_shuffle_epi32( v, _MM_SHUFFLE( 1, 0, 3, 2 ) ) );
+			sum = _mm_add_epi32( sum, _mm_shuffle_epi32( sum, _MM_SHUFFLE( 2, 3, 0, 1 ) ) );
+			return _mm_cvtsi128_si32( sum );
+		}
+#endif
+	}
+
+	/*****************************************************************
+	*	static methods
+	******************************************************************/
+
+	/*! \brief load the network from a file
+	*
+	*	return false if the file can't be read or doesn't contain a valid network, the loaded network isn't changed
+	*/
+	bool Nnue::load( const std::string& fileName )
+	{
+		std::ifstream file( fileName, std::ios::binary );
+		return file && load( file );
+	}
+
+	bool Nnue::load( std::istream& stream )
+	{
+		uint32_t magic = 0;
+		uint32_t version = 0;
+		if( !readValue( stream, magic ) || !readValue( stream, version ) || magic != fileMagic || version != fileVersion )
+		{
+			return false;
+		}
+
+		std::vector< int16_t > featureBiases, featureWeights;
+		std::vector< int32_t > hidden1Biases, hidden2Biases;
+		std::vector< int8_t > hidden1Weights, hidden2Weights, outputWeights;
+		int32_t outputBias = 0;
+
+		if( !readValues( stream, featureBiases, halfDimensions )
+			|| !readValues( stream, featureWeights, featuresNumber * halfDimensions )
+			|| !readValues( stream, hidden1Biases, hiddenDimensions )
+			|| !readValues( stream, hidden1Weights, hiddenDimensions * 2 * halfDimensions )
+			|| !readValues( stream, hidden2Biases, hiddenDimensions )
+			|| !readValues( stream, hidden2Weights, hiddenDimensions * hiddenDimensions )
+			|| !readValue( stream, outputBias )
+			|| !readValues( stream, outputWeights, hiddenDimensions )
+			|| stream.peek() != std::istream::traits_type::eof() )
+		{
+			return false;
+		}
+
+		_featureBiases = std::move( featureBiases );
+		_featureWeights = std::move( featureWeights );
+		_hidden1Biases = std::move( hidden1Biases );
+		_hidden1Weights = std::move( hidden1Weights );
+		_hidden2Biases = std::move( hidden2Biases );
+		_hidden2Weights = std::move( hidden2Weights );
+		_outputBias = outputBias;
+		_outputWeights = std::move( outputWeights );
+
+		// the accumulators computed with the previous network are no more valid
+		_networkId = ++_loadsCount;
+		return true;
+	}
+
+	/*! \brief free the network, the evaluation falls back to the classical one
+	*
+	*/
+	void Nnue::unload()
+	{
+		_featureBiases.clear();
+		_featureWeights.clear();
+		_hidden1Biases.clear();
+		_hidden1Weights.clear();
+		_hidden2Biases.clear();
+		_hidden2Weights.clear();
+		_outputBias = 0;
+		_outputWeights.clear();
+		_networkId = 0;
+	}
+
+	/*! \brief evaluate the position from the point of view of the side to move
+	*
+	*/
+	Score Nnue::evaluate( const Position& pos )
+	{
+		assert( isLoaded() );
+		const Accumulator& acc = pos.getAccumulator();
+		const baseTypes::eTurn us = pos.getActualStateConst().getTurn();
+		const baseTypes::eTurn them = getSwitchedTurn( us );
+
+		alignas( 32 ) std::array< uint8_t, 2 * halfDimensions > input;
+		alignas( 32 ) std::array< int32_t, hiddenDimensions > hidden;
+		alignas( 32 ) std::array< uint8_t, hiddenDimensions > hidden1;
+		alignas( 32 ) std::array< uint8_t, hiddenDimensions > hidden2;
+		int32_t output;
+
+		_clipAccumulator( acc.values[ us ].data(), input.data() );
+		_clipAccumulator( acc.values[ them ].data(), input.data() + halfDimensions );
+
+		_affine< 2 * halfDimensions >( input.data(), _hidden1Weights.data(), _hidden1Biases.data(), hidden.data(), hiddenDimensions );
+		_clipHidden( hidden.data(), hidden1.data() );
+		_affine< hiddenDimensions >( hidden1.data(), _hidden2Weights.data(), _hidden2Biases.data(), hidden.data(), hiddenDimensions );
+		_clipHidden( hidden.data(), hidden2.data() );
+		_affine< hiddenDimensions >( hidden2.data(), _outputWeights.data(), &_outputBias, &output, 1 );
+
+		return output / outputScale;
+	}
+
+	/*! \brief compute the accumulator of both perspectives from the board
+	*
+	*/
+	void Nnue::refresh( const Position& pos, Accumulator& acc )
+	{
+		refresh( pos, acc, baseTypes::whiteTurn );
+		refresh( pos, acc, baseTypes::blackTurn );
+	}
+
+	void Nnue::refresh( const Position& pos, Accumulator& acc, const baseTypes::eTurn perspective )
+	{
+		assert( isLoaded() );
+		int16_t* values = acc.values[ perspective ].data();
+		const baseTypes::tSquare kingSquare = pos.getSquareOfThePiece( baseTypes::getPiece( perspective, baseTypes::King ) );
+
+		std::copy( _featureBiases.begin(), _featureBiases.end(), values );
+		const baseTypes::BitMap pieces = pos.getOccupationBitMap() ^ pos.getBitmap( baseTypes::whiteKing ) ^ pos.getBitmap( baseTypes::blackKing );
+		for( const auto sq : pieces )
+		{
+			_addWeights( values, values, _getFeatureWeights( getFeatureIndex( perspective, kingSquare, pos.getPieceAt( sq ), sq ) ) );
+		}
+		acc.networkId[ perspective ] = _networkId;
+	}
+
+	/*! \brief compute the accumulator of a perspective from the previous one and the pieces changed by the move
+	*
+	*	the king of the perspective shall not be moved by the move, the kings aren't features
+	*/
+	void Nnue::update( const Accumulator& previous, Accumulator& acc, const baseTypes::eTurn perspective, const baseTypes::tSquare kingSquare )
+	{
+		assert( previous.isComputed( perspective ) );
+		int16_t* values = acc.values[ perspective ].data();
+		// the first change reads the previous accumulator, the next ones work in place
+		const int16_t* in = previous.values[ perspective ].data();
+
+		for( unsigned int i = 0; i < acc.dirty.count; ++i )
+		{
+			const DirtyPiece& dp = acc.dirty.pieces[ i ];
+			if( baseTypes::isKing( dp.piece ) )
+			{
+				assert( dp.piece != baseTypes::getPiece( perspective, baseTypes::King ) );
+				continue;
+			}
+			if( dp.from == baseTypes::squareNone )
+			{
+				_addWeights( values, in, _getFeatureWeights( getFeatureIndex( perspective, kingSquare, dp.piece, dp.to ) ) );
+			}
+			else if( dp.to == baseTypes::squareNone )
+			{
+				_subWeights( values, in, _getFeatureWeights( getFeatureIndex( perspective, kingSquare, dp.piece, dp.from ) ) );
+			}
+			else
+			{
+				_addSubWeights( values, in,
+					_getFeatureWeights( getFeatureIndex( perspective, kingSquare, dp.piece, dp.to ) ),
+					_getFeatureWeights( getFeatureIndex( perspective, kingSquare, dp.piece, dp.from ) ) );
+			}
+			in = values;
+		}
+		if( in != values )
+		{
+			// null move, or only the other king moved
+			acc.values[ perspective ] = previous.values[ perspective ];
+		}
+		acc.networkId[ perspective ] = _networkId;
+	}
+
+	/*****************************************************************
+	*	kernels
+	******************************************************************/
+	void Nnue::_addWeights( int16_t* out, const int16_t* in, const int16_t* weights )
+	{
+#if defined(__AVX2__)
+		for( unsigned int i = 0; i < halfDimensions; i += 16 )
+		{
+			const __m256i a = _mm256_load_si256( reinterpret_cast< const __m256i* >( in + i ) );
+			_mm256_store_si256( reinterpret_cast< __m256i* >( out + i ), _mm256_add_epi16( a, _mm256_loadu_si256( reinterpret_cast< const __m256i* >( weights + i ) ) ) );
+		}
+#elif defined(__SSE4_1__)
+		for( unsigned int i = 0; i < halfDimensions; i += 8 )
+		{
+			const __m128i a = _mm_load_si128( reinterpret_cast< const __m128i* >( in + i ) );
+			_mm_store_si128( reinterpret_cast< __m128i* >( out + i ), _mm_add_epi16( a, _mm_loadu_si128( reinterpret_cast< const __m128i* >( weights + i ) ) ) );
+		}
+#else
+		for( unsigned int i = 0; i < halfDimensions; ++i )
+		{
+			out[ i ] = in[ i ] + weights[ i ];
+		}
+#endif
+	}
+
+	void Nnue::_subWeights( int16_t* out, const int16_t* in, const int16_t* weights )
+	{
+#if defined(__AVX2__)
+		for( unsigned int i = 0; i < halfDimensions; i += 16 )
+		{
+			const __m256i a = _mm256_load_si256( reinterpret_cast< const __m256i* >( in + i ) );
+			_mm256_store_si256( reinterpret_cast< __m256i* >( out + i ), _mm256_sub_epi16( a, _mm256_loadu_si256( reinterpret_cast< const __m256i* >( weights + i ) ) ) );
+		}
+#elif defined(__SSE4_1__)
+		for( unsigned int i = 0; i < halfDimensions; i += 8 )
+		{
+			const __m128i a = _mm_load_si128( reinterpret_cast< const __m128i* >( in + i ) );
+			_mm_store_si128( reinterpret_cast< __m128i* >( out + i ), _mm_sub_epi16( a, _mm_loadu_si128( reinterpret_cast< const __m128i* >( weights + i ) ) ) );
+		}
+#else
+		for( unsigned int i = 0; i < halfDimensions; ++i )
+		{
+			out[ i ] = in[ i ] - weights[ i ];
+		}
+#endif
+	}
+
+	void Nnue::_addSubWeights( int16_t* out, const int16_t* in, const int16_t* added, const int16_t* removed )
+	{
+#if defined(__AVX2__)
+		for( unsigned int i = 0; i < halfDimensions; i += 16 )
+		{
+			const __m256i a = _mm256_load_si256( reinterpret_cast< const __m256i* >( in + i ) );
+			const __m256i delta = _mm256_sub_epi16( _mm256_loadu_si256( reinterpret_cast< const __m256i* >( added + i ) ), _mm256_loadu_si256( reinterpret_cast< const __m256i* >( removed + i ) ) );
+			_mm256_store_si256( reinterpret_cast< __m256i* >( out + i ), _mm256_add_epi16( a, delta ) );
+		}
+#elif defined(__SSE4_1__)
+		for( unsigned int i = 0; i < halfDimensions; i += 8 )
+		{
+			const __m128i a = _mm_load_si128( reinterpret_cast< const __m128i* >( in + i ) );
+			const __m128i delta = _mm_sub_epi16( _mm_loadu_si128( reinterpret_cast< const __m128i* >( added + i ) ), _mm_loadu_si128( reinterpret_cast< const __m128i* >( removed + i ) ) );
+			_mm_store_si128( reinterpret_cast< __m128i* >( out + i ), _mm_add_epi16( a, delta ) );
+		}
+#else
+		for( unsigned int i = 0; i < halfDimensions; ++i )
+		{
+			out[ i ] = in[ i ] + added[ i ] - removed[ i ];
+		}
+#endif
+	}
+
+	/*! \brief clip the accumulator values to [ 0, clipMax ]
+	*
+	*/
+	void Nnue::_clipAccumulator( const int16_t* acc, uint8_t* out )
+	{
+#if defined(__AVX2__)
+		const __m256i zero = _mm256_setzero_si256();
+		for( unsigned int i = 0; i < halfDimensions; i += 32 )
+		{
+			const __m256i a = _mm256_load_si256( reinterpret_cast< const __m256i* >( acc + i ) );
+			const __m256i b = _mm256_load_si256( reinterpret_cast< const __m256i* >( acc + i + 16 ) );
+			// packs works on the 128 bit lanes, the permutation restores the order of the values
+			const __m256i packed = _mm256_permute4x64_epi64( _mm256_packs_epi16( a, b ), 0xD8 );
+			_mm256_store_si256( reinterpret_cast< __m256i* >( out + i ), _mm256_max_epi8( packed, zero ) );
+		}
+#elif defined(__SSE4_1__)
+		const __m128i zero = _mm_setzero_si128();
+		for( unsigned int i = 0; i < halfDimensions; i += 16 )
+		{
+			const __m128i a = _mm_load_si128( reinterpret_cast< const __m128i* >( acc + i ) );
+			const __m128i b = _mm_load_si128( reinterpret_cast< const __m128i* >( acc + i + 8 ) );
+			_mm_store_si128( reinterpret_cast< __m128i* >( out + i ), _mm_max_epi8( _mm_packs_epi16( a, b ), zero ) );
+		}
+#else
+		for( unsigned int i = 0; i < halfDimensions; ++i )
+		{
+			out[ i ] = (uint8_t)std::clamp( (int)acc[ i ], 0, clipMax );
+		}
+#endif
+	}
+
+	/*! \brief out = biases + weights * in, the weights are stored by rows of inputs values
+	*
+	*	the inputs are in [ 0, clipMax ], so the sum of two products computed by maddubs never saturates
+	*/
+	template< unsigned int inputs >
+	void Nnue::_affine( const uint8_t* in, const int8_t* weights, const int32_t* biases, int32_t* out, const unsigned int outputs )
+	{
+#if defined(__AVX2__)
+		static_assert( inputs % 32 == 0, "the inputs shall fill the registers" );
+		const __m256i ones = _mm256_set1_epi16( 1 );
+		for( unsigned int o = 0; o < outputs; ++o )
+		{
+			const int8_t* row = weights + o * inputs;
+			__m256i sum = _mm256_setzero_si256();
+			for( unsigned int i = 0; i < inputs; i += 32 )
+			{
+				const __m256i products = _mm256_maddubs_epi16( _mm256_load_si256( reinterpret_cast< const __m256i* >( in + i ) ), _mm256_loadu_si256( reinterpret_cast< const __m256i* >( row + i ) ) );
+				sum = _mm256_add_epi32( sum, _mm256_madd_epi16( products, ones ) );
+			}
+			out[ o ] = biases[ o ] + horizontalSum( sum );
+		}
+#elif defined(__SSE4_1__)
+		static_assert( inputs % 16 == 0, "the inputs shall fill the registers" );
+		const __m128i ones = _mm_set1_epi16( 1 );
+		for( unsigned int o = 0; o < outputs; ++o )
+		{
+			const int8_t* row = weights + o * inputs;
+			__m128i sum = _mm_setzero_si128();
+			for( unsigned int i = 0; i < inputs; i += 16 )
+			{
+				const __m128i products = _mm_maddubs_epi16( _mm_load_si128( reinterpret_cast< const __m128i* >( in + i ) ), _mm_loadu_si128( reinterpret_cast< const __m128i* >( row + i ) ) );
+				sum = _mm_add_epi32( sum, _mm_madd_epi16( products, ones ) );
+			}
+			out[ o ] = biases[ o ] + horizontalSum( sum );
+		}
+#else
+		for( unsigned int o = 0; o < outputs; ++o )
+		{
+			const int8_t* row = weights + o * inputs;
+			int32_t sum = biases[ o ];
+			for( unsigned int i = 0; i < inputs; ++i )
+			{
+				sum += in[ i ] * row[ i ];
+			}
+			out[ o ] = sum;
+		}
+#endif
+	}
+
+	void Nnue::_clipHidden( const int32_t* in, uint8_t* out )
+	{
+		for( unsigned int i = 0; i < hiddenDimensions; ++i )
+		{
+			out[ i ] = (uint8_t)std::clamp( in[ i ] >> weightShift, 0, clipMax );
+		}
+	}
+}
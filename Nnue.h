@@ -0,0 +1,225 @@
+/*
+	This file is part of Vajolet.
+	Copyright (C) 2013-2018 Marco Belli
+
+    Vajolet is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Vajolet is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#ifndef NNUE_H_
+#define NNUE_H_
+
+#include <array>
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <vector>
+#include "BitBoardIndex.h"
+#include "eTurn.h"
+#include "Score.h"
+#include "tSquare.h"
+
+namespace libChess
+{
+	// forward declaration
+	class Position;
+
+	/*!	\brief efficiently updatable neural network evaluation
+
+		the network use the HalfKP feature set: for each perspective a feature is the tuple ( king square, piece, square )
+		of every piece that isn't a king, with the board flipped vertically for black.
+		the first layer ( the feature transformer ) is kept in an Accumulator for every state of the Position. doMove only
+		records the pieces changed by the move, the accumulator is updated from the previous one when the evaluation needs it;
+		only a king move refresh the accumulator of its perspective from the board.
+		The two halves of the accumulator, side to move first, are clipped and fed to two hidden layers of int8 weights and
+		to the output neuron.
+
+		The network file is little endian and contains, in order:
+		uint32 fileMagic, uint32 fileVersion,
+		int16 feature biases[ halfDimensions ], int16 feature weights[ featuresNumber ][ halfDimensions ],
+		int32 hidden1 biases[ hiddenDimensions ], int8 hidden1 weights[ hiddenDimensions ][ 2 * halfDimensions ],
+		int32 hidden2 biases[ hiddenDimensions ], int8 hidden2 weights[ hiddenDimensions ][ hiddenDimensions ],
+		int32 output bias, int8 output weights[ hiddenDimensions ]
+	 */
+	class Nnue
+	{
+	public:
+		/*****************************************************************
+		*	static members
+		******************************************************************/
+		static constexpr unsigned int featuresNumber = 64 * 10 * 64;	// king square * piece * piece square
+		static constexpr unsigned int halfDimensions = 256;
+		static constexpr unsigned int hiddenDimensions = 32;
+		static constexpr int weightShift = 6;		// the hidden layers outputs are divided by 2^weightShift before the clipping
+		static constexpr int outputScale = 16;		// the output of the network is divided by outputScale to get centipawns
+		static constexpr int clipMax = 127;
+		static constexpr uint32_t fileMagic = 0x4E4E4A56;	// "VJNN"
+		static constexpr uint32_t fileVersion = 1;
+
+		/*!	\brief a piece added ( from is squareNone ), removed ( to is squareNone ) or moved by a move
+		 */
+		struct DirtyPiece
+		{
+			baseTypes::bitboardIndex piece;
+			baseTypes::tSquare from;
+			baseTypes::tSquare to;
+		};
+
+		/*!	\brief changes of the board done by a move, recorded by doMove and applied to the accumulator when it's needed
+		 */
+		struct DirtyPieces
+		{
+			std::array< DirtyPiece, 3 > pieces;	// at most a capture and a promotion, or the king and the rook of a castling
+			unsigned int count = 0;
+
+			void add( const baseTypes::bitboardIndex piece, const baseTypes::tSquare sq );
+			void remove( const baseTypes::bitboardIndex piece, const baseTypes::tSquare sq );
+			void move( const baseTypes::bitboardIndex piece, const baseTypes::tSquare from, const baseTypes::tSquare to );
+			void promote( const baseTypes::bitboardIndex promotedPiece );
+			bool isMoved( const baseTypes::bitboardIndex piece ) const;
+		};
+
+		/*!	\brief output of the feature transformer for the two perspectives, with the changes from the previous one
+
+			every perspective is valid only if it was computed with the network currently loaded.
+			The values aren't initialized by the constructor, they are written only when the accumulator is computed
+		 */
+		struct Accumulator
+		{
+			Accumulator(){}
+
+			alignas( 32 ) std::array< std::array< int16_t, halfDimensions >, baseTypes::turnNumber > values;
+			std::array< unsigned int, baseTypes::turnNumber > networkId = {{ 0, 0 }};
+			DirtyPieces dirty;
+
+			bool isComputed( const baseTypes::eTurn perspective ) const;
+		};
+
+		/*****************************************************************
+		*	static methods
+		******************************************************************/
+		static bool load( const std::string& fileName );
+		static bool load( std::istream& stream );
+		static void unload();
+		static bool isLoaded();
+		static unsigned int getNetworkId();
+
+		static Score evaluate( const Position& pos );
+		static unsigned int getFeatureIndex( const baseTypes::eTurn perspective, const baseTypes::tSquare kingSquare, const baseTypes::bitboardIndex piece, const baseTypes::tSquare sq );
+
+		static void refresh( const Position& pos, Accumulator& acc );
+		static void refresh( const Position& pos, Accumulator& acc, const baseTypes::eTurn perspective );
+		static void update( const Accumulator& previous, Accumulator& acc, const baseTypes::eTurn perspective, const baseTypes::tSquare kingSquare );
+
+	private:
+		/*****************************************************************
+		*	static methods
+		******************************************************************/
+		static void _addWeights( int16_t* out, const int16_t* in, const int16_t* weights );
+		static void _subWeights( int16_t* out, const int16_t* in, const int16_t* weights );
+		static void _addSubWeights( int16_t* out, const int16_t* in, const int16_t* added, const int16_t* removed );
+		static void _clipAccumulator( const int16_t* acc, uint8_t* out );
+		template< unsigned int inputs > static void _affine( const uint8_t* in, const int8_t* weights, const int32_t* biases, int32_t* out, const unsigned int outputs );
+		static void _clipHidden( const int32_t* in, uint8_t* out );
+		static const int16_t* _getFeatureWeights( const unsigned int index );
+
+		/*****************************************************************
+		*	static members
+		******************************************************************/
+		static std::vector< int16_t > _featureBiases;
+		static std::vector< int16_t > _featureWeights;
+		static std::vector< int32_t > _hidden1Biases;
+		static std::vector< int8_t > _hidden1Weights;
+		static std::vector< int32_t > _hidden2Biases;
+		static std::vector< int8_t > _hidden2Weights;
+		static int32_t _outputBias;
+		static std::vector< int8_t > _outputWeights;
+		static unsigned int _networkId;	// incremented by every load, 0 when no network is loaded
+		static unsigned int _loadsCount;
+	};
+
+	inline bool Nnue::isLoaded()
+	{
+		return _networkId != 0;
+	}
+
+	inline unsigned int Nnue::getNetworkId()
+	{
+		return _networkId;
+	}
+
+	inline bool Nnue::Accumulator::isComputed( const baseTypes::eTurn perspective ) const
+	{
+		return networkId[ perspective ] != 0 && networkId[ perspective ] == Nnue::getNetworkId();
+	}
+
+	inline void Nnue::DirtyPieces::add( const baseTypes::bitboardIndex piece, const baseTypes::tSquare sq )
+	{
+		assert( count < pieces.size() );
+		pieces[ count++ ] = { piece, baseTypes::squareNone, sq };
+	}
+
+	inline void Nnue::DirtyPieces::remove( const baseTypes::bitboardIndex piece, const baseTypes::tSquare sq )
+	{
+		assert( count < pieces.size() );
+		pieces[ count++ ] = { piece, sq, baseTypes::squareNone };
+	}
+
+	inline void Nnue::DirtyPieces::move( const baseTypes::bitboardIndex piece, const baseTypes::tSquare from, const baseTypes::tSquare to )
+	{
+		assert( count < pieces.size() );
+		pieces[ count++ ] = { piece, from, to };
+	}
+
+	/*! \brief the last piece moved is replaced by the promoted piece on its destination square
+	*
+	*/
+	inline void Nnue::DirtyPieces::promote( const baseTypes::bitboardIndex promotedPiece )
+	{
+		assert( count > 0 && count < pieces.size() );
+		DirtyPiece& pawn = pieces[ count - 1 ];
+		add( promotedPiece, pawn.to );
+		pawn.to = baseTypes::squareNone;
+	}
+
+	inline bool Nnue::DirtyPieces::isMoved( const baseTypes::bitboardIndex piece ) const
+	{
+		for( unsigned int i = 0; i < count; ++i )
+		{
+			if( pieces[ i ].piece == piece )
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/*! \brief index of a feature, the square of the king and of the piece are seen from the perspective
+	*
+	*	own pieces use the piece indexes 0-4 ( queen to pawn ), the opponent ones 5-9
+	*/
+	inline unsigned int Nnue::getFeatureIndex( const baseTypes::eTurn perspective, const baseTypes::tSquare kingSquare, const baseTypes::bitboardIndex piece, const baseTypes::tSquare sq )
+	{
+		assert( !baseTypes::isKing( piece ) );
+		const unsigned int flip = perspective == baseTypes::whiteTurn ? 0 : 56;
+		const unsigned int pieceIndex = ( piece & 7 ) - baseTypes::Queens + ( baseTypes::isWhitePiece( piece ) == ( perspective == baseTypes::whiteTurn ) ? 0 : 5 );
+		return ( ( (unsigned int)kingSquare ^ flip ) * 10 + pieceIndex ) * 64 + ( (unsigned int)sq ^ flip );
+	}
+
+	inline const int16_t* Nnue::_getFeatureWeights( const unsigned int index )
+	{
+		return &_featureWeights[ index * halfDimensions ];
+	}
+}
+
+#endif /* NNUE_H_ */
@@ -0,0 +1,140 @@
+/*
+	This file is part of Vajolet.
+	Copyright (C) 2013-2018 Marco Belli
+
+    Vajolet is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Vajolet is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#include <algorithm>
+#include <cassert>
+#include "BitBoardIndex.h"
+#include "PackedPosition.h"
+#include "Position.h"
+
+namespace libChess
+{
+	/*****************************************************************
+	*	constructors
+	******************************************************************/
+	PackedPosition::PackedPosition()
+	{
+		_data.fill( 0 );
+	}
+
+	PackedPosition::PackedPosition( const Position& pos )
+	{
+		_data.fill( 0 );
+		const GameState& st = pos.getActualStateConst();
+
+		const uint64_t occupancy = pos.getOccupationBitMap().getInternalRepresentation();
+		for( unsigned int i = 0; i < 8; ++i )
+		{
+			_data[ i ] = ( occupancy >> ( 8 * i ) ) & 0xFF;
+		}
+
+		unsigned int n = 0;
+		for( const auto sq : pos.getOccupationBitMap() )
+		{
+			assert( n < maxPieces );
+			_data[ _piecesOffset + n / 2 ] |= pos.getPieceAt( sq ) << ( 4 * ( n & 1 ) );
+			++n;
+		}
+
+		_data[ _flagsOffset ] = ( st.getTurn() == baseTypes::blackTurn ? 1 : 0 ) | ( st.getCastleRights() << 1 );
+		_data[ _epOffset ] = st.hasEpSquareSet() ? st.getEpSquare() : baseTypes::squareNumber;
+		_data[ _fiftyMoveOffset ] = std::min( st.getFiftyMoveCnt(), 255u );
+		const unsigned int fullMove = std::min( st.getFullMoveCounter(), 65535u );
+		_data[ _fullMoveOffset ] = fullMove & 0xFF;
+		_data[ _fullMoveOffset + 1 ] = fullMove >> 8;
+	}
+
+	/*! \brief read a packed position from the size bytes written by getData
+	*
+	*/
+	PackedPosition::PackedPosition( const uint8_t* data )
+	{
+		std::copy( data, data + size, _data.begin() );
+	}
+
+	/*****************************************************************
+	*	methods
+	******************************************************************/
+	std::string PackedPosition::getFen() const
+	{
+		uint64_t occupancy = 0;
+		for( unsigned int i = 0; i < 8; ++i )
+		{
+			occupancy |= uint64_t( _data[ i ] ) << ( 8 * i );
+		}
+
+		std::array< baseTypes::bitboardIndex, baseTypes::squareNumber > squares;
+		squares.fill( baseTypes::empty );
+		unsigned int n = 0;
+		for( const auto sq : baseTypes::BitMap( occupancy ) )
+		{
+			squares[ sq ] = baseTypes::bitboardIndex( ( _data[ _piecesOffset + n / 2 ] >> ( 4 * ( n & 1 ) ) ) & 0xF );
+			++n;
+		}
+
+		std::string s;
+		for( int rank = 7; rank >= 0; --rank )
+		{
+			unsigned int emptyFiles = 0;
+			for( int file = 0; file < 8; ++file )
+			{
+				const baseTypes::bitboardIndex piece = squares[ rank * 8 + file ];
+				if( piece == baseTypes::empty )
+				{
+					++emptyFiles;
+					continue;
+				}
+				if( emptyFiles != 0 )
+				{
+					s += std::to_string( emptyFiles );
+					emptyFiles = 0;
+				}
+				s += baseTypes::getPieceName( piece );
+			}
+			if( emptyFiles != 0 )
+			{
+				s += std::to_string( emptyFiles );
+			}
+			if( rank != 0 )
+			{
+				s += "/";
+			}
+		}
+
+		const uint8_t flags = _data[ _flagsOffset ];
+		s += ( flags & 1 ) ? " b " : " w ";
+
+		// castle rights bits in the eCastle order
+		const char castleNames[] = "KQkq";
+		std::string castle;
+		for( unsigned int i = 0; i < 4; ++i )
+		{
+			if( flags & ( 2 << i ) )
+			{
+				castle += castleNames[ i ];
+			}
+		}
+		s += castle.empty() ? "-" : castle;
+
+		const unsigned int ep = _data[ _epOffset ];
+		s += " " + ( ep < baseTypes::squareNumber ? baseTypes::to_string( baseTypes::tSquare( ep ) ) : std::string( "-" ) );
+		s += " " + std::to_string( _data[ _fiftyMoveOffset ] );
+		s += " " + std::to_string( _data[ _fullMoveOffset ] | ( _data[ _fullMoveOffset + 1 ] << 8 ) );
+		return s;
+	}
+}
@@ -0,0 +1,112 @@
+/*
+	This file is part of Vajolet.
+	Copyright (C) 2013-2018 Marco Belli
+
+    Vajolet is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Vajolet is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#ifndef PACKEDPOSITION_H_
+#define PACKEDPOSITION_H_
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+namespace libChess
+{
+	// forward declaration
+	class Position;
+
+	/*!	\brief position packed in 32 bytes, used to store training data
+
+		bytes 0-7 are the occupancy bitmap, followed by the pieces of the occupied squares ( 4 bits each, in square order ).
+		byte 24 holds the side to move ( bit 0 ) and the castle rights ( bits 1-4 ), byte 25 the en passant square
+		( 64 when not set ), byte 26 the fifty move counter and bytes 27-28 the full move counter.
+		Only the standard chess castle rights are supported
+	 */
+	class PackedPosition
+	{
+	public:
+		/*****************************************************************
+		*	constructors
+		******************************************************************/
+		PackedPosition();
+		explicit PackedPosition( const Position& pos );
+		explicit PackedPosition( const uint8_t* data );
+
+		/*****************************************************************
+		*	operators
+		******************************************************************/
+		bool operator==( const PackedPosition& other ) const;
+
+		/*****************************************************************
+		*	methods
+		******************************************************************/
+		std::string getFen() const;
+		const uint8_t* getData() const;
+
+		/*****************************************************************
+		*	static members
+		******************************************************************/
+		static constexpr unsigned int size = 32;
+		static constexpr unsigned int maxPieces = 32;
+
+	private:
+		/*****************************************************************
+		*	members
+		******************************************************************/
+		std::array< uint8_t, size > _data;
+
+		/*****************************************************************
+		*	static members
+		******************************************************************/
+		static constexpr unsigned int _piecesOffset = 8;
+		static constexpr unsigned int _flagsOffset = 24;
+		static constexpr unsigned int _epOffset = 25;
+		static constexpr unsigned int _fiftyMoveOffset = 26;
+		static constexpr unsigned int _fullMoveOffset = 27;
+	};
+
+	/*!	\brief a position of a game with its search result, as written by the training data generator
+
+		score and result are seen from the side to move, the result is 1 for a win, 0 for a draw and -1 for a loss
+	 */
+	struct TrainingRecord
+	{
+		PackedPosition pos;
+		int16_t score;
+		int8_t result;
+		uint8_t reserved;
+		uint16_t move;	// packed best move
+		uint16_t ply;
+	};
+
+	static_assert( sizeof( PackedPosition ) == PackedPosition::size, "packed position shall be 32 bytes" );
+	static_assert( sizeof( TrainingRecord ) == 40, "training record shall be 40 bytes" );
+
+	/*! \brief the size bytes of the packed position, to be stored
+	*
+	*/
+	inline const uint8_t* PackedPosition::getData() const
+	{
+		return _data.data();
+	}
+
+	inline bool PackedPosition::operator==( const PackedPosition& other ) const
+	{
+		return _data == other._data;
+	}
+}
+
+#endif /* PACKEDPOSITION_H_ */
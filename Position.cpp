@@ -16,10 +16,15 @@
     along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
 */
 
+#include <algorithm>
 #include <utility>
 #include <sstream>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
 #include "Position.h"
 #include "BitMapMoveGenerator.h"
+#include "Cuckoo.h"
 #include "MoveGenerator.h"
 #include "MoveSelector.h"
 #include "MoveList.h"
@@ -41,7 +46,7 @@ namespace libChess
 		//_setKingsSquare();
 	}
 	
-	Position::Position(const Position& other):_stateList(other._stateList), _squares(other._squares),_bitBoard(other._bitBoard), _castleRightsMask(other._castleRightsMask), _castleKingPath(other._castleKingPath), _castleOccupancyPath(other._castleOccupancyPath), _castleRookInvolved(other._castleRookInvolved), _castleKingFinalSquare(other._castleKingFinalSquare), _castleRookFinalSquare(other._castleRookFinalSquare), _kingsSquare(other._kingsSquare)
+	Position::Position(const Position& other):_stateList(other._stateList), _keyHistory(other._keyHistory), _squares(other._squares),_bitBoard(other._bitBoard), _castleRightsMask(other._castleRightsMask), _castleKingPath(other._castleKingPath), _castleOccupancyPath(other._castleOccupancyPath), _castleRookInvolved(other._castleRookInvolved), _castleKingFinalSquare(other._castleKingFinalSquare), _castleRookFinalSquare(other._castleRookFinalSquare), _kingsSquare(other._kingsSquare), _accumulators(other._accumulators)
 	{		
 		_setUsThem();
 		
@@ -53,6 +58,7 @@ namespace libChess
 			return *this;
 
 		_stateList = other._stateList;
+		_keyHistory = other._keyHistory;
 		
 		_squares = other._squares;
 		_bitBoard = other._bitBoard;
@@ -67,6 +73,8 @@ namespace libChess
 		_kingsSquare = other._kingsSquare;
 		_castleKingFinalSquare = other._castleKingFinalSquare;
 		_castleRookFinalSquare = other._castleKingFinalSquare;
+		
+		_accumulators = other._accumulators;
 
 		return *this;
 	}
@@ -76,6 +84,10 @@ namespace libChess
 	{
 		_stateList.clear();
 		_stateList.emplace_back(GameState());
+		_keyHistory.clear();
+		_keyHistory.push_back( getActualStateConst().getKey().getKey() );
+		_accumulators.clear();
+		_accumulators.emplace_back();
 	}
 	
 	
@@ -95,12 +107,15 @@ namespace libChess
 	inline GameState& Position::_pushState(void)
 	{
 		_stateList.emplace_back( getActualStateConst() );
+		_accumulators.emplace_back();
 		return _getActualState();
 	}
 	
 	inline void Position::_popState(void)
 	{
 		_stateList.pop_back();
+		_keyHistory.pop_back();
+		_accumulators.pop_back();
 	}
 	
 	const GameState& Position::getState(unsigned int n)const
@@ -167,7 +182,6 @@ namespace libChess
 		_bitBoard[ baseTypes::occupiedSquares ] ^= b;
 		_bitBoard[ piece ] ^= b;
 		_bitBoard[ MyPieces ] ^= b;
-
 	}
 	
 	inline void Position::_movePiece(const baseTypes::bitboardIndex piece, const baseTypes::tSquare from, const baseTypes::tSquare to)
@@ -189,9 +203,6 @@ namespace libChess
 		_bitBoard[baseTypes::occupiedSquares] ^= fromTo;
 		_bitBoard[piece] ^= fromTo;
 		_bitBoard[MyPieces] ^= fromTo;
-		
-
-
 	}
 	
 	
@@ -259,6 +270,38 @@ namespace libChess
 		return hash;
 	}	
 	
+	/*	\brief calculate from scratch the material value of the position
+	*
+	*/
+	simdScore Position::_calcMaterialValue(void) const
+	{
+		simdScore score = { 0, 0, 0, 0 };
+		for( const auto p: baseTypes::bitboardIndexRange() )
+		{
+			if ( baseTypes::isValidPiece(p) )
+			{
+				score += _pieceValue[ p ] * (int)getPieceCount( p );
+			}
+		}
+		return score;
+	}
+	
+	/*	\brief calculate from scratch the non pawn material value of the position
+	*
+	*/
+	simdScore Position::_calcNonPawnMaterialValue(void) const
+	{
+		simdScore score = { 0, 0, 0, 0 };
+		for( const auto p: baseTypes::bitboardIndexRange() )
+		{
+			if ( baseTypes::isValidPiece(p) )
+			{
+				score += _nonPawnValue[ p ] * (int)getPieceCount( p );
+			}
+		}
+		return score;
+	}
+	
 	/*	\brief display the fen string of the position
 	\author Marco Belli
 	\version 1.0
@@ -794,22 +837,13 @@ namespace libChess
 		st.resetCountersNullMove();
 		st.setCurrentMove( Move::NOMOVE );
 		st.resetCapturedPiece();
-		/*
-		// todo readd those methods
-
-		x.nonPawnMaterial = calcNonPawnMaterialValue();
-
-		x.material=  calcMaterialValue();*/
+		st.setMaterialValues( _calcMaterialValue(), _calcNonPawnMaterialValue() );
 		
 		st.setKeys(_calcKey(), _calcPawnKey(), _calcMaterialKey() );
+		_keyHistory.back() = st.getKey().getKey();
 
-
-		
-		
 		_calcCheckingSquares();
-	
-		st.setDiscoveryChechers( _calcPin( getSquareOfEnemyKing(), getOurQBSlidingBitMap(), getOurQRSlidingBitMap() ) );
-		st.setPinned( _calcPin( getSquareOfMyKing(), getTheirQBSlidingBitMap(), getTheirQRSlidingBitMap() ) );
+		_calcPinnedAndDiscoveryCheckers();
 		
 		st.setCheckers( getAttackersTo( getSquareOfMyKing() ) & getTheirBitMap() );
 	
@@ -1010,33 +1044,41 @@ namespace libChess
 		\version 1.0
 		\date 08/11/2013
 	*/
-	void Position::_calcCheckingSquares(void)
+	void Position::_calcCheckingSquares(void) const
 	{
-		GameState &st = _getActualState();
+		// the method is const because it's also used to lazily fill the checking squares of the actual state, that are mutable
+		const GameState &st = getActualStateConst();
 
 		const baseTypes::tSquare OppKingSquare = getSquareOfEnemyKing();
 
 		const baseTypes::BitMap& occupancy = getOccupationBitMap();
 		const baseTypes::eTurn color = getSwitchedTurn( st.getTurn() );
+		
+		const baseTypes::BitMap rookChecks = BitMapMoveGenerator::getRookMoves( OppKingSquare, occupancy );
+		const baseTypes::BitMap bishopChecks = BitMapMoveGenerator::getBishopMoves( OppKingSquare, occupancy );
 
-		st.setCheckingSquare( getMyPiece( baseTypes::King ), baseTypes::BitMap(0) );
-		st.setCheckingSquare( getMyPiece( baseTypes::Rooks ), BitMapMoveGenerator::getRookMoves( OppKingSquare, occupancy ) );
-		st.setCheckingSquare( getMyPiece( baseTypes::Bishops ), BitMapMoveGenerator::getBishopMoves( OppKingSquare, occupancy ) );
-		st.setCheckingSquare( getMyPiece( baseTypes::Queens ), BitMapMoveGenerator::getQueenMoves( OppKingSquare, occupancy ) );
-		st.setCheckingSquare( getMyPiece( baseTypes::Knights ), BitMapMoveGenerator::getKnightMoves( OppKingSquare ) );
-		st.setCheckingSquare( getMyPiece( baseTypes::Pawns ), BitMapMoveGenerator::getPawnAttack( OppKingSquare,color ) );
+		st._checkingSquares[ getMyPiece( baseTypes::King ) ] = baseTypes::BitMap(0);
+		st._checkingSquares[ getMyPiece( baseTypes::Rooks ) ] = rookChecks;
+		st._checkingSquares[ getMyPiece( baseTypes::Bishops ) ] = bishopChecks;
+		st._checkingSquares[ getMyPiece( baseTypes::Queens ) ] = rookChecks + bishopChecks;
+		st._checkingSquares[ getMyPiece( baseTypes::Knights ) ] = BitMapMoveGenerator::getKnightMoves( OppKingSquare );
+		st._checkingSquares[ getMyPiece( baseTypes::Pawns ) ] = BitMapMoveGenerator::getPawnAttack( OppKingSquare,color );
 
-		st.setCheckingSquare( getEnemyPiece( baseTypes::King ), baseTypes::BitMap(0) );
-		st.setCheckingSquare( getEnemyPiece( baseTypes::Rooks ), baseTypes::BitMap(0) );
-		st.setCheckingSquare( getEnemyPiece( baseTypes::Bishops ), baseTypes::BitMap(0) );
-		st.setCheckingSquare( getEnemyPiece( baseTypes::Queens ), baseTypes::BitMap(0) );
-		st.setCheckingSquare( getEnemyPiece( baseTypes::Knights ), baseTypes::BitMap(0) );
-		st.setCheckingSquare( getEnemyPiece( baseTypes::Pawns ), baseTypes::BitMap(0) );
+		st._checkingSquares[ getEnemyPiece( baseTypes::King ) ] = baseTypes::BitMap(0);
+		st._checkingSquares[ getEnemyPiece( baseTypes::Rooks ) ] = baseTypes::BitMap(0);
+		st._checkingSquares[ getEnemyPiece( baseTypes::Bishops ) ] = baseTypes::BitMap(0);
+		st._checkingSquares[ getEnemyPiece( baseTypes::Queens ) ] = baseTypes::BitMap(0);
+		st._checkingSquares[ getEnemyPiece( baseTypes::Knights ) ] = baseTypes::BitMap(0);
+		st._checkingSquares[ getEnemyPiece( baseTypes::Pawns ) ] = baseTypes::BitMap(0);
+		
+		st._hasCheckingSquares = true;
 
 	}
 	
-	
-	const baseTypes::BitMap Position::_calcPin( const baseTypes::tSquare kingSquare, const baseTypes::BitMap& bishopLikeBitMap, const baseTypes::BitMap& rookLikeBitMap ) const
+	/*! \brief return the pieces of both colors that are the only obstacle between the king and an enemy slider
+	*
+	*/
+	const baseTypes::BitMap Position::_calcBlockers( const baseTypes::tSquare kingSquare, const baseTypes::BitMap& bishopLikeBitMap, const baseTypes::BitMap& rookLikeBitMap ) const
 	{
 		assert( kingSquare < baseTypes::squareNumber );
 		baseTypes::BitMap result(0);
@@ -1049,16 +1091,42 @@ namespace libChess
 			baseTypes::BitMap b = baseTypes::BitMap::getSquaresBetween( kingSquare, pinSq ) & getOccupationBitMap();
 			if ( !b.moreThanOneBit() )
 			{
-				result += b & getOurBitMap();
+				result += b;
 			}
 		}
 		return result;
 
 	}
 	
+	/*! \brief calculate the blockers of both kings, and from them the pinned pieces and the discovery checkers
+	*
+	*/
+	void Position::_calcPinnedAndDiscoveryCheckers(void)
+	{
+		GameState& st = _getActualState();
+		const baseTypes::eTurn us = st.getTurn();
+		const baseTypes::eTurn them = getSwitchedTurn( us );
+		
+		st.setBlockersForKing( us, _calcBlockers( getSquareOfMyKing(), getTheirQBSlidingBitMap(), getTheirQRSlidingBitMap() ) );
+		st.setBlockersForKing( them, _calcBlockers( getSquareOfEnemyKing(), getOurQBSlidingBitMap(), getOurQRSlidingBitMap() ) );
+		
+		st.setDiscoveryChechers( st.getBlockersForKing( them ) & getOurBitMap() );
+		st.setPinned( st.getBlockersForKing( us ) & getOurBitMap() );
+	}
+	
+	/*! \brief pass the turn to the opponent
+	*
+	*	the method is called by the null move pruning at a lot of nodes, so it's kept as cheap as possible:
+	*	the state is not fully copied, the pinned pieces and the discovery checkers are obtained from the blockers of the
+	*	previous state, and the checking squares are calculated only when needed ( see getCheckingSquare )
+	*/
 	void Position::doNullMove( void )
 	{
-		GameState& st = _pushState();
+		assert( !isInCheck() );
+		_stateList.emplace_back();
+		_accumulators.emplace_back();
+		GameState& st = _getActualState();
+		st.copyForNullMove( _stateList[ _stateList.size() - 2 ] );
 		st.setCurrentMove( Move::NOMOVE );
 		
 		st.clearEpSquare();
@@ -1068,10 +1136,11 @@ namespace libChess
 		
 		_swapUsThem();
 		
-		_calcCheckingSquares();
+		// pieces didn't move, the blockers are the same of the previous state
+		st.setDiscoveryChechers( st.getBlockersForKing( getSwitchedTurn( st.getTurn() ) ) & getOurBitMap() );
+		st.setPinned( st.getBlockersForKing( st.getTurn() ) & getOurBitMap() );
 		
-		st.setDiscoveryChechers( _calcPin( getSquareOfEnemyKing(), getOurQBSlidingBitMap(), getOurQRSlidingBitMap() ) );
-		st.setPinned( _calcPin( getSquareOfMyKing(), getTheirQBSlidingBitMap(), getTheirQRSlidingBitMap() ) );
+		_keyHistory.push_back( st.getKey().getKey() );
 		
 		// checker doesn't change, don't update them
 		//st.setCheckers( getAttackersTo( getSquareOfMyKing() & getTheirBitmap();
@@ -1091,9 +1160,16 @@ namespace libChess
 	{
 		assert( m != Move::NOMOVE );
 		
+		// make sure the checking squares copied in the new state are up to date, they are needed to detect the checks
+		if( !getActualStateConst()._hasCheckingSquares )
+		{
+			_calcCheckingSquares();
+		}
+		
 		GameState& st = _pushState();
 		const baseTypes::eTurn turn = st.getTurn();
 		st.setCurrentMove( m );
+		Nnue::DirtyPieces& dirty = _accumulators.back().dirty;
 		
 		const baseTypes::tSquare from = m.getFrom();
 		const baseTypes::tSquare to = m.getTo();
@@ -1103,8 +1179,7 @@ namespace libChess
 		assert( baseTypes::isValidPiece( piece ) );
 
 		const baseTypes::bitboardIndex capturedPiece = m.isEnPassantMove() ? ( baseTypes::isBlackTurn( turn ) ? baseTypes::whitePawns : baseTypes::blackPawns) : getPieceAt( to );
-		assert( capturedPiece != baseTypes::separationBitmap );
-		assert( capturedPiece != baseTypes::whitePieces );
+		assert( capturedPiece != baseTypes::unused );
 		assert( capturedPiece != baseTypes::blackPieces );
 
 		st.incrementCounters();
@@ -1143,16 +1218,13 @@ namespace libChess
 				_movePiece( piece, kFrom, kTo );
 			}
 			_addPiece( rook, rTo );
+			dirty.move( piece, kFrom, kTo );
+			dirty.move( rook, rFrom, rTo );
 			
 			// update hashKey
 			st.keyMovePiece( rook, rFrom, rTo);
 			st.keyMovePiece( piece, kFrom, kTo );
 			
-			// todo readd this code
-			// st.material += pstValue[rook][rTo] - pstValue[rook][rFrom];
-			//x.material += pstValue[piece][to] - pstValue[piece][from];
-			
-			
 		}
 		else
 		{	// do capture
@@ -1165,22 +1237,15 @@ namespace libChess
 					{
 						captureSquare -= MoveGenerator::pawnPush( turn );
 					}
-					assert( captureSquare < squareNumber );
+					assert( captureSquare < baseTypes::squareNumber );
 					st.pawnKeyRemovePiece( capturedPiece, captureSquare );
 				}
-				/*
-				todo readd this piece of code
-				x.nonPawnMaterial -= nonPawnValue[capture];//[captureSquare];
-				*/
-
 
 				// remove piece
 				_removePiece( capturedPiece, captureSquare );
+				dirty.remove( capturedPiece, captureSquare );
 				// update material
-				/*
-				todo readd this piece of code
-				x.material -= pstValue[capture][captureSquare];
-				*/
+				st.materialCapturePiece( _pieceValue[ capturedPiece ], _nonPawnValue[ capturedPiece ] );
 
 				// update keys
 				st.keyRemovePiece( capturedPiece, captureSquare);
@@ -1193,10 +1258,7 @@ namespace libChess
 			// update hashKey
 			st.keyMovePiece( piece, from, to );
 			_movePiece( piece, from, to );
-			/*
-			todo readd this code
-			x.material += pstValue[piece][to] - pstValue[piece][from];
-			*/
+			dirty.move( piece, from, to );
 		}
 
 
@@ -1221,11 +1283,8 @@ namespace libChess
 				assert ( promotedPiece < baseTypes::bitboardNumber );
 				_removePiece( piece, to );
 				_addPiece( promotedPiece, to );
-	/*
-	todo readd this piece of code
-				x.material += pstValue[promotedPiece][to]-pstValue[piece][to];
-				x.nonPawnMaterial += nonPawnValue[promotedPiece];//[to];
-	*/
+				dirty.promote( promotedPiece );
+				st.materialPromotePiece( _pieceValue[ piece ], _pieceValue[ promotedPiece ], _nonPawnValue[ promotedPiece ] );
 
 				st.keyPromotePiece( piece, promotedPiece, to );
 				st.pawnKeyRemovePiece( piece, to );
@@ -1279,9 +1338,9 @@ namespace libChess
 		st.setCheckers( checkers );
 		
 		_calcCheckingSquares();
+		_calcPinnedAndDiscoveryCheckers();
 		
-		st.setDiscoveryChechers( _calcPin( getSquareOfEnemyKing(), getOurQBSlidingBitMap(), getOurQRSlidingBitMap() ) );
-		st.setPinned( _calcPin( getSquareOfMyKing(), getTheirQBSlidingBitMap(), getTheirQRSlidingBitMap() ) );
+		_keyHistory.push_back( st.getKey().getKey() );
 
 		assert( _checkPositionConsistency() == true );
 	}
@@ -1414,7 +1473,7 @@ namespace libChess
 		assert( baseTypes::isValidPiece( piece ) );
 		
 		// Direct check ?
-		if( st.getCheckingSquare( piece ).isSquareSet( to ) )
+		if( getCheckingSquare( piece ).isSquareSet( to ) )
 		{
 			return true;
 		}
@@ -1452,7 +1511,7 @@ namespace libChess
 		if( m.isPromotionMove() )
 		{
 			// to square is check 
-			if( st.getCheckingSquare( baseTypes::getPiece( turn, baseTypes::Queens + m.getPromotionType() ) ).isSquareSet( to ) )
+			if( getCheckingSquare( baseTypes::getPiece( turn, baseTypes::Queens + m.getPromotionType() ) ).isSquareSet( to ) )
 			{
 				return true;
 			}
@@ -1524,7 +1583,7 @@ namespace libChess
 		// todo is this correct? discovery check test is a little more complicated in moveGivesCheck function, do some research
 		// Direct check & discovery?
 		return ( 
-			st.getCheckingSquare( piece ).isSquareSet( to ) 
+			getCheckingSquare( piece ).isSquareSet( to ) 
 			&& st.isDiscoveryCheckers(from)
 			);
 
@@ -1545,7 +1604,7 @@ namespace libChess
 		
 		return ( 
 			!( BitMapMoveGenerator::getKingMoves( OppKingSquare ).isSquareSet( to ) )
-			&& st.getCheckingSquare( piece ).isSquareSet( to ) 
+			&& getCheckingSquare( piece ).isSquareSet( to ) 
 			&& st.isDiscoveryCheckers(from)
 			);
 	}
@@ -1605,6 +1664,32 @@ namespace libChess
 		return s;
 	}
 	
+	/*! \brief compute the accumulator of the actual state for a perspective
+	*
+	*	the accumulator is updated from the last computed one, applying the pieces changed by the moves played since then.
+	*	if the king of the perspective moved in the meanwhile, or no accumulator was computed, it's refreshed from the board
+	*/
+	void Position::_computeAccumulator( const baseTypes::eTurn perspective ) const
+	{
+		const baseTypes::bitboardIndex king = baseTypes::getPiece( perspective, baseTypes::King );
+		size_t last = _accumulators.size() - 1;
+		while( !_accumulators[ last ].isComputed( perspective ) )
+		{
+			if( last == 0 || _accumulators[ last ].dirty.isMoved( king ) )
+			{
+				Nnue::refresh( *this, _accumulators.back(), perspective );
+				return;
+			}
+			--last;
+		}
+
+		const baseTypes::tSquare kingSquare = getSquareOfThePiece( king );
+		for( size_t i = last + 1; i < _accumulators.size(); ++i )
+		{
+			Nnue::update( _accumulators[ i - 1 ], _accumulators[ i ], perspective, kingSquare );
+		}
+	}
+	
 	/*! \brief do a sanity check on the board
 	\author Marco Belli
 	\version 1.0
@@ -1709,6 +1794,11 @@ namespace libChess
 			return false;
 		}
 		
+		if( _keyHistory.size() != _stateList.size() || _keyHistory.back() != st.getKey().getKey() )
+		{
+			return false;
+		}
+		
 		if( st.getPawnKey() != _calcPawnKey() )
 		{
 			return false;
@@ -1719,6 +1809,26 @@ namespace libChess
 			return false;
 		}
 		
+		/*************************************************
+		check nnue accumulator
+		*************************************************/
+		if( _accumulators.size() != _stateList.size() )
+		{
+			return false;
+		}
+		for( const auto perspective : { baseTypes::whiteTurn, baseTypes::blackTurn } )
+		{
+			if( _accumulators.back().isComputed( perspective ) )
+			{
+				Nnue::Accumulator acc;
+				Nnue::refresh( *this, acc, perspective );
+				if( acc.values[ perspective ] != _accumulators.back().values[ perspective ] )
+				{
+					return false;
+				}
+			}
+		}
+		
 		/*************************************************
 		kings verification
 		*************************************************/
@@ -1765,37 +1875,33 @@ namespace libChess
 				return false;
 			}
 		}
-/*
-
-		// todo readd this code as soon as material value is added
 
-		simdScore sc=calcMaterialValue();
-		if((sc[0]!=x.material[0]) || (sc[1]!=x.material[1]))
+		/*************************************************
+		material values
+		*************************************************/
+		{
+			const simdScore material = _calcMaterialValue();
+			const simdScore nonPawnMaterial = _calcNonPawnMaterialValue();
+			for( int i = 0; i < 4; ++i )
+			{
+				if( material[i] != st.getMaterialValue()[i] || nonPawnMaterial[i] != st.getNonPawnMaterialValue()[i] )
+				{
+					return false;
+				}
+			}
+		}
+		
+		/*************************************************
+		blockers
+		*************************************************/
+		if( st.getPinned() != ( _calcBlockers( getSquareOfMyKing(), getTheirQBSlidingBitMap(), getTheirQRSlidingBitMap() ) & getOurBitMap() ) )
 		{
-			display();
-			sync_cout<<sc[0]<<":"<<x.material[0]<<sync_endl;
-			sync_cout<<sc[1]<<":"<<x.material[1]<<sync_endl;
-			sync_cout<<"material error"<<sync_endl;
-			sync_cout<<(nn?"DO error":"undoError") <<sync_endl;
-			while(1){}
 			return false;
 		}
-		simdScore score = calcNonPawnMaterialValue();
-		if(score[0]!= x.nonPawnMaterial[0] ||
-			score[1]!= x.nonPawnMaterial[1] ||
-			score[2]!= x.nonPawnMaterial[2] ||
-			score[3]!= x.nonPawnMaterial[3]
-		){
-			display();
-			sync_cout<<score[0]<<":"<<x.nonPawnMaterial[0]<<sync_endl;
-			sync_cout<<score[1]<<":"<<x.nonPawnMaterial[1]<<sync_endl;
-			sync_cout<<score[2]<<":"<<x.nonPawnMaterial[2]<<sync_endl;
-			sync_cout<<score[3]<<":"<<x.nonPawnMaterial[3]<<sync_endl;
-			sync_cout<<"non pawn material error"<<sync_endl;
-			sync_cout<<(nn?"DO error":"undoError") <<sync_endl;
-			while(1){}
+		if( st.getDiscoveryCheckers() != ( _calcBlockers( getSquareOfEnemyKing(), getOurQBSlidingBitMap(), getOurQRSlidingBitMap() ) & getOurBitMap() ) )
+		{
 			return false;
-		}*/
+		}
 		return true;
 	}
 	
@@ -2054,10 +2160,451 @@ namespace libChess
         return !( getAttackersTo( to, getOccupationBitMap() & ~getOurBitMap( baseTypes::King ) ).isIntersecting( getTheirBitMap() ) );
     }
     
+    /*! \brief tell whether the side to move has a legal move
+	*
+	*	the king moves are tested first, they are the only ones allowed in double check. Otherwise the moves are generated
+	*/
+	bool Position::hasLegalMoves( void ) const
+	{
+		const baseTypes::tSquare kingSquare = getSquareOfMyKing();
+		for( const auto to: BitMapMoveGenerator::getKingMoves( kingSquare ) & ~getOurBitMap() )
+		{
+			if( checkKingAllowedMove( to ) )
+			{
+				return true;
+			}
+		}
+		if( getActualStateConst().getCheckers().moreThanOneBit() )
+		{
+			return false;
+		}
+		MoveList< MoveSelector::maxMovePerPosition > ml;
+		MoveGenerator::generateMoves< MoveGenerator::allMg >( *this, ml );
+		return ml.size() > 0;
+	}
+	
+	/*! \brief our pieces of the given type that attack the square, the candidates of a san move not made by a pawn
+	*
+	*/
+	baseTypes::BitMap Position::_getSanCandidates( const baseTypes::bitboardIndex piece, const baseTypes::tSquare to ) const
+	{
+		switch( piece )
+		{
+			case baseTypes::King:
+				return BitMapMoveGenerator::getKingMoves( to ) & getOurBitMap( baseTypes::King );
+			case baseTypes::Queens:
+				return BitMapMoveGenerator::getQueenMoves( to, getOccupationBitMap() ) & getOurBitMap( baseTypes::Queens );
+			case baseTypes::Rooks:
+				return BitMapMoveGenerator::getRookMoves( to, getOccupationBitMap() ) & getOurBitMap( baseTypes::Rooks );
+			case baseTypes::Bishops:
+				return BitMapMoveGenerator::getBishopMoves( to, getOccupationBitMap() ) & getOurBitMap( baseTypes::Bishops );
+			case baseTypes::Knights:
+				return BitMapMoveGenerator::getKnightMoves( to ) & getOurBitMap( baseTypes::Knights );
+			default:
+				return baseTypes::BitMap( 0 );
+		}
+	}
+	
+	/*! \brief return the legal move written in standard algebraic notation, NOMOVE if it's illegal, ambiguous or malformed
+	*
+	*	check, mate and annotation suffixes are ignored, castling can be written with O or 0.
+	*	The moving piece is found with the attacks to the destination square, without generating the moves
+	*/
+	Move Position::parseSan( std::string_view san ) const
+	{
+		while( !san.empty() && ( san.back() == '+' || san.back() == '#' || san.back() == '!' || san.back() == '?' ) )
+		{
+			san.remove_suffix( 1 );
+		}
+		
+		const baseTypes::eTurn turn = getActualStateConst().getTurn();
+		if( san == "O-O" || san == "0-0" || san == "O-O-O" || san == "0-0-0" )
+		{
+			const bool kingSide = san.size() == 3;
+			const Move m( getSquareOfMyKing(), getCastleRookInvolved( turn, kingSide ), Move::fcastle );
+			return isMoveLegal( m ) ? m : Move::NOMOVE;
+		}
+		
+		// promotion, as e8=Q or e8Q
+		Move::eflags flag = Move::fnone;
+		Move::epromotion promotion = Move::promQueen;
+		if( san.size() >= 3 )
+		{
+			const char* const promotions = "QRBN";
+			const char* p = std::char_traits< char >::find( promotions, 4, san.back() );
+			if( p )
+			{
+				flag = Move::fpromotion;
+				promotion = Move::epromotion( p - promotions );
+				san.remove_suffix( 1 );
+				if( san.back() == '=' )
+				{
+					san.remove_suffix( 1 );
+				}
+			}
+		}
+		
+		if( san.size() < 2 )
+		{
+			return Move::NOMOVE;
+		}
+		const size_t toIndex = san.size() - 2;
+		if( san[ toIndex ] < 'a' || san[ toIndex ] > 'h' || san.back() < '1' || san.back() > '8' )
+		{
+			return Move::NOMOVE;
+		}
+		const baseTypes::tSquare to = baseTypes::getSquareFromFileRank( baseTypes::tFile( san[ toIndex ] - 'a' ), baseTypes::tRank( san.back() - '1' ) );
+		
+		baseTypes::bitboardIndex piece = baseTypes::Pawns;
+		size_t i = 0;
+		switch( san.front() )
+		{
+			case 'K': piece = baseTypes::King; i = 1; break;
+			case 'Q': piece = baseTypes::Queens; i = 1; break;
+			case 'R': piece = baseTypes::Rooks; i = 1; break;
+			case 'B': piece = baseTypes::Bishops; i = 1; break;
+			case 'N': piece = baseTypes::Knights; i = 1; break;
+			default: break;
+		}
+		
+		// the characters between the piece and the destination square disambiguate the moving piece
+		int fromFile = -1;
+		int fromRank = -1;
+		bool capture = false;
+		for( ; i < toIndex; ++i )
+		{
+			if( san[ i ] >= 'a' && san[ i ] <= 'h' )
+			{
+				fromFile = san[ i ] - 'a';
+			}
+			else if( san[ i ] >= '1' && san[ i ] <= '8' )
+			{
+				fromRank = san[ i ] - '1';
+			}
+			else if( san[ i ] == 'x' || san[ i ] == ':' )
+			{
+				capture = true;
+			}
+			else if( san[ i ] != '-' )
+			{
+				return Move::NOMOVE;
+			}
+		}
+		
+		baseTypes::BitMap candidates( 0 );
+		if( piece == baseTypes::Pawns )
+		{
+			if( capture || fromFile >= 0 )
+			{
+				candidates = BitMapMoveGenerator::getPawnAttack( to, baseTypes::eTurn( 1 - turn ) ) & getOurBitMap( baseTypes::Pawns );
+				if( to == getActualStateConst().getEpSquare() )
+				{
+					flag = Move::fenpassant;
+				}
+			}
+			else
+			{
+				// the pawn in front of the destination square, or the one making a double push
+				const int push = MoveGenerator::pawnPush( turn );
+				const int from = int( to ) - push;
+				if( from >= 0 && from < 64 )
+				{
+					if( getOurBitMap( baseTypes::Pawns ).isSquareSet( baseTypes::tSquare( from ) ) )
+					{
+						candidates = baseTypes::BitMap::getBitmapFromSquare( baseTypes::tSquare( from ) );
+					}
+					else if( from - push >= 0 && from - push < 64 && getPieceAt( baseTypes::tSquare( from ) ) == baseTypes::empty )
+					{
+						candidates = baseTypes::BitMap::getBitmapFromSquare( baseTypes::tSquare( from - push ) ) & getOurBitMap( baseTypes::Pawns );
+					}
+				}
+			}
+		}
+		else
+		{
+			candidates = _getSanCandidates( piece, to );
+		}
+		
+		Move found = Move::NOMOVE;
+		for( const auto from: candidates )
+		{
+			if( ( fromFile >= 0 && (int)baseTypes::getFile( from ) != fromFile ) || ( fromRank >= 0 && (int)baseTypes::getRank( from ) != fromRank ) )
+			{
+				continue;
+			}
+			const Move m( from, to, flag, promotion );
+			if( !isMoveLegal( m ) )
+			{
+				continue;
+			}
+			if( found != Move::NOMOVE )
+			{
+				// ambiguous
+				return Move::NOMOVE;
+			}
+			found = m;
+		}
+		return found;
+	}
+	
+	/*! \brief write the move in standard algebraic notation in san, that shall have room for maxSanLength chars. Return the length of the san
+	*
+	*	only the legal moves of the other pieces are used for disambiguation. The move is done and undone to tell a check from a mate
+	*/
+	unsigned int Position::getSan( const Move& m, char* san )
+	{
+		char* p = san;
+		if( m.isCastleMove() )
+		{
+			const char* castle = Move::isKingsideCastle( m.getFrom(), m.getTo() ) ? "O-O" : "O-O-O";
+			while( *castle )
+			{
+				*p++ = *castle++;
+			}
+		}
+		else
+		{
+			const baseTypes::tSquare from = m.getFrom();
+			const baseTypes::tSquare to = m.getTo();
+			const baseTypes::bitboardIndex piece = baseTypes::bitboardIndex( getPieceAt( from ) & 7 );
+			const bool capture = isCaptureMove( m );
+			if( piece == baseTypes::Pawns )
+			{
+				if( capture )
+				{
+					*p++ = char( 'a' + baseTypes::getFile( from ) );
+				}
+			}
+			else
+			{
+				*p++ = " KQRBN"[ piece ];
+				bool ambiguous = false;
+				bool sameFile = false;
+				bool sameRank = false;
+				for( const auto other: _getSanCandidates( piece, to ) )
+				{
+					if( other != from && isMoveLegal( Move( other, to ) ) )
+					{
+						ambiguous = true;
+						sameFile |= baseTypes::getFile( other ) == baseTypes::getFile( from );
+						sameRank |= baseTypes::getRank( other ) == baseTypes::getRank( from );
+					}
+				}
+				if( ambiguous && ( !sameFile || sameRank ) )
+				{
+					*p++ = char( 'a' + baseTypes::getFile( from ) );
+				}
+				if( ambiguous && sameFile )
+				{
+					*p++ = char( '1' + baseTypes::getRank( from ) );
+				}
+			}
+			if( capture )
+			{
+				*p++ = 'x';
+			}
+			*p++ = char( 'a' + baseTypes::getFile( to ) );
+			*p++ = char( '1' + baseTypes::getRank( to ) );
+			if( m.isPromotionMove() )
+			{
+				*p++ = '=';
+				*p++ = "QRBN"[ m.getPromotionType() ];
+			}
+		}
+		
+		if( moveGivesCheck( m ) )
+		{
+			doMove( m );
+			*p++ = hasLegalMoves() ? '+' : '#';
+			undoMove();
+		}
+		*p = 0;
+		return p - san;
+	}
+	
     unsigned int Position::getNumberOfLegalMoves( void ) const
 	{
 		MoveList< MoveSelector::maxMovePerPosition > ml;
 		MoveGenerator::generateMoves< MoveGenerator::allMg >( *this, ml );
 		return ml.size();
 	}
-}
\ No newline at end of file
+    
+    /*! \brief calculate the MVV-LVA score of an array of packed moves
+	*
+	*	with AVX2 the scores of 8 moves are calculated at a time, the pieces and the MVV/LVA values are read with gather instructions.
+	*	the result is the same of calling getMvvLvaScore for every move
+	*/
+    void Position::getMvvLvaScores( const unsigned short* moves, Score* scores, const unsigned int count ) const
+	{
+		unsigned int i = 0;
+#if defined(__AVX2__)
+		static_assert( sizeof( baseTypes::bitboardIndex ) == sizeof( int ), "the kernel gather the pieces as 32 bits integers" );
+		const int* squares = reinterpret_cast< const int* >( _squares.data() );
+		const __m256i squareMask = _mm256_set1_epi32( 63 );
+		const __m256i enPassantFlag = _mm256_set1_epi32( Move::fenpassant );
+		const __m256i enPassantBonus = _mm256_set1_epi32( _MVVValue[ baseTypes::whitePawns ] );
+		for( ; i + 8 <= count; i += 8 )
+		{
+			const __m256i packed = _mm256_cvtepu16_epi32( _mm_loadu_si128( reinterpret_cast< const __m128i* >( moves + i ) ) );
+			const __m256i from = _mm256_and_si256( packed, squareMask );
+			const __m256i to = _mm256_and_si256( _mm256_srli_epi32( packed, 6 ), squareMask );
+			const __m256i enPassant = _mm256_cmpeq_epi32( _mm256_srli_epi32( packed, 14 ), enPassantFlag );
+			
+			const __m256i victim = _mm256_i32gather_epi32( squares, to, 4 );
+			const __m256i attacker = _mm256_i32gather_epi32( squares, from, 4 );
+			__m256i s = _mm256_sub_epi32( _mm256_i32gather_epi32( _MVVValue, victim, 4 ), _mm256_i32gather_epi32( _LVAValue, attacker, 4 ) );
+			s = _mm256_add_epi32( s, _mm256_and_si256( enPassant, enPassantBonus ) );
+			_mm256_storeu_si256( reinterpret_cast< __m256i* >( scores + i ), s );
+		}
+#endif
+		for( ; i < count; ++i )
+		{
+			scores[ i ] = getMvvLvaScore( Move( moves[ i ] ) );
+		}
+	}
+
+	/*! \brief static exchange evaluation, tell whether the exchange sequence started by the move wins at least threshold
+	*
+	*	the pieces are exchanged on the destination square from the least valuable attacker, x-ray attackers are discovered
+	*	when the pieces in front of them are removed. Pins are not considered.
+	*	promotions, castling and en passant are evaluated as 0
+	*/
+	bool Position::seeGreaterOrEqual( const Move& m, const Score threshold ) const
+	{
+		if( m.isPromotionMove() || m.isCastleMove() || m.isEnPassantMove() )
+		{
+			return 0 >= threshold;
+		}
+
+		const baseTypes::tSquare from = m.getFrom();
+		const baseTypes::tSquare to = m.getTo();
+
+		// the score of the exchange if the opponent stops now, from the point of view of the side that shall move next
+		Score swap = _seeValue[ getPieceAt( to ) ] - threshold;
+		if( swap < 0 )
+		{
+			return false;
+		}
+
+		swap = _seeValue[ getPieceAt( from ) ] - swap;
+		if( swap <= 0 )
+		{
+			return true;
+		}
+
+		baseTypes::BitMap occupied = getOccupationBitMap() ^ from ^ to;
+		baseTypes::eTurn stm = baseTypes::isBlackPiece( getPieceAt( from ) ) ? baseTypes::blackTurn : baseTypes::whiteTurn;
+		baseTypes::BitMap attackers = getAttackersTo( to, occupied );
+		const baseTypes::BitMap bishopLike = getBitmap( baseTypes::whiteBishops ) + getBitmap( baseTypes::blackBishops ) + getBitmap( baseTypes::whiteQueens ) + getBitmap( baseTypes::blackQueens );
+		const baseTypes::BitMap rookLike = getBitmap( baseTypes::whiteRooks ) + getBitmap( baseTypes::blackRooks ) + getBitmap( baseTypes::whiteQueens ) + getBitmap( baseTypes::blackQueens );
+		bool res = true;
+
+		while( true )
+		{
+			stm = baseTypes::getSwitchedTurn( stm );
+			attackers &= occupied;
+
+			const baseTypes::BitMap stmAttackers = attackers & getBitmap( baseTypes::getPiece( stm, baseTypes::Pieces ) );
+			if( stmAttackers.isEmpty() )
+			{
+				break;
+			}
+			res = !res;
+
+			// find the least valuable attacker
+			baseTypes::bitboardIndex type = baseTypes::Pawns;
+			baseTypes::BitMap bb;
+			while( ( bb = stmAttackers & getBitmap( baseTypes::getPiece( stm, type ) ) ).isEmpty() )
+			{
+				type = (baseTypes::bitboardIndex)( type - 1 );
+			}
+
+			if( type == baseTypes::King )
+			{
+				// the king can capture only if the opponent has no more attackers
+				return ( attackers & ~getBitmap( baseTypes::getPiece( stm, baseTypes::Pieces ) ) ).isNotEmpty() ? !res : res;
+			}
+
+			swap = _seeValue[ type ] - swap;
+			if( swap < (Score)res )
+			{
+				break;
+			}
+
+			occupied ^= bb.firstOne();
+			// add the x-ray attackers behind the removed piece
+			if( type == baseTypes::Pawns || type == baseTypes::Bishops || type == baseTypes::Queens )
+			{
+				attackers += BitMapMoveGenerator::getBishopMoves( to, occupied ) & bishopLike;
+			}
+			if( type == baseTypes::Rooks || type == baseTypes::Queens )
+			{
+				attackers += BitMapMoveGenerator::getRookMoves( to, occupied ) & rookLike;
+			}
+		}
+
+		return res;
+	}
+
+	/*! \brief tell whether the position is a draw by repetition
+	*
+	*	a position already met after the root, less than ply plies ago, is a draw without waiting for the third repetition.
+	*	only the positions since the last irreversible move or null move are checked.
+	*	with AVX2 four keys are compared at once, only the ones of the positions with the same side to move are used
+	*/
+	bool Position::isRepetition( const unsigned int ply ) const
+	{
+		const GameState& st = getActualStateConst();
+		const unsigned int end = std::min( { st.getFiftyMoveCnt(), st.getPliesFromNullCnt(), (unsigned int)_keyHistory.size() - 1 } );
+		const uint64_t* const last = &_keyHistory.back();
+		const uint64_t key = *last;
+		unsigned int count = 0;
+		unsigned int i = 4;
+#if defined(__AVX2__)
+		const __m256i keys = _mm256_set1_epi64x( key );
+		for( ; i + 3 <= end; i += 4 )
+		{
+			// lane 3 holds the key of i plies ago and lane 1 the key of i + 2 plies ago
+			const int mask = _mm256_movemask_pd( _mm256_castsi256_pd( _mm256_cmpeq_epi64( _mm256_loadu_si256( reinterpret_cast< const __m256i* >( last - i - 3 ) ), keys ) ) );
+			if( ( mask & 0x8 ) && ( i < ply || ++count == 2 ) )
+			{
+				return true;
+			}
+			if( ( mask & 0x2 ) && ( i + 2 < ply || ++count == 2 ) )
+			{
+				return true;
+			}
+		}
+#endif
+		for( ; i <= end; i += 2 )
+		{
+			if( *( last - i ) == key && ( i < ply || ++count == 2 ) )
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/*! \brief tell whether the side to move can repeat a position with a single reversible move
+	*
+	*	the key difference with every previous position reachable by a move of the side to move is searched in the cuckoo tables,
+	*	and the move found must not be blocked. Only the repetitions of positions after the root, less than ply plies ago, are reported
+	*/
+	bool Position::hasUpcomingRepetition( const unsigned int ply ) const
+	{
+		const GameState& st = getActualStateConst();
+		const unsigned int end = std::min( { st.getFiftyMoveCnt(), st.getPliesFromNullCnt(), (unsigned int)_keyHistory.size() - 1 } );
+		const uint64_t* const last = &_keyHistory.back();
+		for( unsigned int i = 3; i <= end && i < ply; i += 2 )
+		{
+			Move m;
+			if( Cuckoo::probe( HashKey( *last ^ *( last - i ) ), m )
+				&& ( baseTypes::BitMap::getSquaresBetween( m.getFrom(), m.getTo() ) & getOccupationBitMap() ).isEmpty() )
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+}
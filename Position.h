@@ -22,9 +22,11 @@
 #include <vector>
 #include <array>
 #include <iterator>
+#include <string_view>
 #include "State.h"
 #include "BitMap.h"
 #include "BitBoardIndex.h"
+#include "Nnue.h"
 
 namespace libChess
 {
@@ -66,6 +68,7 @@ namespace libChess
 		
 		unsigned int getPieceCount(const baseTypes::bitboardIndex in) const;
 		baseTypes::bitboardIndex getPieceAt(const baseTypes::tSquare sq) const;
+		const std::array< baseTypes::bitboardIndex, baseTypes::squareNumber >& getSquares() const;
 		
 		baseTypes::bitboardIndex getMyPiece(const baseTypes::bitboardIndex in) const;
 		baseTypes::bitboardIndex getEnemyPiece(const baseTypes::bitboardIndex in) const;
@@ -78,6 +81,8 @@ namespace libChess
 		
 		std::string getCastleRightsString( const GameState& st, const bool chess960 ) const;
         unsigned int getNumberOfLegalMoves( void ) const;
+		const Nnue::Accumulator& getAccumulator() const;
+		static const simdScore& getPieceValue( const baseTypes::bitboardIndex piece );
 		
 		/*****************************************************************
 		*	Methods
@@ -96,23 +101,37 @@ namespace libChess
 		void undoMove( void );
 		
 		bool moveGivesCheck( const Move& m ) const;
+		const baseTypes::BitMap& getCheckingSquare( const baseTypes::bitboardIndex piece ) const;
 		bool moveGivesDoubleCheck( const Move& m ) const;
 		bool moveGivesSafeDoubleCheck( const Move& m ) const;
 		
+		bool isCaptureMove( const Move& m ) const;
 		Score getMvvLvaScore( const Move& m ) const;
+		void getMvvLvaScores( const unsigned short* moves, Score* scores, const unsigned int count ) const;
+		bool seeGreaterOrEqual( const Move& m, const Score threshold ) const;
 		
 		bool isInCheck( void ) const;
+		bool isRepetition( const unsigned int ply ) const;
+		bool hasUpcomingRepetition( const unsigned int ply ) const;
 		bool isMoveLegal( const Move& m ) const;
         bool checkKingAllowedMove( const baseTypes::tSquare to/*, const baseTypes::BitMap& occupiedSquares, const baseTypes::BitMap& opponent*/ ) const;
+		bool hasLegalMoves( void ) const;
 		
+		Move parseSan( std::string_view san ) const;
+		unsigned int getSan( const Move& m, char* san );
+		
+		/*****************************************************************
+		*	static members
+		******************************************************************/
+		static constexpr unsigned int maxSanLength = 8;	// size of the buffer of getSan, the longest san is like Qa1xb2+ plus the terminating null
 		
-	
 	private:
 	
 		/*****************************************************************
 		*	Members
 		******************************************************************/
 		std::vector<GameState> _stateList;
+		std::vector<uint64_t> _keyHistory;	// keys of the states, kept contiguous to speed up the repetition checks
 		std::array< baseTypes::bitboardIndex, baseTypes::squareNumber > _squares; // board square rapresentation to speed up, it contain pieces indexed by square
 		std::array< baseTypes::BitMap, baseTypes::bitboardNumber > _bitBoard;     // bitboards indexed by baseTypes::bitboardIndex enum
 		std::array< baseTypes::BitMap, baseTypes::bitboardNumber >::iterator _us,_them;	/*!< pointer to our & their pieces bitboard*/
@@ -126,6 +145,27 @@ namespace libChess
 		
 		std::array< baseTypes::tSquare, 2 > _kingsSquare;
 		
+		// nnue accumulators of the states, with the pieces changed by the move. They are computed lazily by getAccumulator
+		mutable std::vector< Nnue::Accumulator > _accumulators;
+		
+		/*****************************************************************
+		*	static members
+		******************************************************************/
+		static constexpr Score _MVVValue[ baseTypes::bitboardNumber ] = { 0, 3000, 900, 500, 350, 300, 100, 0, 0, 3000, 900, 500, 350, 300, 100, 0 };
+		static constexpr Score _LVAValue[ baseTypes::bitboardNumber ] = { 0, 30, 9, 5, 3, 2, 1, 0, 0, 30, 9, 5, 3, 2, 1, 0 };
+		// value of the pieces used by the static exchange evaluation
+		static constexpr Score _seeValue[ baseTypes::bitboardNumber ] = { 0, 0, 1200, 600, 400, 390, 100, 0, 0, 0, 1200, 600, 400, 390, 100, 0 };
+		// opening/endgame value of the pieces, white pieces are positive and black pieces are negative
+		static constexpr simdScore _pieceValue[ baseTypes::bitboardNumber ] = {
+			{ 0, 0, 0, 0 }, { 0, 0, 0, 0 }, { 1200, 1250, 0, 0 }, { 600, 650, 0, 0 }, { 400, 420, 0, 0 }, { 390, 410, 0, 0 }, { 100, 130, 0, 0 }, { 0, 0, 0, 0 },
+			{ 0, 0, 0, 0 }, { 0, 0, 0, 0 }, { -1200, -1250, 0, 0 }, { -600, -650, 0, 0 }, { -400, -420, 0, 0 }, { -390, -410, 0, 0 }, { -100, -130, 0, 0 }, { 0, 0, 0, 0 }
+		};
+		// opening/endgame non pawn value of the pieces, the first two fields are used by white pieces and the others by black pieces
+		static constexpr simdScore _nonPawnValue[ baseTypes::bitboardNumber ] = {
+			{ 0, 0, 0, 0 }, { 0, 0, 0, 0 }, { 1200, 1250, 0, 0 }, { 600, 650, 0, 0 }, { 400, 420, 0, 0 }, { 390, 410, 0, 0 }, { 0, 0, 0, 0 }, { 0, 0, 0, 0 },
+			{ 0, 0, 0, 0 }, { 0, 0, 0, 0 }, { 0, 0, 1200, 1250 }, { 0, 0, 600, 650 }, { 0, 0, 400, 420 }, { 0, 0, 390, 410 }, { 0, 0, 0, 0 }, { 0, 0, 0, 0 }
+		};
+		
 	private:
 	
 		/*****************************************************************
@@ -148,8 +188,11 @@ namespace libChess
 		HashKey _calcKey(void) const;
 		HashKey _calcPawnKey(void) const;
 		HashKey _calcMaterialKey(void) const;
-		void _calcCheckingSquares(void);
-		const baseTypes::BitMap _calcPin( const baseTypes::tSquare kingSquare, const baseTypes::BitMap& bishopLikeBitMap, const baseTypes::BitMap& rookLikeBitMap ) const;
+		simdScore _calcMaterialValue(void) const;
+		simdScore _calcNonPawnMaterialValue(void) const;
+		void _calcCheckingSquares(void) const;
+		const baseTypes::BitMap _calcBlockers( const baseTypes::tSquare kingSquare, const baseTypes::BitMap& bishopLikeBitMap, const baseTypes::BitMap& rookLikeBitMap ) const;
+		void _calcPinnedAndDiscoveryCheckers(void);
 		
 		bool _setupCastleRight(const baseTypes::tSquare rsq);
 		bool _tryAddCastleRight( const baseTypes::eCastle cr, const baseTypes::tSquare ksq, const baseTypes::tSquare rsq );
@@ -164,6 +207,8 @@ namespace libChess
 		void _clearCastleRookInvolved(void);
 		
 		bool _checkPositionConsistency(void) const;
+		void _computeAccumulator( const baseTypes::eTurn perspective ) const;
+		baseTypes::BitMap _getSanCandidates( const baseTypes::bitboardIndex piece, const baseTypes::tSquare to ) const;
 		
 	
 		
@@ -179,6 +224,31 @@ namespace libChess
 		return _stateList.back();
 	}
 	
+	/*! \brief nnue accumulator of the position, computed only when it's requested
+	*
+	*/
+	inline const Nnue::Accumulator& Position::getAccumulator() const
+	{
+		const Nnue::Accumulator& acc = _accumulators.back();
+		if( !acc.isComputed( baseTypes::whiteTurn ) )
+		{
+			_computeAccumulator( baseTypes::whiteTurn );
+		}
+		if( !acc.isComputed( baseTypes::blackTurn ) )
+		{
+			_computeAccumulator( baseTypes::blackTurn );
+		}
+		return acc;
+	}
+	
+	/*! \brief opening/endgame value of a piece, negative for the black pieces
+	*
+	*/
+	inline const simdScore& Position::getPieceValue( const baseTypes::bitboardIndex piece )
+	{
+		return _pieceValue[ piece ];
+	}
+	
 	inline const baseTypes::BitMap& Position::getOccupationBitMap() const
 	{
 		return _bitBoard[ baseTypes::occupiedSquares ];
@@ -199,6 +269,11 @@ namespace libChess
 		return _squares[sq];
 	}
 	
+	inline const std::array< baseTypes::bitboardIndex, baseTypes::squareNumber >& Position::getSquares() const
+	{
+		return _squares;
+	}
+	
 	inline baseTypes::tSquare Position::getSquareOfThePiece(const baseTypes::bitboardIndex piece) const
 	{
 		return getBitmap(piece).firstOne();
@@ -291,14 +366,18 @@ namespace libChess
 		return _castleRookInvolved[ _calcCRPIndex( color, kingSide ) ];
 	}
 	
+	inline bool Position::isCaptureMove( const Move& m ) const
+	{
+		// castling moves are encoded as king captures rook
+		return ( getPieceAt( m.getTo() ) != baseTypes::empty && !m.isCastleMove() ) || m.isEnPassantMove();
+	}
+	
 	inline Score Position::getMvvLvaScore( const Move& m ) const
 	{	
-		const Score MVVValue[] = { 0, 3000, 900, 500, 350, 300, 100, 0, 0, 3000, 900, 500, 350, 300, 100, 0 } ;
-		const Score LVAValue[] = { 0, 30, 9, 5, 3, 2, 1, 0, 0, 30, 9, 5, 3, 2, 1, 0 } ;
 		assert( isValidPiece( getPieceAt( m.getFrom() ) ) );
 		assert( isValidPiece( getPieceAt( m.getTo() ) ) || m.isEnPassantMove() );
 		
-		Score s = MVVValue[ getPieceAt( m.getTo() ) ] - LVAValue[ getPieceAt( m.getFrom() ) ];
+		Score s = _MVVValue[ getPieceAt( m.getTo() ) ] - _LVAValue[ getPieceAt( m.getFrom() ) ];
 		
 		// todo da riaggiungere?		
 		/*if ( m.isPromotionMove() )
@@ -308,7 +387,7 @@ namespace libChess
 		else */if( m.isEnPassantMove() )
 		{
 			//todo questo può essere eliminato mettendo MVVValue[empty ] = 100;
-			s += MVVValue[ baseTypes::whitePawns ];
+			s += _MVVValue[ baseTypes::whitePawns ];
 		}
 		
 		return s;
@@ -319,6 +398,19 @@ namespace libChess
 		return getActualStateConst().getCheckers().isNotEmpty();
 	}
 	
+	/*! \brief return the checking squares of a piece, calculating them if they are stale after a null move
+	*
+	*/
+	inline const baseTypes::BitMap& Position::getCheckingSquare( const baseTypes::bitboardIndex piece ) const
+	{
+		const GameState& st = getActualStateConst();
+		if( !st._hasCheckingSquares )
+		{
+			_calcCheckingSquares();
+		}
+		return st.getCheckingSquare( piece );
+	}
+	
 	inline void Position::_setKingsSquare(void)
 	{ 
 		_kingsSquare[ baseTypes::whiteTurn ] = getBitmap(baseTypes::whiteKing).firstOne();
@@ -0,0 +1,142 @@
+/*
+	This file is part of Vajolet.
+	Copyright (C) 2013-2018 Marco Belli
+
+    Vajolet is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Vajolet is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#ifndef REDUCTIONS_H_
+#define REDUCTIONS_H_
+
+#include <algorithm>
+#include <array>
+#include "Score.h"
+
+namespace libChess
+{
+	/*!	\brief late move reductions and move count pruning parameters
+
+		the reduction table is indexed by depth and move number and it's calculated at compile time
+		as log( depth ) * log( moveNumber ) / 2
+	 */
+	class Reductions
+	{
+	public:
+		/*****************************************************************
+		*	static methods
+		******************************************************************/
+		static int get( const bool PVnode, const bool improving, const int depth, const unsigned int moveNumber, const Score historyScore );
+		static int getTableValue( const int depth, const unsigned int moveNumber );
+		static unsigned int moveCountLimit( const int depth, const bool improving );
+		static Score futilityMargin( const int depth );
+
+		/*****************************************************************
+		*	static members
+		******************************************************************/
+		static constexpr int tableSize = 64;
+		static constexpr int minDepth = 3;				// moves are reduced from this depth
+		static constexpr int moveCountPruningDepth = 8;	// quiet moves are pruned by move count below this depth
+		static constexpr int futilityPruningDepth = 7;	// quiet moves are pruned by futility below this reduced depth
+		static constexpr Score historyDivisor = 8192;	// every historyDivisor points of history change the reduction by a ply
+
+	private:
+		using tableType = std::array< std::array< int, tableSize >, tableSize >;
+
+		/*****************************************************************
+		*	static methods
+		******************************************************************/
+		static constexpr double _log( const double x );
+		static constexpr tableType _initTable();
+
+		/*****************************************************************
+		*	static members
+		******************************************************************/
+		static const tableType _table;
+	};
+
+	/*! \brief natural logarithm usable at compile time, calculated with the series of 2 * atanh( ( x - 1 ) / ( x + 1 ) )
+	*
+	*/
+	constexpr double Reductions::_log( const double x )
+	{
+		const double y = ( x - 1.0 ) / ( x + 1.0 );
+		const double y2 = y * y;
+		double term = y;
+		double sum = 0.0;
+		for( int n = 1; n < 200; n += 2 )
+		{
+			sum += term / n;
+			term *= y2;
+		}
+		return 2.0 * sum;
+	}
+
+	constexpr Reductions::tableType Reductions::_initTable()
+	{
+		std::array< double, tableSize > logs{};
+		for( int i = 1; i < tableSize; ++i )
+		{
+			logs[ i ] = _log( i );
+		}
+
+		tableType t{};
+		for( int d = 1; d < tableSize; ++d )
+		{
+			for( int m = 1; m < tableSize; ++m )
+			{
+				t[ d ][ m ] = int( 0.5 + logs[ d ] * logs[ m ] / 2.0 );
+			}
+		}
+		return t;
+	}
+
+	inline constexpr Reductions::tableType Reductions::_table = Reductions::_initTable();
+
+	inline int Reductions::getTableValue( const int depth, const unsigned int moveNumber )
+	{
+		return _table[ std::min( depth, tableSize - 1 ) ][ std::min( moveNumber, (unsigned int)tableSize - 1 ) ];
+	}
+
+	/*! \brief reduction of a quiet move
+	*
+	*	PV nodes are reduced less, nodes whose static evaluation is not improving more.
+	*	moves with good history are reduced less and moves with bad history more. The result is never negative
+	*/
+	inline int Reductions::get( const bool PVnode, const bool improving, const int depth, const unsigned int moveNumber, const Score historyScore )
+	{
+		int r = getTableValue( depth, moveNumber );
+		r -= PVnode;
+		r += !improving;
+		r -= historyScore / historyDivisor;
+		return std::max( r, 0 );
+	}
+
+	/*! \brief number of quiet moves searched before pruning the others
+	*
+	*/
+	inline unsigned int Reductions::moveCountLimit( const int depth, const bool improving )
+	{
+		return ( 3 + depth * depth ) / ( 2 - improving );
+	}
+
+	/*! \brief margin over alpha the static evaluation needs to search a quiet move at the given depth
+	*
+	*/
+	inline Score Reductions::futilityMargin( const int depth )
+	{
+		return 150 + 120 * depth;
+	}
+}
+
+#endif /* REDUCTIONS_H_ */
@@ -0,0 +1,800 @@
+/*
+	This file is part of Vajolet.
+	Copyright (C) 2013-2018 Marco Belli
+
+    Vajolet is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Vajolet is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <sstream>
+#include "Eval.h"
+#include "MoveSelector.h"
+#include "Reductions.h"
+#include "Search.h"
+
+namespace libChess
+{
+	void Search::Statistics::clear()
+	{
+		nodes = 0;
+		qsearchNodes = 0;
+		nullMoveSearches = 0;
+		nullMoveCutoffs = 0;
+		nullMoveVerifications = 0;
+		nullMoveVerificationFails = 0;
+		ttHits = 0;
+		singularSearches = 0;
+		singularExtensions = 0;
+		multiCutPrunes = 0;
+		probCutSearches = 0;
+		probCutCutoffs = 0;
+		lmrReductions = 0;
+		lmrResearches = 0;
+		moveCountPrunes = 0;
+		futilityPrunes = 0;
+		repetitionDraws = 0;
+		upcomingRepetitionCutoffs = 0;
+	}
+
+	Search::Search( Position& pos, TranspositionTable& tt ):_pos( pos ), _tt( tt ), _history( new SearchHistory ), _bestMove( Move::NOMOVE ), _nmpMinPly( 0 ), _nmpColor( baseTypes::whiteTurn ), _stop( false ), _prepared( false ), _rootDepth( 0 ), _bestMoveChanges( 0 ), _bestMoveNodes( 0 ), _pvIndex( 0 ), _selDepth( 0 )
+	{
+		_stats.clear();
+		_staticEvals.fill( 0 );
+	}
+
+	/*! \brief clear the history tables and the transposition table, to be called before a new game
+	*
+	*/
+	void Search::clear()
+	{
+		_history->clear();
+		_tt.clear();
+	}
+
+	/*! \brief iterative deepening search up to maxDepth
+	*
+	*	return the score of the last iteration, the best move is available with getBestMove
+	*/
+	Score Search::search( const unsigned int maxDepth )
+	{
+		SearchLimits limits;
+		limits.depth = maxDepth;
+		return search( limits );
+	}
+
+	/*! \brief iterative deepening search within the limits
+	*
+	*	the first iteration is always completed. An interrupted iteration is discarded, but the best move it found
+	*	is kept, since it has been searched completely.
+	*	with multi pv every iteration searches the lines in turn, each line excludes the root moves of the previous ones.
+	*	The lines share the transposition table, so the following lines are much cheaper than the first one.
+	*	return the score of the last completed iteration, the best move is available with getBestMove and the lines with getRootMoves
+	*/
+	Score Search::search( const SearchLimits& limits )
+	{
+		if( !_prepared )
+		{
+			prepare( limits );
+		}
+		_prepared = false;
+		_stats.clear();
+		_bestMove = Move::NOMOVE;
+		_nmpMinPly = 0;
+		_tt.newSearch();
+
+		_rootMoves.clear();
+		MoveSelector ms( _pos );
+		Move m;
+		while( ( m = ms.getNextMove() ) != Move::NOMOVE )
+		{
+			_rootMoves.emplace_back( m );
+		}
+		const unsigned int lines = getLinesNumber();
+
+		const unsigned int maxDepth = limits.depth ? std::min( limits.depth, maxPly - 1 ) : maxPly - 1;
+		Score score = 0;
+		for( _rootDepth = 1; _rootDepth <= maxDepth; ++_rootDepth )
+		{
+			_bestMoveChanges = 0;
+			_bestMoveNodes = 0;
+			unsigned long long firstLineNodes = 0;
+			for( auto& rm : _rootMoves )
+			{
+				rm.previousScore = rm.score;
+			}
+
+			Score iterationScore = 0;
+			for( _pvIndex = 0; _pvIndex < lines; ++_pvIndex )
+			{
+				_selDepth = 0;
+				const unsigned long long lineStartNodes = _stats.nodes;
+				const Score lineScore = _alphaBeta< true >( 0, _rootDepth, -infinite, infinite );
+				if( _stop )
+				{
+					break;
+				}
+				if( _pvIndex == 0 )
+				{
+					iterationScore = lineScore;
+					firstLineNodes = _stats.nodes - lineStartNodes;
+				}
+				if( !_rootMoves.empty() )
+				{
+					_sortRootMoves( _pvIndex, _rootMoves.size() );
+					RootMove& rm = _rootMoves[ _pvIndex ];
+					rm.depth = _rootDepth;
+					rm.selDepth = _selDepth;
+					rm.nodes = _stats.nodes - lineStartNodes;
+				}
+			}
+			if( _stop )
+			{
+				// the moves of the interrupted line keep the result of the previous iteration
+				for( unsigned int i = _pvIndex; i < _rootMoves.size(); ++i )
+				{
+					_rootMoves[ i ].score = _rootMoves[ i ].previousScore;
+				}
+				_sortRootMoves( _pvIndex, _rootMoves.size() );
+				break;
+			}
+			score = iterationScore;
+
+			_sortRootMoves( 0, lines );
+			if( _infoListener && !_rootMoves.empty() )
+			{
+				for( unsigned int line = 0; line < lines; ++line )
+				{
+					_infoListener( getUciInfo( line ) );
+				}
+			}
+
+			_tm.newIteration( score, _bestMoveChanges, firstLineNodes ? double( _bestMoveNodes ) / firstLineNodes : 1.0 );
+			if( _tm.stopAfterIteration( _tm.getElapsedTime() ) )
+			{
+				break;
+			}
+		}
+
+		// the best move can't be returned while pondering, a finished ponder search waits for the ponder hit or the stop
+		std::unique_lock< std::mutex > lock( _waitMutex );
+		_waitCondition.wait( lock, [&]{ return !_tm.isPondering() || _stop; } );
+		return score;
+	}
+
+	/*! \brief clear the stop request and start the clock of the next search
+	*
+	*	to be called by the thread starting a search run by another thread, before starting it
+	*/
+	void Search::prepare( const SearchLimits& limits )
+	{
+		_stop = false;
+		_tm.init( limits, _pos.getActualStateConst().getTurn() );
+		_prepared = true;
+	}
+
+	/*! \brief uci info string of a line of the last completed iteration
+	*
+	*/
+	std::string Search::getUciInfo( const unsigned int line ) const
+	{
+		assert( line < _rootMoves.size() );
+		const RootMove& rm = _rootMoves[ line ];
+		std::ostringstream ss;
+		ss << "info multipv " << line + 1 << " depth " << rm.depth << " seldepth " << rm.selDepth << " score ";
+		if( rm.score >= mateInMaxPly )
+		{
+			ss << "mate " << ( mate - rm.score + 1 ) / 2;
+		}
+		else if( rm.score <= matedInMaxPly )
+		{
+			ss << "mate " << -( mate + rm.score ) / 2;
+		}
+		else
+		{
+			ss << "cp " << rm.score;
+		}
+		ss << " nodes " << rm.nodes << " time " << _tm.getElapsedTime() << " pv";
+		for( const auto& m : rm.pv )
+		{
+			ss << " " << m.to_string();
+		}
+		return ss.str();
+	}
+
+	/*! \brief sort the root moves in the range by score, the moves with the same score by the score of the previous iteration
+	*
+	*/
+	void Search::_sortRootMoves( const unsigned int first, const unsigned int last )
+	{
+		assert( first <= last );
+		std::stable_sort( _rootMoves.begin() + std::min< size_t >( first, _rootMoves.size() ), _rootMoves.begin() + std::min< size_t >( last, _rootMoves.size() ), []( const RootMove& a, const RootMove& b )
+		{
+			return a.score != b.score ? a.score > b.score : a.previousScore > b.previousScore;
+		});
+	}
+
+	/*! \brief the principal variation of ply is the move followed by the principal variation of the child
+	*
+	*/
+	inline void Search::_updatePV( const unsigned int ply, const Move& m )
+	{
+		_pv[ ply ][ 0 ] = m;
+		std::copy( _pv[ ply + 1 ].begin(), _pv[ ply + 1 ].begin() + _pvLength[ ply + 1 ], _pv[ ply ].begin() + 1 );
+		_pvLength[ ply ] = _pvLength[ ply + 1 ] + 1;
+	}
+
+	/*! \brief stop the search as soon as possible
+	*
+	*/
+	void Search::stop()
+	{
+		{
+			std::lock_guard< std::mutex > lock( _waitMutex );
+			_stop = true;
+		}
+		_waitCondition.notify_all();
+	}
+
+	/*! \brief the opponent played the ponder move, the running search continues with the time limits
+	*
+	*	the transposition table and the histories filled while pondering are kept
+	*/
+	void Search::ponderHit()
+	{
+		{
+			std::lock_guard< std::mutex > lock( _waitMutex );
+			_tm.ponderHit();
+		}
+		_waitCondition.notify_all();
+	}
+
+	/*! \brief expected reply to the best move, to be searched while pondering
+	*
+	*	the move is taken from the principal variation, or from the transposition table when the principal variation is too short
+	*/
+	Move Search::getPonderMove()
+	{
+		if( _rootMoves.empty() || _rootMoves[ 0 ].move != _bestMove )
+		{
+			return Move::NOMOVE;
+		}
+		if( _rootMoves[ 0 ].pv.size() > 1 )
+		{
+			return _rootMoves[ 0 ].pv[ 1 ];
+		}
+
+		_pos.doMove( _bestMove );
+		const ttEntry* const tte = _tt.probe( _pos.getActualStateConst().getKey() );
+		Move ponderMove = tte ? tte->getMove() : Move::NOMOVE;
+		if( ponderMove != Move::NOMOVE && !_pos.isMoveLegal( ponderMove ) )
+		{
+			ponderMove = Move::NOMOVE;
+		}
+		_pos.undoMove();
+		return ponderMove;
+	}
+
+	/*! \brief check the time and the nodes limit every TimeManagement::pollingInterval nodes
+	*
+	*	the first iteration is never interrupted, so that a best move is always available
+	*/
+	inline void Search::_pollLimits()
+	{
+		if( TimeManagement::isPollingNode( _stats.nodes ) && _rootDepth > 1 && _tm.isSearchFinished( _tm.getElapsedTime(), _stats.nodes ) )
+		{
+			_stop = true;
+		}
+	}
+
+	/*! \brief reduction of the null move search
+	*
+	*	the reduction grows with the depth and with the margin of the static evaluation over beta
+	*/
+	int Search::nullMoveReduction( const int depth, const Score eval, const Score beta )
+	{
+		assert( eval >= beta );
+		return 3 + depth / 4 + std::min( ( eval - beta ) / 200, 3 );
+	}
+
+	inline Score Search::_getNonPawnMaterial( const baseTypes::eTurn color ) const
+	{
+		return _pos.getActualStateConst().getNonPawnMaterialValue()[ baseTypes::isWhiteTurn( color ) ? 0 : 2 ];
+	}
+
+	/*! \brief tell whether the null move can be tried in a non PV node
+	*
+	*	the null move is not tried when in check, after another null move, and when the side to move has only pawns:
+	*	in pawn endings zugzwang is common and passing the move would give a wrong result
+	*/
+	inline bool Search::_isNullMoveAllowed( const unsigned int ply, const int depth, const Score eval, const Score beta ) const
+	{
+		const GameState& st = _pos.getActualStateConst();
+		const baseTypes::eTurn us = st.getTurn();
+		return _settings.nullMovePruning
+			&& depth >= nullMoveMinDepth
+			&& eval >= beta
+			&& !_pos.isInCheck()
+			&& st.getPliesFromNullCnt() > 0
+			&& _getNonPawnMaterial( us ) > 0
+			&& ( ply >= _nmpMinPly || us != _nmpColor );
+	}
+
+	template< bool PVnode >
+	Score Search::_alphaBeta( const unsigned int ply, const int depth, Score alpha, Score beta, const Move& excludedMove )
+	{
+		assert( alpha < beta );
+		assert( PVnode || alpha + 1 == beta );
+
+		if( PVnode )
+		{
+			_pvLength[ ply ] = 0;
+		}
+		if( depth <= 0 )
+		{
+			return _qsearch( ply, alpha, beta );
+		}
+
+		++_stats.nodes;
+		_selDepth = std::max( _selDepth, ply + 1 );
+		_pollLimits();
+		if( _stop )
+		{
+			return 0;
+		}
+
+		const bool rootNode = PVnode && ply == 0;
+		const GameState& st = _pos.getActualStateConst();
+		const bool inCheck = _pos.isInCheck();
+
+		if( !rootNode )
+		{
+			if( st.getFiftyMoveCnt() >= 100 )
+			{
+				return 0;
+			}
+			if( _pos.isRepetition( ply ) )
+			{
+				++_stats.repetitionDraws;
+				return 0;
+			}
+
+			// if the side to move can repeat a position the score is at least a draw
+			if( _settings.upcomingRepetition && alpha < 0 && _pos.hasUpcomingRepetition( ply ) )
+			{
+				alpha = 0;
+				if( alpha >= beta )
+				{
+					++_stats.upcomingRepetitionCutoffs;
+					return alpha;
+				}
+			}
+			if( ply >= maxPly - 1 )
+			{
+				return inCheck ? 0 : Eval::evaluate( _pos );
+			}
+
+			// mate distance pruning
+			alpha = std::max( matedIn( ply ), alpha );
+			beta = std::min( mateIn( ply + 1 ), beta );
+			if( alpha >= beta )
+			{
+				return alpha;
+			}
+		}
+
+		//------------------------------------------------------
+		// transposition table
+		//------------------------------------------------------
+		// the search excluding a move use its own key, so its results don't mix with the ones of the full search
+		const HashKey posKey = excludedMove == Move::NOMOVE ? st.getKey() : st.getKey().exclusion();
+		const ttEntry* const tte = _tt.probe( posKey );
+		// the entry is shared with the other threads, copy it before using it
+		const bool ttHit = tte != nullptr;
+		Move ttMove = ttHit ? tte->getMove() : Move::NOMOVE;
+		const Score ttValue = ttHit ? _scoreFromTT( tte->getScore(), ply ) : 0;
+		const int ttDepth = ttHit ? tte->getDepth() : 0;
+		const bool ttLowerBound = ttHit && tte->isLowerBound();
+		const bool ttUpperBound = ttHit && tte->isUpperBound();
+		const Score ttStaticValue = ttHit ? tte->getStaticValue() : 0;
+
+		if( ttHit )
+		{
+			++_stats.ttHits;
+		}
+		// at the root the best move of the line in the previous iteration is searched first
+		if( rootNode && _rootDepth > 1 && _pvIndex < _rootMoves.size() )
+		{
+			ttMove = _rootMoves[ _pvIndex ].move;
+		}
+		if( ttMove != Move::NOMOVE && !_pos.isMoveLegal( ttMove ) )
+		{
+			ttMove = Move::NOMOVE;
+		}
+
+		if( !PVnode && ttHit && ttDepth >= depth && ( ttValue >= beta ? ttLowerBound : ttUpperBound ) )
+		{
+			return ttValue;
+		}
+
+		const Score staticEval = inCheck ? -infinite : ( ttHit ? ttStaticValue : Eval::evaluate( _pos ) );
+		_staticEvals[ ply ] = staticEval;
+		const bool improving = !inCheck && ( ply < 2 || staticEval > _staticEvals[ ply - 2 ] );
+
+		//------------------------------------------------------
+		// null move pruning
+		//------------------------------------------------------
+		if( !PVnode && excludedMove == Move::NOMOVE && _isNullMoveAllowed( ply, depth, staticEval, beta ) )
+		{
+			const int reduction = nullMoveReduction( depth, staticEval, beta );
+			const baseTypes::eTurn us = st.getTurn();
+
+			++_stats.nullMoveSearches;
+			_pos.doNullMove();
+			Score nullScore = -_alphaBeta< false >( ply + 1, depth - reduction, -beta, -beta + 1 );
+			_pos.undoNullMove();
+
+			if( _stop )
+			{
+				return 0;
+			}
+
+			if( nullScore >= beta )
+			{
+				// don't return unproven mates
+				if( nullScore >= mateInMaxPly )
+				{
+					nullScore = beta;
+				}
+
+				// with only a minor piece left zugzwang is likely, verify the cutoff at every depth
+				const bool zugzwangRisk = _getNonPawnMaterial( us ) < nullMoveVerificationMaterial;
+				if( _nmpMinPly != 0 || ( depth < nullMoveVerificationDepth && !zugzwangRisk && std::abs( beta ) < Eval::knownWin ) )
+				{
+					++_stats.nullMoveCutoffs;
+					return nullScore;
+				}
+
+				// verification search, with null move disabled for us in the first part of the tree
+				++_stats.nullMoveVerifications;
+				_nmpMinPly = ply + 3 * ( depth - reduction ) / 4;
+				_nmpColor = us;
+				const Score verificationScore = _alphaBeta< false >( ply, depth - reduction, beta - 1, beta );
+				_nmpMinPly = 0;
+
+				if( verificationScore >= beta )
+				{
+					++_stats.nullMoveCutoffs;
+					return nullScore;
+				}
+				++_stats.nullMoveVerificationFails;
+			}
+		}
+
+		//------------------------------------------------------
+		// ProbCut
+		//------------------------------------------------------
+		// if a good capture beats beta by a margin with a reduced search, the full depth search will very likely fail high too.
+		// the tt is trusted when it tells that the reduced search can't succeed
+		const Score probCutBeta = beta + probCutMargin;
+		if( !PVnode
+			&& _settings.probCut
+			&& !inCheck
+			&& excludedMove == Move::NOMOVE
+			&& depth >= probCutDepth
+			&& std::abs( beta ) < mateInMaxPly
+			&& !( ttHit && ttDepth >= depth - probCutReduction + 1 && ttValue < probCutBeta ) )
+		{
+			MoveSelector pcs( _pos, probCutBeta - staticEval, ttMove );
+			Move m;
+			while( ( m = pcs.getNextMove() ) != Move::NOMOVE )
+			{
+				++_stats.probCutSearches;
+				_pos.doMove( m );
+				// verify with the quiescence search before spending the reduced depth search
+				Score score = -_qsearch( ply + 1, -probCutBeta, -probCutBeta + 1 );
+				if( score >= probCutBeta )
+				{
+					score = -_alphaBeta< false >( ply + 1, depth - probCutReduction, -probCutBeta, -probCutBeta + 1 );
+				}
+				_pos.undoMove();
+
+				if( _stop )
+				{
+					return 0;
+				}
+				if( score >= probCutBeta )
+				{
+					++_stats.probCutCutoffs;
+					_tt.store( posKey, _scoreToTT( score, ply ), ttEntry::typeLowerBound, depth - probCutReduction + 1, m, staticEval );
+					return score;
+				}
+			}
+		}
+
+		// the tt move is a candidate for the singular extension if it failed high at a similar depth
+		const bool singularExtensionNode = _settings.singularExtension
+			&& !rootNode
+			&& depth >= singularExtensionDepth
+			&& ttMove != Move::NOMOVE
+			&& excludedMove == Move::NOMOVE
+			&& ttLowerBound
+			&& ttDepth >= depth - 3
+			&& std::abs( ttValue ) < Eval::knownWin;
+
+		//------------------------------------------------------
+		// moves loop
+		//------------------------------------------------------
+		MoveSelector ms( _pos, *_history, ply, ttMove );
+		if( ply + 2 < maxPly )
+		{
+			_history->clearKillers( ply + 2 );
+		}
+
+		Score bestScore = -infinite;
+		Move bestMove = Move::NOMOVE;
+		unsigned int moveCount = 0;
+		std::array< Move, 64 > quietsSearched;
+		unsigned int quietsCount = 0;
+
+		Move m;
+		while( ( m = ms.getNextMove() ) != Move::NOMOVE )
+		{
+			if( m == excludedMove )
+			{
+				continue;
+			}
+			// the root moves of the previous lines are excluded
+			if( rootNode && std::find( _rootMoves.begin() + _pvIndex, _rootMoves.end(), m ) == _rootMoves.end() )
+			{
+				continue;
+			}
+			++moveCount;
+			const bool isQuiet = !_pos.isCaptureMove( m );
+			const bool givesCheck = _pos.moveGivesCheck( m );
+			// quiet moves that can be reduced and pruned
+			const bool lateMoveCandidate = isQuiet && !givesCheck && !m.isPromotionMove();
+
+			//------------------------------------------------------
+			// move count and futility pruning
+			//------------------------------------------------------
+			// the pruned moves are skipped without playing them, at least a move has been searched when they are pruned
+			const bool pruningAllowed = _settings.lateMovePruning && !rootNode && lateMoveCandidate && bestScore > matedInMaxPly;
+			if( pruningAllowed && depth < Reductions::moveCountPruningDepth && moveCount > Reductions::moveCountLimit( depth, improving ) )
+			{
+				++_stats.moveCountPrunes;
+				continue;
+			}
+
+			const Score historyScore = lateMoveCandidate ? _history->getQuietScore( _pos, m ) : 0;
+			if( pruningAllowed && !inCheck )
+			{
+				const int lmrDepth = std::max( depth - 1 - Reductions::get( PVnode, improving, depth, moveCount, historyScore ), 0 );
+				if( lmrDepth < Reductions::futilityPruningDepth && staticEval + Reductions::futilityMargin( lmrDepth ) <= alpha )
+				{
+					++_stats.futilityPrunes;
+					continue;
+				}
+			}
+
+			//------------------------------------------------------
+			// singular extension
+			//------------------------------------------------------
+			// search all the other moves at reduced depth with a window just below the tt value,
+			// if all of them fail low the tt move is singular and it's extended
+			int extension = 0;
+			if( singularExtensionNode && m == ttMove )
+			{
+				const Score singularBeta = ttValue - 2 * depth;
+				++_stats.singularSearches;
+				const Score score = _alphaBeta< false >( ply, depth / 2, singularBeta - 1, singularBeta, m );
+				if( _stop )
+				{
+					return 0;
+				}
+				if( score < singularBeta )
+				{
+					++_stats.singularExtensions;
+					extension = 1;
+				}
+				else if( singularBeta >= beta )
+				{
+					// multi-cut: the tt move and at least another move fail high, the node will fail high
+					++_stats.multiCutPrunes;
+					return singularBeta;
+				}
+			}
+			const int newDepth = depth - 1 + extension;
+
+			const unsigned long long moveStartNodes = _stats.nodes;
+			if( PVnode )
+			{
+				_pvLength[ ply + 1 ] = 0;
+			}
+			_pos.doMove( m );
+			Score score;
+			if( moveCount == 1 )
+			{
+				score = -_alphaBeta< PVnode >( ply + 1, newDepth, -beta, -alpha );
+			}
+			else
+			{
+				//------------------------------------------------------
+				// late move reductions
+				//------------------------------------------------------
+				int reduction = 0;
+				if( _settings.lateMoveReductions && depth >= Reductions::minDepth && lateMoveCandidate && !inCheck && moveCount > 1u + rootNode )
+				{
+					reduction = std::max( std::min( Reductions::get( PVnode, improving, depth, moveCount, historyScore ), newDepth - 1 ), 0 );
+				}
+
+				score = -_alphaBeta< false >( ply + 1, newDepth - reduction, -alpha - 1, -alpha );
+				if( reduction > 0 )
+				{
+					++_stats.lmrReductions;
+					// the reduced search failed high, verify it at full depth
+					if( score > alpha )
+					{
+						++_stats.lmrResearches;
+						score = -_alphaBeta< false >( ply + 1, newDepth, -alpha - 1, -alpha );
+					}
+				}
+				if( PVnode && score > alpha && score < beta )
+				{
+					score = -_alphaBeta< true >( ply + 1, newDepth, -beta, -alpha );
+				}
+			}
+			_pos.undoMove();
+
+			// the score of an interrupted search is not valid
+			if( _stop )
+			{
+				return 0;
+			}
+
+			if( rootNode )
+			{
+				// the moves failing low have only an upper bound, they are sorted after the best one
+				RootMove& rm = *std::find( _rootMoves.begin() + _pvIndex, _rootMoves.end(), m );
+				if( moveCount == 1 || score > alpha )
+				{
+					rm.score = score;
+					rm.pv.assign( 1, m );
+					rm.pv.insert( rm.pv.end(), _pv[ 1 ].begin(), _pv[ 1 ].begin() + _pvLength[ 1 ] );
+				}
+				else
+				{
+					rm.score = -infinite;
+				}
+			}
+
+			if( score > bestScore )
+			{
+				bestScore = score;
+				if( score > alpha )
+				{
+					bestMove = m;
+					if( PVnode && !rootNode )
+					{
+						_updatePV( ply, m );
+					}
+					if( rootNode && _pvIndex == 0 )
+					{
+						if( moveCount > 1 && m != _bestMove )
+						{
+							++_bestMoveChanges;
+						}
+						_bestMove = m;
+						_bestMoveNodes = _stats.nodes - moveStartNodes;
+					}
+					if( score >= beta )
+					{
+						break;
+					}
+					alpha = score;
+				}
+			}
+
+			if( isQuiet && quietsCount < quietsSearched.size() )
+			{
+				quietsSearched[ quietsCount++ ] = m;
+			}
+		}
+
+		if( moveCount == 0 )
+		{
+			// when the only legal move is the excluded one, the node fails low
+			return excludedMove != Move::NOMOVE ? alpha : ( inCheck ? matedIn( ply ) : 0 );
+		}
+
+		if( bestScore >= beta && !_pos.isCaptureMove( bestMove ) )
+		{
+			_history->updateQuietStats( _pos, ply, bestMove, quietsSearched.data(), quietsCount, depth );
+		}
+
+		const ttEntry::eBound bound = bestScore >= beta ? ttEntry::typeLowerBound : ( PVnode && bestMove != Move::NOMOVE ? ttEntry::typeExact : ttEntry::typeUpperBound );
+		_tt.store( posKey, _scoreToTT( bestScore, ply ), bound, depth, bestMove, staticEval );
+
+		return bestScore;
+	}
+
+	/*! \brief quiescence search
+	*
+	*	captures and promotions are searched, plus the quiet checks at the first ply ( depth 0 ). All the evasions when in check
+	*/
+	Score Search::_qsearch( const unsigned int ply, Score alpha, Score beta, const int depth )
+	{
+		assert( alpha < beta );
+
+		++_stats.nodes;
+		++_stats.qsearchNodes;
+		_selDepth = std::max( _selDepth, ply + 1 );
+		_pollLimits();
+		if( _stop )
+		{
+			return 0;
+		}
+
+		const bool inCheck = _pos.isInCheck();
+		if( ply >= maxPly - 1 )
+		{
+			return inCheck ? 0 : Eval::evaluate( _pos );
+		}
+
+		Score bestScore = -infinite;
+		if( !inCheck )
+		{
+			// stand pat
+			bestScore = Eval::evaluate( _pos );
+			if( bestScore >= beta )
+			{
+				return bestScore;
+			}
+			alpha = std::max( alpha, bestScore );
+		}
+
+		MoveSelector ms( _pos, depth == 0 ? MoveSelector::quiescentWithChecks : MoveSelector::quiescentCaptures, Move::NOMOVE );
+
+		unsigned int moveCount = 0;
+		Move m;
+		while( ( m = ms.getNextMove() ) != Move::NOMOVE )
+		{
+			++moveCount;
+			_pos.doMove( m );
+			const Score score = -_qsearch( ply + 1, -beta, -alpha, depth - 1 );
+			_pos.undoMove();
+
+			if( score > bestScore )
+			{
+				bestScore = score;
+				if( score > alpha )
+				{
+					if( score >= beta )
+					{
+						break;
+					}
+					alpha = score;
+				}
+			}
+		}
+
+		if( inCheck && moveCount == 0 )
+		{
+			return matedIn( ply );
+		}
+
+		return bestScore;
+	}
+}
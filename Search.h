@@ -0,0 +1,272 @@
+/*
+	This file is part of Vajolet.
+	Copyright (C) 2013-2018 Marco Belli
+
+    Vajolet is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Vajolet is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#ifndef SEARCH_H_
+#define SEARCH_H_
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "eTurn.h"
+#include "History.h"
+#include "Move.h"
+#include "Position.h"
+#include "Score.h"
+#include "TimeManagement.h"
+#include "TranspositionTable.h"
+
+namespace libChess
+{
+	/*!	\brief alpha beta search with quiescence search
+
+		the search work on the position passed to the constructor, that is restored at the end of the search.
+		Every Search owns its SearchHistory, so it shall be used by a single thread.
+		A search run by another thread shall be prepared by the thread starting it, so that a stop or a ponder hit
+		received before the search begins isn't lost
+	 */
+	class Search
+	{
+	public:
+		/*!	\brief counters collected during the search
+		 */
+		struct Statistics
+		{
+			unsigned long long nodes;
+			unsigned long long qsearchNodes;
+			unsigned long long nullMoveSearches;
+			unsigned long long nullMoveCutoffs;
+			unsigned long long nullMoveVerifications;
+			unsigned long long nullMoveVerificationFails;
+			unsigned long long ttHits;
+			unsigned long long singularSearches;
+			unsigned long long singularExtensions;
+			unsigned long long multiCutPrunes;
+			unsigned long long probCutSearches;
+			unsigned long long probCutCutoffs;
+			unsigned long long lmrReductions;
+			unsigned long long lmrResearches;
+			unsigned long long moveCountPrunes;
+			unsigned long long futilityPrunes;
+			unsigned long long repetitionDraws;
+			unsigned long long upcomingRepetitionCutoffs;
+
+			void clear();
+		};
+
+		/*!	\brief a legal move of the root position with the result of its last search
+		 */
+		struct RootMove
+		{
+			explicit RootMove( const Move& m ): move( m ){}
+			bool operator==( const Move& m ) const { return move == m; }
+
+			Move move;
+			Score score = -infinite;
+			Score previousScore = -infinite;	// score of the previous iteration, used to keep the order of the moves failing low
+			unsigned int depth = 0;
+			unsigned int selDepth = 0;
+			unsigned long long nodes = 0;	// nodes of the last search of the line
+			std::vector< Move > pv;
+		};
+
+		/*!	\brief switches of the search features, used to measure their effect, and number of lines searched
+		 */
+		struct Settings
+		{
+			bool nullMovePruning = true;
+			bool singularExtension = true;
+			bool probCut = true;
+			bool lateMoveReductions = true;
+			bool lateMovePruning = true;
+			bool upcomingRepetition = true;
+			unsigned int multiPV = 1;
+		};
+
+		/*****************************************************************
+		*	constructors
+		******************************************************************/
+		Search( Position& pos, TranspositionTable& tt );
+
+		/*****************************************************************
+		*	methods
+		******************************************************************/
+		Score search( const unsigned int maxDepth );
+		Score search( const SearchLimits& limits );
+		void prepare( const SearchLimits& limits );
+		void stop();
+		void ponderHit();
+		void clear();
+		const Move& getBestMove() const;
+		Move getPonderMove();
+		const Statistics& getStatistics() const;
+		Settings& getSettings();
+		TimeManagement& getTimeManagement();
+		const std::vector< RootMove >& getRootMoves() const;
+		unsigned int getLinesNumber() const;
+		std::string getUciInfo( const unsigned int line ) const;
+		void setInfoListener( const std::function< void( const std::string& ) >& listener );
+
+		/*****************************************************************
+		*	static methods
+		******************************************************************/
+		static Score mateIn( const unsigned int ply );
+		static Score matedIn( const unsigned int ply );
+		static int nullMoveReduction( const int depth, const Score eval, const Score beta );
+
+		/*****************************************************************
+		*	static members
+		******************************************************************/
+		static constexpr unsigned int maxPly = SearchHistory::maxPly;
+		static constexpr Score infinite = 32000;
+		static constexpr Score mate = 31000;
+		static constexpr Score mateInMaxPly = mate - maxPly;
+		static constexpr Score matedInMaxPly = -mateInMaxPly;
+
+		static constexpr int nullMoveMinDepth = 2;
+		static constexpr int nullMoveVerificationDepth = 12;	// null move cutoffs are verified by a reduced search from this depth
+		static constexpr Score nullMoveVerificationMaterial = 600;	// with less non pawn material ( a single minor piece ) the cutoffs are always verified
+		static constexpr int singularExtensionDepth = 8;
+		static constexpr int probCutDepth = 5;
+		static constexpr int probCutReduction = 4;
+		static constexpr Score probCutMargin = 200;
+
+	private:
+		/*****************************************************************
+		*	members
+		******************************************************************/
+		Position& _pos;
+		TranspositionTable& _tt;
+		std::unique_ptr< SearchHistory > _history;
+		Statistics _stats;
+		Settings _settings;
+		TimeManagement _tm;
+		Move _bestMove;
+		// static evaluation of the nodes in the current line, used to tell whether the position is improving
+		std::array< Score, maxPly + 1 > _staticEvals;
+
+		// during a null move verification search the null move is disabled for _nmpColor up to _nmpMinPly
+		unsigned int _nmpMinPly;
+		baseTypes::eTurn _nmpColor;
+
+		std::atomic< bool > _stop;
+		// set by prepare, so that search doesn't reset the stop request and the clock
+		bool _prepared;
+		// signalled by stop and ponderHit, wakes up a finished ponder search
+		std::mutex _waitMutex;
+		std::condition_variable _waitCondition;
+		unsigned int _rootDepth;
+		// best move changes and nodes spent on the best move in the current iteration, used by the time management
+		unsigned int _bestMoveChanges;
+		unsigned long long _bestMoveNodes;
+
+		// multi pv: the lines are searched in turn, the search of the line _pvIndex skips the root moves of the previous lines
+		std::vector< RootMove > _rootMoves;
+		unsigned int _pvIndex;
+		unsigned int _selDepth;
+		// triangular table of the principal variations found at every ply
+		std::array< std::array< Move, maxPly + 1 >, maxPly + 1 > _pv;
+		std::array< unsigned int, maxPly + 1 > _pvLength;
+		std::function< void( const std::string& ) > _infoListener;
+
+		/*****************************************************************
+		*	methods
+		******************************************************************/
+		template< bool PVnode > Score _alphaBeta( const unsigned int ply, const int depth, Score alpha, Score beta, const Move& excludedMove = Move::NOMOVE );
+		Score _qsearch( const unsigned int ply, Score alpha, Score beta, const int depth = 0 );
+		void _pollLimits();
+		void _updatePV( const unsigned int ply, const Move& m );
+		void _sortRootMoves( const unsigned int first, const unsigned int last );
+		bool _isNullMoveAllowed( const unsigned int ply, const int depth, const Score eval, const Score beta ) const;
+		Score _getNonPawnMaterial( const baseTypes::eTurn color ) const;
+
+		/*****************************************************************
+		*	static methods
+		******************************************************************/
+		static Score _scoreToTT( const Score v, const unsigned int ply );
+		static Score _scoreFromTT( const Score v, const unsigned int ply );
+	};
+
+	inline const Move& Search::getBestMove() const
+	{
+		return _bestMove;
+	}
+
+	inline const Search::Statistics& Search::getStatistics() const
+	{
+		return _stats;
+	}
+
+	inline Search::Settings& Search::getSettings()
+	{
+		return _settings;
+	}
+
+	inline TimeManagement& Search::getTimeManagement()
+	{
+		return _tm;
+	}
+
+	inline const std::vector< Search::RootMove >& Search::getRootMoves() const
+	{
+		return _rootMoves;
+	}
+
+	/*! \brief number of lines searched, never more than the legal moves
+	*
+	*/
+	inline unsigned int Search::getLinesNumber() const
+	{
+		return std::max( std::min( _settings.multiPV, (unsigned int)_rootMoves.size() ), 1u );
+	}
+
+	inline void Search::setInfoListener( const std::function< void( const std::string& ) >& listener )
+	{
+		_infoListener = listener;
+	}
+
+	inline Score Search::mateIn( const unsigned int ply )
+	{
+		return mate - ply;
+	}
+
+	inline Score Search::matedIn( const unsigned int ply )
+	{
+		return -mate + ply;
+	}
+
+	/*! \brief mate scores are stored in the transposition table as distance from the node instead of distance from the root
+	*
+	*/
+	inline Score Search::_scoreToTT( const Score v, const unsigned int ply )
+	{
+		return v >= mateInMaxPly ? v + ply : ( v <= matedInMaxPly ? v - ply : v );
+	}
+
+	inline Score Search::_scoreFromTT( const Score v, const unsigned int ply )
+	{
+		return v >= mateInMaxPly ? v - ply : ( v <= matedInMaxPly ? v + ply : v );
+	}
+}
+
+#endif /* SEARCH_H_ */
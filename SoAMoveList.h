@@ -0,0 +1,251 @@
+/*
+	This file is part of Vajolet.
+	Copyright (C) 2013-2018 Marco Belli
+
+    Vajolet is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Vajolet is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#ifndef SOAMOVELIST_H_
+#define SOAMOVELIST_H_
+
+#include <array>
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include "Move.h"
+#include "Score.h"
+#include "History.h"
+#include "Position.h"
+
+namespace libChess
+{
+	/*!	\brief structure of arrays move list
+
+		packed moves and scores are stored in two separated aligned arrays, so that the scoring
+		and the search of the best move can work on 8 moves at a time with AVX2.
+		The interface mimic MoveList, the scores are calculated by the list itself
+	 */
+	template <std::size_t N> class SoAMoveList
+	{
+	public:
+	/*****************************************************************
+	*	methods
+	******************************************************************/
+		void insert( const Move& m );
+		void reset(void);
+		unsigned int size() const;
+		Move get( const unsigned int n ) const;
+		Score getScore( const unsigned int n ) const;
+		void setScore( const unsigned int n, const Score s );
+		Move findNextBestMove(void);
+		Move getNextMove(void);
+		void ignoreMove( const Move& m );
+		void sortAbove( const Score limit );
+
+		void scoreCaptures( const Position& pos );
+		void scoreQuietMoves( const Position& pos, const SearchHistory& history );
+
+	/*****************************************************************
+	*	static members
+	******************************************************************/
+		static const std::size_t capacity = ( N + 7 ) / 8 * 8;	// padded to a multiple of the AVX2 width
+
+	/*****************************************************************
+	*	members
+	******************************************************************/
+	private:
+		alignas( 32 ) std::array< unsigned short, capacity > _moves;
+		alignas( 32 ) std::array< Score, capacity > _scores;
+		unsigned int _moveListEnd = 0;
+		unsigned int _moveListPosition = 0;
+
+		unsigned int _findBestMove(void) const;
+		void _swap( const unsigned int a, const unsigned int b );
+	};
+
+	template <std::size_t N>
+	inline void SoAMoveList<N>::insert( const Move& m )
+	{
+		assert( _moveListEnd < N );
+		_moves[ _moveListEnd++ ] = m.getPacked();
+	}
+
+	template <std::size_t N>
+	inline void SoAMoveList<N>::reset()
+	{
+		_moveListPosition = 0;
+		_moveListEnd = 0;
+	}
+
+	template <std::size_t N>
+	inline unsigned int SoAMoveList<N>::size() const
+	{
+		return _moveListEnd;
+	}
+
+	template <std::size_t N>
+	inline Move SoAMoveList<N>::get( const unsigned int n ) const
+	{
+		assert( n < N );
+		return Move( _moves[ n ] );
+	}
+
+	template <std::size_t N>
+	inline Score SoAMoveList<N>::getScore( const unsigned int n ) const
+	{
+		assert( n < N );
+		return _scores[ n ];
+	}
+
+	template <std::size_t N>
+	inline void SoAMoveList<N>::setScore( const unsigned int n, const Score s )
+	{
+		assert( n < N );
+		_scores[ n ] = s;
+	}
+
+	template <std::size_t N>
+	inline void SoAMoveList<N>::_swap( const unsigned int a, const unsigned int b )
+	{
+		std::swap( _moves[ a ], _moves[ b ] );
+		std::swap( _scores[ a ], _scores[ b ] );
+	}
+
+	/*! \brief return the index of the first move with the highest score between actualPosition and end
+	*
+	*	with AVX2 the maximum is reduced 8 scores at a time, then the first matching score is found with a compare and movemask
+	*/
+	template <std::size_t N>
+	inline unsigned int SoAMoveList<N>::_findBestMove(void) const
+	{
+		unsigned int i = _moveListPosition;
+#if defined(__AVX2__)
+		if( _moveListEnd - _moveListPosition >= 8 )
+		{
+			__m256i vMax = _mm256_set1_epi32( std::numeric_limits< Score >::min() );
+			for( ; i + 8 <= _moveListEnd; i += 8 )
+			{
+				vMax = _mm256_max_epi32( vMax, _mm256_loadu_si256( reinterpret_cast< const __m256i* >( _scores.data() + i ) ) );
+			}
+			__m128i m = _mm_max_epi32( _mm256_castsi256_si128( vMax ), _mm256_extracti128_si256( vMax, 1 ) );
+			m = _mm_max_epi32( m, _mm_shuffle_epi32( m, _MM_SHUFFLE( 1, 0, 3, 2 ) ) );
+			m = _mm_max_epi32( m, _mm_shuffle_epi32( m, _MM_SHUFFLE( 2, 3, 0, 1 ) ) );
+			Score max = _mm_cvtsi128_si32( m );
+			for( ; i < _moveListEnd; ++i )
+			{
+				max = std::max( max, _scores[ i ] );
+			}
+
+			const __m256i vBest = _mm256_set1_epi32( max );
+			for( i = _moveListPosition; i + 8 <= _moveListEnd; i += 8 )
+			{
+				const int mask = _mm256_movemask_ps( _mm256_castsi256_ps( _mm256_cmpeq_epi32( vBest, _mm256_loadu_si256( reinterpret_cast< const __m256i* >( _scores.data() + i ) ) ) ) );
+				if( mask )
+				{
+					return i + __builtin_ctz( mask );
+				}
+			}
+			return std::find( _scores.begin() + i, _scores.begin() + _moveListEnd, max ) - _scores.begin();
+		}
+#endif
+		return std::max_element( _scores.begin() + i, _scores.begin() + _moveListEnd ) - _scores.begin();
+	}
+
+	template <std::size_t N>
+	inline Move SoAMoveList<N>::findNextBestMove(void)
+	{
+		if( _moveListPosition != _moveListEnd )
+		{
+			_swap( _findBestMove(), _moveListPosition );
+			return Move( _moves[ _moveListPosition++ ] );
+		}
+		return Move::NOMOVE;
+	}
+
+	template <std::size_t N>
+	inline Move SoAMoveList<N>::getNextMove(void)
+	{
+		if( _moveListPosition != _moveListEnd )
+		{
+			return Move( _moves[ _moveListPosition++ ] );
+		}
+		return Move::NOMOVE;
+	}
+
+	template <std::size_t N>
+	inline void SoAMoveList<N>::ignoreMove( const Move& m )
+	{
+		const auto i = std::find( _moves.begin() + _moveListPosition, _moves.begin() + _moveListEnd, m.getPacked() );
+		if( i != _moves.begin() + _moveListEnd )
+		{
+			_swap( i - _moves.begin(), _moveListPosition );
+			++_moveListPosition;
+		}
+	}
+
+	/*! \brief partial insertion sort of the moves between actualPosition and end, see MoveList::sortAbove
+	*
+	*/
+	template <std::size_t N>
+	inline void SoAMoveList<N>::sortAbove( const Score limit )
+	{
+		if( _moveListPosition == _moveListEnd )
+		{
+			return;
+		}
+		for( unsigned int sortedEnd = _moveListPosition, p = _moveListPosition + 1; p < _moveListEnd; ++p )
+		{
+			if( _scores[ p ] >= limit )
+			{
+				const unsigned short tmpMove = _moves[ p ];
+				const Score tmpScore = _scores[ p ];
+				++sortedEnd;
+				_moves[ p ] = _moves[ sortedEnd ];
+				_scores[ p ] = _scores[ sortedEnd ];
+				unsigned int q = sortedEnd;
+				for( ; q != _moveListPosition && _scores[ q - 1 ] < tmpScore; --q )
+				{
+					_moves[ q ] = _moves[ q - 1 ];
+					_scores[ q ] = _scores[ q - 1 ];
+				}
+				_moves[ q ] = tmpMove;
+				_scores[ q ] = tmpScore;
+			}
+		}
+	}
+
+	/*! \brief assign the MVV-LVA score to the moves between actualPosition and end
+	*
+	*/
+	template <std::size_t N>
+	inline void SoAMoveList<N>::scoreCaptures( const Position& pos )
+	{
+		pos.getMvvLvaScores( _moves.data() + _moveListPosition, _scores.data() + _moveListPosition, _moveListEnd - _moveListPosition );
+	}
+
+	/*! \brief assign the history score to the moves between actualPosition and end
+	*
+	*/
+	template <std::size_t N>
+	inline void SoAMoveList<N>::scoreQuietMoves( const Position& pos, const SearchHistory& history )
+	{
+		history.getQuietScores( pos, _moves.data() + _moveListPosition, _scores.data() + _moveListPosition, _moveListEnd - _moveListPosition );
+	}
+}
+
+#endif /* SOAMOVELIST_H_ */
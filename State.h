@@ -73,6 +73,7 @@ namespace libChess
 		
 		const baseTypes::BitMap& getDiscoveryCheckers() const;
 		const baseTypes::BitMap& getPinned() const;
+		const baseTypes::BitMap& getBlockersForKing( const baseTypes::eTurn color ) const;
 		const baseTypes::BitMap& getCheckers() const;
 		
 		const Move& getCurrentMove() const;
@@ -110,6 +111,7 @@ namespace libChess
 		void setCheckingSquare( const baseTypes::bitboardIndex idx, const baseTypes::BitMap& b );
 		void setDiscoveryChechers( const baseTypes::BitMap& b);
 		void setPinned( const baseTypes::BitMap& b);
+		void setBlockersForKing( const baseTypes::eTurn color, const baseTypes::BitMap& b );
 		void setCheckers( const baseTypes::BitMap& b );
 			
 		/*****************************************************************
@@ -141,6 +143,7 @@ namespace libChess
 		void materialMovePiece( const simdScore from, const simdScore to );
 		void materialCapturePiece( const simdScore material, const simdScore nonPawnMaterial );
 		void materialPromotePiece( const simdScore material, const simdScore promotedMaterial , const simdScore nonPawnPromotedMaterial );
+		void copyForNullMove( const GameState& st );
 		
 		
 	private:
@@ -166,9 +169,11 @@ namespace libChess
 			
 		baseTypes::bitboardIndex _capturedPiece; /*!<  index of the captured piece for unmakeMove*/
 		
-		baseTypes::BitMap _checkingSquares[baseTypes::bitboardNumber]; /*!< squares of the board from where a king can be checked*/
+		mutable baseTypes::BitMap _checkingSquares[baseTypes::bitboardNumber]; /*!< squares of the board from where a king can be checked, lazily calculated by Position after a null move*/
+		mutable bool _hasCheckingSquares;	/*!< true if _checkingSquares are up to date*/
 		baseTypes::BitMap _discoveryCheckers;	/*!< pieces who can make a discover check moving*/
 		baseTypes::BitMap _pinned;	/*!< pinned pieces*/
+		baseTypes::BitMap _blockersForKing[baseTypes::turnNumber];	/*!< pieces of both colors who block an enemy slider attack to the king*/
 		baseTypes::BitMap _checkers;	/*!< checking pieces*/
 		Move _currentMove;
 		
@@ -177,7 +182,7 @@ namespace libChess
 	//-----------------------------------------
 	// constructor
 	//-----------------------------------------
-	inline GameState::GameState(){}
+	inline GameState::GameState():_hasCheckingSquares(false), _blockersForKing{ baseTypes::BitMap( 0 ), baseTypes::BitMap( 0 ) }{}
 	
 	
 	//-----------------------------------------
@@ -203,6 +208,7 @@ namespace libChess
 	
 	inline const baseTypes::BitMap& GameState::getDiscoveryCheckers()      const { return _discoveryCheckers; }
 	inline const baseTypes::BitMap& GameState::getPinned()   const { return _pinned; }
+	inline const baseTypes::BitMap& GameState::getBlockersForKing( const baseTypes::eTurn color ) const { return _blockersForKing[color]; }
 	inline const baseTypes::BitMap& GameState::getCheckers() const { return _checkers; }
 	
 	inline const Move& GameState::getCurrentMove()           const { return _currentMove; }
@@ -346,6 +352,11 @@ namespace libChess
 		_discoveryCheckers = b;
 	}
 	
+	inline void GameState::setBlockersForKing( const baseTypes::eTurn color, const baseTypes::BitMap& b )
+	{
+		_blockersForKing[color] = b;
+	}
+	
 	inline void GameState::setCheckers( const baseTypes::BitMap& b )
 	{
 		_checkers = b;
@@ -409,6 +420,30 @@ namespace libChess
 		_nonPawnMaterialValue += nonPawnPromotedMaterial;
 	}
 	
+	/*! \brief copy the fields that survive a null move
+	*
+	*	the null move doesn't move any piece, so the blockers are still valid and the checking squares
+	*	are not copied: they are marked as stale and recalculated by Position only if needed
+	*/
+	inline void GameState::copyForNullMove( const GameState& st )
+	{
+		_key = st._key;
+		_pawnKey = st._pawnKey;
+		_materialKey = st._materialKey;
+		_nonPawnMaterialValue = st._nonPawnMaterialValue;
+		_materialValue = st._materialValue;
+		_turn = st._turn;
+		_castleRights = st._castleRights;
+		_epSquare = st._epSquare;
+		_fiftyMoveCnt = st._fiftyMoveCnt;
+		_pliesFromNull = st._pliesFromNull;
+		_ply = st._ply;
+		_hasCheckingSquares = false;
+		_blockersForKing[ baseTypes::whiteTurn ] = st._blockersForKing[ baseTypes::whiteTurn ];
+		_blockersForKing[ baseTypes::blackTurn ] = st._blockersForKing[ baseTypes::blackTurn ];
+		_checkers = st._checkers;
+	}
+	
 	inline unsigned int GameState::getFullMoveCounter(void) const
 	{
 		return 1 + (getPliesCnt() - int( isBlackTurn( getTurn() ) ) ) / 2;
@@ -0,0 +1,114 @@
+/*
+	This file is part of Vajolet.
+	Copyright (C) 2013-2018 Marco Belli
+
+    Vajolet is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Vajolet is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#include <algorithm>
+#include "TimeManagement.h"
+
+namespace libChess
+{
+	TimeManagement::TimeManagement():_optimumTime( 0 ), _maximumTime( 0 ), _timeScale( 1.0 ), _nodesLimit( 0 ), _timeManaged( false ), _fixedTime( false ), _moveOverhead( defaultMoveOverhead ), _pondering( false ), _ponderTime( 0 ), _hasPreviousScore( false ), _previousScore( 0 ), _bestMoveInstability( 0.0 )
+	{
+	}
+
+	/*! \brief start the clock and calculate the optimum and maximum time of the search
+	*
+	*	with movetime the whole time is used, otherwise the remaining time plus the future increments is split
+	*	between movestogo moves, reserving the move overhead for every move
+	*/
+	void TimeManagement::init( const SearchLimits& limits, const baseTypes::eTurn us )
+	{
+		_startTime = std::chrono::steady_clock::now();
+		_ponderTime = 0;
+		_pondering = limits.ponder;
+		_nodesLimit = limits.nodes;
+		_timeScale = 1.0;
+		_hasPreviousScore = false;
+		_previousScore = 0;
+		_bestMoveInstability = 0.0;
+
+		const long long time = baseTypes::isWhiteTurn( us ) ? limits.wtime : limits.btime;
+		const long long inc = baseTypes::isWhiteTurn( us ) ? limits.winc : limits.binc;
+
+		_fixedTime = limits.moveTime > 0;
+		_timeManaged = !limits.infinite && ( _fixedTime || time > 0 );
+		if( !_timeManaged )
+		{
+			_optimumTime = 0;
+			_maximumTime = 0;
+			return;
+		}
+
+		if( _fixedTime )
+		{
+			_optimumTime = _maximumTime = std::max( limits.moveTime - _moveOverhead, 1ll );
+			return;
+		}
+
+		const long long movesToGo = limits.movesToGo ? std::min( limits.movesToGo, defaultMovesToGo ) : defaultMovesToGo;
+		const long long timeLeft = std::max( time + inc * ( movesToGo - 1 ) - _moveOverhead * ( 2 + movesToGo ), 1ll );
+
+		_maximumTime = std::max( std::min( (long long)( timeLeft / movesToGo * maximumRatio ), (long long)( ( time - _moveOverhead ) * maximumTimeFraction ) ), 1ll );
+		_optimumTime = std::min( std::max( timeLeft / movesToGo, 1ll ), _maximumTime );
+	}
+
+	/*! \brief update the time scale with the result of an iteration
+	*
+	*	the search get more time when the best move changes and when the score drops,
+	*	and less time when most of the nodes have been spent to search the best move
+	*/
+	void TimeManagement::newIteration( const Score score, const unsigned int bestMoveChanges, const double bestMoveNodesFraction )
+	{
+		// the old changes count less
+		_bestMoveInstability = _bestMoveInstability / 2 + bestMoveChanges;
+		const double instabilityFactor = 1.0 + 1.5 * _bestMoveInstability;
+
+		const double fallingEval = _hasPreviousScore ? std::clamp( 1.0 + ( _previousScore - score ) / 200.0, 0.5, 1.5 ) : 1.0;
+
+		const double nodesFactor = std::clamp( 1.5 - bestMoveNodesFraction, 0.5, 1.5 );
+
+		_timeScale = instabilityFactor * fallingEval * nodesFactor;
+		_previousScore = score;
+		_hasPreviousScore = true;
+	}
+
+	/*! \brief tell whether a new iteration should be started
+	*
+	*/
+	bool TimeManagement::stopAfterIteration( const long long elapsed ) const
+	{
+		return !_pondering && _timeManaged && !_fixedTime && elapsed >= getScaledOptimumTime();
+	}
+
+	/*! \brief tell whether the search shall be stopped immediately
+	*
+	*/
+	bool TimeManagement::isSearchFinished( const long long elapsed, const unsigned long long nodes ) const
+	{
+		return !_pondering && ( ( _timeManaged && elapsed >= _maximumTime ) || ( _nodesLimit && nodes >= _nodesLimit ) );
+	}
+
+	/*! \brief the opponent played the expected move, from now on the limits are applied
+	*
+	*	the clock restarts, the time spent pondering is a gift of the opponent
+	*/
+	void TimeManagement::ponderHit()
+	{
+		_ponderTime = std::chrono::duration_cast< std::chrono::milliseconds >( std::chrono::steady_clock::now() - _startTime ).count();
+		_pondering = false;
+	}
+}
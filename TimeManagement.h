@@ -0,0 +1,170 @@
+/*
+	This file is part of Vajolet.
+	Copyright (C) 2013-2018 Marco Belli
+
+    Vajolet is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Vajolet is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#ifndef TIMEMANAGEMENT_H_
+#define TIMEMANAGEMENT_H_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include "eTurn.h"
+#include "Score.h"
+
+namespace libChess
+{
+	/*!	\brief limits of a search, as received by the uci go command
+
+		times are in milliseconds, a zero value means that the limit is not set
+	 */
+	struct SearchLimits
+	{
+		long long wtime = 0;
+		long long btime = 0;
+		long long winc = 0;
+		long long binc = 0;
+		unsigned int movesToGo = 0;
+		long long moveTime = 0;
+		unsigned int depth = 0;
+		unsigned long long nodes = 0;
+		bool infinite = false;
+		bool ponder = false;	// search the position after the expected reply, the limits are applied after ponderHit
+	};
+
+	/*!	\brief calculate the time budget of a search and decide when to stop it
+
+		the optimum time is the time the search should spend in a normal move, it's scaled after every iteration
+		using the stability of the best move, the score drop and the fraction of nodes spent on the best root move.
+		The maximum time is a hard limit checked while searching, every pollingInterval nodes.
+		While pondering no limit is applied, the time spent pondering isn't counted after the ponder hit
+	 */
+	class TimeManagement
+	{
+	public:
+		/*****************************************************************
+		*	constructors
+		******************************************************************/
+		TimeManagement();
+
+		/*****************************************************************
+		*	methods
+		******************************************************************/
+		void init( const SearchLimits& limits, const baseTypes::eTurn us );
+		void newIteration( const Score score, const unsigned int bestMoveChanges, const double bestMoveNodesFraction );
+		bool stopAfterIteration( const long long elapsed ) const;
+		bool isSearchFinished( const long long elapsed, const unsigned long long nodes ) const;
+		void ponderHit();
+		bool isPondering() const;
+
+		long long getElapsedTime() const;
+		long long getOptimumTime() const;
+		long long getMaximumTime() const;
+		long long getScaledOptimumTime() const;
+		bool isTimeManaged() const;
+
+		void setMoveOverhead( const long long overhead );
+		long long getMoveOverhead() const;
+
+		/*****************************************************************
+		*	static methods
+		******************************************************************/
+		static bool isPollingNode( const unsigned long long nodes );
+
+		/*****************************************************************
+		*	static members
+		******************************************************************/
+		static constexpr unsigned long long pollingInterval = 1024;	// the clock is read every pollingInterval nodes, it shall be a power of 2
+		static constexpr unsigned int defaultMovesToGo = 50;		// moves the remaining time is split in when movestogo is not set
+		static constexpr double maximumRatio = 5.0;				// maximum time compared to the optimum time
+		static constexpr double maximumTimeFraction = 0.8;		// fraction of the remaining time that can be used in a single move
+		static constexpr long long defaultMoveOverhead = 30;
+
+	private:
+		/*****************************************************************
+		*	members
+		******************************************************************/
+		std::chrono::steady_clock::time_point _startTime;
+		long long _optimumTime;
+		long long _maximumTime;
+		double _timeScale;
+		unsigned long long _nodesLimit;
+		bool _timeManaged;
+		bool _fixedTime;
+		long long _moveOverhead;
+		// written by the thread receiving the ponder hit while the search is running
+		std::atomic< bool > _pondering;
+		std::atomic< long long > _ponderTime;
+
+		// state of the previous iterations
+		bool _hasPreviousScore;
+		Score _previousScore;
+		double _bestMoveInstability;
+	};
+
+	inline long long TimeManagement::getOptimumTime() const
+	{
+		return _optimumTime;
+	}
+
+	inline long long TimeManagement::getMaximumTime() const
+	{
+		return _maximumTime;
+	}
+
+	inline long long TimeManagement::getScaledOptimumTime() const
+	{
+		return std::min( (long long)( _optimumTime * _timeScale ), _maximumTime );
+	}
+
+	inline bool TimeManagement::isTimeManaged() const
+	{
+		return _timeManaged;
+	}
+
+	inline void TimeManagement::setMoveOverhead( const long long overhead )
+	{
+		_moveOverhead = overhead;
+	}
+
+	inline long long TimeManagement::getMoveOverhead() const
+	{
+		return _moveOverhead;
+	}
+
+	inline bool TimeManagement::isPondering() const
+	{
+		return _pondering;
+	}
+
+	/*! \brief time elapsed since the start of the search, or since the ponder hit
+	*
+	*/
+	inline long long TimeManagement::getElapsedTime() const
+	{
+		return std::chrono::duration_cast< std::chrono::milliseconds >( std::chrono::steady_clock::now() - _startTime ).count() - _ponderTime;
+	}
+
+	/*! \brief tell whether the search shall check the clock and the node limit at this node
+	*
+	*/
+	inline bool TimeManagement::isPollingNode( const unsigned long long nodes )
+	{
+		return ( nodes & ( pollingInterval - 1 ) ) == 0;
+	}
+}
+
+#endif /* TIMEMANAGEMENT_H_ */
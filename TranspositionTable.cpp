@@ -0,0 +1,161 @@
+/*
+	This file is part of Vajolet.
+	Copyright (C) 2013-2018 Marco Belli
+
+    Vajolet is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Vajolet is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#include <algorithm>
+#include <cassert>
+#include "TranspositionTable.h"
+
+namespace libChess
+{
+	static_assert( sizeof( ttEntry ) == 16, "ttEntry shall be 16 bytes long" );
+
+	void ttEntry::save( const uint32_t key, const Score value, const eBound bound, const int depth, const Move& move, const Score staticValue, const uint8_t generation )
+	{
+		// keep the old move if the new one is missing
+		if( move != Move::NOMOVE || key != _key )
+		{
+			_packedMove = move.getPacked();
+		}
+		_key = key;
+		_value = (int16_t)value;
+		_staticValue = (int16_t)staticValue;
+		_bound = bound;
+		_depth = (int16_t)depth;
+		_generation = generation;
+	}
+
+	void ttEntry::clear()
+	{
+		_key = 0;
+		_packedMove = 0;
+		_depth = 0;
+		_value = 0;
+		_staticValue = 0;
+		_bound = typeVoid;
+		_generation = 0;
+	}
+
+	TranspositionTable::TranspositionTable( const unsigned int mbSize ):_clusterCount( 0 ), _generation( 0 )
+	{
+		setSize( mbSize );
+	}
+
+	/*! \brief resize the table to the biggest power of 2 of clusters fitting in mbSize megabytes
+	*
+	*/
+	void TranspositionTable::setSize( const unsigned int mbSize )
+	{
+		uint64_t clusterCount = ( (uint64_t)mbSize << 20 ) / sizeof( ttCluster );
+		uint64_t size = 1;
+		while( size * 2 <= clusterCount )
+		{
+			size *= 2;
+		}
+		if( size != _clusterCount )
+		{
+			_clusterCount = size;
+			_table.reset( new ttCluster[ _clusterCount ] );
+		}
+		clear();
+	}
+
+	void TranspositionTable::clear()
+	{
+		for( uint64_t i = 0; i < _clusterCount; ++i )
+		{
+			for( auto& e : _table[ i ].data )
+			{
+				e.clear();
+			}
+		}
+		_generation = 0;
+	}
+
+	/*! \brief to be called at the start of every search, entries of old searches are replaced first
+	*
+	*/
+	void TranspositionTable::newSearch()
+	{
+		++_generation;
+	}
+
+	/*! \brief return the entry of the position, or nullptr if the position is not in the table
+	*
+	*/
+	ttEntry* TranspositionTable::probe( const HashKey& key ) const
+	{
+		const uint32_t key32 = key.getKey() >> 32;
+		for( auto& e : _findCluster( key ).data )
+		{
+			if( e.getKey() == key32 && e.getBound() != ttEntry::typeVoid )
+			{
+				e.refresh( _generation );
+				return &e;
+			}
+		}
+		return nullptr;
+	}
+
+	/*! \brief save a search result
+	*
+	*	the entry of the same position is overwritten, otherwise the entry replaced is the one
+	*	with the lowest depth, preferring entries of older searches
+	*/
+	void TranspositionTable::store( const HashKey& key, const Score value, const ttEntry::eBound bound, const int depth, const Move& move, const Score staticValue )
+	{
+		const uint32_t key32 = key.getKey() >> 32;
+		ttCluster& cluster = _findCluster( key );
+
+		ttEntry* replace = &cluster.data[ 0 ];
+		for( auto& e : cluster.data )
+		{
+			if( e.getKey() == key32 || e.getBound() == ttEntry::typeVoid )
+			{
+				replace = &e;
+				break;
+			}
+			const int replaceValue = replace->getDepth() - 8 * ( replace->getGeneration() != _generation );
+			const int value = e.getDepth() - 8 * ( e.getGeneration() != _generation );
+			if( value < replaceValue )
+			{
+				replace = &e;
+			}
+		}
+		replace->save( key32, value, bound, depth, move, staticValue, _generation );
+	}
+
+	/*! \brief return the permille of entries used in the current search, sampling the first 1000 clusters
+	*
+	*/
+	unsigned int TranspositionTable::getFullness() const
+	{
+		unsigned int count = 0;
+		const uint64_t samples = std::min< uint64_t >( 1000, _clusterCount );
+		for( uint64_t i = 0; i < samples; ++i )
+		{
+			for( const auto& e : _table[ i ].data )
+			{
+				if( e.getBound() != ttEntry::typeVoid && e.getGeneration() == _generation )
+				{
+					++count;
+				}
+			}
+		}
+		return count * 1000 / ( samples * clusterSize );
+	}
+}
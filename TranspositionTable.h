@@ -0,0 +1,155 @@
+/*
+	This file is part of Vajolet.
+	Copyright (C) 2013-2018 Marco Belli
+
+    Vajolet is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Vajolet is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#ifndef TRANSPOSITIONTABLE_H_
+#define TRANSPOSITIONTABLE_H_
+
+#include <cstdint>
+#include <memory>
+#include "HashKeys.h"
+#include "Move.h"
+#include "Score.h"
+
+namespace libChess
+{
+	/*!	\brief entry of the transposition table
+
+		the entry is 16 bytes long, the upper 32 bits of the key are stored to verify the hit
+	 */
+	class ttEntry
+	{
+	public:
+		/*****************************************************************
+		*	enums
+		******************************************************************/
+		enum eBound : uint8_t
+		{
+			typeVoid,
+			typeExact,
+			typeLowerBound,	/*!< the score is >= of the stored score ( fail high ) */
+			typeUpperBound	/*!< the score is <= of the stored score ( fail low ) */
+		};
+
+		/*****************************************************************
+		*	methods
+		******************************************************************/
+		void save( const uint32_t key, const Score value, const eBound bound, const int depth, const Move& move, const Score staticValue, const uint8_t generation );
+		void refresh( const uint8_t generation );
+		void clear();
+
+		uint32_t getKey() const;
+		Move getMove() const;
+		Score getScore() const;
+		Score getStaticValue() const;
+		int getDepth() const;
+		eBound getBound() const;
+		uint8_t getGeneration() const;
+		bool isLowerBound() const;
+		bool isUpperBound() const;
+
+	private:
+		/*****************************************************************
+		*	members
+		******************************************************************/
+		uint32_t _key;
+		uint16_t _packedMove;
+		int16_t _depth;
+		int16_t _value;
+		int16_t _staticValue;
+		eBound _bound;
+		uint8_t _generation;
+	};
+
+	/*!	\brief shared hash table of the searched positions
+
+		the table is made of clusters of 4 entries fitting a cache line. The table is shared between the search
+		threads without locks, so a probed entry shall always be validated by the caller ( i.e. the move legality )
+	 */
+	class TranspositionTable
+	{
+	public:
+		/*****************************************************************
+		*	constructors
+		******************************************************************/
+		explicit TranspositionTable( const unsigned int mbSize = 16 );
+
+		/*****************************************************************
+		*	methods
+		******************************************************************/
+		void setSize( const unsigned int mbSize );
+		void clear();
+		void newSearch();
+		ttEntry* probe( const HashKey& key ) const;
+		void store( const HashKey& key, const Score value, const ttEntry::eBound bound, const int depth, const Move& move, const Score staticValue );
+		unsigned int getFullness() const;
+		uint64_t getClusterCount() const;
+
+		/*****************************************************************
+		*	static members
+		******************************************************************/
+		static constexpr unsigned int clusterSize = 4;
+
+	private:
+		/*****************************************************************
+		*	members
+		******************************************************************/
+		struct alignas( 64 ) ttCluster
+		{
+			ttEntry data[ clusterSize ];
+		};
+
+		std::unique_ptr< ttCluster[] > _table;
+		uint64_t _clusterCount;
+		uint8_t _generation;
+
+		/*****************************************************************
+		*	methods
+		******************************************************************/
+		ttCluster& _findCluster( const HashKey& key ) const;
+	};
+
+	inline uint32_t ttEntry::getKey() const { return _key; }
+	inline Move ttEntry::getMove() const { return Move( _packedMove ); }
+	inline Score ttEntry::getScore() const { return _value; }
+	inline Score ttEntry::getStaticValue() const { return _staticValue; }
+	inline int ttEntry::getDepth() const { return _depth; }
+	inline ttEntry::eBound ttEntry::getBound() const { return _bound; }
+	inline uint8_t ttEntry::getGeneration() const { return _generation; }
+	inline bool ttEntry::isLowerBound() const { return _bound == typeExact || _bound == typeLowerBound; }
+	inline bool ttEntry::isUpperBound() const { return _bound == typeExact || _bound == typeUpperBound; }
+
+	inline void ttEntry::refresh( const uint8_t generation )
+	{
+		_generation = generation;
+	}
+
+	inline uint64_t TranspositionTable::getClusterCount() const
+	{
+		return _clusterCount;
+	}
+
+	/*! \brief the cluster is selected by the lower bits of the key, the entry is verified with the upper 32 bits
+	*
+	*/
+	inline TranspositionTable::ttCluster& TranspositionTable::_findCluster( const HashKey& key ) const
+	{
+		return _table[ key.getKey() & ( _clusterCount - 1 ) ];
+	}
+}
+
+#endif /* TRANSPOSITIONTABLE_H_ */
@@ -21,6 +21,8 @@
 #include "BitMap.h"
 #include "HashKeys.h"
 #include "BitMapMoveGenerator.h"
+#include "Cuckoo.h"
+#include "KPKBitbase.h"
 
 #include <chrono>
 #include "MoveSelector.h"
@@ -41,6 +43,8 @@ static void init(void)
 	libChess::baseTypes::BitMap::init();
 	libChess::HashKey::init();
 	libChess::BitMapMoveGenerator::init();
+	libChess::Cuckoo::init();
+	libChess::KPKBitbase::init();
 }
 
 
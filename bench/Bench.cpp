@@ -0,0 +1,79 @@
+/*
+	This file is part of Vajolet.
+	Copyright (C) 2013-2018 Marco Belli
+	
+    Vajolet is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Vajolet is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+#include "Bench.h"
+#include "./../BitMap.h"
+#include "./../BitMapMoveGenerator.h"
+#include "./../Cuckoo.h"
+#include "./../HashKeys.h"
+#include "./../KPKBitbase.h"
+#include "./../tSquare.h"
+
+namespace bench
+{
+	std::vector< std::string > loadPerftFens( const std::string& fileName )
+	{
+		std::vector< std::string > fens;
+		std::ifstream infile( fileName );
+		std::string line;
+		while( std::getline( infile, line ) )
+		{
+			fens.push_back( line.substr( 0, line.find_first_of( "," ) ) );
+		}
+		return fens;
+	}
+
+	void report( const std::string& name, const std::chrono::nanoseconds& time, const unsigned long long iterations, const unsigned long long checksum )
+	{
+		std::cout << std::left << std::setw( 40 ) << name
+			<< std::right << std::setw( 12 ) << std::fixed << std::setprecision( 1 ) << (double)time.count() / iterations << " ns/iter"
+			<< "  (" << iterations << " iterations, checksum " << checksum << ")" << std::endl;
+	}
+}
+
+int main( int argc, char** argv )
+{
+	libChess::baseTypes::inittSquare();
+	libChess::baseTypes::BitMap::init();
+	libChess::HashKey::init();
+	libChess::BitMapMoveGenerator::init();
+	libChess::Cuckoo::init();
+	libChess::KPKBitbase::init();
+
+	const std::string fileName = argc > 1 ? argv[ 1 ] : "perft.txt";
+	const auto fens = bench::loadPerftFens( fileName );
+	if( fens.empty() )
+	{
+		std::cerr << "unable to read positions from " << fileName << std::endl;
+		return 1;
+	}
+	std::cout << fens.size() << " positions loaded from " << fileName << std::endl;
+
+	bench::moveOrderingBench( fens );
+	bench::moveListLayoutBench( fens );
+	bench::nnueBench( fens );
+	bench::nullMoveBench( fens );
+	bench::repetitionBench( fens );
+	bench::searchBench( fens );
+
+	return 0;
+}
@@ -0,0 +1,49 @@
+/*
+	This file is part of Vajolet.
+	Copyright (C) 2013-2018 Marco Belli
+	
+    Vajolet is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Vajolet is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#ifndef BENCH_H_
+#define BENCH_H_
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace bench
+{
+	/*! \brief load the fens of the perft file used by the unit tests
+	*
+	*/
+	std::vector< std::string > loadPerftFens( const std::string& fileName );
+
+	/*! \brief print a line of the benchmark report
+	*
+	*/
+	void report( const std::string& name, const std::chrono::nanoseconds& time, const unsigned long long iterations, const unsigned long long checksum );
+
+	/*****************************************************************
+	*	benchmarks
+	******************************************************************/
+	void moveOrderingBench( const std::vector< std::string >& fens );
+	void moveListLayoutBench( const std::vector< std::string >& fens );
+	void nnueBench( const std::vector< std::string >& fens );
+	void nullMoveBench( const std::vector< std::string >& fens );
+	void repetitionBench( const std::vector< std::string >& fens );
+	void searchBench( const std::vector< std::string >& fens );
+}
+
+#endif /* BENCH_H_ */
@@ -0,0 +1,241 @@
+/*
+	This file is part of Vajolet.
+	Copyright (C) 2013-2018 Marco Belli
+	
+    Vajolet is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Vajolet is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#include <iostream>
+#include <memory>
+
+#include "Bench.h"
+#include "./../History.h"
+#include "./../MoveGenerator.h"
+#include "./../MoveList.h"
+#include "./../MoveSelector.h"
+#include "./../Position.h"
+#include "./../SoAMoveList.h"
+
+using namespace libChess;
+
+namespace
+{
+	using AoSList = MoveList< MoveSelector::maxMovePerPosition >;
+	using SoAList = SoAMoveList< MoveSelector::maxMovePerPosition >;
+
+	const unsigned int maxPositions = 20000;
+	const unsigned int repetitions = 20;
+
+	struct benchPosition
+	{
+		Position pos;
+		std::vector< Move > captures;
+		std::vector< Move > quiets;
+	};
+
+	/*! \brief collect the children of the perft positions with their capture and quiet moves
+	*
+	*	while walking the positions the history is trained with pseudo random cutoffs, as in the move ordering benchmark
+	*/
+	void collectPositions( const std::vector< std::string >& fens, SearchHistory& h, std::vector< benchPosition >& positions )
+	{
+		Position pos;
+		unsigned int seed = 1;
+		for( const auto& fen : fens )
+		{
+			pos.setupFromFen( fen );
+			MoveSelector ms( pos );
+			Move m;
+			while( ( m = ms.getNextMove() ) != Move::NOMOVE && positions.size() < maxPositions )
+			{
+				pos.doMove( m );
+				if( !pos.isInCheck() )
+				{
+					AoSList ml;
+					benchPosition bp{ pos, {}, {} };
+					MoveGenerator::generateMoves< MoveGenerator::captureMg >( pos, ml );
+					bp.captures.assign( ml.begin(), ml.end() );
+					ml.reset();
+					MoveGenerator::generateMoves< MoveGenerator::quietMg >( pos, ml );
+					bp.quiets.assign( ml.begin(), ml.end() );
+					if( !bp.quiets.empty() )
+					{
+						seed = seed * 1103515245 + 12345;
+						const unsigned int best = ( seed >> 16 ) % bp.quiets.size();
+						h.updateQuietStats( pos, 1, bp.quiets[ best ], bp.quiets.data(), best + 1, 1 + ( seed >> 8 ) % 8 );
+					}
+					positions.push_back( std::move( bp ) );
+				}
+				pos.undoMove();
+			}
+		}
+	}
+
+	template< typename List >
+	inline void fillList( List& ml, const std::vector< Move >& moves )
+	{
+		ml.reset();
+		for( const auto& m : moves )
+		{
+			ml.insert( m );
+		}
+	}
+
+	template< typename List >
+	inline unsigned long long iterate( List& ml, const bool sorted )
+	{
+		unsigned long long checksum = 0;
+		unsigned int i = 0;
+		Move m;
+		while( ( m = sorted ? ml.getNextMove() : ml.findNextBestMove() ) != Move::NOMOVE )
+		{
+			checksum += m.getPacked() * ++i;
+		}
+		return checksum;
+	}
+
+	template< typename List, typename Function >
+	void run( const std::string& name, const std::vector< benchPosition >& positions, Function f )
+	{
+		std::unique_ptr< List > ml( new List );
+		unsigned long long checksum = 0;
+		unsigned long long iterations = 0;
+		const auto start = std::chrono::steady_clock::now();
+		for( unsigned int r = 0; r < repetitions; ++r )
+		{
+			for( const auto& bp : positions )
+			{
+				checksum += f( *ml, bp );
+				++iterations;
+			}
+		}
+		const auto time = std::chrono::steady_clock::now() - start;
+		bench::report( name, std::chrono::duration_cast< std::chrono::nanoseconds >( time ), iterations, checksum );
+	}
+}
+
+namespace bench
+{
+	/*! \brief compare the array of structures MoveList with the structure of arrays SoAMoveList
+	*
+	*	every test fill the list, score the moves ( MVV-LVA for captures, history for quiet moves ) and return all of them in order
+	*/
+	void moveListLayoutBench( const std::vector< std::string >& fens )
+	{
+		std::unique_ptr< SearchHistory > h( new SearchHistory );
+		std::vector< benchPosition > positions;
+		collectPositions( fens, *h, positions );
+
+		std::cout << std::endl << "move list layout: " << positions.size() << " positions";
+#if defined(__AVX2__)
+		std::cout << ", AVX2 SoA kernels" << std::endl;
+#else
+		std::cout << ", scalar SoA kernels" << std::endl;
+#endif
+
+		const SearchHistory& history = *h;
+
+		run< AoSList >( "AoS captures score", positions, []( AoSList& ml, const benchPosition& bp )
+		{
+			fillList( ml, bp.captures );
+			unsigned long long checksum = 0;
+			for( auto& m : ml )
+			{
+				m.setScore( bp.pos.getMvvLvaScore( m ) );
+				checksum += m.getScore();
+			}
+			return checksum;
+		});
+		run< SoAList >( "SoA captures score", positions, []( SoAList& ml, const benchPosition& bp )
+		{
+			fillList( ml, bp.captures );
+			ml.scoreCaptures( bp.pos );
+			unsigned long long checksum = 0;
+			for( unsigned int i = 0; i < ml.size(); ++i )
+			{
+				checksum += ml.getScore( i );
+			}
+			return checksum;
+		});
+		run< AoSList >( "AoS captures score + selection", positions, []( AoSList& ml, const benchPosition& bp )
+		{
+			fillList( ml, bp.captures );
+			for( auto& m : ml )
+			{
+				m.setScore( bp.pos.getMvvLvaScore( m ) );
+			}
+			return iterate( ml, false );
+		});
+		run< SoAList >( "SoA captures score + selection", positions, []( SoAList& ml, const benchPosition& bp )
+		{
+			fillList( ml, bp.captures );
+			ml.scoreCaptures( bp.pos );
+			return iterate( ml, false );
+		});
+		run< AoSList >( "AoS quiet score", positions, [&history]( AoSList& ml, const benchPosition& bp )
+		{
+			fillList( ml, bp.quiets );
+			unsigned long long checksum = 0;
+			for( auto& m : ml )
+			{
+				m.setScore( history.getQuietScore( bp.pos, m ) );
+				checksum += m.getScore();
+			}
+			return checksum;
+		});
+		run< SoAList >( "SoA quiet score", positions, [&history]( SoAList& ml, const benchPosition& bp )
+		{
+			fillList( ml, bp.quiets );
+			ml.scoreQuietMoves( bp.pos, history );
+			unsigned long long checksum = 0;
+			for( unsigned int i = 0; i < ml.size(); ++i )
+			{
+				checksum += ml.getScore( i );
+			}
+			return checksum;
+		});
+		run< AoSList >( "AoS quiet score + selection", positions, [&history]( AoSList& ml, const benchPosition& bp )
+		{
+			fillList( ml, bp.quiets );
+			for( auto& m : ml )
+			{
+				m.setScore( history.getQuietScore( bp.pos, m ) );
+			}
+			return iterate( ml, false );
+		});
+		run< SoAList >( "SoA quiet score + selection", positions, [&history]( SoAList& ml, const benchPosition& bp )
+		{
+			fillList( ml, bp.quiets );
+			ml.scoreQuietMoves( bp.pos, history );
+			return iterate( ml, false );
+		});
+		run< AoSList >( "AoS quiet score + partial sort", positions, [&history]( AoSList& ml, const benchPosition& bp )
+		{
+			fillList( ml, bp.quiets );
+			for( auto& m : ml )
+			{
+				m.setScore( history.getQuietScore( bp.pos, m ) );
+			}
+			ml.sortAbove( MoveSelector::quietSortLimit );
+			return iterate( ml, true );
+		});
+		run< SoAList >( "SoA quiet score + partial sort", positions, [&history]( SoAList& ml, const benchPosition& bp )
+		{
+			fillList( ml, bp.quiets );
+			ml.scoreQuietMoves( bp.pos, history );
+			ml.sortAbove( MoveSelector::quietSortLimit );
+			return iterate( ml, true );
+		});
+	}
+}
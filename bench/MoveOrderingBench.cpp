@@ -0,0 +1,192 @@
+/*
+	This file is part of Vajolet.
+	Copyright (C) 2013-2018 Marco Belli
+	
+    Vajolet is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Vajolet is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#include <iostream>
+#include <memory>
+#include <utility>
+
+#include "Bench.h"
+#include "./../History.h"
+#include "./../MoveGenerator.h"
+#include "./../MoveList.h"
+#include "./../MoveSelector.h"
+#include "./../Position.h"
+
+using namespace libChess;
+
+namespace
+{
+	using scoredMoveList = std::vector< std::pair< Move, Score > >;
+	using benchMoveList = MoveList< MoveSelector::maxMovePerPosition >;
+
+	const unsigned int repetitions = 20;
+
+	/*! \brief fill the history tables simulating the cutoffs of a shallow search
+	*
+	*	the quiet moves of every child of the root are searched in generation order and a pseudo random one
+	*	cause the cutoff, so the tables end up with the mix of positive and negative scores found in a real search
+	*/
+	void trainHistory( SearchHistory& h, Position& pos, unsigned int& seed )
+	{
+		MoveSelector ms( pos, h, 0 );
+		Move m;
+		while( ( m = ms.getNextMove() ) != Move::NOMOVE )
+		{
+			pos.doMove( m );
+			if( !pos.isInCheck() )
+			{
+				benchMoveList ml;
+				MoveGenerator::generateMoves< MoveGenerator::quietMg >( pos, ml );
+				if( ml.size() > 0 )
+				{
+					std::vector< Move > quiets( ml.begin(), ml.end() );
+					seed = seed * 1103515245 + 12345;
+					const unsigned int best = ( seed >> 16 ) % quiets.size();
+					h.updateQuietStats( pos, 1, quiets[ best ], quiets.data(), best + 1, 1 + ( seed >> 8 ) % 8 );
+				}
+			}
+			pos.undoMove();
+		}
+	}
+
+	void collectQuietLists( const SearchHistory& h, Position& pos, std::vector< scoredMoveList >& lists )
+	{
+		MoveSelector ms( pos );
+		Move m;
+		while( ( m = ms.getNextMove() ) != Move::NOMOVE )
+		{
+			pos.doMove( m );
+			if( !pos.isInCheck() )
+			{
+				benchMoveList ml;
+				MoveGenerator::generateMoves< MoveGenerator::quietMg >( pos, ml );
+				scoredMoveList l;
+				for( const auto& qm : ml )
+				{
+					l.emplace_back( qm, h.getQuietScore( pos, qm ) );
+				}
+				lists.push_back( std::move( l ) );
+			}
+			pos.undoMove();
+		}
+	}
+
+	inline void fillList( benchMoveList& ml, const scoredMoveList& l )
+	{
+		ml.reset();
+		for( const auto& m : l )
+		{
+			ml.insert( m.first );
+		}
+		auto it = ml.begin();
+		for( const auto& m : l )
+		{
+			( it++ )->setScore( m.second );
+		}
+	}
+
+	template< typename Function >
+	void run( const std::string& name, const std::vector< scoredMoveList >& lists, Function f )
+	{
+		std::unique_ptr< benchMoveList > ml( new benchMoveList );
+		unsigned long long checksum = 0;
+		unsigned long long iterations = 0;
+		const auto start = std::chrono::steady_clock::now();
+		for( unsigned int r = 0; r < repetitions; ++r )
+		{
+			for( const auto& l : lists )
+			{
+				fillList( *ml, l );
+				checksum += f( *ml );
+				++iterations;
+			}
+		}
+		const auto time = std::chrono::steady_clock::now() - start;
+		bench::report( name, std::chrono::duration_cast< std::chrono::nanoseconds >( time ), iterations, checksum );
+	}
+
+	unsigned long long selection( benchMoveList& ml, const unsigned int count )
+	{
+		unsigned long long checksum = 0;
+		Move m;
+		for( unsigned int i = 0; i < count && ( m = ml.findNextBestMove() ) != Move::NOMOVE; ++i )
+		{
+			checksum += m.getPacked() * ( i + 1 );
+		}
+		return checksum;
+	}
+
+	unsigned long long insertionSort( benchMoveList& ml, const unsigned int count, const Score limit )
+	{
+		unsigned long long checksum = 0;
+		ml.sortAbove( limit );
+		Move m;
+		for( unsigned int i = 0; i < count && ( m = ml.getNextMove() ) != Move::NOMOVE; ++i )
+		{
+			checksum += m.getPacked() * ( i + 1 );
+		}
+		return checksum;
+	}
+}
+
+namespace bench
+{
+	/*! \brief compare the selection of the best move with the partial insertion sort on quiet move lists
+	*
+	*	the lists are the quiet moves of the children of the perft positions, scored with a trained SearchHistory
+	*/
+	void moveOrderingBench( const std::vector< std::string >& fens )
+	{
+		std::unique_ptr< SearchHistory > h( new SearchHistory );
+		Position pos;
+		unsigned int seed = 1;
+		for( const auto& fen : fens )
+		{
+			pos.setupFromFen( fen );
+			trainHistory( *h, pos, seed );
+		}
+
+		std::vector< scoredMoveList > lists;
+		unsigned long long moves = 0;
+		for( const auto& fen : fens )
+		{
+			pos.setupFromFen( fen );
+			collectQuietLists( *h, pos, lists );
+		}
+		for( const auto& l : lists )
+		{
+			moves += l.size();
+		}
+
+		std::cout << std::endl << "move ordering: " << lists.size() << " quiet move lists, " << (double)moves / lists.size() << " moves per list";
+#if defined(__SSE4_1__)
+		std::cout << ", SSE4.1 max search" << std::endl;
+#else
+		std::cout << ", scalar max search" << std::endl;
+#endif
+
+		const unsigned int all = MoveSelector::maxMovePerPosition;
+		run( "fill list only", lists, []( benchMoveList& ml ){ return (unsigned long long)ml.size(); } );
+		run( "selection, all moves", lists, [all]( benchMoveList& ml ){ return selection( ml, all ); } );
+		run( "selection, first 4 moves", lists, []( benchMoveList& ml ){ return selection( ml, 4 ); } );
+		run( "insertion sort, all moves", lists, [all]( benchMoveList& ml ){ return insertionSort( ml, all, std::numeric_limits< Score >::min() ); } );
+		run( "insertion sort, first 4 moves", lists, []( benchMoveList& ml ){ return insertionSort( ml, 4, std::numeric_limits< Score >::min() ); } );
+		run( "partial insertion sort, all moves", lists, [all]( benchMoveList& ml ){ return insertionSort( ml, all, MoveSelector::quietSortLimit ); } );
+		run( "partial insertion sort, first 4 moves", lists, []( benchMoveList& ml ){ return insertionSort( ml, 4, MoveSelector::quietSortLimit ); } );
+	}
+}
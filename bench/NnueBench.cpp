@@ -0,0 +1,166 @@
+/*
+	This file is part of Vajolet.
+	Copyright (C) 2013-2018 Marco Belli
+
+    Vajolet is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Vajolet is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#include <iostream>
+#include <random>
+#include <sstream>
+
+#include "Bench.h"
+#include "./../Eval.h"
+#include "./../MoveGenerator.h"
+#include "./../MoveList.h"
+#include "./../MoveSelector.h"
+#include "./../Nnue.h"
+#include "./../Position.h"
+
+using namespace libChess;
+
+namespace
+{
+	const unsigned int maxPositions = 2000;
+	const unsigned int repetitions = 20;
+
+	struct benchPosition
+	{
+		Position pos;
+		std::vector< Move > moves;
+	};
+
+	/*! \brief write a network of random weights in the nnue file format
+	*
+	*/
+	bool loadRandomNetwork()
+	{
+		std::mt19937 rnd( 19091979 );
+		std::ostringstream s;
+		auto write = [&s, &rnd]( const size_t size, const size_t valueSize, const int min, const int max )
+		{
+			std::uniform_int_distribution< int > d( min, max );
+			for( size_t i = 0; i < size; ++i )
+			{
+				const int32_t v = d( rnd );
+				s.write( reinterpret_cast< const char* >( &v ), valueSize );
+			}
+		};
+		s.write( reinterpret_cast< const char* >( &Nnue::fileMagic ), sizeof( Nnue::fileMagic ) );
+		s.write( reinterpret_cast< const char* >( &Nnue::fileVersion ), sizeof( Nnue::fileVersion ) );
+		write( Nnue::halfDimensions, sizeof( int16_t ), 0, 40 );
+		write( Nnue::featuresNumber * Nnue::halfDimensions, sizeof( int16_t ), -20, 20 );
+		write( Nnue::hiddenDimensions, sizeof( int32_t ), -500, 500 );
+		write( Nnue::hiddenDimensions * 2 * Nnue::halfDimensions, sizeof( int8_t ), -128, 127 );
+		write( Nnue::hiddenDimensions, sizeof( int32_t ), -500, 500 );
+		write( Nnue::hiddenDimensions * Nnue::hiddenDimensions, sizeof( int8_t ), -128, 127 );
+		write( 1, sizeof( int32_t ), -1000, 1000 );
+		write( Nnue::hiddenDimensions, sizeof( int8_t ), -128, 127 );
+
+		std::istringstream in( s.str() );
+		return Nnue::load( in );
+	}
+
+	void collectPositions( const std::vector< std::string >& fens, std::vector< benchPosition >& positions )
+	{
+		for( const auto& fen : fens )
+		{
+			if( positions.size() >= maxPositions )
+			{
+				break;
+			}
+			benchPosition bp;
+			bp.pos.setupFromFen( fen );
+			MoveList< MoveSelector::maxMovePerPosition > ml;
+			MoveGenerator::generateMoves< MoveGenerator::allMg >( bp.pos, ml );
+			bp.moves.assign( ml.begin(), ml.end() );
+			positions.push_back( bp );
+		}
+	}
+
+	template< typename Function >
+	void run( const std::string& name, std::vector< benchPosition >& positions, Function f )
+	{
+		unsigned long long checksum = 0;
+		unsigned long long iterations = 0;
+		const auto start = std::chrono::steady_clock::now();
+		for( unsigned int r = 0; r < repetitions; ++r )
+		{
+			for( auto& bp : positions )
+			{
+				for( const auto& m : bp.moves )
+				{
+					bp.pos.doMove( m );
+					checksum += f( bp.pos );
+					bp.pos.undoMove();
+					++iterations;
+				}
+			}
+		}
+		const auto time = std::chrono::steady_clock::now() - start;
+		bench::report( name, std::chrono::duration_cast< std::chrono::nanoseconds >( time ), iterations, checksum );
+	}
+}
+
+namespace bench
+{
+	/*! \brief cost of a move with its evaluation: classical, nnue with the incremental accumulator and nnue refreshing it
+	*
+	*	the network has random weights, only the speed is measured. The accumulators are computed only when requested,
+	*	so the moves not evaluated don't pay for them
+	*/
+	void nnueBench( const std::vector< std::string >& fens )
+	{
+		std::vector< benchPosition > positions;
+		collectPositions( fens, positions );
+
+		std::cout << std::endl << "nnue: " << positions.size() << " positions, every legal move played and evaluated" << std::endl;
+
+		run( "do move + classical eval", positions, []( Position& pos )
+		{
+			return Eval::evaluate( pos );
+		});
+
+		if( !loadRandomNetwork() )
+		{
+			std::cout << "unable to load the network" << std::endl;
+			return;
+		}
+		for( auto& bp : positions )
+		{
+			bp.pos.getAccumulator();
+		}
+
+		run( "do move, not evaluated", positions, []( Position& pos )
+		{
+			return pos.getActualStateConst().getKey().getKey() & 1;
+		});
+		run( "do move + accumulator incremental", positions, []( Position& pos )
+		{
+			return pos.getAccumulator().values[ 0 ][ 0 ];
+		});
+		run( "do move + nnue eval incremental", positions, []( Position& pos )
+		{
+			return Nnue::evaluate( pos );
+		});
+		run( "do move + accumulator refresh", positions, []( Position& pos )
+		{
+			Nnue::Accumulator acc;
+			Nnue::refresh( pos, acc );
+			return acc.values[ 0 ][ 0 ];
+		});
+
+		Nnue::unload();
+	}
+}
@@ -0,0 +1,122 @@
+/*
+	This file is part of Vajolet.
+	Copyright (C) 2013-2018 Marco Belli
+
+    Vajolet is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Vajolet is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#include <iostream>
+
+#include "Bench.h"
+#include "./../MoveGenerator.h"
+#include "./../MoveList.h"
+#include "./../MoveSelector.h"
+#include "./../Position.h"
+
+using namespace libChess;
+
+namespace
+{
+	const unsigned int maxPositions = 2000;
+	const unsigned int repetitions = 500;
+
+	struct benchPosition
+	{
+		Position pos;
+		std::vector< Move > nullChildMoves;	// legal moves of the opponent after a null move
+	};
+
+	/*! \brief collect the children of the perft positions where a null move can be played
+	*
+	*/
+	void collectPositions( const std::vector< std::string >& fens, std::vector< benchPosition >& positions )
+	{
+		Position pos;
+		for( const auto& fen : fens )
+		{
+			pos.setupFromFen( fen );
+			MoveSelector ms( pos );
+			Move m;
+			while( ( m = ms.getNextMove() ) != Move::NOMOVE && positions.size() < maxPositions )
+			{
+				pos.doMove( m );
+				if( !pos.isInCheck() )
+				{
+					benchPosition bp{ pos, {} };
+					bp.pos.doNullMove();
+					MoveList< MoveSelector::maxMovePerPosition > ml;
+					MoveGenerator::generateMoves< MoveGenerator::allMg >( bp.pos, ml );
+					bp.nullChildMoves.assign( ml.begin(), ml.end() );
+					bp.pos.undoNullMove();
+					positions.push_back( std::move( bp ) );
+				}
+				pos.undoMove();
+			}
+		}
+	}
+
+	template< typename Function >
+	void run( const std::string& name, std::vector< benchPosition >& positions, Function f )
+	{
+		unsigned long long checksum = 0;
+		unsigned long long iterations = 0;
+		const auto start = std::chrono::steady_clock::now();
+		for( unsigned int r = 0; r < repetitions; ++r )
+		{
+			for( auto& bp : positions )
+			{
+				checksum += f( bp );
+				++iterations;
+			}
+		}
+		const auto time = std::chrono::steady_clock::now() - start;
+		bench::report( name, std::chrono::duration_cast< std::chrono::nanoseconds >( time ), iterations, checksum );
+	}
+}
+
+namespace bench
+{
+	/*! \brief measure the cost of the null move
+	*
+	*	the second test ask moveGivesCheck for all the moves of the opponent after the null move, as done by a search
+	*	that doesn't cut off immediately after the null move
+	*/
+	void nullMoveBench( const std::vector< std::string >& fens )
+	{
+		std::vector< benchPosition > positions;
+		collectPositions( fens, positions );
+
+		std::cout << std::endl << "null move: " << positions.size() << " positions" << std::endl;
+
+		run( "doNullMove + undoNullMove", positions, []( benchPosition& bp )
+		{
+			bp.pos.doNullMove();
+			const GameState& st = bp.pos.getActualStateConst();
+			const unsigned long long checksum = st.getPinned().bitCnt() + st.getDiscoveryCheckers().bitCnt();
+			bp.pos.undoNullMove();
+			return checksum;
+		});
+		run( "doNullMove + children moveGivesCheck", positions, []( benchPosition& bp )
+		{
+			bp.pos.doNullMove();
+			unsigned long long checksum = 0;
+			for( const auto& m : bp.nullChildMoves )
+			{
+				checksum += bp.pos.moveGivesCheck( m );
+			}
+			bp.pos.undoNullMove();
+			return checksum;
+		});
+	}
+}
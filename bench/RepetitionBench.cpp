@@ -0,0 +1,135 @@
+/*
+	This file is part of Vajolet.
+	Copyright (C) 2013-2018 Marco Belli
+
+    Vajolet is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Vajolet is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#include <iostream>
+#include <random>
+
+#include "Bench.h"
+#include "./../MoveGenerator.h"
+#include "./../MoveList.h"
+#include "./../MoveSelector.h"
+#include "./../Position.h"
+
+using namespace libChess;
+
+namespace
+{
+	const unsigned int maxPositions = 2000;
+	const unsigned int reversiblePlies = 24;
+	const unsigned int repetitions = 200;
+	const unsigned int rootPly = 1000;	// the whole history is after the root, every repetition is reported
+
+	bool isReversible( const Position& pos, const Move& m )
+	{
+		return !pos.isCaptureMove( m ) && !m.isPromotionMove() && !m.isCastleMove() && !baseTypes::isPawn( pos.getPieceAt( m.getFrom() ) );
+	}
+
+	/*! \brief play random reversible moves from the perft positions, keeping every position with its history
+	*
+	*/
+	void collectPositions( const std::vector< std::string >& fens, std::vector< Position >& positions )
+	{
+		std::mt19937 rnd( 19091979 );
+		Position pos;
+		for( const auto& fen : fens )
+		{
+			pos.setupFromFen( fen );
+			for( unsigned int ply = 0; ply < reversiblePlies && positions.size() < maxPositions; ++ply )
+			{
+				MoveList< MoveSelector::maxMovePerPosition > ml;
+				MoveGenerator::generateMoves< MoveGenerator::allMg >( pos, ml );
+				std::vector< Move > moves;
+				for( const auto& m : ml )
+				{
+					if( isReversible( pos, m ) )
+					{
+						moves.push_back( m );
+					}
+				}
+				if( moves.empty() )
+				{
+					break;
+				}
+				pos.doMove( moves[ rnd() % moves.size() ] );
+				positions.push_back( pos );
+			}
+		}
+	}
+
+	template< typename Function >
+	void run( const std::string& name, std::vector< Position >& positions, Function f )
+	{
+		unsigned long long checksum = 0;
+		unsigned long long iterations = 0;
+		const auto start = std::chrono::steady_clock::now();
+		for( unsigned int r = 0; r < repetitions; ++r )
+		{
+			for( auto& pos : positions )
+			{
+				checksum += f( pos );
+				++iterations;
+			}
+		}
+		const auto time = std::chrono::steady_clock::now() - start;
+		bench::report( name, std::chrono::duration_cast< std::chrono::nanoseconds >( time ), iterations, checksum );
+	}
+}
+
+namespace bench
+{
+	/*! \brief compare the cuckoo upcoming repetition test with the walks of the state list
+	*
+	*	the upcoming repetition by linear walk plays every reversible move and looks for the new position in the history.
+	*	its checksum can differ from the cuckoo one, which doesn't check the legality of the repeating move
+	*/
+	void repetitionBench( const std::vector< std::string >& fens )
+	{
+		std::vector< Position > positions;
+		collectPositions( fens, positions );
+
+		std::cout << std::endl << "repetition: " << positions.size() << " positions, up to " << reversiblePlies << " reversible plies" << std::endl;
+
+		run( "repetition linear walk", positions, []( Position& pos )
+		{
+			return pos.isRepetition( rootPly );
+		});
+		run( "upcoming repetition linear walk", positions, []( Position& pos )
+		{
+			MoveList< MoveSelector::maxMovePerPosition > ml;
+			MoveGenerator::generateMoves< MoveGenerator::allMg >( pos, ml );
+			for( const auto& m : ml )
+			{
+				if( isReversible( pos, m ) )
+				{
+					pos.doMove( m );
+					const bool repetition = pos.isRepetition( rootPly );
+					pos.undoMove();
+					if( repetition )
+					{
+						return true;
+					}
+				}
+			}
+			return false;
+		});
+		run( "upcoming repetition cuckoo", positions, []( Position& pos )
+		{
+			return pos.hasUpcomingRepetition( rootPly );
+		});
+	}
+}
@@ -0,0 +1,138 @@
+/*
+	This file is part of Vajolet.
+	Copyright (C) 2013-2018 Marco Belli
+
+    Vajolet is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Vajolet is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#include <iomanip>
+#include <iostream>
+
+#include "Bench.h"
+#include "./../Position.h"
+#include "./../Search.h"
+#include "./../TranspositionTable.h"
+
+using namespace libChess;
+
+namespace
+{
+	const unsigned int maxPositions = 40;
+	const unsigned int searchDepth = 9;
+
+	/*! \brief search at fixed depth the first perft positions and report time, nodes and statistics
+	*
+	*/
+	void run( const std::string& name, const std::vector< std::string >& fens, const Search::Settings& settings, const SearchLimits& limits )
+	{
+		Position pos;
+		TranspositionTable tt;
+		Search src( pos, tt );
+		src.getSettings() = settings;
+
+		Search::Statistics total;
+		total.clear();
+		unsigned long long checksum = 0;
+		unsigned int iterations = 0;
+		std::chrono::nanoseconds time( 0 );
+
+		for( const auto& fen : fens )
+		{
+			if( iterations == maxPositions )
+			{
+				break;
+			}
+			pos.setupFromFen( fen );
+			src.clear();
+			const auto start = std::chrono::steady_clock::now();
+			const Score score = src.search( limits );
+			time += std::chrono::duration_cast< std::chrono::nanoseconds >( std::chrono::steady_clock::now() - start );
+			checksum += src.getBestMove().getPacked() + score;
+			++iterations;
+
+			const Search::Statistics& stats = src.getStatistics();
+			total.nodes += stats.nodes;
+			total.qsearchNodes += stats.qsearchNodes;
+			total.nullMoveSearches += stats.nullMoveSearches;
+			total.nullMoveCutoffs += stats.nullMoveCutoffs;
+			total.nullMoveVerifications += stats.nullMoveVerifications;
+			total.nullMoveVerificationFails += stats.nullMoveVerificationFails;
+			total.ttHits += stats.ttHits;
+			total.singularSearches += stats.singularSearches;
+			total.singularExtensions += stats.singularExtensions;
+			total.multiCutPrunes += stats.multiCutPrunes;
+			total.probCutSearches += stats.probCutSearches;
+			total.probCutCutoffs += stats.probCutCutoffs;
+			total.lmrReductions += stats.lmrReductions;
+			total.lmrResearches += stats.lmrResearches;
+			total.moveCountPrunes += stats.moveCountPrunes;
+			total.futilityPrunes += stats.futilityPrunes;
+		}
+
+		bench::report( name, time, iterations, checksum );
+		std::cout << "    nodes " << total.nodes << " (qsearch " << total.qsearchNodes << "), "
+			<< (unsigned long long)( total.nodes * 1e9 / time.count() ) << " nps" << std::endl;
+		std::cout << "    null move searches " << total.nullMoveSearches << ", cutoffs " << total.nullMoveCutoffs
+			<< ", verifications " << total.nullMoveVerifications << " (" << total.nullMoveVerificationFails << " failed)" << std::endl;
+		std::cout << "    tt hits " << total.ttHits << ", singular searches " << total.singularSearches
+			<< ", extensions " << total.singularExtensions << " (" << std::fixed << std::setprecision( 1 ) << ( total.singularSearches ? 100.0 * total.singularExtensions / total.singularSearches : 0.0 ) << "% of singular searches)"
+			<< ", multi-cut prunes " << total.multiCutPrunes << std::endl;
+		std::cout << "    probcut searches " << total.probCutSearches << ", cutoffs " << total.probCutCutoffs << std::endl;
+		std::cout << "    reduced " << total.lmrReductions << " (" << total.lmrResearches << " re-searched)"
+			<< ", pruned by move count " << total.moveCountPrunes << ", by futility " << total.futilityPrunes << std::endl;
+	}
+}
+
+namespace bench
+{
+	/*! \brief fixed depth search of the perft positions, with and without the search features
+	*
+	*	the time per iteration is the time to reach the search depth.
+	*	the search with a movetime that is never reached shows the cost of polling the clock
+	*/
+	void searchBench( const std::vector< std::string >& fens )
+	{
+		std::cout << std::endl << "search: depth " << searchDepth << std::endl;
+
+		SearchLimits limits;
+		limits.depth = searchDepth;
+		Search::Settings settings;
+		run( "search", fens, settings, limits );
+
+		SearchLimits timeLimits = limits;
+		timeLimits.moveTime = 1000000;
+		run( "search with time polling", fens, settings, timeLimits );
+
+		settings.multiPV = 4;
+		run( "search multipv 4", fens, settings, limits );
+		settings.multiPV = 1;
+
+		settings.singularExtension = false;
+		run( "search without singular extension", fens, settings, limits );
+
+		settings.singularExtension = true;
+		settings.probCut = false;
+		run( "search without probcut", fens, settings, limits );
+
+		settings.probCut = true;
+		settings.lateMoveReductions = false;
+		settings.lateMovePruning = false;
+		run( "search without late move reductions and pruning", fens, settings, limits );
+
+		settings.lateMoveReductions = true;
+		settings.lateMovePruning = true;
+		settings.nullMovePruning = false;
+		run( "search without null move", fens, settings, limits );
+	}
+}
@@ -0,0 +1,85 @@
+/*
+	This file is part of Vajolet.
+
+    Vajolet is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Vajolet is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#include "gtest/gtest.h"
+#include "./../BitMapMoveGenerator.h"
+#include "./../Cuckoo.h"
+
+using namespace libChess;
+
+namespace {
+
+	baseTypes::BitMap getPseudoMoves( const baseTypes::bitboardIndex piece, const baseTypes::tSquare from )
+	{
+		if( baseTypes::isKing( piece ) )
+		{
+			return BitMapMoveGenerator::getKingMoves( from );
+		}
+		if( baseTypes::isQueen( piece ) )
+		{
+			return BitMapMoveGenerator::getQueenPseudoMoves( from );
+		}
+		if( baseTypes::isRook( piece ) )
+		{
+			return BitMapMoveGenerator::getRookPseudoMoves( from );
+		}
+		if( baseTypes::isBishop( piece ) )
+		{
+			return BitMapMoveGenerator::getBishopPseudoMoves( from );
+		}
+		return BitMapMoveGenerator::getKnightMoves( from );
+	}
+
+	TEST(Cuckoo, reversibleMovesAreFound)
+	{
+		unsigned int count = 0;
+		for( const auto piece : { baseTypes::whiteKing, baseTypes::whiteQueens, baseTypes::whiteRooks, baseTypes::whiteBishops, baseTypes::whiteKnights,
+			baseTypes::blackKing, baseTypes::blackQueens, baseTypes::blackRooks, baseTypes::blackBishops, baseTypes::blackKnights } )
+		{
+			for( baseTypes::tSquare from = baseTypes::A1; from < baseTypes::squareNumber; ++from )
+			{
+				const baseTypes::BitMap moves = getPseudoMoves( piece, from );
+				for( baseTypes::tSquare to = baseTypes::A1; to < baseTypes::squareNumber; ++to )
+				{
+					Move m;
+					const bool found = Cuckoo::probe( Cuckoo::getMoveKey( piece, from, to ), m );
+					ASSERT_EQ( moves.isSquareSet( to ), found );
+					if( found )
+					{
+						// both directions share the same entry
+						ASSERT_EQ( Move( std::min( from, to ), std::max( from, to ) ), m );
+						++count;
+					}
+				}
+			}
+		}
+		ASSERT_EQ( 2 * Cuckoo::reversibleMoves, count );
+	}
+
+	TEST(Cuckoo, otherKeysAreNotFound)
+	{
+		Move m;
+		// pawn moves, captures and moves without the side change
+		ASSERT_FALSE( Cuckoo::probe( Cuckoo::getMoveKey( baseTypes::whitePawns, baseTypes::E2, baseTypes::E4 ), m ) );
+		ASSERT_FALSE( Cuckoo::probe( Cuckoo::getMoveKey( baseTypes::whiteKnights, baseTypes::G1, baseTypes::F3 ).removePiece( baseTypes::blackPawns, baseTypes::F3 ), m ) );
+		ASSERT_FALSE( Cuckoo::probe( Cuckoo::getMoveKey( baseTypes::whiteKnights, baseTypes::G1, baseTypes::F3 ).changeSide(), m ) );
+		// not a move of the piece
+		ASSERT_FALSE( Cuckoo::probe( Cuckoo::getMoveKey( baseTypes::whiteKnights, baseTypes::G1, baseTypes::G3 ), m ) );
+		ASSERT_FALSE( Cuckoo::probe( Cuckoo::getMoveKey( baseTypes::blackBishops, baseTypes::C8, baseTypes::C6 ), m ) );
+		ASSERT_FALSE( Cuckoo::probe( HashKey( 0 ), m ) );
+	}
+}
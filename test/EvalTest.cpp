@@ -0,0 +1,103 @@
+/*
+	This file is part of Vajolet.
+
+    Vajolet is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Vajolet is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#include "gtest/gtest.h"
+#include "./../Eval.h"
+#include "./../Position.h"
+
+using namespace libChess;
+
+namespace {
+
+	TEST(Eval, startPosition)
+	{
+		Position pos;
+		pos.setupFromFen();
+		ASSERT_EQ( Eval::maxPhase, Eval::getPhase( pos ) );
+		ASSERT_EQ( Eval::tempo, Eval::evaluate( pos ) );
+		pos.doMove( Move( baseTypes::E2, baseTypes::E4 ) );
+		ASSERT_EQ( Eval::tempo, Eval::evaluate( pos ) );
+	}
+
+	TEST(Eval, phase)
+	{
+		Position pos;
+		pos.setupFromFen("4k3/pppppppp/8/8/8/8/PPPPPPPP/4K3 w - - 0 1");
+		ASSERT_EQ( 0, Eval::getPhase( pos ) );
+		pos.setupFromFen("r3k3/pppppppp/8/8/8/8/PPPPPPPP/R2QK3 w - - 0 1");
+		ASSERT_GT( Eval::getPhase( pos ), 0 );
+		ASSERT_LT( Eval::getPhase( pos ), Eval::maxPhase );
+	}
+
+	TEST(Eval, sideToMove)
+	{
+		Position pos;
+		pos.setupFromFen("r1bqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
+		const Score white = Eval::evaluate( pos );
+		ASSERT_GT( white, Eval::tempo );
+		pos.setupFromFen("r1bqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR b KQkq - 0 1");
+		ASSERT_EQ( -white + 2 * Eval::tempo, Eval::evaluate( pos ) );
+
+		// mirrored position
+		pos.setupFromFen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/R1BQKBNR b KQkq - 0 1");
+		ASSERT_EQ( white, Eval::evaluate( pos ) );
+	}
+
+	TEST(Eval, kpk)
+	{
+		Position pos;
+		// king in front of the pawn, the side to move decides the result
+		pos.setupFromFen("8/4k3/8/4K3/4P3/8/8/8 w - - 0 1");
+		ASSERT_EQ( 0, Eval::evaluate( pos ) );
+		pos.setupFromFen("8/4k3/8/4K3/4P3/8/8/8 b - - 0 1");
+		ASSERT_LE( Eval::evaluate( pos ), -Eval::knownWin );
+
+		pos.setupFromFen("8/8/8/4p3/4k3/8/4K3/8 w - - 0 1");
+		ASSERT_LE( Eval::evaluate( pos ), -Eval::knownWin );
+		pos.setupFromFen("8/8/8/4p3/4k3/8/4K3/8 b - - 0 1");
+		ASSERT_EQ( 0, Eval::evaluate( pos ) );
+
+		// advanced pawns are better
+		pos.setupFromFen("4k3/8/4K3/4P3/8/8/8/8 w - - 0 1");
+		const Score advanced = Eval::evaluate( pos );
+		pos.setupFromFen("8/4k3/8/4K3/4P3/8/8/8 b - - 0 1");
+		ASSERT_GT( advanced, -Eval::evaluate( pos ) );
+	}
+
+	TEST(Eval, trace)
+	{
+		const Eval::Parameters parameters = Eval::getParameters();
+		Position pos;
+		for( const auto& fen : { "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", "r1bqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR b KQkq - 0 1",
+			"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 b - - 0 1", "4k3/8/8/8/8/8/3PPP2/R3K3 b - - 0 1" } )
+		{
+			pos.setupFromFen( fen );
+			const Eval::Trace trace = Eval::getTrace( pos );
+			ASSERT_EQ( Eval::evaluate( pos ), Eval::evaluate( trace, parameters ) );
+			ASSERT_EQ( pos.isWhiteTurn() ? 1 : -1, trace.coefficients[ Eval::tempoValue ] );
+		}
+
+		// the trace is linear in the parameters
+		pos.setupFromFen( "r3k3/pppppppp/8/8/8/8/PPPPPPP1/R2QK3 w - - 0 1" );
+		const Eval::Trace trace = Eval::getTrace( pos );
+		ASSERT_EQ( 1, trace.coefficients[ Eval::queenValue ] );
+		ASSERT_EQ( -1, trace.coefficients[ Eval::pawnValue ] );
+		Eval::Parameters changed = parameters;
+		changed[ Eval::queenValue ] += simdScore{ Eval::maxPhase, Eval::maxPhase, 0, 0 };
+		ASSERT_EQ( Eval::evaluate( trace, parameters ) + Eval::maxPhase, Eval::evaluate( trace, changed ) );
+	}
+}
@@ -0,0 +1,150 @@
+/*
+	This file is part of Vajolet.
+
+    Vajolet is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Vajolet is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
+*/
+#include <random>
+#include <vector>
+#include "gtest/gtest.h"
+#include "./../GameCodec.h"
+#include "./../MoveSelector.h"
+#include "./../Position.h"
+
+using namespace libChess;
+
+namespace {
+
+	/*! \brief play random legal moves until the end of the game or maxPlies
+	*
+	*/
+	std::vector< Move > playRandomGame( Position& pos, std::mt19937& rnd, const unsigned int maxPlies )
+	{
+		std::vector< Move > moves;
+		const std::string fen = pos.getFen();
+		while( moves.size() < maxPlies )
+		{
+			std::vector< Move > legal;
+			MoveSelector ms( pos );
+			Move m;
+			while( ( m = ms.getNextMove() ) != Move::NOMOVE )
+			{
+				legal.push_back( m );
+			}
+			if( legal.empty() )
+			{
+				break;
+			}
+			moves.push_back( legal[ rnd() % legal.size() ] );
+			pos.doMove( moves.back() );
+		}
+		pos.setupFromFen( fen );
+		return moves;
+	}
+
+	TEST(GameCodec, moveIndex)
+	{
+		Position pos;
+		pos.setupFromFen( "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1" );
+
+		std::vector< bool > used( pos.getNumberOfLegalMoves(), false );
+		MoveSelector ms( pos );
+		Move m;
+		while( ( m = ms.getNextMove() ) != Move::NOMOVE )
+		{
+			unsigned int movesNumber;
+			const unsigned int index = GameCodec::getMoveIndex( pos, m, movesNumber );
+			ASSERT_EQ( 48u, movesNumber );
+			ASSERT_LT( index, movesNumber );
+			ASSERT_FALSE( used[ index ] );
+			used[ index ] = true;
+			ASSERT_EQ( m, GameCodec::getMove( pos, index, movesNumber ) );
+		}
+
+		unsigned int movesNumber;
+		ASSERT_EQ( 48u, GameCodec::getMoveIndex( pos, Move( baseTypes::tSquare::A2, baseTypes::tSquare::A5 ), movesNumber ) );
+		ASSERT_EQ( Move::NOMOVE, GameCodec::getMove( pos, 48, movesNumber ) );
+	}
+
+	TEST(GameCodec, roundTrip)
+	{
+		std::mt19937 rnd( 42 );
+		Position pos;
+		std::vector< Move > decoded;
+		unsigned long long plies = 0;
+		size_t bytes = 0;
+		for( const auto& fen : { "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+			"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8" } )
+		{
+			for( unsigned int game = 0; game < 50; ++game )
+			{
+				pos.setupFromFen( fen );
+				const std::vector< Move > moves = playRandomGame( pos, rnd, game * 7 );
+				const GameCodec::Result result = static_cast< GameCodec::Result >( game % 4 );
+
+				std::vector< uint8_t > data;
+				GameCodec::encode( pos, moves, result, data );
+				// the start position is restored
+				ASSERT_EQ( fen, pos.getFen() );
+
+				GameCodec::Result decodedResult;
+				ASSERT_TRUE( GameCodec::decode( data.data(), data.size(), pos, decoded, decodedResult ) );
+				ASSERT_EQ( moves, decoded );
+				ASSERT_EQ( result, decodedResult );
+				ASSERT_EQ( moves.size(), pos.getStateSize() - 1 );
+
+				plies += moves.size();
+				bytes += data.size();
+			}
+		}
+		// random moves are uniformly distributed, they cost the log2 of the legal moves number
+		ASSERT_LT( bytes * 8.0 / plies, 6.0 );
+	}
+
+	TEST(GameCodec, concatenatedGames)
+	{
+		std::mt19937 rnd( 7 );
+		Position pos;
+		std::vector< uint8_t > data;
+		std::vector< size_t > offsets;
+		std::vector< std::vector< Move > > games;
+		for( unsigned int game = 0; game < 20; ++game )
+		{
+			pos.setupFromFen();
+			games.push_back( playRandomGame( pos, rnd, 100 ) );
+			offsets.push_back( data.size() );
+			GameCodec::encode( pos, games.back(), GameCodec::Result::draw, data );
+		}
+		offsets.push_back( data.size() );
+
+		std::vector< Move > decoded;
+		GameCodec::Result result;
+		for( unsigned int game = 20; game-- > 0; )
+		{
+			ASSERT_TRUE( GameCodec::decode( data.data() + offsets[ game ], offsets[ game + 1 ] - offsets[ game ], pos, decoded, result ) );
+			ASSERT_EQ( games[ game ], decoded );
+		}
+	}
+
+	TEST(GameCodec, invalidData)
+	{
+		Position pos;
+		std::vector< Move > moves;
+		GameCodec::Result result;
+		const uint8_t customStart[] = { 1, 0, 0 };
+		const uint8_t truncatedPlies[] = { 0, 0x80 };
+		ASSERT_FALSE( GameCodec::decode( customStart, 0, pos, moves, result ) );
+		ASSERT_FALSE( GameCodec::decode( customStart, sizeof( customStart ), pos, moves, result ) );
+		ASSERT_FALSE( GameCodec::decode( truncatedPlies, sizeof( truncatedPlies ), pos, moves, result ) );
+	}
+}
@@ -0,0 +1,198 @@
+/*
+	This file is part of Vajolet.
+
+    Vajolet is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Vajolet is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#include <memory>
+#include <set>
+#include "gtest/gtest.h"
+#include "./../History.h"
+#include "./../MoveGenerator.h"
+#include "./../MoveSelector.h"
+#include "./../Position.h"
+
+using namespace libChess;
+
+namespace {
+
+	TEST(History, gravity)
+	{
+		Score entry = 0;
+		for( int i = 0; i < 1000; ++i )
+		{
+			applyHistoryGravity( entry, 5000, 10000 );
+			ASSERT_LE( entry, 10000 );
+		}
+		ASSERT_GT( entry, 9000 );
+
+		for( int i = 0; i < 1000; ++i )
+		{
+			applyHistoryGravity( entry, -50000, 10000 );
+			ASSERT_GE( entry, -10000 );
+		}
+		ASSERT_EQ( entry, -10000 );
+	}
+
+	TEST(History, killers)
+	{
+		std::unique_ptr<SearchHistory> h( new SearchHistory );
+		Position pos;
+		pos.setupFromFen();
+
+		const Move m1( baseTypes::E2, baseTypes::E4 );
+		const Move m2( baseTypes::D2, baseTypes::D4 );
+
+		ASSERT_EQ( Move::NOMOVE, h->getKiller( 3, 0 ) );
+		ASSERT_EQ( Move::NOMOVE, h->getKiller( 3, 1 ) );
+
+		h->updateQuietStats( pos, 3, m1, nullptr, 0, 4 );
+		ASSERT_EQ( m1, h->getKiller( 3, 0 ) );
+		ASSERT_EQ( Move::NOMOVE, h->getKiller( 3, 1 ) );
+
+		// inserting twice the same killer doesn't change the table
+		h->updateQuietStats( pos, 3, m1, nullptr, 0, 4 );
+		ASSERT_EQ( m1, h->getKiller( 3, 0 ) );
+		ASSERT_EQ( Move::NOMOVE, h->getKiller( 3, 1 ) );
+
+		h->updateQuietStats( pos, 3, m2, nullptr, 0, 4 );
+		ASSERT_EQ( m2, h->getKiller( 3, 0 ) );
+		ASSERT_EQ( m1, h->getKiller( 3, 1 ) );
+
+		h->clearKillers( 3 );
+		ASSERT_EQ( Move::NOMOVE, h->getKiller( 3, 0 ) );
+		ASSERT_EQ( Move::NOMOVE, h->getKiller( 3, 1 ) );
+	}
+
+	TEST(History, counterMoveAndHistory)
+	{
+		std::unique_ptr<SearchHistory> h( new SearchHistory );
+		Position pos;
+		pos.setupFromFen();
+		pos.doMove( Move( baseTypes::E2, baseTypes::E4 ) );
+
+		const Move best( baseTypes::E7, baseTypes::E5 );
+		const Move bad( baseTypes::A7, baseTypes::A6 );
+		const Move quiets[] = { bad, best };
+
+		ASSERT_EQ( Move::NOMOVE, h->getCounterMove( pos ) );
+
+		h->updateQuietStats( pos, 1, best, quiets, 2, 5 );
+
+		ASSERT_EQ( best, h->getCounterMove( pos ) );
+		ASSERT_GT( h->getQuietScore( pos, best ), 0 );
+		ASSERT_LT( h->getQuietScore( pos, bad ), 0 );
+		ASSERT_EQ( 0, h->getQuietScore( pos, Move( baseTypes::H7, baseTypes::H6 ) ) );
+
+		// the counter move is tied to the previous move
+		pos.undoMove();
+		pos.doMove( Move( baseTypes::D2, baseTypes::D4 ) );
+		ASSERT_EQ( Move::NOMOVE, h->getCounterMove( pos ) );
+		// continuation history is tied to the previous move too, butterfly is not
+		ASSERT_GT( h->getQuietScore( pos, best ), 0 );
+		ASSERT_LT( h->getQuietScore( pos, best ), SearchHistory::statBonus( 5 ) * 3 );
+	}
+
+	TEST(History, counterMoveAfterCastling)
+	{
+		std::unique_ptr<SearchHistory> h( new SearchHistory );
+		Position pos;
+		pos.setupFromFen( "r3k2r/pppq1ppp/8/8/8/8/PPPQ1PPP/R3K2R w KQkq - 0 1" );
+		pos.doMove( Move( baseTypes::E1, baseTypes::H1, Move::fcastle ) );
+
+		const Move best( baseTypes::A7, baseTypes::A6 );
+		h->updateQuietStats( pos, 1, best, &best, 1, 5 );
+		ASSERT_EQ( best, h->getCounterMove( pos ) );
+
+		// castling is indexed by the king and its final square, not by the empty square of the rook
+		pos.undoMove();
+		pos.doMove( Move( baseTypes::E1, baseTypes::A1, Move::fcastle ) );
+		ASSERT_EQ( Move::NOMOVE, h->getCounterMove( pos ) );
+
+		pos.setupFromFen( "r3k2r/pppq1ppp/8/8/8/8/PPPQ1PPP/R4K1R w kq - 0 1" );
+		pos.doMove( Move( baseTypes::F1, baseTypes::G1 ) );
+		ASSERT_EQ( best, h->getCounterMove( pos ) );
+	}
+
+	TEST(History, moveSelectorOrder)
+	{
+		std::unique_ptr<SearchHistory> h( new SearchHistory );
+		Position pos;
+		pos.setupFromFen("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+
+		const Move killer( baseTypes::A2, baseTypes::A3 );
+		const Move historyMove( baseTypes::G2, baseTypes::G3 );
+		const Move quiets[] = { historyMove };
+		h->updateQuietStats( pos, 2, historyMove, quiets, 1, 10 );
+		h->updateQuietStats( pos, 2, killer, nullptr, 0, 1 );
+
+		MoveSelector ms( pos, *h, 2 );
+		std::vector<Move> moves;
+		Move m;
+		while( ( m = ms.getNextMove() ) != Move::NOMOVE )
+		{
+			moves.push_back( m );
+		}
+
+		// all the legal moves are returned exactly once
+		std::set<unsigned short> uniqueMoves;
+		for( const auto& mm : moves )
+		{
+			uniqueMoves.insert( mm.getPacked() );
+		}
+		ASSERT_EQ( pos.getNumberOfLegalMoves(), moves.size() );
+		ASSERT_EQ( moves.size(), uniqueMoves.size() );
+
+		// first the captures, then the killers, then the quiet moves sorted by history
+		const auto killerIt = std::find( moves.begin(), moves.end(), killer );
+		const auto secondKillerIt = std::find( moves.begin(), moves.end(), historyMove );
+		ASSERT_NE( moves.end(), killerIt );
+		ASSERT_EQ( killerIt + 1, secondKillerIt );
+		for( auto it = moves.begin(); it != killerIt; ++it )
+		{
+			ASSERT_TRUE( pos.getTheirBitMap().isSquareSet( it->getTo() ) || it->isEnPassantMove() );
+		}
+	}
+
+	TEST(History, moveSelectorPerft)
+	{
+		std::unique_ptr<SearchHistory> h( new SearchHistory );
+		Position pos;
+		pos.setupFromFen("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+
+		// fill the killers with moves valid in some positions
+		MoveList< MoveSelector::maxMovePerPosition > ml;
+		MoveGenerator::generateMoves< MoveGenerator::allMg >( pos, ml );
+		for( auto& m : ml )
+		{
+			h->updateQuietStats( pos, 1, m, nullptr, 0, 3 );
+		}
+
+		unsigned long long tot = 0;
+		MoveSelector ms( pos, *h, 0 );
+		Move m;
+		while( ( m = ms.getNextMove() ) != Move::NOMOVE )
+		{
+			pos.doMove( m );
+			MoveSelector ms2( pos, *h, 1 );
+			Move m2;
+			while( ( m2 = ms2.getNextMove() ) != Move::NOMOVE )
+			{
+				++tot;
+			}
+			pos.undoMove();
+		}
+		ASSERT_EQ( 2039ull, tot );
+	}
+}
@@ -0,0 +1,121 @@
+/*
+	This file is part of Vajolet.
+
+    Vajolet is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Vajolet is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#include "gtest/gtest.h"
+#include "./../KPKBitbase.h"
+#include "./../Position.h"
+
+using namespace libChess;
+
+namespace {
+
+	TEST(KPKBitbase, isKPK)
+	{
+		Position pos;
+		pos.setupFromFen("4k3/8/8/8/4P3/8/8/4K3 w - - 0 1");
+		ASSERT_TRUE( KPKBitbase::isKPK( pos ) );
+
+		pos.setupFromFen("4k3/8/8/8/4p3/8/8/4K3 w - - 0 1");
+		ASSERT_TRUE( KPKBitbase::isKPK( pos ) );
+
+		pos.setupFromFen("4k3/8/8/8/4P3/8/4P3/4K3 w - - 0 1");
+		ASSERT_FALSE( KPKBitbase::isKPK( pos ) );
+
+		pos.setupFromFen("4k3/8/8/8/4N3/8/8/4K3 w - - 0 1");
+		ASSERT_FALSE( KPKBitbase::isKPK( pos ) );
+
+		pos.setupFromFen();
+		ASSERT_FALSE( KPKBitbase::isKPK( pos ) );
+	}
+
+	TEST(KPKBitbase, opposition)
+	{
+		Position pos;
+		// king in front of the pawn, the side to move decides the result
+		pos.setupFromFen("8/4k3/8/4K3/4P3/8/8/8 w - - 0 1");
+		ASSERT_FALSE( KPKBitbase::probe( pos ) );
+
+		pos.setupFromFen("8/4k3/8/4K3/4P3/8/8/8 b - - 0 1");
+		ASSERT_TRUE( KPKBitbase::probe( pos ) );
+
+		// king on the sixth rank in front of the pawn always win
+		pos.setupFromFen("4k3/8/4K3/4P3/8/8/8/8 w - - 0 1");
+		ASSERT_TRUE( KPKBitbase::probe( pos ) );
+
+		pos.setupFromFen("4k3/8/4K3/4P3/8/8/8/8 b - - 0 1");
+		ASSERT_TRUE( KPKBitbase::probe( pos ) );
+	}
+
+	TEST(KPKBitbase, rookPawn)
+	{
+		Position pos;
+		pos.setupFromFen("k7/8/8/8/8/8/P7/7K w - - 0 1");
+		ASSERT_FALSE( KPKBitbase::probe( pos ) );
+
+		pos.setupFromFen("7k/8/8/8/8/8/7P/K7 w - - 0 1");
+		ASSERT_FALSE( KPKBitbase::probe( pos ) );
+	}
+
+	TEST(KPKBitbase, runningPawn)
+	{
+		Position pos;
+		// black king outside the square of the pawn
+		pos.setupFromFen("8/8/1P6/8/8/8/8/K6k w - - 0 1");
+		ASSERT_TRUE( KPKBitbase::probe( pos ) );
+
+		// black king can capture the pawn
+		pos.setupFromFen("8/8/8/8/3kP3/8/8/7K b - - 0 1");
+		ASSERT_FALSE( KPKBitbase::probe( pos ) );
+	}
+
+	TEST(KPKBitbase, blackPawn)
+	{
+		Position pos;
+		// mirrored positions of the opposition test
+		pos.setupFromFen("8/8/8/4p3/4k3/8/4K3/8 b - - 0 1");
+		ASSERT_FALSE( KPKBitbase::probe( pos ) );
+
+		pos.setupFromFen("8/8/8/4p3/4k3/8/4K3/8 w - - 0 1");
+		ASSERT_TRUE( KPKBitbase::probe( pos ) );
+
+		pos.setupFromFen("8/8/1p6/8/8/8/8/K6k b - - 0 1");
+		ASSERT_FALSE( KPKBitbase::probe( pos ) );
+
+		pos.setupFromFen("8/8/8/8/8/1p6/8/5K1k b - - 0 1");
+		ASSERT_TRUE( KPKBitbase::probe( pos ) );
+	}
+
+	TEST(KPKBitbase, mirroredFiles)
+	{
+		for( const auto wk : baseTypes::tSquareRange() )
+		{
+			for( const auto bk : baseTypes::tSquareRange() )
+			{
+				for( auto p = baseTypes::A2; p <= baseTypes::H7; ++p )
+				{
+					if( wk == bk || wk == p || bk == p || baseTypes::distance( wk, bk ) <= 1 )
+					{
+						continue;
+					}
+					const auto mirror = []( const baseTypes::tSquare sq ){ return baseTypes::tSquare( sq ^ 7 ); };
+					ASSERT_EQ( KPKBitbase::probe( baseTypes::whiteTurn, wk, p, bk ), KPKBitbase::probe( baseTypes::whiteTurn, mirror( wk ), mirror( p ), mirror( bk ) ) );
+					ASSERT_EQ( KPKBitbase::probe( baseTypes::blackTurn, wk, p, bk ), KPKBitbase::probe( baseTypes::blackTurn, mirror( wk ), mirror( p ), mirror( bk ) ) );
+				}
+			}
+		}
+	}
+}
@@ -16,6 +16,7 @@
 */
 
 #include <fstream>
+#include <set>
 #include "gtest/gtest.h"
 #include "./../MoveGenerator.h"
 #include "./../MoveSelector.h"
@@ -196,6 +197,74 @@ static const std::vector<positions> perftPos ={
 
 		}
 	}
-
 	
-}
\ No newline at end of file
+	void testQuietChecksAndPromotions( const Position& pos )
+	{
+		std::set<unsigned short> expectedChecks;
+		std::set<unsigned short> expectedPromotions;
+		MoveList< MoveSelector::maxMovePerPosition > quiets;
+		MoveGenerator::generateMoves< MoveGenerator::quietMg >( pos, quiets );
+		for( const auto& m : quiets )
+		{
+			if( m.isPromotionMove() )
+			{
+				expectedPromotions.insert( m.getPacked() );
+			}
+			else if( pos.moveGivesCheck( m ) )
+			{
+				expectedChecks.insert( m.getPacked() );
+			}
+		}
+		
+		MoveList< MoveSelector::maxMovePerPosition > ml;
+		MoveGenerator::generateMoves< MoveGenerator::quietChecksMg >( pos, ml );
+		std::set<unsigned short> checks;
+		for( const auto& m : ml )
+		{
+			checks.insert( m.getPacked() );
+		}
+		ASSERT_EQ( ml.size(), checks.size() );
+		ASSERT_TRUE( expectedChecks == checks );
+		
+		ml.reset();
+		MoveGenerator::generateMoves< MoveGenerator::quietPromotionMg >( pos, ml );
+		std::set<unsigned short> promotions;
+		for( const auto& m : ml )
+		{
+			promotions.insert( m.getPacked() );
+		}
+		ASSERT_EQ( ml.size(), promotions.size() );
+		ASSERT_TRUE( expectedPromotions == promotions );
+	}
+	
+	TEST(MoveGenerator, quietChecksAndPromotions)
+	{
+		std::ifstream infile("perft.txt");
+		ASSERT_FALSE(infile.fail());
+		
+		Position pos;
+		std::string line;
+		while (std::getline(infile, line))
+		{
+			pos.setupFromFen( line.substr(0, line.find_first_of(",")) );
+			if( pos.isInCheck() )
+			{
+				continue;
+			}
+			testQuietChecksAndPromotions( pos );
+			
+			// the children have discovered checks and pinned pieces more often
+			MoveList< MoveSelector::maxMovePerPosition > ml;
+			MoveGenerator::generateMoves< MoveGenerator::allMg >( pos, ml );
+			for( const auto& m : ml )
+			{
+				pos.doMove( m );
+				if( !pos.isInCheck() )
+				{
+					testQuietChecksAndPromotions( pos );
+				}
+				pos.undoMove();
+			}
+		}
+	}
+}
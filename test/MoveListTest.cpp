@@ -15,6 +15,8 @@
     along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
 */
 
+#include <limits>
+#include <set>
 #include "gtest/gtest.h"
 #include "./../MoveList.h"
 
@@ -232,6 +234,102 @@ namespace {
 		
 	}
 	
+	TEST(MoveList,findNextBestMoveLongList)
+	{
+		// long enough to use the vectorized search, with duplicated scores
+		Score ss[] ={ 10, -600, 25, 950, 3, 950, -7, 12, 0, 400, 400, -3000, 5 };
+		const unsigned int n = sizeof( ss ) / sizeof( Score );
+		
+		MoveList<30> ml;
+		for( unsigned int i = 0; i < n; ++i )
+		{
+			ml.insert( Move( (unsigned short)( i + 1 ) ) );
+		}
+		unsigned int i= 0;
+		for( auto it = ml.actualPosition(); it != ml.end(); ++it)
+		{
+			(*it).setScore(ss[i]);
+			++i;
+		}
+		
+		Score previous = std::numeric_limits< Score >::max();
+		for( i = 0; i < n; ++i )
+		{
+			const Move& m = ml.findNextBestMove();
+			ASSERT_NE( Move::NOMOVE, m );
+			const Score s = ss[ m.getPacked() - 1 ];
+			ASSERT_LE( s, previous );
+			previous = s;
+		}
+		ASSERT_EQ( Move::NOMOVE, ml.findNextBestMove() );
+	}
+	
+	TEST(MoveList,sortAbove)
+	{
+		Score ss[] ={ -50, 10, -600, 25, 950, 3, -7, 400, -3000, 5 };
+		const unsigned int n = sizeof( ss ) / sizeof( Score );
+		
+		MoveList<30> ml;
+		for( unsigned int i = 0; i < n; ++i )
+		{
+			ml.insert( Move( (unsigned short)( i + 1 ) ) );
+		}
+		unsigned int i= 0;
+		for( auto it = ml.actualPosition(); it != ml.end(); ++it)
+		{
+			(*it).setScore(ss[i]);
+			++i;
+		}
+		
+		ml.sortAbove( 0 );
+		
+		// the moves with score >= 0 are sorted
+		Score expected[] = { 950, 400, 25, 10, 5, 3 };
+		for( const auto s : expected )
+		{
+			ASSERT_EQ( s, ss[ ml.getNextMove().getPacked() - 1 ] );
+		}
+		// all the other moves follow
+		std::set<Score> remaining;
+		Move m;
+		while( ( m = ml.getNextMove() ) != Move::NOMOVE )
+		{
+			const Score s = ss[ m.getPacked() - 1 ];
+			ASSERT_LT( s, 0 );
+			remaining.insert( s );
+		}
+		ASSERT_EQ( 4, remaining.size() );
+	}
+	
+	TEST(MoveList,sortAboveAll)
+	{
+		Move mm[] ={ Move(baseTypes::E2 , baseTypes::E4), Move( baseTypes::G1 , baseTypes::D8), Move( baseTypes::D6 , baseTypes::C4), Move( baseTypes::E2 , baseTypes::E3) };
+		Score ss[] ={ 10,600,25,950 };
+		
+		MoveList<30> ml;
+		ml.sortAbove( 0 );
+		ASSERT_EQ( Move::NOMOVE, ml.getNextMove() );
+		
+		for( unsigned int i = 0; i < 4; ++i )
+		{
+			ml.insert( mm[ i ] );
+		}
+		unsigned int i= 0;
+		for( auto it = ml.actualPosition(); it != ml.end(); ++it)
+		{
+			(*it).setScore(ss[i]);
+			++i;
+		}
+		// the already returned moves are not sorted
+		ASSERT_EQ( mm[0], ml.getNextMove() );
+		ml.sortAbove( std::numeric_limits< Score >::min() );
+		
+		ASSERT_EQ( mm[3], ml.getNextMove() );
+		ASSERT_EQ( mm[1], ml.getNextMove() );
+		ASSERT_EQ( mm[2], ml.getNextMove() );
+		ASSERT_EQ( Move::NOMOVE, ml.getNextMove() );
+	}
+	
 	TEST(MoveList,emptyList)
 	{
 		
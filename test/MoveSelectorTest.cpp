@@ -0,0 +1,217 @@
+/*
+	This file is part of Vajolet.
+
+    Vajolet is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Vajolet is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#include <memory>
+#include <set>
+#include <vector>
+#include "gtest/gtest.h"
+#include "./../History.h"
+#include "./../MoveGenerator.h"
+#include "./../MoveSelector.h"
+#include "./../Position.h"
+
+using namespace libChess;
+
+namespace {
+
+	std::vector<Move> getAllMoves( MoveSelector& ms )
+	{
+		std::vector<Move> moves;
+		Move m;
+		while( ( m = ms.getNextMove() ) != Move::NOMOVE )
+		{
+			moves.push_back( m );
+		}
+		return moves;
+	}
+
+	void checkUnique( const Position& pos, const std::vector<Move>& moves )
+	{
+		std::set<unsigned short> uniqueMoves;
+		for( const auto& m : moves )
+		{
+			uniqueMoves.insert( m.getPacked() );
+		}
+		ASSERT_EQ( pos.getNumberOfLegalMoves(), moves.size() );
+		ASSERT_EQ( moves.size(), uniqueMoves.size() );
+	}
+
+	TEST(MoveSelector, ttMoveReturnedOnce)
+	{
+		const std::string fens[] = {
+			"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+			"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R b KQkq - 0 1",
+			"rnbqkbnr/ppp2ppp/3p4/1B2p3/4P3/8/PPPP1PPP/RNBQK1NR b KQkq - 1 3"
+		};
+		std::unique_ptr<SearchHistory> h( new SearchHistory );
+		Position pos;
+		for( const auto& fen : fens )
+		{
+			pos.setupFromFen( fen );
+			MoveList< MoveSelector::maxMovePerPosition > ml;
+			MoveGenerator::generateMoves< MoveGenerator::allMg >( pos, ml );
+			for( const auto& ttMove : ml )
+			{
+				const Move tt( ttMove );
+				{
+					MoveSelector ms( pos, tt );
+					const auto moves = getAllMoves( ms );
+					ASSERT_EQ( tt, moves[ 0 ] );
+					checkUnique( pos, moves );
+				}
+				{
+					MoveSelector ms( pos, *h, 0, tt );
+					const auto moves = getAllMoves( ms );
+					ASSERT_EQ( tt, moves[ 0 ] );
+					checkUnique( pos, moves );
+				}
+			}
+		}
+	}
+
+	TEST(MoveSelector, captureOrder)
+	{
+		Position pos;
+		pos.setupFromFen("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+		MoveSelector ms( pos );
+		const auto moves = getAllMoves( ms );
+		checkUnique( pos, moves );
+
+		// captures first, sorted by MVV-LVA
+		Score previous = std::numeric_limits<Score>::max();
+		unsigned int captures = 0;
+		for( const auto& m : moves )
+		{
+			if( !pos.getTheirBitMap().isSquareSet( m.getTo() ) )
+			{
+				break;
+			}
+			const Score s = pos.getMvvLvaScore( m );
+			ASSERT_LE( s, previous );
+			previous = s;
+			++captures;
+		}
+		ASSERT_EQ( 8, captures );
+	}
+
+	TEST(MoveSelector, probCut)
+	{
+		const std::string fens[] = {
+			"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+			"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R b KQkq - 0 1",
+			"1k1r3q/1ppn3p/p4b2/4p3/8/P2N2P1/1PP1R1BP/2K1Q3 w - - 0 1"
+		};
+		Position pos;
+		for( const auto& fen : fens )
+		{
+			pos.setupFromFen( fen );
+			MoveList< MoveSelector::maxMovePerPosition > ml;
+			MoveGenerator::generateMoves< MoveGenerator::captureMg >( pos, ml );
+			for( const Score threshold : { -1000, -100, 0, 1, 200, 600 } )
+			{
+				std::set<unsigned short> expected;
+				for( const auto& m : ml )
+				{
+					if( pos.seeGreaterOrEqual( m, threshold ) )
+					{
+						expected.insert( m.getPacked() );
+					}
+				}
+				
+				const Move ttMove = ml.size() ? Move( *ml.begin() ) : Move::NOMOVE;
+				MoveSelector ms( pos, threshold, ttMove );
+				const auto moves = getAllMoves( ms );
+				std::set<unsigned short> returned;
+				for( const auto& m : moves )
+				{
+					returned.insert( m.getPacked() );
+				}
+				ASSERT_EQ( moves.size(), returned.size() );
+				ASSERT_TRUE( expected == returned );
+				if( expected.count( ttMove.getPacked() ) )
+				{
+					ASSERT_EQ( ttMove, moves[ 0 ] );
+				}
+			}
+		}
+		
+		// a quiet tt move is never returned
+		pos.setupFromFen( fens[ 0 ] );
+		const Move quietTTMove( baseTypes::A2, baseTypes::A3 );
+		MoveSelector ms( pos, -1000, quietTTMove );
+		for( const auto& m : getAllMoves( ms ) )
+		{
+			ASSERT_NE( quietTTMove, m );
+		}
+	}
+	
+	TEST(MoveSelector, quiescent)
+	{
+		const std::string fens[] = {
+			"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+			"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R b KQkq - 0 1",
+			"n1n5/PPPk4/8/8/8/8/4Kppp/5N1N b - - 0 1",
+			"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+			"4k3/8/8/8/8/8/8/4K2R w K - 0 1"
+		};
+		Position pos;
+		for( const auto& fen : fens )
+		{
+			pos.setupFromFen( fen );
+			MoveList< MoveSelector::maxMovePerPosition > ml;
+			MoveGenerator::generateMoves< MoveGenerator::allMg >( pos, ml );
+			
+			std::set<unsigned short> expectedCaptures;
+			std::set<unsigned short> expectedWithChecks;
+			for( const auto& m : ml )
+			{
+				if( pos.isInCheck() || pos.isCaptureMove( m ) || m.isPromotionMove() )
+				{
+					expectedCaptures.insert( m.getPacked() );
+					expectedWithChecks.insert( m.getPacked() );
+				}
+				else if( pos.moveGivesCheck( m ) )
+				{
+					expectedWithChecks.insert( m.getPacked() );
+				}
+			}
+			
+			for( const auto type : { MoveSelector::quiescentCaptures, MoveSelector::quiescentWithChecks } )
+			{
+				const auto& expected = type == MoveSelector::quiescentCaptures ? expectedCaptures : expectedWithChecks;
+				// try a tt move of every kind, it shall be returned first only if it belongs to the moves searched
+				for( const auto& ttMove : ml )
+				{
+					const Move tt( ttMove );
+					MoveSelector ms( pos, type, tt );
+					const auto moves = getAllMoves( ms );
+					std::set<unsigned short> returned;
+					for( const auto& m : moves )
+					{
+						returned.insert( m.getPacked() );
+					}
+					ASSERT_EQ( moves.size(), returned.size() );
+					ASSERT_TRUE( expected == returned );
+					if( expected.count( tt.getPacked() ) )
+					{
+						ASSERT_EQ( tt, moves[ 0 ] );
+					}
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,381 @@
+/*
+	This file is part of Vajolet.
+
+    Vajolet is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Vajolet is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#include <algorithm>
+#include <random>
+#include <sstream>
+#include "gtest/gtest.h"
+#include "./../Eval.h"
+#include "./../MoveGenerator.h"
+#include "./../MoveList.h"
+#include "./../MoveSelector.h"
+#include "./../Nnue.h"
+#include "./../Position.h"
+
+using namespace libChess;
+
+namespace {
+
+	/*! \brief random network written in the nnue file format, with a plain reference implementation of the evaluation
+	*
+	*	the weights are small enough to never overflow the int16 accumulators
+	*/
+	struct TestNetwork
+	{
+		std::vector< int16_t > featureBiases;
+		std::vector< int16_t > featureWeights;
+		std::vector< int32_t > hidden1Biases;
+		std::vector< int8_t > hidden1Weights;
+		std::vector< int32_t > hidden2Biases;
+		std::vector< int8_t > hidden2Weights;
+		int32_t outputBias;
+		std::vector< int8_t > outputWeights;
+
+		explicit TestNetwork( const unsigned int seed )
+		{
+			std::mt19937 rnd( seed );
+			auto fill = [&rnd]( auto& v, const size_t size, const int min, const int max )
+			{
+				std::uniform_int_distribution< int > d( min, max );
+				v.resize( size );
+				for( auto& x : v )
+				{
+					x = d( rnd );
+				}
+			};
+			fill( featureBiases, Nnue::halfDimensions, 0, 40 );
+			fill( featureWeights, Nnue::featuresNumber * Nnue::halfDimensions, -20, 20 );
+			fill( hidden1Biases, Nnue::hiddenDimensions, -500, 500 );
+			fill( hidden1Weights, Nnue::hiddenDimensions * 2 * Nnue::halfDimensions, -128, 127 );
+			fill( hidden2Biases, Nnue::hiddenDimensions, -500, 500 );
+			fill( hidden2Weights, Nnue::hiddenDimensions * Nnue::hiddenDimensions, -128, 127 );
+			outputBias = std::uniform_int_distribution< int >( -1000, 1000 )( rnd );
+			fill( outputWeights, Nnue::hiddenDimensions, -128, 127 );
+		}
+
+		template< typename T >
+		static void write( std::ostream& s, const T* v, const size_t size )
+		{
+			s.write( reinterpret_cast< const char* >( v ), size * sizeof( T ) );
+		}
+
+		std::string serialize() const
+		{
+			std::ostringstream s;
+			write( s, &Nnue::fileMagic, 1 );
+			write( s, &Nnue::fileVersion, 1 );
+			write( s, featureBiases.data(), featureBiases.size() );
+			write( s, featureWeights.data(), featureWeights.size() );
+			write( s, hidden1Biases.data(), hidden1Biases.size() );
+			write( s, hidden1Weights.data(), hidden1Weights.size() );
+			write( s, hidden2Biases.data(), hidden2Biases.size() );
+			write( s, hidden2Weights.data(), hidden2Weights.size() );
+			write( s, &outputBias, 1 );
+			write( s, outputWeights.data(), outputWeights.size() );
+			return s.str();
+		}
+
+		bool load() const
+		{
+			std::istringstream s( serialize() );
+			return Nnue::load( s );
+		}
+
+		static unsigned int featureIndex( const bool white, const baseTypes::tSquare king, const baseTypes::bitboardIndex piece, const baseTypes::tSquare sq )
+		{
+			// queen, rook, bishop, knight, pawn of the perspective, then the opponent ones
+			const unsigned int flip = white ? 0 : 56;
+			const unsigned int pieceIndex = ( piece & 7 ) - 2 + ( baseTypes::isWhitePiece( piece ) == white ? 0 : 5 );
+			return ( ( king ^ flip ) * 10 + pieceIndex ) * 64 + ( sq ^ flip );
+		}
+
+		std::vector< int > accumulate( const Position& pos, const bool white ) const
+		{
+			std::vector< int > acc( featureBiases.begin(), featureBiases.end() );
+			const baseTypes::tSquare king = pos.getSquareOfThePiece( white ? baseTypes::whiteKing : baseTypes::blackKing );
+			for( auto sq : baseTypes::tSquareRange() )
+			{
+				const baseTypes::bitboardIndex piece = pos.getPieceAt( sq );
+				if( piece != baseTypes::empty && !baseTypes::isKing( piece ) )
+				{
+					const unsigned int index = featureIndex( white, king, piece, sq );
+					for( unsigned int i = 0; i < Nnue::halfDimensions; ++i )
+					{
+						acc[ i ] += featureWeights[ index * Nnue::halfDimensions + i ];
+					}
+				}
+			}
+			return acc;
+		}
+
+		static std::vector< int > layer( const std::vector< int >& in, const std::vector< int8_t >& w, const std::vector< int32_t >& b )
+		{
+			std::vector< int > out( b.begin(), b.end() );
+			for( unsigned int o = 0; o < out.size(); ++o )
+			{
+				for( unsigned int i = 0; i < in.size(); ++i )
+				{
+					out[ o ] += in[ i ] * w[ o * in.size() + i ];
+				}
+			}
+			return out;
+		}
+
+		static std::vector< int > clip( std::vector< int > v, const int shift )
+		{
+			for( auto& x : v )
+			{
+				x = std::min( std::max( x >> shift, 0 ), 127 );
+			}
+			return v;
+		}
+
+		Score evaluate( const Position& pos ) const
+		{
+			std::vector< int > input = clip( accumulate( pos, pos.isWhiteTurn() ), 0 );
+			const std::vector< int > them = clip( accumulate( pos, !pos.isWhiteTurn() ), 0 );
+			input.insert( input.end(), them.begin(), them.end() );
+
+			const std::vector< int > h1 = clip( layer( input, hidden1Weights, hidden1Biases ), 6 );
+			const std::vector< int > h2 = clip( layer( h1, hidden2Weights, hidden2Biases ), 6 );
+			const std::vector< int > out = layer( h2, outputWeights, std::vector< int32_t >{ outputBias } );
+			return out[ 0 ] / 16;
+		}
+	};
+
+	const TestNetwork& getNetwork( const unsigned int n )
+	{
+		static const TestNetwork first( 1 );
+		static const TestNetwork second( 2 );
+		return n == 0 ? first : second;
+	}
+
+	const std::vector< std::string > fens = {
+		"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+		"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+		"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+		"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+		"rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8"
+	};
+
+	TEST(Nnue, loadRejectsInvalidStreams)
+	{
+		Nnue::unload();
+		std::istringstream empty( "" );
+		ASSERT_FALSE( Nnue::load( empty ) );
+
+		std::string data = getNetwork( 0 ).serialize();
+
+		std::string wrongMagic = data;
+		wrongMagic[ 0 ] ^= 1;
+		std::istringstream s1( wrongMagic );
+		ASSERT_FALSE( Nnue::load( s1 ) );
+
+		std::istringstream s2( data.substr( 0, data.size() - 1 ) );
+		ASSERT_FALSE( Nnue::load( s2 ) );
+
+		std::istringstream s3( data + "x" );
+		ASSERT_FALSE( Nnue::load( s3 ) );
+
+		ASSERT_FALSE( Nnue::isLoaded() );
+		ASSERT_FALSE( Nnue::load( "missing.nnue" ) );
+		ASSERT_FALSE( Nnue::isLoaded() );
+
+		std::istringstream s4( data );
+		ASSERT_TRUE( Nnue::load( s4 ) );
+		ASSERT_TRUE( Nnue::isLoaded() );
+		Nnue::unload();
+		ASSERT_FALSE( Nnue::isLoaded() );
+	}
+
+	TEST(Nnue, featureIndex)
+	{
+		ASSERT_EQ( ( 4 * 10 + 4 ) * 64 + 12, Nnue::getFeatureIndex( baseTypes::whiteTurn, baseTypes::E1, baseTypes::whitePawns, baseTypes::E2 ) );
+		ASSERT_EQ( ( 4 * 10 + 9 ) * 64 + 52, Nnue::getFeatureIndex( baseTypes::whiteTurn, baseTypes::E1, baseTypes::blackPawns, baseTypes::E7 ) );
+		// the black perspective sees the board flipped
+		ASSERT_EQ( Nnue::getFeatureIndex( baseTypes::whiteTurn, baseTypes::E1, baseTypes::whiteQueens, baseTypes::D1 ), Nnue::getFeatureIndex( baseTypes::blackTurn, baseTypes::E8, baseTypes::blackQueens, baseTypes::D8 ) );
+		ASSERT_EQ( Nnue::getFeatureIndex( baseTypes::whiteTurn, baseTypes::G1, baseTypes::blackKnights, baseTypes::F6 ), Nnue::getFeatureIndex( baseTypes::blackTurn, baseTypes::G8, baseTypes::whiteKnights, baseTypes::F3 ) );
+		ASSERT_LT( Nnue::getFeatureIndex( baseTypes::blackTurn, baseTypes::A1, baseTypes::whitePawns, baseTypes::H1 ), Nnue::featuresNumber );
+	}
+
+	TEST(Nnue, evaluate)
+	{
+		const TestNetwork& net = getNetwork( 0 );
+		ASSERT_TRUE( net.load() );
+		Position pos;
+		for( const auto& fen : fens )
+		{
+			pos.setupFromFen( fen );
+			ASSERT_EQ( net.evaluate( pos ), Nnue::evaluate( pos ) );
+		}
+
+		// the evaluation is symmetric
+		Position mirrored;
+		pos.setupFromFen( "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1" );
+		mirrored.setupFromFen( "r3k2r/pppbbppp/2n2q1P/1P2p3/3pn3/BN2PNP1/P1PPQPB1/R3K2R b KQkq - 0 1" );
+		ASSERT_EQ( Nnue::evaluate( pos ), Nnue::evaluate( mirrored ) );
+		pos.setupFromFen( "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 b - - 0 1" );
+		mirrored.setupFromFen( "8/4p1p1/8/1r3P1K/kp5R/3P4/2P5/8 w - - 0 1" );
+		ASSERT_EQ( Nnue::evaluate( pos ), Nnue::evaluate( mirrored ) );
+		Nnue::unload();
+	}
+
+	TEST(Nnue, incrementalUpdate)
+	{
+		const TestNetwork& net = getNetwork( 0 );
+		ASSERT_TRUE( net.load() );
+		std::mt19937 rnd( 42 );
+		Position pos;
+		for( const auto& fen : fens )
+		{
+			pos.setupFromFen( fen );
+			const Score rootEval = Nnue::evaluate( pos );
+			unsigned int plies = 0;
+			for( unsigned int i = 0; i < 60; ++i )
+			{
+				MoveList< MoveSelector::maxMovePerPosition > ml;
+				MoveGenerator::generateMoves< MoveGenerator::allMg >( pos, ml );
+				if( ml.size() == 0 )
+				{
+					break;
+				}
+				pos.doMove( ml.get( rnd() % ml.size() ) );
+				++plies;
+				ASSERT_EQ( net.evaluate( pos ), Nnue::evaluate( pos ) );
+
+				// sometimes take back the move, the accumulator shall follow
+				if( rnd() % 4 == 0 )
+				{
+					pos.undoMove();
+					--plies;
+					ASSERT_EQ( net.evaluate( pos ), Nnue::evaluate( pos ) );
+				}
+			}
+			while( plies-- )
+			{
+				pos.undoMove();
+			}
+			ASSERT_EQ( rootEval, Nnue::evaluate( pos ) );
+		}
+		Nnue::unload();
+	}
+
+	TEST(Nnue, lazyUpdate)
+	{
+		const TestNetwork& net = getNetwork( 0 );
+		ASSERT_TRUE( net.load() );
+		std::mt19937 rnd( 7 );
+		Position pos;
+		for( const auto& fen : fens )
+		{
+			pos.setupFromFen( fen );
+			ASSERT_EQ( net.evaluate( pos ), Nnue::evaluate( pos ) );
+			// play some moves before evaluating, the accumulator is updated through all of them
+			std::vector< Score > evals;
+			for( unsigned int i = 0; i < 40; ++i )
+			{
+				MoveList< MoveSelector::maxMovePerPosition > ml;
+				MoveGenerator::generateMoves< MoveGenerator::allMg >( pos, ml );
+				if( ml.size() == 0 )
+				{
+					break;
+				}
+				if( i % 7 == 3 && !pos.isInCheck() )
+				{
+					pos.doNullMove();
+				}
+				else
+				{
+					pos.doMove( ml.get( rnd() % ml.size() ) );
+				}
+				evals.push_back( net.evaluate( pos ) );
+				if( i % 5 == 4 )
+				{
+					ASSERT_EQ( evals.back(), Nnue::evaluate( pos ) );
+				}
+			}
+			// going back the accumulators computed on the way are reused, the others are updated from them
+			while( !evals.empty() )
+			{
+				ASSERT_EQ( evals.back(), Nnue::evaluate( pos ) );
+				evals.pop_back();
+				if( pos.getActualStateConst().getCurrentMove() == Move::NOMOVE )
+				{
+					pos.undoNullMove();
+				}
+				else
+				{
+					pos.undoMove();
+				}
+			}
+			ASSERT_EQ( net.evaluate( pos ), Nnue::evaluate( pos ) );
+		}
+		Nnue::unload();
+	}
+
+	TEST(Nnue, castlingAndPromotionDeltas)
+	{
+		const TestNetwork& net = getNetwork( 0 );
+		ASSERT_TRUE( net.load() );
+		Position pos;
+		pos.setupFromFen( "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 b kq - 0 1" );
+		ASSERT_EQ( net.evaluate( pos ), Nnue::evaluate( pos ) );
+		// capture with promotion, then castling
+		pos.doMove( Move( baseTypes::B2, baseTypes::A1, Move::fpromotion, Move::promQueen ) );
+		pos.doMove( Move( baseTypes::D1, baseTypes::A1 ) );
+		pos.doMove( Move( baseTypes::E8, baseTypes::H8, Move::fcastle ) );
+		ASSERT_EQ( net.evaluate( pos ), Nnue::evaluate( pos ) );
+		pos.undoMove();
+		ASSERT_EQ( net.evaluate( pos ), Nnue::evaluate( pos ) );
+		pos.undoMove();
+		pos.undoMove();
+		ASSERT_EQ( net.evaluate( pos ), Nnue::evaluate( pos ) );
+		Nnue::unload();
+	}
+
+	TEST(Nnue, reloadInvalidatesAccumulators)
+	{
+		Position pos;
+		pos.setupFromFen( fens[ 1 ] );
+		ASSERT_TRUE( getNetwork( 0 ).load() );
+		ASSERT_EQ( getNetwork( 0 ).evaluate( pos ), Nnue::evaluate( pos ) );
+		ASSERT_TRUE( getNetwork( 1 ).load() );
+		ASSERT_EQ( getNetwork( 1 ).evaluate( pos ), Nnue::evaluate( pos ) );
+		Nnue::unload();
+	}
+
+	TEST(Nnue, evalUsesTheNetwork)
+	{
+		Position pos;
+		pos.setupFromFen();
+		ASSERT_EQ( Eval::tempo, Eval::evaluate( pos ) );
+
+		ASSERT_TRUE( getNetwork( 0 ).load() );
+		ASSERT_EQ( std::min( std::max( getNetwork( 0 ).evaluate( pos ), -Eval::knownWin + 1 ), Eval::knownWin - 1 ), Eval::evaluate( pos ) );
+
+		// king and pawn vs king is still scored by the bitbase
+		pos.setupFromFen( "8/8/8/4k3/8/8/4P3/4K3 w - - 0 1" );
+		Nnue::unload();
+		const Score kpk = Eval::evaluate( pos );
+		ASSERT_TRUE( getNetwork( 0 ).load() );
+		ASSERT_EQ( kpk, Eval::evaluate( pos ) );
+
+		Nnue::unload();
+		pos.setupFromFen();
+		ASSERT_EQ( Eval::tempo, Eval::evaluate( pos ) );
+	}
+}
@@ -0,0 +1,82 @@
+/*
+	This file is part of Vajolet.
+
+    Vajolet is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Vajolet is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#include <fstream>
+#include "gtest/gtest.h"
+#include "./../MoveSelector.h"
+#include "./../PackedPosition.h"
+#include "./../Position.h"
+
+using namespace libChess;
+
+namespace {
+
+	TEST(PackedPosition, startPosition)
+	{
+		Position pos;
+		pos.setupFromFen();
+		PackedPosition packed( pos );
+		ASSERT_EQ( pos.getFen(), packed.getFen() );
+		ASSERT_FALSE( packed == PackedPosition() );
+	}
+
+	TEST(PackedPosition, counters)
+	{
+		Position pos;
+		pos.setupFromFen( "r3k2r/8/8/3pP3/8/8/8/R3K2R w Kq d6 37 120" );
+		ASSERT_EQ( "r3k2r/8/8/3pP3/8/8/8/R3K2R w Kq d6 37 120", PackedPosition( pos ).getFen() );
+
+		// stored and read back
+		const PackedPosition packed( pos );
+		ASSERT_TRUE( packed == PackedPosition( packed.getData() ) );
+	}
+
+	TEST(PackedPosition, roundTrip)
+	{
+		std::ifstream infile("perft.txt");
+		ASSERT_FALSE(infile.fail());
+
+		Position pos;
+		Position unpacked;
+		std::string line;
+		while (std::getline(infile, line))
+		{
+			pos.setupFromFen( line.substr(0, line.find_first_of(",")) );
+			// the position and its children, with en passant squares and castle rights changes
+			MoveSelector ms( pos );
+			Move m = Move::NOMOVE;
+			do
+			{
+				const PackedPosition packed( pos );
+				unpacked.setupFromFen( packed.getFen() );
+				ASSERT_EQ( pos.getFen(), unpacked.getFen() );
+				ASSERT_TRUE( packed == PackedPosition( unpacked ) );
+
+				if( m != Move::NOMOVE )
+				{
+					pos.undoMove();
+				}
+				m = ms.getNextMove();
+				if( m != Move::NOMOVE )
+				{
+					pos.doMove( m );
+				}
+			}
+			while( m != Move::NOMOVE );
+		}
+	}
+}
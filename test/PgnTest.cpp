@@ -0,0 +1,173 @@
+/*
+	This file is part of Vajolet.
+
+    Vajolet is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Vajolet is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
+*/
+#include <string>
+#include "gtest/gtest.h"
+#include "./../Position.h"
+#include "./../tools/Pgn.h"
+
+using namespace libChess;
+using namespace tools;
+
+namespace {
+
+	const std::string threeGames =
+		"some text before the first game\n"
+		"[Event \"first\"]\n"
+		"[Result \"1-0\"]\n"
+		"\n"
+		"1. e4 e5 2. Qh5 Nc6 3. Bc4 Nf6 4. Qxf7# 1-0\n"
+		"\n"
+		"[Event \"second\"]\n"
+		"[Result \"1/2-1/2\"]\n"
+		"\n"
+		"1. d4 { a comment with [Event \"inside\"] } d5 1/2-1/2\n"
+		"\n"
+		"[Event \"third\"]\n"
+		"[Result \"*\"]\n"
+		"\n"
+		"1. c4 *\n";
+
+	TEST(Pgn, readGames)
+	{
+		PgnReader reader( threeGames );
+		std::string_view text;
+		Position pos;
+		PgnGame game;
+
+		ASSERT_TRUE( reader.getNextGame( text ) );
+		ASSERT_EQ( 0u, text.find( "[Event \"first\"]" ) );
+		ASSERT_TRUE( parsePgnGame( text, pos, game ) );
+		ASSERT_EQ( 7u, game.moves.size() );
+		ASSERT_EQ( GameResult::whiteWins, game.result );
+		ASSERT_TRUE( game.error.empty() );
+
+		// an [Event inside a line doesn't start a game
+		ASSERT_TRUE( reader.getNextGame( text ) );
+		ASSERT_EQ( 0u, text.find( "[Event \"second\"]" ) );
+		ASSERT_TRUE( parsePgnGame( text, pos, game ) );
+		ASSERT_EQ( 2u, game.moves.size() );
+		ASSERT_EQ( GameResult::draw, game.result );
+
+		ASSERT_TRUE( reader.getNextGame( text ) );
+		ASSERT_EQ( 0u, text.find( "[Event \"third\"]" ) );
+		ASSERT_TRUE( parsePgnGame( text, pos, game ) );
+		ASSERT_EQ( 1u, game.moves.size() );
+		ASSERT_EQ( GameResult::none, game.result );
+
+		ASSERT_FALSE( reader.getNextGame( text ) );
+	}
+
+	TEST(Pgn, split)
+	{
+		const size_t first = threeGames.find( "[Event" );
+		for( unsigned int parts = 1; parts <= 10; ++parts )
+		{
+			const auto chunks = PgnReader::split( threeGames, parts );
+			ASSERT_GE( chunks.size(), 1u );
+			ASSERT_LE( chunks.size(), std::min( parts, 3u ) );
+
+			// the chunks start at a game and cover the text from the first game, in order
+			std::string joined;
+			unsigned int games = 0;
+			for( const auto& chunk : chunks )
+			{
+				ASSERT_EQ( 0u, chunk.find( "[Event " ) );
+				joined += chunk;
+				PgnReader reader( chunk );
+				std::string_view text;
+				while( reader.getNextGame( text ) )
+				{
+					++games;
+				}
+			}
+			ASSERT_EQ( threeGames.substr( first ), joined );
+			ASSERT_EQ( 3u, games );
+		}
+		ASSERT_TRUE( PgnReader::split( "no games here", 4 ).empty() );
+	}
+
+	TEST(Pgn, commentsAndVariations)
+	{
+		const std::string text =
+			"[Event \"annotated\"]\n"
+			"[Result \"0-1\"]\n"
+			"\n"
+			"1.e4 {best by test} e5 $1 2. Nf3 ; a rest of line comment 3. d4\n"
+			"Nc6 (2... d6 (2... Nf6 3. Nxe5) 3. d4) 3. Bb5 $14 a6 4. Ba4 Nf6 5. O-O Be7 0-1\n";
+		Position pos;
+		PgnGame game;
+		// the moves after ; and inside the variations are skipped
+		ASSERT_TRUE( parsePgnGame( text, pos, game ) );
+		ASSERT_EQ( 10u, game.moves.size() );
+		ASSERT_EQ( GameResult::blackWins, game.result );
+		ASSERT_EQ( "r1bqk2r/1pppbppp/p1n2n2/4p3/B3P3/5N2/PPPP1PPP/RNBQ1RK1 w kq - 4 6", pos.getFen() );
+	}
+
+	TEST(Pgn, fenAndCastling)
+	{
+		const std::string text =
+			"[Event \"castling\"]\n"
+			"[FEN \"r3k2r/pppq1ppp/8/8/8/8/PPPQ1PPP/R3K2R b KQkq - 0 12\"]\n"
+			"\n"
+			"12... 0-0-0 13. 0-0 Kb8 14. O-O-O *\n";
+		Position pos;
+		PgnGame game;
+		ASSERT_FALSE( parsePgnGame( text, pos, game ) );
+		ASSERT_EQ( "r3k2r/pppq1ppp/8/8/8/8/PPPQ1PPP/R3K2R b KQkq - 0 12", game.fen );
+		// white has already castled
+		ASSERT_EQ( "illegal move O-O-O at ply 4", game.error );
+		ASSERT_EQ( 3u, game.moves.size() );
+		ASSERT_EQ( "1k1r3r/pppq1ppp/8/8/8/8/PPPQ1PPP/R4RK1 w - - 3 14", pos.getFen() );
+
+		const std::string castled =
+			"[Event \"castling\"]\n"
+			"[FEN \"r3k2r/pppq1ppp/8/8/8/8/PPPQ1PPP/R3K2R b KQkq - 0 12\"]\n"
+			"\n"
+			"12... 0-0-0 13. 0-0 *\n";
+		ASSERT_TRUE( parsePgnGame( castled, pos, game ) );
+		ASSERT_EQ( 2u, game.moves.size() );
+		ASSERT_TRUE( game.moves[ 0 ].isCastleMove() );
+		ASSERT_TRUE( game.moves[ 1 ].isCastleMove() );
+	}
+
+	TEST(Pgn, illegalMove)
+	{
+		const std::string text =
+			"[Event \"illegal\"]\n"
+			"\n"
+			"1. e4 e5 2. Ke3 Nc6 *\n";
+		Position pos;
+		PgnGame game;
+		ASSERT_FALSE( parsePgnGame( text, pos, game ) );
+		ASSERT_EQ( "illegal move Ke3 at ply 3", game.error );
+		ASSERT_EQ( 2u, game.moves.size() );
+	}
+
+	TEST(Pgn, invalidFen)
+	{
+		const std::string text =
+			"[Event \"invalid\"]\n"
+			"[FEN \"not a fen\"]\n"
+			"\n"
+			"1. e4 *\n";
+		Position pos;
+		PgnGame game;
+		ASSERT_FALSE( parsePgnGame( text, pos, game ) );
+		ASSERT_FALSE( game.error.empty() );
+		ASSERT_TRUE( game.moves.empty() );
+	}
+}
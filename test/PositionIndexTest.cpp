@@ -0,0 +1,184 @@
+/*
+	This file is part of Vajolet.
+
+    Vajolet is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Vajolet is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
+*/
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "./../tools/PositionIndex.h"
+
+using namespace tools;
+
+namespace {
+
+	const std::string indexName = "positionIndexTest";
+	// memory used by the writer besides the sort buffer
+	const size_t outputBufferSize = PositionIndexWriter::mergeBufferEntries * sizeof( PositionIndexEntry );
+
+	/*! \brief entries with uniform keys, repeated keys and the smallest and biggest keys
+	*
+	*/
+	std::vector< PositionIndexEntry > getEntries()
+	{
+		std::mt19937_64 rnd( 42 );
+		std::vector< PositionIndexEntry > entries;
+		for( uint32_t game = 0; game < 2000; ++game )
+		{
+			entries.push_back( { rnd(), game, 1 } );
+		}
+		// the same position in many games and twice in a game
+		for( uint32_t game = 0; game < 300; ++game )
+		{
+			entries.push_back( { 0x123456789ABCDEFull, game, 5 } );
+		}
+		entries.push_back( { 0x123456789ABCDEFull, 7, 9 } );
+		entries.push_back( { 0, 3, 0 } );
+		entries.push_back( { 0, 4, 0 } );
+		entries.push_back( { UINT64_MAX, 5, 2 } );
+		std::shuffle( entries.begin(), entries.end(), rnd );
+		return entries;
+	}
+
+	void writeIndex( const std::vector< PositionIndexEntry >& entries, PositionIndexWriter& writer )
+	{
+		ASSERT_TRUE( writer.open( indexName ) );
+		// entries added in pieces of different sizes
+		for( size_t first = 0, size = 1; first < entries.size(); first += size, size = size * 2 + 1 )
+		{
+			const size_t last = std::min( first + size, entries.size() );
+			ASSERT_TRUE( writer.add( std::vector< PositionIndexEntry >( entries.begin() + first, entries.begin() + last ) ) );
+		}
+		ASSERT_TRUE( writer.close() );
+		ASSERT_EQ( entries.size(), writer.getEntriesNumber() );
+	}
+
+	bool areEqual( const PositionIndexEntry& a, const PositionIndexEntry& b )
+	{
+		return a.key == b.key && a.game == b.game && a.ply == b.ply;
+	}
+
+	TEST(PositionIndex, externalSort)
+	{
+		const std::vector< PositionIndexEntry > entries = getEntries();
+		std::vector< PositionIndexEntry > sorted = entries;
+		std::sort( sorted.begin(), sorted.end() );
+
+		// room for 100 entries, a lot of runs merged 2 at a time
+		PositionIndexWriter writer( outputBufferSize + 100 * sizeof( PositionIndexEntry ), 3 );
+		writeIndex( entries, writer );
+		ASSERT_EQ( ( entries.size() + 99 ) / 100, writer.getRunsNumber() );
+		ASSERT_GT( writer.getMergePassesNumber(), 1u );
+
+		// the temporary runs are removed
+		std::FILE* run = std::fopen( ( indexName + ".run0" ).c_str(), "rb" );
+		ASSERT_EQ( nullptr, run );
+
+		PositionIndex index;
+		ASSERT_TRUE( index.open( indexName ) );
+		ASSERT_EQ( sorted.size(), index.getEntriesNumber() );
+		ASSERT_TRUE( std::equal( sorted.begin(), sorted.end(), index.begin(), areEqual ) );
+
+		// a single run, sorted in chunks by 4 threads, gives the same file
+		PositionIndexWriter bigWriter( 1 << 20, 4 );
+		writeIndex( entries, bigWriter );
+		ASSERT_EQ( 1u, bigWriter.getRunsNumber() );
+		ASSERT_EQ( 0u, bigWriter.getMergePassesNumber() );
+		PositionIndex singleRun;
+		ASSERT_TRUE( singleRun.open( indexName ) );
+		ASSERT_TRUE( std::equal( sorted.begin(), sorted.end(), singleRun.begin(), areEqual ) );
+
+		std::remove( PositionIndex::getFileName( indexName ).c_str() );
+	}
+
+	TEST(PositionIndex, find)
+	{
+		const std::vector< PositionIndexEntry > entries = getEntries();
+		std::vector< PositionIndexEntry > sorted = entries;
+		std::sort( sorted.begin(), sorted.end() );
+
+		PositionIndexWriter writer( outputBufferSize + 1000 * sizeof( PositionIndexEntry ), 2 );
+		writeIndex( entries, writer );
+		PositionIndex index;
+		ASSERT_TRUE( index.open( indexName ) );
+
+		auto check = [&]( const uint64_t key, const size_t count )
+		{
+			const auto range = index.find( key );
+			ASSERT_EQ( count, size_t( range.second - range.first ) ) << key;
+			const auto expected = std::equal_range( sorted.begin(), sorted.end(), PositionIndexEntry{ key, 0, 0 },
+				[]( const PositionIndexEntry& a, const PositionIndexEntry& b ){ return a.key < b.key; } );
+			ASSERT_EQ( size_t( expected.first - sorted.begin() ), size_t( range.first - index.begin() ) ) << key;
+		};
+
+		// every key present
+		for( const auto& entry : entries )
+		{
+			check( entry.key, entry.key == 0x123456789ABCDEFull ? 301 : ( entry.key == 0 ? 2 : 1 ) );
+		}
+
+		// the edges
+		check( 0, 2 );
+		check( 1, 0 );
+		check( UINT64_MAX, 1 );
+		check( UINT64_MAX - 1, 0 );
+
+		// repeated keys are sorted by game and ply
+		const auto repeated = index.find( 0x123456789ABCDEFull );
+		ASSERT_EQ( 0u, repeated.first->game );
+		ASSERT_EQ( 7u, repeated.first[ 7 ].game );
+		ASSERT_EQ( 5u, repeated.first[ 7 ].ply );
+		ASSERT_EQ( 9u, repeated.first[ 8 ].ply );
+
+		// keys not present, between the keys of the index
+		std::mt19937_64 rnd( 7 );
+		for( unsigned int i = 0; i < 1000; ++i )
+		{
+			const uint64_t key = rnd();
+			const bool present = std::binary_search( sorted.begin(), sorted.end(), PositionIndexEntry{ key, 0, 0 },
+				[]( const PositionIndexEntry& a, const PositionIndexEntry& b ){ return a.key < b.key; } );
+			ASSERT_FALSE( present );
+			check( key, 0 );
+		}
+		for( size_t i = 1; i < sorted.size(); ++i )
+		{
+			if( sorted[ i ].key - sorted[ i - 1 ].key > 1 )
+			{
+				check( sorted[ i ].key - 1, 0 );
+				check( sorted[ i - 1 ].key + 1, 0 );
+			}
+		}
+
+		std::remove( PositionIndex::getFileName( indexName ).c_str() );
+	}
+
+	TEST(PositionIndex, emptyIndex)
+	{
+		PositionIndexWriter writer( 1 << 10, 1 );
+		ASSERT_TRUE( writer.open( indexName ) );
+		ASSERT_TRUE( writer.close() );
+
+		PositionIndex index;
+		ASSERT_TRUE( index.open( indexName ) );
+		ASSERT_EQ( 0u, index.getEntriesNumber() );
+		const auto range = index.find( 12345 );
+		ASSERT_EQ( range.first, range.second );
+
+		std::remove( PositionIndex::getFileName( indexName ).c_str() );
+		ASSERT_FALSE( index.open( indexName ) );
+	}
+}
@@ -16,10 +16,12 @@
 */
 
 #include <fstream>
+#include <sstream>
 #include "gtest/gtest.h"
 #include "./../tSquare.h"
 #include "./../Position.h"
 #include "./../MoveGenerator.h"
+#include "./../MoveSelector.h"
 
 
 
@@ -255,6 +257,136 @@ namespace {
 		
 	}
     
+	TEST(Position, materialValue)
+	{
+		Position p;
+		p.setupFromFen();
+		simdScore material = p.getActualStateConst().getMaterialValue();
+		simdScore nonPawnMaterial = p.getActualStateConst().getNonPawnMaterialValue();
+		ASSERT_EQ( 0, material[0] );
+		ASSERT_EQ( 0, material[1] );
+		ASSERT_EQ( nonPawnMaterial[0], nonPawnMaterial[2] );
+		ASSERT_EQ( nonPawnMaterial[1], nonPawnMaterial[3] );
+		ASSERT_GT( nonPawnMaterial[0], 0 );
+		
+		// white knight capture a black bishop
+		p.setupFromFen("4k3/8/8/3b4/8/4N3/8/4K3 w - - 0 1");
+		const simdScore startMaterial = p.getActualStateConst().getMaterialValue();
+		const simdScore startNonPawnMaterial = p.getActualStateConst().getNonPawnMaterialValue();
+		ASSERT_EQ( startMaterial[0], startNonPawnMaterial[0] - startNonPawnMaterial[2] );
+		p.doMove( Move( baseTypes::E3, baseTypes::D5 ) );
+		ASSERT_EQ( 0, p.getActualStateConst().getNonPawnMaterialValue()[2] );
+		ASSERT_EQ( startNonPawnMaterial[0], p.getActualStateConst().getNonPawnMaterialValue()[0] );
+		ASSERT_EQ( startNonPawnMaterial[0], p.getActualStateConst().getMaterialValue()[0] );
+		p.undoMove();
+		ASSERT_EQ( startMaterial[0], p.getActualStateConst().getMaterialValue()[0] );
+		ASSERT_EQ( startNonPawnMaterial[2], p.getActualStateConst().getNonPawnMaterialValue()[2] );
+		
+		// promotion
+		p.setupFromFen("4k3/1P6/8/8/8/8/8/4K3 w - - 0 1");
+		const Score pawnValue = p.getActualStateConst().getMaterialValue()[0];
+		ASSERT_EQ( 0, p.getActualStateConst().getNonPawnMaterialValue()[0] );
+		Move promotion( baseTypes::B7, baseTypes::B8, Move::fpromotion, Move::promQueen );
+		p.doMove( promotion );
+		const Score queenValue = p.getActualStateConst().getMaterialValue()[0];
+		ASSERT_GT( queenValue, pawnValue );
+		ASSERT_EQ( queenValue, p.getActualStateConst().getNonPawnMaterialValue()[0] );
+		
+		// the incremental value is the same of a position created from scratch
+		Position p2;
+		p2.setupFromFen( p.getFen() );
+		ASSERT_EQ( queenValue, p2.getActualStateConst().getMaterialValue()[0] );
+	}
+	
+	TEST(Position, nullMove)
+	{
+		std::ifstream infile("perft.txt");
+		ASSERT_FALSE(infile.fail());
+		
+		Position pos;
+		Position swapped;
+		
+		std::string line;
+		while (std::getline(infile, line))
+		{
+			std::string fen = line.substr(0, line.find_first_of(","));
+			pos.setupFromFen( fen );
+			if( pos.isInCheck() )
+			{
+				continue;
+			}
+			
+			// same position with the other side to move and without en passant square
+			std::istringstream ss( fen );
+			std::string board, turn, castle, ep;
+			ss >> board >> turn >> castle >> ep;
+			swapped.setupFromFen( board + ( turn == "w" ? " b " : " w " ) + castle + " -" );
+			
+			const HashKey key = pos.getActualStateConst().getKey();
+			const std::string originalFen = pos.getFen();
+			pos.doNullMove();
+			
+			const GameState& st = pos.getActualStateConst();
+			const GameState& st2 = swapped.getActualStateConst();
+			ASSERT_EQ( st2.getKey(), st.getKey() );
+			ASSERT_EQ( st2.getPinned(), st.getPinned() );
+			ASSERT_EQ( st2.getDiscoveryCheckers(), st.getDiscoveryCheckers() );
+			ASSERT_EQ( 0u, st.getPliesFromNullCnt() );
+			ASSERT_EQ( Move::NOMOVE, st.getCurrentMove() );
+			
+			libChess::MoveList< libChess::MoveSelector::maxMovePerPosition > ml;
+			libChess::MoveGenerator::generateMoves< libChess::MoveGenerator::allMg >( pos, ml );
+			ASSERT_EQ( swapped.getNumberOfLegalMoves(), ml.size() );
+			for( const auto& m : ml )
+			{
+				ASSERT_EQ( swapped.moveGivesCheck( m ), pos.moveGivesCheck( m ) );
+				
+				// the moves after the null move shall detect the checks
+				pos.doMove( m );
+				swapped.doMove( m );
+				ASSERT_EQ( swapped.getActualStateConst().getCheckers(), pos.getActualStateConst().getCheckers() );
+				swapped.undoMove();
+				pos.undoMove();
+			}
+			
+			pos.undoNullMove();
+			ASSERT_EQ( key, pos.getActualStateConst().getKey() );
+			ASSERT_STREQ( originalFen.c_str(), pos.getFen().c_str() );
+		}
+	}
+	
+	TEST(Position, seeGreaterOrEqual)
+	{
+		Position pos;
+		// undefended pawn
+		pos.setupFromFen("1k1r4/1pp4p/p7/4p3/8/P5P1/1PP4P/2K1R3 w - - 0 1");
+		ASSERT_TRUE( pos.seeGreaterOrEqual( Move( baseTypes::E1, baseTypes::E5 ), 100 ) );
+		ASSERT_FALSE( pos.seeGreaterOrEqual( Move( baseTypes::E1, baseTypes::E5 ), 101 ) );
+		
+		// pawn defended by a pawn
+		pos.setupFromFen("4k3/8/3p4/4p3/8/8/8/4RK2 w - - 0 1");
+		ASSERT_FALSE( pos.seeGreaterOrEqual( Move( baseTypes::E1, baseTypes::E5 ), 0 ) );
+		ASSERT_TRUE( pos.seeGreaterOrEqual( Move( baseTypes::E1, baseTypes::E5 ), -500 ) );
+		ASSERT_FALSE( pos.seeGreaterOrEqual( Move( baseTypes::E1, baseTypes::E5 ), -499 ) );
+		
+		// the second rook is discovered as x-ray attacker
+		pos.setupFromFen("4k3/4r3/8/4p3/8/8/4R3/4RK2 w - - 0 1");
+		ASSERT_TRUE( pos.seeGreaterOrEqual( Move( baseTypes::E2, baseTypes::E5 ), 100 ) );
+		ASSERT_FALSE( pos.seeGreaterOrEqual( Move( baseTypes::E2, baseTypes::E5 ), 101 ) );
+		
+		// the king can't recapture a defended piece
+		pos.setupFromFen("4k3/8/8/8/8/4r3/3K4/4R3 b - - 0 1");
+		ASSERT_FALSE( pos.seeGreaterOrEqual( Move( baseTypes::E3, baseTypes::E1 ), 1 ) );
+		pos.setupFromFen("4k3/4r3/8/8/8/4r3/3K4/4R3 b - - 0 1");
+		ASSERT_TRUE( pos.seeGreaterOrEqual( Move( baseTypes::E3, baseTypes::E1 ), 600 ) );
+		
+		// quiet move to a square attacked by a pawn
+		pos.setupFromFen("4k3/8/3p4/8/4N3/8/8/4K3 w - - 0 1");
+		ASSERT_TRUE( pos.seeGreaterOrEqual( Move( baseTypes::E4, baseTypes::C3 ), 0 ) );
+		ASSERT_FALSE( pos.seeGreaterOrEqual( Move( baseTypes::E4, baseTypes::C5 ), 0 ) );
+		ASSERT_TRUE( pos.seeGreaterOrEqual( Move( baseTypes::E4, baseTypes::C5 ), -390 ) );
+	}
+	
     void testIsLegal( libChess::MoveList< libChess::MoveSelector::maxMovePerPosition >& ml, const Move& m, const Position& pos)
     {
         if( std::find( ml.begin(), ml.end(), m ) != ml.end() )
@@ -321,4 +453,154 @@ namespace {
 
 		}
 	}
+
+	TEST(Position, repetition)
+	{
+		Position pos;
+		pos.setupFromFen();
+		pos.doMove( Move( baseTypes::tSquare::G1, baseTypes::tSquare::F3 ) );
+		pos.doMove( Move( baseTypes::tSquare::G8, baseTypes::tSquare::F6 ) );
+		pos.doMove( Move( baseTypes::tSquare::F3, baseTypes::tSquare::G1 ) );
+		ASSERT_FALSE( pos.isRepetition( 100 ) );
+		// black can repeat the starting position, only a cycle after the root is reported
+		ASSERT_TRUE( pos.hasUpcomingRepetition( 4 ) );
+		ASSERT_FALSE( pos.hasUpcomingRepetition( 3 ) );
+
+		pos.doMove( Move( baseTypes::tSquare::F6, baseTypes::tSquare::G8 ) );
+		ASSERT_TRUE( pos.isRepetition( 5 ) );
+		// before the root the third repetition is needed
+		ASSERT_FALSE( pos.isRepetition( 4 ) );
+		ASSERT_FALSE( pos.isRepetition( 0 ) );
+		// white can go back to the position after Nf3
+		ASSERT_TRUE( pos.hasUpcomingRepetition( 100 ) );
+
+		pos.doMove( Move( baseTypes::tSquare::G1, baseTypes::tSquare::F3 ) );
+		pos.doMove( Move( baseTypes::tSquare::G8, baseTypes::tSquare::F6 ) );
+		pos.doMove( Move( baseTypes::tSquare::F3, baseTypes::tSquare::G1 ) );
+		pos.doMove( Move( baseTypes::tSquare::F6, baseTypes::tSquare::G8 ) );
+		ASSERT_TRUE( pos.isRepetition( 0 ) );
+
+		// an irreversible move clears the history
+		pos.doMove( Move( baseTypes::tSquare::E2, baseTypes::tSquare::E4 ) );
+		pos.doMove( Move( baseTypes::tSquare::G8, baseTypes::tSquare::F6 ) );
+		pos.doMove( Move( baseTypes::tSquare::G1, baseTypes::tSquare::F3 ) );
+		ASSERT_FALSE( pos.hasUpcomingRepetition( 100 ) );
+		ASSERT_FALSE( pos.isRepetition( 100 ) );
+
+		// the history before a null move is not checked
+		pos.doMove( Move( baseTypes::tSquare::F6, baseTypes::tSquare::G8 ) );
+		pos.doNullMove();
+		pos.doMove( Move( baseTypes::tSquare::G8, baseTypes::tSquare::F6 ) );
+		ASSERT_FALSE( pos.hasUpcomingRepetition( 100 ) );
+		ASSERT_FALSE( pos.isRepetition( 100 ) );
+	}
+
+	TEST(Position, repetitionLongHistory)
+	{
+		// knights and kings moving back and forth, the positions repeat many times
+		Position pos;
+		pos.setupFromFen("4k1n1/8/8/8/8/8/8/1N2K3 w - - 0 1");
+		const Move cycle[] = {
+			Move( baseTypes::tSquare::B1, baseTypes::tSquare::C3 ), Move( baseTypes::tSquare::G8, baseTypes::tSquare::F6 ),
+			Move( baseTypes::tSquare::E1, baseTypes::tSquare::D2 ), Move( baseTypes::tSquare::E8, baseTypes::tSquare::D7 ),
+			Move( baseTypes::tSquare::C3, baseTypes::tSquare::B1 ), Move( baseTypes::tSquare::F6, baseTypes::tSquare::G8 ),
+			Move( baseTypes::tSquare::D2, baseTypes::tSquare::E1 ), Move( baseTypes::tSquare::D7, baseTypes::tSquare::E8 ),
+			Move( baseTypes::tSquare::B1, baseTypes::tSquare::A3 ), Move( baseTypes::tSquare::G8, baseTypes::tSquare::H6 ),
+			Move( baseTypes::tSquare::A3, baseTypes::tSquare::B1 ), Move( baseTypes::tSquare::H6, baseTypes::tSquare::G8 )
+		};
+		for( unsigned int n = 0; n < 60; ++n )
+		{
+			pos.doMove( cycle[ n % 12 ] );
+
+			// compare with the keys stored in the states
+			const GameState& st = pos.getActualStateConst();
+			const unsigned int size = pos.getStateSize();
+			for( const unsigned int ply : { 0u, 3u, 4u, 5u, 9u, 13u, 100u } )
+			{
+				unsigned int count = 0;
+				bool repetition = false;
+				for( unsigned int i = 4; i < size && i <= st.getFiftyMoveCnt() && !repetition; i += 2 )
+				{
+					repetition = pos.getState( size - 1 - i ).getKey() == st.getKey() && ( i < ply || ++count == 2 );
+				}
+				ASSERT_EQ( repetition, pos.isRepetition( ply ) );
+			}
+		}
+	}
+
+	TEST(Position, san)
+	{
+		Position pos;
+		char san[ Position::maxSanLength ];
+		const auto check = [&]( const std::string& fen, const Move& m, const std::string& expected )
+		{
+			pos.setupFromFen( fen );
+			ASSERT_EQ( expected.size(), pos.getSan( m, san ) );
+			ASSERT_EQ( expected, std::string( san ) );
+			ASSERT_EQ( m, pos.parseSan( expected ) );
+			ASSERT_EQ( fen, pos.getFen() );
+		};
+
+		const std::string start = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+		check( start, Move( baseTypes::tSquare::E2, baseTypes::tSquare::E4 ), "e4" );
+		check( start, Move( baseTypes::tSquare::G1, baseTypes::tSquare::F3 ), "Nf3" );
+		// disambiguation by file, by rank and by both, the pinned knight isn't considered
+		check( "4k3/8/8/8/8/8/8/1N2KN2 w - - 0 1", Move( baseTypes::tSquare::B1, baseTypes::tSquare::D2 ), "Nbd2" );
+		check( "R7/8/8/8/8/8/8/R3K2k w - - 0 1", Move( baseTypes::tSquare::A1, baseTypes::tSquare::A4 ), "R1a4" );
+		check( "4k3/8/8/8/8/Q7/8/Q1Q1K3 w - - 0 1", Move( baseTypes::tSquare::A1, baseTypes::tSquare::B2 ), "Qa1b2" );
+		check( "4k3/4r3/8/8/8/8/4N3/1N2K3 w - - 0 1", Move( baseTypes::tSquare::B1, baseTypes::tSquare::C3 ), "Nc3" );
+		// check and mate
+		check( "rnbqkbnr/ppp1pppp/8/3p4/4P3/8/PPPP1PPP/RNBQKBNR w KQkq - 0 2", Move( baseTypes::tSquare::F1, baseTypes::tSquare::B5 ), "Bb5+" );
+		check( "rnbqkbnr/pppp1ppp/8/4p3/6P1/5P2/PPPPP2P/RNBQKBNR b KQkq - 0 2", Move( baseTypes::tSquare::D8, baseTypes::tSquare::H4 ), "Qh4#" );
+		// castling, promotion and en passant
+		check( "r3k2r/8/8/8/8/8/8/R3K2R w KQkq - 0 1", Move( baseTypes::tSquare::E1, baseTypes::tSquare::H1, Move::fcastle ), "O-O" );
+		check( "r3k2r/8/8/8/8/8/8/R3K2R b KQkq - 0 1", Move( baseTypes::tSquare::E8, baseTypes::tSquare::A8, Move::fcastle ), "O-O-O" );
+		check( "1n2k3/P7/8/8/8/8/8/4K3 w - - 0 1", Move( baseTypes::tSquare::A7, baseTypes::tSquare::B8, Move::fpromotion, Move::promKnight ), "axb8=N" );
+		check( "4k3/8/8/3pP3/8/8/8/4K3 w - d6 0 1", Move( baseTypes::tSquare::E5, baseTypes::tSquare::D6, Move::fenpassant ), "exd6" );
+
+		// alternative notations
+		pos.setupFromFen( "4k2r/P7/8/8/8/8/8/R3K2R w KQk - 0 1" );
+		ASSERT_EQ( Move( baseTypes::tSquare::E1, baseTypes::tSquare::A1, Move::fcastle ), pos.parseSan( "0-0-0" ) );
+		ASSERT_EQ( Move( baseTypes::tSquare::A7, baseTypes::tSquare::A8, Move::fpromotion, Move::promRook ), pos.parseSan( "a8R+!" ) );
+		ASSERT_EQ( Move( baseTypes::tSquare::A1, baseTypes::tSquare::A2 ), pos.parseSan( "Ra1-a2" ) );
+
+		// illegal, ambiguous and malformed moves
+		pos.setupFromFen( start );
+		for( const auto& s : { "e5", "Ke2", "Qd3", "O-O", "Nd2", "Ng1f3x", "xyz", "", "e", "Pe4", "e8=Q" } )
+		{
+			ASSERT_EQ( Move::NOMOVE, pos.parseSan( s ) );
+		}
+		pos.setupFromFen( "4k3/8/8/8/8/8/8/1N2KN2 w - - 0 1" );
+		ASSERT_EQ( Move::NOMOVE, pos.parseSan( "Nd2" ) );
+	}
+
+	TEST(Position, sanRoundTrip)
+	{
+		std::ifstream infile("perft.txt");
+		ASSERT_FALSE(infile.fail());
+
+		Position pos;
+		std::string line;
+		char san[ Position::maxSanLength ];
+		while (std::getline(infile, line))
+		{
+			pos.setupFromFen( line.substr(0, line.find_first_of(",")) );
+			ASSERT_EQ( pos.getNumberOfLegalMoves() > 0, pos.hasLegalMoves() );
+			MoveSelector ms( pos );
+			Move m;
+			while( ( m = ms.getNextMove() ) != Move::NOMOVE )
+			{
+				const unsigned int length = pos.getSan( m, san );
+				ASSERT_LT( length, Position::maxSanLength );
+				ASSERT_EQ( m, pos.parseSan( san ) );
+
+				pos.doMove( m );
+				const bool check = pos.isInCheck();
+				const bool mate = check && pos.getNumberOfLegalMoves() == 0;
+				ASSERT_EQ( pos.getNumberOfLegalMoves() > 0, pos.hasLegalMoves() );
+				pos.undoMove();
+				ASSERT_EQ( mate ? '#' : ( check ? '+' : san[ length - 1 ] ), san[ length - 1 ] );
+			}
+		}
+	}
 }
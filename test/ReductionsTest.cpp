@@ -0,0 +1,68 @@
+/*
+	This file is part of Vajolet.
+
+    Vajolet is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Vajolet is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#include "gtest/gtest.h"
+#include "./../Reductions.h"
+
+using namespace libChess;
+
+namespace {
+
+	TEST(Reductions, table)
+	{
+		// log( depth ) * log( moveNumber ) / 2
+		ASSERT_EQ( 0, Reductions::getTableValue( 1, 1 ) );
+		ASSERT_EQ( 0, Reductions::getTableValue( 1, 63 ) );
+		ASSERT_EQ( 0, Reductions::getTableValue( 63, 1 ) );
+		ASSERT_EQ( 1, Reductions::getTableValue( 4, 4 ) );
+		ASSERT_EQ( 3, Reductions::getTableValue( 10, 20 ) );
+		ASSERT_EQ( 9, Reductions::getTableValue( 63, 63 ) );
+		// out of table values are clamped
+		ASSERT_EQ( Reductions::getTableValue( 63, 63 ), Reductions::getTableValue( 200, 300 ) );
+
+		// the reduction grows with depth and move number
+		for( int d = 1; d < Reductions::tableSize; ++d )
+		{
+			for( unsigned int m = 1; m < Reductions::tableSize; ++m )
+			{
+				ASSERT_LE( Reductions::getTableValue( d - 1, m ), Reductions::getTableValue( d, m ) );
+				ASSERT_LE( Reductions::getTableValue( d, m - 1 ), Reductions::getTableValue( d, m ) );
+			}
+		}
+	}
+
+	TEST(Reductions, adjustments)
+	{
+		const int base = Reductions::getTableValue( 10, 20 );
+		ASSERT_EQ( base, Reductions::get( false, true, 10, 20, 0 ) );
+		ASSERT_EQ( base - 1, Reductions::get( true, true, 10, 20, 0 ) );
+		ASSERT_EQ( base + 1, Reductions::get( false, false, 10, 20, 0 ) );
+		ASSERT_EQ( base - 2, Reductions::get( false, true, 10, 20, 2 * Reductions::historyDivisor ) );
+		ASSERT_EQ( base + 2, Reductions::get( false, true, 10, 20, -2 * Reductions::historyDivisor ) );
+		// never negative
+		ASSERT_EQ( 0, Reductions::get( true, true, 10, 20, 100000 ) );
+	}
+
+	TEST(Reductions, moveCountLimit)
+	{
+		ASSERT_EQ( 2u, Reductions::moveCountLimit( 1, false ) );
+		ASSERT_EQ( 4u, Reductions::moveCountLimit( 1, true ) );
+		ASSERT_LT( Reductions::moveCountLimit( 5, false ), Reductions::moveCountLimit( 5, true ) );
+		ASSERT_LT( Reductions::moveCountLimit( 4, true ), Reductions::moveCountLimit( 5, true ) );
+		ASSERT_LT( Reductions::futilityMargin( 1 ), Reductions::futilityMargin( 2 ) );
+	}
+}
@@ -0,0 +1,404 @@
+/*
+	This file is part of Vajolet.
+
+    Vajolet is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Vajolet is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "gtest/gtest.h"
+#include "./../Search.h"
+#include "./../Position.h"
+#include "./../TranspositionTable.h"
+
+using namespace libChess;
+
+namespace {
+
+	TEST(Search, mateInOne)
+	{
+		Position pos;
+		pos.setupFromFen("6k1/5ppp/8/8/8/8/8/R5K1 w - - 0 1");
+		TranspositionTable tt;
+		Search src( pos, tt );
+		ASSERT_EQ( Search::mateIn( 1 ), src.search( 3 ) );
+		ASSERT_EQ( Move( baseTypes::A1, baseTypes::A8 ), src.getBestMove() );
+	}
+
+	TEST(Search, mateInTwo)
+	{
+		Position pos;
+		pos.setupFromFen("k7/8/2K5/8/8/8/8/6R1 w - - 0 1");
+		TranspositionTable tt;
+		Search src( pos, tt );
+		ASSERT_EQ( Search::mateIn( 3 ), src.search( 4 ) );
+		ASSERT_EQ( Move( baseTypes::C6, baseTypes::B6 ), src.getBestMove() );
+	}
+
+	TEST(Search, checkmateAndStalemate)
+	{
+		Position pos;
+		pos.setupFromFen("R5k1/5ppp/8/8/8/8/8/6K1 b - - 0 1");
+		TranspositionTable tt;
+		Search src( pos, tt );
+		ASSERT_EQ( Search::matedIn( 0 ), src.search( 3 ) );
+		ASSERT_EQ( Move::NOMOVE, src.getBestMove() );
+
+		pos.setupFromFen("7k/5Q2/6K1/8/8/8/8/8 b - - 0 1");
+		ASSERT_EQ( 0, src.search( 3 ) );
+		ASSERT_EQ( Move::NOMOVE, src.getBestMove() );
+	}
+
+	TEST(Search, winMaterial)
+	{
+		Position pos;
+		pos.setupFromFen("4k3/8/8/3q4/8/8/8/3RK3 w - - 0 1");
+		TranspositionTable tt;
+		Search src( pos, tt );
+		ASSERT_GT( src.search( 4 ), 500 );
+		ASSERT_EQ( Move( baseTypes::D1, baseTypes::D5 ), src.getBestMove() );
+	}
+
+	TEST(Search, positionIsRestored)
+	{
+		Position pos;
+		pos.setupFromFen("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+		const std::string fen = pos.getFen();
+		const unsigned int stateSize = pos.getStateSize();
+		TranspositionTable tt;
+		Search src( pos, tt );
+		src.search( 4 );
+		ASSERT_STREQ( fen.c_str(), pos.getFen().c_str() );
+		ASSERT_EQ( stateSize, pos.getStateSize() );
+		ASSERT_NE( Move::NOMOVE, src.getBestMove() );
+	}
+
+	TEST(Search, nullMoveReduction)
+	{
+		ASSERT_EQ( 4, Search::nullMoveReduction( 4, 100, 100 ) );
+		ASSERT_EQ( 6, Search::nullMoveReduction( 12, 100, 100 ) );
+		ASSERT_EQ( 7, Search::nullMoveReduction( 12, 300, 100 ) );
+		ASSERT_EQ( 9, Search::nullMoveReduction( 12, 5000, 100 ) );
+	}
+
+	TEST(Search, nullMovePruning)
+	{
+		Position pos;
+		pos.setupFromFen("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+		TranspositionTable tt;
+		Search src( pos, tt );
+		src.search( 5 );
+		const Search::Statistics& stats = src.getStatistics();
+		ASSERT_GT( stats.nullMoveSearches, 0u );
+		ASSERT_GT( stats.nullMoveCutoffs, 0u );
+		ASSERT_LE( stats.nullMoveCutoffs, stats.nullMoveSearches );
+		ASSERT_LE( stats.nullMoveVerificationFails, stats.nullMoveVerifications );
+		ASSERT_LT( stats.qsearchNodes, stats.nodes );
+	}
+
+	TEST(Search, nullMoveZugzwangSafeguards)
+	{
+		Position pos;
+		// pawn ending, null move is never tried
+		pos.setupFromFen("8/8/4k3/8/3KP3/8/8/8 w - - 0 1");
+		TranspositionTable tt;
+		Search src( pos, tt );
+		src.search( 8 );
+		ASSERT_EQ( 0u, src.getStatistics().nullMoveSearches );
+
+		// with a single minor piece the null move cutoffs are verified at every depth
+		pos.setupFromFen("8/5k2/8/3p4/3P4/2N5/5K2/8 w - - 0 1");
+		src.search( 7 );
+		ASSERT_GT( src.getStatistics().nullMoveSearches, 0u );
+		ASSERT_GT( src.getStatistics().nullMoveVerifications, 0u );
+	}
+
+	TEST(Search, transpositionTable)
+	{
+		Position pos;
+		pos.setupFromFen("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+		// a small table, so that the fullness sample is filled
+		TranspositionTable tt( 1 );
+		Search src( pos, tt );
+		src.search( 5 );
+		ASSERT_GT( src.getStatistics().ttHits, 0u );
+		ASSERT_GT( tt.getFullness(), 0u );
+
+		// the root is stored as exact score with the best move
+		const ttEntry* tte = tt.probe( pos.getActualStateConst().getKey() );
+		ASSERT_NE( nullptr, tte );
+		ASSERT_EQ( src.getBestMove(), tte->getMove() );
+		ASSERT_EQ( 5, tte->getDepth() );
+	}
+
+	TEST(Search, singularExtension)
+	{
+		Position pos;
+		pos.setupFromFen("r1b1k2r/ppppqppp/2n5/4N3/1b2n3/2NB4/PPPP1PPP/R1BQK2R w KQkq - 0 1");
+		TranspositionTable tt;
+		Search src( pos, tt );
+		src.search( 10 );
+		const Search::Statistics& stats = src.getStatistics();
+		ASSERT_GT( stats.singularSearches, 0u );
+		ASSERT_GT( stats.singularExtensions, 0u );
+		ASSERT_LE( stats.singularExtensions + stats.multiCutPrunes, stats.singularSearches );
+
+		src.clear();
+		src.getSettings().singularExtension = false;
+		src.search( 10 );
+		ASSERT_EQ( 0u, src.getStatistics().singularSearches );
+		ASSERT_EQ( 0u, src.getStatistics().singularExtensions );
+	}
+
+	TEST(Search, probCut)
+	{
+		Position pos;
+		pos.setupFromFen("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+		TranspositionTable tt;
+		Search src( pos, tt );
+		src.search( 7 );
+		const Search::Statistics& stats = src.getStatistics();
+		ASSERT_GT( stats.probCutSearches, 0u );
+		ASSERT_GT( stats.probCutCutoffs, 0u );
+		ASSERT_LE( stats.probCutCutoffs, stats.probCutSearches );
+
+		src.clear();
+		src.getSettings().probCut = false;
+		src.search( 7 );
+		ASSERT_EQ( 0u, src.getStatistics().probCutSearches );
+	}
+
+	TEST(Search, lateMoveReductionsAndPruning)
+	{
+		Position pos;
+		pos.setupFromFen("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+		TranspositionTable tt;
+		Search src( pos, tt );
+		src.search( 7 );
+		const Search::Statistics stats = src.getStatistics();
+		ASSERT_GT( stats.lmrReductions, 0u );
+		ASSERT_GT( stats.lmrResearches, 0u );
+		ASSERT_LE( stats.lmrResearches, stats.lmrReductions );
+		ASSERT_GT( stats.moveCountPrunes + stats.futilityPrunes, 0u );
+
+		src.clear();
+		src.getSettings().lateMoveReductions = false;
+		src.getSettings().lateMovePruning = false;
+		src.search( 7 );
+		ASSERT_EQ( 0u, src.getStatistics().lmrReductions );
+		ASSERT_EQ( 0u, src.getStatistics().moveCountPrunes );
+		ASSERT_EQ( 0u, src.getStatistics().futilityPrunes );
+		ASSERT_LT( stats.nodes, src.getStatistics().nodes );
+	}
+
+	TEST(Search, timeLimits)
+	{
+		Position pos;
+		pos.setupFromFen("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+		const std::string fen = pos.getFen();
+		TranspositionTable tt;
+		Search src( pos, tt );
+
+		SearchLimits limits;
+		limits.moveTime = 200;
+		const auto start = std::chrono::steady_clock::now();
+		src.search( limits );
+		const auto elapsed = std::chrono::duration_cast< std::chrono::milliseconds >( std::chrono::steady_clock::now() - start ).count();
+		ASSERT_LT( elapsed, 1000 );
+		ASSERT_NE( Move::NOMOVE, src.getBestMove() );
+		ASSERT_STREQ( fen.c_str(), pos.getFen().c_str() );
+
+		// the node limit is checked every TimeManagement::pollingInterval nodes
+		src.clear();
+		limits = SearchLimits();
+		limits.nodes = 20000;
+		src.search( limits );
+		ASSERT_LT( src.getStatistics().nodes, limits.nodes + TimeManagement::pollingInterval );
+		ASSERT_NE( Move::NOMOVE, src.getBestMove() );
+	}
+
+	TEST(Search, stop)
+	{
+		Position pos;
+		pos.setupFromFen("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+		TranspositionTable tt;
+		Search src( pos, tt );
+		SearchLimits limits;
+		limits.infinite = true;
+		src.prepare( limits );
+		std::thread t( [&]{ src.search( limits ); } );
+		std::this_thread::sleep_for( std::chrono::milliseconds( 100 ) );
+		src.stop();
+		t.join();
+		ASSERT_NE( Move::NOMOVE, src.getBestMove() );
+	}
+
+	TEST(Search, repetition)
+	{
+		Position pos;
+		pos.setupFromFen();
+		pos.doMove( Move( baseTypes::G1, baseTypes::F3 ) );
+		pos.doMove( Move( baseTypes::G8, baseTypes::F6 ) );
+		pos.doMove( Move( baseTypes::F3, baseTypes::G1 ) );
+		pos.doMove( Move( baseTypes::F6, baseTypes::G8 ) );
+		TranspositionTable tt;
+		Search src( pos, tt );
+		src.search( 9 );
+		ASSERT_GT( src.getStatistics().upcomingRepetitionCutoffs, 0u );
+
+		// without the upcoming repetition test the cycles are found when they are completed
+		src.clear();
+		src.getSettings().upcomingRepetition = false;
+		src.search( 9 );
+		ASSERT_GT( src.getStatistics().repetitionDraws, 0u );
+		ASSERT_EQ( 0u, src.getStatistics().upcomingRepetitionCutoffs );
+	}
+
+	TEST(Search, multiPV)
+	{
+		Position pos;
+		pos.setupFromFen("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+		const std::string fen = pos.getFen();
+		TranspositionTable tt;
+		Search src( pos, tt );
+		src.getSettings().multiPV = 4;
+		std::vector< std::string > infos;
+		src.setInfoListener( [&]( const std::string& info ){ infos.push_back( info ); } );
+		const Score score = src.search( 6 );
+
+		ASSERT_EQ( 4u, src.getLinesNumber() );
+		ASSERT_EQ( 6u * 4u, infos.size() );
+		ASSERT_EQ( 0u, infos[ 0 ].find( "info multipv 1 depth 1 seldepth " ) );
+		ASSERT_EQ( 0u, infos.back().find( "info multipv 4 depth 6 seldepth " ) );
+
+		const auto& rootMoves = src.getRootMoves();
+		ASSERT_EQ( pos.getNumberOfLegalMoves(), rootMoves.size() );
+		ASSERT_EQ( src.getBestMove(), rootMoves[ 0 ].move );
+		ASSERT_EQ( score, rootMoves[ 0 ].score );
+		for( unsigned int line = 0; line < 4; ++line )
+		{
+			const auto& rm = rootMoves[ line ];
+			ASSERT_EQ( 6u, rm.depth );
+			ASSERT_GE( rm.selDepth, rm.depth );
+			ASSERT_GT( rm.nodes, 0u );
+			if( line > 0 )
+			{
+				ASSERT_LE( rm.score, rootMoves[ line - 1 ].score );
+			}
+
+			// the principal variation starts with the root move and is legal
+			ASSERT_EQ( rm.move, rm.pv[ 0 ] );
+			for( const auto& m : rm.pv )
+			{
+				ASSERT_TRUE( pos.isMoveLegal( m ) );
+				pos.doMove( m );
+			}
+			for( unsigned int i = 0; i < rm.pv.size(); ++i )
+			{
+				pos.undoMove();
+			}
+		}
+		ASSERT_STREQ( fen.c_str(), pos.getFen().c_str() );
+
+		// the lines share the transposition table, 4 lines cost less than 4 single line searches
+		const unsigned long long multiPVNodes = src.getStatistics().nodes;
+		TranspositionTable singleTT;
+		Search single( pos, singleTT );
+		single.search( 6 );
+		ASSERT_LT( multiPVNodes, 4 * single.getStatistics().nodes );
+	}
+
+	TEST(Search, multiPVMoreLinesThanMoves)
+	{
+		Position pos;
+		pos.setupFromFen("6k1/5ppp/8/8/8/8/8/R5K1 w - - 0 1");
+		TranspositionTable tt;
+		Search src( pos, tt );
+		src.getSettings().multiPV = 100;
+		std::vector< std::string > infos;
+		src.setInfoListener( [&]( const std::string& info ){ infos.push_back( info ); } );
+		ASSERT_EQ( Search::mateIn( 1 ), src.search( 3 ) );
+		ASSERT_EQ( pos.getNumberOfLegalMoves(), src.getLinesNumber() );
+		ASSERT_EQ( Move( baseTypes::A1, baseTypes::A8 ), src.getBestMove() );
+		ASSERT_NE( std::string::npos, infos[ infos.size() - src.getLinesNumber() ].find( " score mate 1 " ) );
+		ASSERT_NE( std::string::npos, infos[ infos.size() - src.getLinesNumber() ].find( " pv a1a8" ) );
+	}
+
+	TEST(Search, ponder)
+	{
+		Position pos;
+		pos.setupFromFen("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+		TranspositionTable tt;
+		Search src( pos, tt );
+		src.search( 5 );
+		const Move bestMove = src.getBestMove();
+		const Move ponderMove = src.getPonderMove();
+		ASSERT_NE( Move::NOMOVE, ponderMove );
+
+		// ponder on the position after the expected reply
+		pos.doMove( bestMove );
+		ASSERT_TRUE( pos.isMoveLegal( ponderMove ) );
+		pos.doMove( ponderMove );
+		SearchLimits limits;
+		limits.wtime = 2000;
+		limits.btime = 2000;
+		limits.ponder = true;
+		std::atomic< bool > finished( false );
+		src.prepare( limits );
+		std::thread t( [&]{ src.search( limits ); finished = true; } );
+
+		// the search isn't stopped by the time limits while pondering
+		std::this_thread::sleep_for( std::chrono::milliseconds( 300 ) );
+		ASSERT_FALSE( finished );
+
+		// after the ponder hit the search continue with the time limits, without restarting
+		src.ponderHit();
+		const auto start = std::chrono::steady_clock::now();
+		t.join();
+		const auto elapsed = std::chrono::duration_cast< std::chrono::milliseconds >( std::chrono::steady_clock::now() - start ).count();
+		ASSERT_LE( elapsed, src.getTimeManagement().getMaximumTime() + 100 );
+		ASSERT_NE( Move::NOMOVE, src.getBestMove() );
+	}
+
+	TEST(Search, stopBeforeSearch)
+	{
+		Position pos;
+		pos.setupFromFen("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+		TranspositionTable tt;
+		Search src( pos, tt );
+		SearchLimits limits;
+		limits.wtime = 2000;
+		limits.btime = 2000;
+		limits.ponder = true;
+
+		// the stop arrives before the searching thread begins, the ponder search shall not wait for a ponder hit
+		src.prepare( limits );
+		src.stop();
+		std::thread t( [&]{ src.search( limits ); } );
+		t.join();
+
+		// a ponder hit received before the search begins is kept too
+		limits.wtime = 100;
+		limits.btime = 100;
+		src.prepare( limits );
+		src.ponderHit();
+		const auto start = std::chrono::steady_clock::now();
+		std::thread t2( [&]{ src.search( limits ); } );
+		t2.join();
+		const auto elapsed = std::chrono::duration_cast< std::chrono::milliseconds >( std::chrono::steady_clock::now() - start ).count();
+		ASSERT_LE( elapsed, 1000 );
+		ASSERT_NE( Move::NOMOVE, src.getBestMove() );
+	}
+}
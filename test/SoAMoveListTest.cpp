@@ -0,0 +1,163 @@
+/*
+	This file is part of Vajolet.
+
+    Vajolet is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Vajolet is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#include <memory>
+#include "gtest/gtest.h"
+#include "./../MoveGenerator.h"
+#include "./../MoveList.h"
+#include "./../MoveSelector.h"
+#include "./../SoAMoveList.h"
+
+using namespace libChess;
+
+namespace {
+
+	TEST(SoAMoveList, insertAndIgnore)
+	{
+		SoAMoveList<30> ml;
+		ASSERT_EQ( 0, ml.size() );
+		ASSERT_EQ( Move::NOMOVE, ml.getNextMove() );
+
+		Move mm[] ={ Move(baseTypes::E2 , baseTypes::E4), Move( baseTypes::G1 , baseTypes::D8), Move( baseTypes::D6 , baseTypes::C4), Move( baseTypes::E2 , baseTypes::E3) };
+		for( const auto& m : mm )
+		{
+			ml.insert( m );
+		}
+		ASSERT_EQ( 4, ml.size() );
+		ASSERT_EQ( mm[2], ml.get( 2 ) );
+
+		ml.ignoreMove( mm[2] );
+		ml.ignoreMove( Move( baseTypes::A2 , baseTypes::A4 ) );
+		ASSERT_EQ( mm[1], ml.getNextMove() );
+		ASSERT_EQ( mm[0], ml.getNextMove() );
+		ASSERT_EQ( mm[3], ml.getNextMove() );
+		ASSERT_EQ( Move::NOMOVE, ml.getNextMove() );
+
+		ml.reset();
+		ASSERT_EQ( 0, ml.size() );
+	}
+
+	TEST(SoAMoveList, findNextBestMove)
+	{
+		// same order of MoveList, even with duplicated scores
+		Score ss[] ={ 10, -600, 25, 950, 3, 950, -7, 12, 0, 400, 400, -3000, 5, 8, 950, 1, 2, 2, 40 };
+		const unsigned int n = sizeof( ss ) / sizeof( Score );
+
+		SoAMoveList<30> soa;
+		MoveList<30> aos;
+		for( unsigned int i = 0; i < n; ++i )
+		{
+			soa.insert( Move( (unsigned short)( i + 1 ) ) );
+			soa.setScore( i, ss[ i ] );
+			aos.insert( Move( (unsigned short)( i + 1 ) ) );
+		}
+		unsigned int i= 0;
+		for( auto it = aos.actualPosition(); it != aos.end(); ++it)
+		{
+			(*it).setScore(ss[i]);
+			++i;
+		}
+
+		for( i = 0; i <= n; ++i )
+		{
+			ASSERT_EQ( aos.findNextBestMove(), soa.findNextBestMove() );
+		}
+	}
+
+	TEST(SoAMoveList, sortAbove)
+	{
+		Score ss[] ={ -50, 10, -600, 25, 950, 3, -7, 400, -3000, 5 };
+		const unsigned int n = sizeof( ss ) / sizeof( Score );
+
+		SoAMoveList<30> ml;
+		for( unsigned int i = 0; i < n; ++i )
+		{
+			ml.insert( Move( (unsigned short)( i + 1 ) ) );
+			ml.setScore( i, ss[ i ] );
+		}
+		ml.sortAbove( 0 );
+
+		Score expected[] = { 950, 400, 25, 10, 5, 3 };
+		for( const auto s : expected )
+		{
+			ASSERT_EQ( s, ss[ ml.getNextMove().getPacked() - 1 ] );
+		}
+		unsigned int remaining = 0;
+		Move m;
+		while( ( m = ml.getNextMove() ) != Move::NOMOVE )
+		{
+			ASSERT_LT( ss[ m.getPacked() - 1 ], 0 );
+			++remaining;
+		}
+		ASSERT_EQ( 4, remaining );
+	}
+
+	TEST(SoAMoveList, scoreCaptures)
+	{
+		const std::string fens[] = {
+			"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+			"r3k2r/p1ppqpb1/bn2pnp1/3PN3/Pp2P3/2N2Q1p/1PPBBPPP/R3K2R b KQkq a3 0 1",
+			"rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3"
+		};
+		Position pos;
+		for( const auto& fen : fens )
+		{
+			pos.setupFromFen( fen );
+			MoveList< MoveSelector::maxMovePerPosition > aos;
+			MoveGenerator::generateMoves< MoveGenerator::captureMg >( pos, aos );
+			SoAMoveList< MoveSelector::maxMovePerPosition > soa;
+			for( const auto& m : aos )
+			{
+				soa.insert( m );
+			}
+			ASSERT_GT( soa.size(), 0 );
+			soa.scoreCaptures( pos );
+			for( unsigned int i = 0; i < soa.size(); ++i )
+			{
+				ASSERT_EQ( pos.getMvvLvaScore( soa.get( i ) ), soa.getScore( i ) );
+			}
+		}
+	}
+
+	TEST(SoAMoveList, scoreQuietMoves)
+	{
+		std::unique_ptr<SearchHistory> h( new SearchHistory );
+		Position pos;
+		pos.setupFromFen("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+		pos.doMove( Move( baseTypes::E5, baseTypes::G4 ) );
+		pos.doMove( Move( baseTypes::B6, baseTypes::C4 ) );
+
+		MoveList< MoveSelector::maxMovePerPosition > aos;
+		MoveGenerator::generateMoves< MoveGenerator::quietMg >( pos, aos );
+		std::vector< Move > quiets( aos.begin(), aos.end() );
+		for( unsigned int i = 0; i < quiets.size(); i += 3 )
+		{
+			h->updateQuietStats( pos, 2, quiets[ i ], quiets.data(), i + 1, 1 + i % 10 );
+		}
+
+		SoAMoveList< MoveSelector::maxMovePerPosition > soa;
+		for( const auto& m : quiets )
+		{
+			soa.insert( m );
+		}
+		soa.scoreQuietMoves( pos, *h );
+		for( unsigned int i = 0; i < soa.size(); ++i )
+		{
+			ASSERT_EQ( h->getQuietScore( pos, soa.get( i ) ), soa.getScore( i ) );
+		}
+	}
+}
@@ -0,0 +1,88 @@
+/*
+	This file is part of Vajolet.
+
+    Vajolet is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Vajolet is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
+*/
+#include "gtest/gtest.h"
+#include "./../tools/Sprt.h"
+
+using namespace tools;
+
+namespace {
+
+	TEST(Sprt, bounds)
+	{
+		const Sprt sprt( 0.0, 5.0, 0.05, 0.05 );
+		ASSERT_NEAR( -2.944439, sprt.getLowerBound(), 1e-6 );
+		ASSERT_NEAR( 2.944439, sprt.getUpperBound(), 1e-6 );
+
+		const Sprt asymmetric( 0.0, 5.0, 0.05, 0.1 );
+		ASSERT_NEAR( -2.251292, asymmetric.getLowerBound(), 1e-6 );
+		ASSERT_NEAR( 2.890372, asymmetric.getUpperBound(), 1e-6 );
+	}
+
+	TEST(Sprt, llr)
+	{
+		const Sprt sprt( 0.0, 5.0, 0.05, 0.05 );
+		ASSERT_NEAR( 0.537202, sprt.getLLR( 120, 100, 280 ), 1e-6 );
+		ASSERT_NEAR( 2.404400, sprt.getLLR( 1000, 900, 3000 ), 1e-6 );
+		ASSERT_NEAR( -5.024234, sprt.getLLR( 900, 1000, 3000 ), 1e-6 );
+
+		const Sprt wide( 0.0, 10.0, 0.05, 0.05 );
+		ASSERT_NEAR( -0.414810, wide.getLLR( 500, 500, 0 ), 1e-6 );
+	}
+
+	TEST(Sprt, oneSidedResults)
+	{
+		const Sprt sprt( 0.0, 5.0, 0.05, 0.05 );
+		ASSERT_EQ( 0.0, sprt.getLLR( 0, 0, 0 ) );
+		ASSERT_NEAR( 3.090845, sprt.getLLR( 50, 0, 100 ), 1e-6 );
+		ASSERT_NEAR( -3.228616, sprt.getLLR( 0, 50, 100 ), 1e-6 );
+		ASSERT_GT( sprt.getLLR( 3, 0, 0 ), 0.0 );
+		ASSERT_LT( sprt.getLLR( 0, 0, 1 ), 0.0 );
+
+		ASSERT_EQ( Sprt::Result::acceptH1, sprt.getResult( 50, 0, 100 ) );
+		ASSERT_EQ( Sprt::Result::acceptH0, sprt.getResult( 0, 50, 100 ) );
+		ASSERT_EQ( Sprt::Result::acceptH1, sprt.getResult( 1000, 0, 0 ) );
+		ASSERT_EQ( Sprt::Result::acceptH0, sprt.getResult( 0, 1000, 0 ) );
+		ASSERT_EQ( Sprt::Result::none, sprt.getResult( 1, 0, 0 ) );
+	}
+
+	TEST(Sprt, result)
+	{
+		const Sprt sprt( 0.0, 5.0, 0.05, 0.05 );
+		ASSERT_EQ( Sprt::Result::none, sprt.getResult( 120, 100, 280 ) );
+		ASSERT_EQ( Sprt::Result::none, sprt.getResult( 1000, 900, 3000 ) );
+		ASSERT_EQ( Sprt::Result::acceptH0, sprt.getResult( 900, 1000, 3000 ) );
+		ASSERT_EQ( Sprt::Result::acceptH1, sprt.getResult( 1100, 900, 3000 ) );
+	}
+
+	TEST(Sprt, elo)
+	{
+		double margin;
+		ASSERT_EQ( 0.0, Sprt::getElo( 0, 0, 0, margin ) );
+		ASSERT_EQ( 0.0, margin );
+
+		ASSERT_NEAR( 0.0, Sprt::getElo( 100, 100, 300, margin ), 1e-9 );
+		ASSERT_GT( margin, 0.0 );
+
+		ASSERT_NEAR( 13.904843, Sprt::getElo( 120, 100, 280, margin ), 1e-6 );
+		double otherMargin;
+		ASSERT_NEAR( -13.904843, Sprt::getElo( 100, 120, 280, otherMargin ), 1e-6 );
+		ASSERT_NEAR( margin, otherMargin, 1e-9 );
+		// more games give a smaller error
+		Sprt::getElo( 1200, 1000, 2800, otherMargin );
+		ASSERT_LT( otherMargin, margin );
+	}
+}
@@ -0,0 +1,175 @@
+/*
+	This file is part of Vajolet.
+
+    Vajolet is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Vajolet is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#include <chrono>
+#include <thread>
+#include "gtest/gtest.h"
+#include "./../TimeManagement.h"
+
+using namespace libChess;
+
+namespace {
+
+	TEST(TimeManagement, moveTime)
+	{
+		TimeManagement tm;
+		SearchLimits limits;
+		limits.moveTime = 1000;
+		tm.init( limits, baseTypes::whiteTurn );
+		ASSERT_TRUE( tm.isTimeManaged() );
+		ASSERT_EQ( 1000 - TimeManagement::defaultMoveOverhead, tm.getOptimumTime() );
+		ASSERT_EQ( 1000 - TimeManagement::defaultMoveOverhead, tm.getMaximumTime() );
+
+		// with fixed time all the time is used
+		ASSERT_FALSE( tm.stopAfterIteration( 900 ) );
+		ASSERT_FALSE( tm.isSearchFinished( 900, 0 ) );
+		ASSERT_TRUE( tm.isSearchFinished( 1000 - TimeManagement::defaultMoveOverhead, 0 ) );
+	}
+
+	TEST(TimeManagement, remainingTime)
+	{
+		TimeManagement tm;
+		tm.setMoveOverhead( 0 );
+		SearchLimits limits;
+		limits.wtime = 60000;
+		limits.btime = 10000;
+		tm.init( limits, baseTypes::whiteTurn );
+		ASSERT_TRUE( tm.isTimeManaged() );
+		ASSERT_EQ( 1200, tm.getOptimumTime() );
+		ASSERT_EQ( 6000, tm.getMaximumTime() );
+
+		tm.init( limits, baseTypes::blackTurn );
+		ASSERT_EQ( 200, tm.getOptimumTime() );
+		ASSERT_EQ( 1000, tm.getMaximumTime() );
+
+		// the increment adds time
+		limits.winc = 1000;
+		tm.init( limits, baseTypes::whiteTurn );
+		ASSERT_EQ( ( 60000 + 49 * 1000 ) / 50, tm.getOptimumTime() );
+
+		// a few moves to the time control
+		limits.winc = 0;
+		limits.movesToGo = 2;
+		tm.init( limits, baseTypes::whiteTurn );
+		ASSERT_EQ( 30000, tm.getOptimumTime() );
+		ASSERT_EQ( 48000, tm.getMaximumTime() );
+		ASSERT_LE( tm.getOptimumTime(), tm.getMaximumTime() );
+	}
+
+	TEST(TimeManagement, moveOverhead)
+	{
+		TimeManagement tm;
+		ASSERT_EQ( TimeManagement::defaultMoveOverhead, tm.getMoveOverhead() );
+		tm.setMoveOverhead( 100 );
+		SearchLimits limits;
+		limits.wtime = 100;
+		tm.init( limits, baseTypes::whiteTurn );
+		// the budget never goes below 1 ms
+		ASSERT_EQ( 1, tm.getOptimumTime() );
+		ASSERT_EQ( 1, tm.getMaximumTime() );
+	}
+
+	TEST(TimeManagement, notManaged)
+	{
+		TimeManagement tm;
+		SearchLimits limits;
+		limits.depth = 5;
+		tm.init( limits, baseTypes::whiteTurn );
+		ASSERT_FALSE( tm.isTimeManaged() );
+		ASSERT_FALSE( tm.stopAfterIteration( 1000000 ) );
+		ASSERT_FALSE( tm.isSearchFinished( 1000000, 1000000 ) );
+
+		limits.wtime = 1000;
+		limits.infinite = true;
+		tm.init( limits, baseTypes::whiteTurn );
+		ASSERT_FALSE( tm.isTimeManaged() );
+		ASSERT_FALSE( tm.isSearchFinished( 1000000, 0 ) );
+	}
+
+	TEST(TimeManagement, nodesLimit)
+	{
+		TimeManagement tm;
+		SearchLimits limits;
+		limits.nodes = 10000;
+		tm.init( limits, baseTypes::whiteTurn );
+		ASSERT_FALSE( tm.isSearchFinished( 0, 9999 ) );
+		ASSERT_TRUE( tm.isSearchFinished( 0, 10000 ) );
+	}
+
+	TEST(TimeManagement, scaling)
+	{
+		TimeManagement tm;
+		tm.setMoveOverhead( 0 );
+		SearchLimits limits;
+		limits.wtime = 60000;
+		tm.init( limits, baseTypes::whiteTurn );
+		ASSERT_EQ( tm.getOptimumTime(), tm.getScaledOptimumTime() );
+
+		// a stable best move that takes most of the nodes saves time
+		tm.newIteration( 50, 0, 0.9 );
+		ASSERT_LT( tm.getScaledOptimumTime(), tm.getOptimumTime() );
+		ASSERT_TRUE( tm.stopAfterIteration( tm.getOptimumTime() ) );
+
+		// a changing best move and a falling score use more time, up to the maximum
+		tm.newIteration( -50, 2, 0.3 );
+		ASSERT_GT( tm.getScaledOptimumTime(), tm.getOptimumTime() );
+		ASSERT_LE( tm.getScaledOptimumTime(), tm.getMaximumTime() );
+		ASSERT_FALSE( tm.stopAfterIteration( tm.getOptimumTime() ) );
+		ASSERT_TRUE( tm.stopAfterIteration( tm.getMaximumTime() ) );
+
+		// a new search forget the history
+		tm.init( limits, baseTypes::whiteTurn );
+		ASSERT_EQ( tm.getOptimumTime(), tm.getScaledOptimumTime() );
+	}
+
+	TEST(TimeManagement, isPollingNode)
+	{
+		unsigned int polls = 0;
+		for( unsigned long long n = 1; n <= 100 * TimeManagement::pollingInterval; ++n )
+		{
+			polls += TimeManagement::isPollingNode( n );
+		}
+		ASSERT_EQ( 100u, polls );
+	}
+
+	TEST(TimeManagement, ponder)
+	{
+		TimeManagement tm;
+		SearchLimits limits;
+		limits.wtime = 1000;
+		limits.nodes = 100;
+		limits.ponder = true;
+		tm.init( limits, baseTypes::whiteTurn );
+		ASSERT_TRUE( tm.isPondering() );
+		// no limit while pondering
+		ASSERT_FALSE( tm.stopAfterIteration( 1000000 ) );
+		ASSERT_FALSE( tm.isSearchFinished( 1000000, 1000000 ) );
+
+		std::this_thread::sleep_for( std::chrono::milliseconds( 50 ) );
+		ASSERT_GE( tm.getElapsedTime(), 50 );
+		tm.ponderHit();
+		ASSERT_FALSE( tm.isPondering() );
+		// the clock restarts at the ponder hit
+		ASSERT_LT( tm.getElapsedTime(), 50 );
+		ASSERT_TRUE( tm.stopAfterIteration( tm.getMaximumTime() ) );
+		ASSERT_TRUE( tm.isSearchFinished( 0, 100 ) );
+
+		limits.ponder = false;
+		tm.init( limits, baseTypes::whiteTurn );
+		ASSERT_FALSE( tm.isPondering() );
+	}
+}
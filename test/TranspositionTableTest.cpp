@@ -0,0 +1,99 @@
+/*
+	This file is part of Vajolet.
+
+    Vajolet is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Vajolet is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#include "gtest/gtest.h"
+#include "./../Position.h"
+#include "./../TranspositionTable.h"
+
+using namespace libChess;
+
+namespace {
+
+	TEST(TranspositionTable, size)
+	{
+		TranspositionTable tt( 1 );
+		ASSERT_EQ( ( 1u << 20 ) / 64, tt.getClusterCount() );
+		tt.setSize( 3 );
+		ASSERT_EQ( ( 2u << 20 ) / 64, tt.getClusterCount() );
+		ASSERT_EQ( 0u, tt.getFullness() );
+	}
+
+	TEST(TranspositionTable, storeAndProbe)
+	{
+		TranspositionTable tt( 1 );
+		Position pos;
+		pos.setupFromFen();
+		const HashKey key = pos.getActualStateConst().getKey();
+		const Move m( baseTypes::E2, baseTypes::E4 );
+
+		ASSERT_EQ( nullptr, tt.probe( key ) );
+		tt.store( key, 35, ttEntry::typeLowerBound, 7, m, 10 );
+
+		const ttEntry* tte = tt.probe( key );
+		ASSERT_NE( nullptr, tte );
+		ASSERT_EQ( m, tte->getMove() );
+		ASSERT_EQ( 35, tte->getScore() );
+		ASSERT_EQ( 10, tte->getStaticValue() );
+		ASSERT_EQ( 7, tte->getDepth() );
+		ASSERT_TRUE( tte->isLowerBound() );
+		ASSERT_FALSE( tte->isUpperBound() );
+
+		// the exclusion key identify a different position
+		ASSERT_EQ( nullptr, tt.probe( key.exclusion() ) );
+
+		// storing without a move keep the old one
+		tt.store( key, -20, ttEntry::typeUpperBound, 8, Move::NOMOVE, 10 );
+		tte = tt.probe( key );
+		ASSERT_EQ( m, tte->getMove() );
+		ASSERT_EQ( -20, tte->getScore() );
+		ASSERT_TRUE( tte->isUpperBound() );
+
+		tt.clear();
+		ASSERT_EQ( nullptr, tt.probe( key ) );
+	}
+
+	TEST(TranspositionTable, replacement)
+	{
+		TranspositionTable tt( 1 );
+		const uint64_t clusters = tt.getClusterCount();
+
+		// keys of the same cluster
+		std::vector< HashKey > keys;
+		for( uint64_t i = 1; i <= TranspositionTable::clusterSize + 1; ++i )
+		{
+			keys.emplace_back( ( i << 32 ) | ( 5 & ( clusters - 1 ) ) );
+		}
+		for( unsigned int i = 0; i < TranspositionTable::clusterSize; ++i )
+		{
+			tt.store( keys[ i ], 0, ttEntry::typeExact, 10 + i, Move::NOMOVE, 0 );
+		}
+
+		// entries of old searches are replaced first, the first entry is used in the new search
+		tt.newSearch();
+		ASSERT_NE( nullptr, tt.probe( keys[ 0 ] ) );
+		tt.store( keys[ TranspositionTable::clusterSize ], 0, ttEntry::typeExact, 1, Move::NOMOVE, 0 );
+		ASSERT_NE( nullptr, tt.probe( keys[ 0 ] ) );
+		ASSERT_EQ( nullptr, tt.probe( keys[ 1 ] ) );
+		ASSERT_NE( nullptr, tt.probe( keys[ 2 ] ) );
+		ASSERT_NE( nullptr, tt.probe( keys[ TranspositionTable::clusterSize ] ) );
+
+		// between entries of the same search the shallowest is replaced
+		tt.store( keys[ 1 ], 0, ttEntry::typeExact, 5, Move::NOMOVE, 0 );
+		ASSERT_NE( nullptr, tt.probe( keys[ 1 ] ) );
+		ASSERT_EQ( nullptr, tt.probe( keys[ TranspositionTable::clusterSize ] ) );
+	}
+}
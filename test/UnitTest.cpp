@@ -20,6 +20,8 @@
 #include "./../tSquare.h"
 #include "./../HashKeys.h"
 #include "./../BitMapMoveGenerator.h"
+#include "./../Cuckoo.h"
+#include "./../KPKBitbase.h"
 
 class EnvironmentInvocationCatcher : public ::testing::Environment
 {
@@ -30,6 +32,8 @@ protected:
 		libChess::baseTypes::BitMap::init();
 		libChess::HashKey::init();
 		libChess::BitMapMoveGenerator::init();
+		libChess::Cuckoo::init();
+		libChess::KPKBitbase::init();
 	}
 
 	virtual void TearDown()
@@ -0,0 +1,336 @@
+/*
+	This file is part of Vajolet.
+	Copyright (C) 2013-2018 Marco Belli
+
+    Vajolet is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Vajolet is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Tools.h"
+#include "./../Position.h"
+#include "./../Search.h"
+#include "./../TranspositionTable.h"
+
+using namespace libChess;
+
+/*	epd test suite runner
+
+	every thread takes the next position of the suite and searches it with its own Position, Search and transposition table.
+	A position is solved when the best move is one of the bm moves and none of the am moves; the solution time and nodes
+	are the ones of the iteration after which the best move has always been a solution.
+	options: input threads time nodes depth hash
+*/
+namespace
+{
+	struct Settings
+	{
+		std::string input;
+		unsigned int threads;
+		long long time;
+		unsigned long long nodes;
+		unsigned int depth;
+		unsigned int hash;
+	};
+
+	/*!	\brief a position of the suite with the result of its search
+	 */
+	struct EpdPosition
+	{
+		std::string id;
+		std::string fen;
+		std::vector< std::string > bestMoves;	// san of the bm and am opcodes
+		std::vector< std::string > avoidMoves;
+
+		std::string error;
+		bool solved = false;
+		Move found = Move::NOMOVE;
+		std::string foundSan;
+		long long solutionTime = 0;
+		unsigned long long solutionNodes = 0;
+	};
+
+	std::vector< std::string > split( const std::string& s )
+	{
+		std::istringstream ss( s );
+		std::vector< std::string > tokens;
+		std::string token;
+		while( ss >> token )
+		{
+			tokens.push_back( token );
+		}
+		return tokens;
+	}
+
+	std::string unquote( const std::string& s )
+	{
+		const auto begin = s.find_first_not_of( " \"" );
+		const auto end = s.find_last_not_of( " \"" );
+		return begin == std::string::npos ? "" : s.substr( begin, end - begin + 1 );
+	}
+
+	/*! \brief parse an epd line: the first four fields of a fen followed by opcodes terminated by semicolons
+	*
+	*/
+	bool parseEpd( const std::string& line, const unsigned int lineNumber, EpdPosition& epd )
+	{
+		std::istringstream ss( line );
+		std::string board, turn, castle, ep;
+		if( !( ss >> board >> turn >> castle >> ep ) )
+		{
+			return false;
+		}
+		epd.fen = board + " " + turn + " " + castle + " " + ep + " 0 1";
+		epd.id = "line " + std::to_string( lineNumber );
+
+		std::string operation;
+		while( std::getline( ss, operation, ';' ) )
+		{
+			std::vector< std::string > tokens = split( operation );
+			if( tokens.empty() )
+			{
+				continue;
+			}
+			const std::string opcode = tokens.front();
+			tokens.erase( tokens.begin() );
+			if( opcode == "bm" )
+			{
+				epd.bestMoves.insert( epd.bestMoves.end(), tokens.begin(), tokens.end() );
+			}
+			else if( opcode == "am" )
+			{
+				epd.avoidMoves.insert( epd.avoidMoves.end(), tokens.begin(), tokens.end() );
+			}
+			else if( opcode == "id" )
+			{
+				epd.id = unquote( operation.substr( operation.find( "id" ) + 2 ) );
+			}
+		}
+		return true;
+	}
+
+	/*! \brief convert the san of the opcodes, return false if one of them isn't a legal move
+	*
+	*/
+	bool getMoves( const Position& pos, const std::vector< std::string >& sans, std::vector< Move >& moves, std::string& error )
+	{
+		for( const auto& san : sans )
+		{
+			const Move m = pos.parseSan( san );
+			if( m == Move::NOMOVE )
+			{
+				error = "invalid move " + san;
+				return false;
+			}
+			moves.push_back( m );
+		}
+		return true;
+	}
+
+	bool isSolution( const Move& m, const std::vector< Move >& bestMoves, const std::vector< Move >& avoidMoves )
+	{
+		return ( bestMoves.empty() || std::find( bestMoves.begin(), bestMoves.end(), m ) != bestMoves.end() )
+			&& std::find( avoidMoves.begin(), avoidMoves.end(), m ) == avoidMoves.end();
+	}
+
+	void solve( EpdPosition& epd, Position& pos, Search& search, const SearchLimits& limits )
+	{
+		if( !pos.setupFromFen( epd.fen ) )
+		{
+			epd.error = "invalid fen";
+			return;
+		}
+		std::vector< Move > bestMoves;
+		std::vector< Move > avoidMoves;
+		if( !getMoves( pos, epd.bestMoves, bestMoves, epd.error ) || !getMoves( pos, epd.avoidMoves, avoidMoves, epd.error ) )
+		{
+			return;
+		}
+		if( bestMoves.empty() && avoidMoves.empty() )
+		{
+			epd.error = "no bm or am opcode";
+			return;
+		}
+
+		// the listener is called at the end of every iteration, by the searching thread
+		bool solving = false;
+		search.setInfoListener( [&]( const std::string& )
+		{
+			const Move& best = search.getRootMoves().front().move;
+			if( !isSolution( best, bestMoves, avoidMoves ) )
+			{
+				solving = false;
+			}
+			else if( !solving )
+			{
+				solving = true;
+				epd.solutionTime = search.getTimeManagement().getElapsedTime();
+				epd.solutionNodes = search.getStatistics().nodes;
+			}
+		});
+		search.clear();
+		search.search( limits );
+		epd.found = search.getBestMove();
+		if( epd.found != Move::NOMOVE )
+		{
+			char san[ Position::maxSanLength ];
+			pos.getSan( epd.found, san );
+			epd.foundSan = san;
+		}
+
+		// the best move of an interrupted iteration is kept by the search
+		epd.solved = isSolution( epd.found, bestMoves, avoidMoves );
+		if( epd.solved && !solving )
+		{
+			epd.solutionTime = search.getTimeManagement().getElapsedTime();
+			epd.solutionNodes = search.getStatistics().nodes;
+		}
+	}
+
+	void worker( const Settings& settings, std::vector< EpdPosition >& suite, std::atomic< size_t >& next )
+	{
+		Position pos;
+		TranspositionTable tt( settings.hash );
+		Search search( pos, tt );
+		SearchLimits limits;
+		limits.moveTime = settings.time;
+		limits.nodes = settings.nodes;
+		limits.depth = settings.depth;
+
+		size_t i;
+		while( ( i = next++ ) < suite.size() )
+		{
+			solve( suite[ i ], pos, search, limits );
+		}
+	}
+
+	void printReport( const std::vector< EpdPosition >& suite, const double seconds )
+	{
+		// upper limits of the time histogram buckets, in milliseconds
+		static const long long timeBuckets[] = { 10, 50, 100, 250, 500, 1000, 2500, 5000, 10000, 30000, 60000 };
+		constexpr unsigned int bucketsNumber = sizeof( timeBuckets ) / sizeof( timeBuckets[ 0 ] ) + 1;
+		std::vector< unsigned int > histogram( bucketsNumber, 0 );
+		std::vector< unsigned long long > nodes;
+		unsigned int errors = 0;
+
+		for( const auto& epd : suite )
+		{
+			std::cout << std::left << std::setw( 20 ) << epd.id << " ";
+			if( !epd.error.empty() )
+			{
+				++errors;
+				std::cout << "error: " << epd.error << std::endl;
+				continue;
+			}
+			std::cout << ( epd.solved ? "solved " : "failed " ) << std::setw( 7 ) << epd.foundSan;
+			if( epd.solved )
+			{
+				std::cout << " time " << epd.solutionTime << " nodes " << epd.solutionNodes;
+				++histogram[ std::upper_bound( std::begin( timeBuckets ), std::end( timeBuckets ), epd.solutionTime ) - std::begin( timeBuckets ) ];
+				nodes.push_back( epd.solutionNodes );
+			}
+			std::cout << std::endl;
+		}
+
+		std::cout << std::endl << "solved " << nodes.size() << "/" << suite.size() - errors;
+		if( errors )
+		{
+			std::cout << " ( " << errors << " invalid positions )";
+		}
+		std::cout << " in " << seconds << "s" << std::endl;
+
+		std::cout << "time to solution" << std::endl;
+		for( unsigned int b = 0; b < bucketsNumber; ++b )
+		{
+			std::cout << ( b + 1 < bucketsNumber ? "<= " + std::to_string( timeBuckets[ b ] ) + "ms" : " > " + std::to_string( timeBuckets[ b - 1 ] ) + "ms" );
+			std::cout << "\t" << histogram[ b ] << "\t" << std::string( histogram[ b ] * 60 / std::max< size_t >( nodes.size(), 1 ), '#' ) << std::endl;
+		}
+
+		if( !nodes.empty() )
+		{
+			std::sort( nodes.begin(), nodes.end() );
+			unsigned long long total = 0;
+			for( const auto n : nodes )
+			{
+				total += n;
+			}
+			std::cout << "nodes to solution: average " << total / nodes.size() << " median " << nodes[ nodes.size() / 2 ] << " max " << nodes.back() << std::endl;
+		}
+	}
+}
+
+int main( int argc, char** argv )
+{
+	tools::init();
+
+	const tools::Options options( argc, argv );
+	if( !options.isValid() )
+	{
+		return 1;
+	}
+
+	Settings settings;
+	settings.input = options.getString( "input", "" );
+	settings.threads = options.getInt( "threads", tools::getHardwareThreads() );
+	settings.time = options.getInt( "time", 0 );
+	settings.nodes = options.getInt( "nodes", 0 );
+	settings.depth = options.getInt( "depth", 0 );
+	settings.hash = options.getInt( "hash", 16 );
+	if( settings.time == 0 && settings.nodes == 0 && settings.depth == 0 )
+	{
+		settings.time = 1000;
+	}
+
+	std::ifstream file( settings.input );
+	if( !file )
+	{
+		std::cerr << "unable to read the suite " << settings.input << std::endl;
+		return 1;
+	}
+	std::vector< EpdPosition > suite;
+	std::string line;
+	unsigned int lineNumber = 0;
+	while( std::getline( file, line ) )
+	{
+		EpdPosition epd;
+		if( parseEpd( line, ++lineNumber, epd ) )
+		{
+			suite.push_back( epd );
+		}
+	}
+
+	std::cout << "running " << suite.size() << " positions on " << settings.threads << " threads" << std::endl;
+	const auto start = std::chrono::steady_clock::now();
+	std::atomic< size_t > next( 0 );
+	std::vector< std::thread > threads;
+	for( unsigned int i = 0; i < settings.threads; ++i )
+	{
+		threads.emplace_back( worker, std::cref( settings ), std::ref( suite ), std::ref( next ) );
+	}
+	for( auto& t : threads )
+	{
+		t.join();
+	}
+	printReport( suite, std::chrono::duration< double >( std::chrono::steady_clock::now() - start ).count() );
+	return 0;
+}
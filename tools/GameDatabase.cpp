@@ -0,0 +1,167 @@
+/*
+	This file is part of Vajolet.
+	Copyright (C) 2013-2018 Marco Belli
+
+    Vajolet is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Vajolet is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#include "GameDatabase.h"
+
+using namespace libChess;
+
+namespace tools
+{
+	namespace
+	{
+		uint64_t readLittleEndian( const char* data, const unsigned int bytes )
+		{
+			uint64_t value = 0;
+			for( unsigned int i = 0; i < bytes; ++i )
+			{
+				value |= uint64_t( uint8_t( data[ i ] ) ) << ( 8 * i );
+			}
+			return value;
+		}
+
+		void writeLittleEndian( std::FILE* file, const uint64_t value, const unsigned int bytes )
+		{
+			uint8_t buffer[ 8 ];
+			for( unsigned int i = 0; i < bytes; ++i )
+			{
+				buffer[ i ] = ( value >> ( 8 * i ) ) & 0xFF;
+			}
+			std::fwrite( buffer, 1, bytes, file );
+		}
+	}
+
+	std::string GameDatabase::getDataFileName( const std::string& name )
+	{
+		return name + ".vgd";
+	}
+
+	std::string GameDatabase::getIndexFileName( const std::string& name )
+	{
+		return name + ".vgi";
+	}
+
+	bool GameDatabase::open( const std::string& name )
+	{
+		_gamesNumber = 0;
+		if( !_data.open( getDataFileName( name ) ) || !_index.open( getIndexFileName( name ) ) )
+		{
+			return false;
+		}
+		if( _data.size() < 4 || readLittleEndian( _data.data(), 4 ) != dataMagic
+			|| _index.size() < indexHeaderSize || readLittleEndian( _index.data(), 4 ) != indexMagic || readLittleEndian( _index.data() + 4, 4 ) != version )
+		{
+			return false;
+		}
+		const uint64_t gamesNumber = readLittleEndian( _index.data() + 8, 8 );
+		if( _index.size() != indexHeaderSize + ( gamesNumber + 1 ) * 8 )
+		{
+			return false;
+		}
+		_gamesNumber = gamesNumber;
+		return _getOffset( _gamesNumber ) == _data.size();
+	}
+
+	uint64_t GameDatabase::getGamesNumber() const
+	{
+		return _gamesNumber;
+	}
+
+	uint64_t GameDatabase::_getOffset( const uint64_t id ) const
+	{
+		return readLittleEndian( _index.data() + indexHeaderSize + id * 8, 8 );
+	}
+
+	bool GameDatabase::getGame( const uint64_t id, Position& pos, std::vector< Move >& moves, GameCodec::Result& result ) const
+	{
+		if( id >= _gamesNumber )
+		{
+			return false;
+		}
+		const uint64_t begin = _getOffset( id );
+		const uint64_t end = _getOffset( id + 1 );
+		if( begin > end || end > _data.size() )
+		{
+			return false;
+		}
+		return GameCodec::decode( reinterpret_cast< const uint8_t* >( _data.data() ) + begin, end - begin, pos, moves, result );
+	}
+
+	GameDatabaseWriter::~GameDatabaseWriter()
+	{
+		close();
+	}
+
+	bool GameDatabaseWriter::open( const std::string& name )
+	{
+		close();
+		_name = name;
+		_file = std::fopen( GameDatabase::getDataFileName( name ).c_str(), "wb" );
+		if( !_file )
+		{
+			return false;
+		}
+		writeLittleEndian( _file, GameDatabase::dataMagic, 4 );
+		_offsets.assign( 1, 4 );
+		return true;
+	}
+
+	/*! \brief append encoded games, data holds the games one after the other and sizes their sizes
+	*
+	*/
+	void GameDatabaseWriter::addGames( const std::vector< uint8_t >& data, const std::vector< uint64_t >& sizes )
+	{
+		std::fwrite( data.data(), 1, data.size(), _file );
+		for( const auto size : sizes )
+		{
+			_offsets.push_back( _offsets.back() + size );
+		}
+	}
+
+	uint64_t GameDatabaseWriter::getGamesNumber() const
+	{
+		return _offsets.empty() ? 0 : _offsets.size() - 1;
+	}
+
+	/*! \brief close the data file and write the index
+	*
+	*/
+	bool GameDatabaseWriter::close()
+	{
+		if( !_file )
+		{
+			return false;
+		}
+		bool ok = std::fclose( _file ) == 0;
+		_file = nullptr;
+
+		std::FILE* index = std::fopen( GameDatabase::getIndexFileName( _name ).c_str(), "wb" );
+		if( !index )
+		{
+			return false;
+		}
+		writeLittleEndian( index, GameDatabase::indexMagic, 4 );
+		writeLittleEndian( index, GameDatabase::version, 4 );
+		writeLittleEndian( index, getGamesNumber(), 8 );
+		for( const auto offset : _offsets )
+		{
+			writeLittleEndian( index, offset, 8 );
+		}
+		ok = std::fclose( index ) == 0 && ok;
+		return ok;
+	}
+}
@@ -0,0 +1,87 @@
+/*
+	This file is part of Vajolet.
+	Copyright (C) 2013-2018 Marco Belli
+
+    Vajolet is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Vajolet is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#ifndef GAMEDATABASE_H_
+#define GAMEDATABASE_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "MappedFile.h"
+#include "./../GameCodec.h"
+#include "./../Move.h"
+#include "./../Position.h"
+
+namespace tools
+{
+	/*!	\brief database of games encoded by GameCodec
+
+		the games are stored one after the other in name.vgd, after a 4 bytes magic. name.vgi is the index: a 4 bytes magic,
+		a 4 bytes version, the number of games and the offsets of the games in name.vgd followed by its size, as 64 bits
+		little endian integers. Both files are memory mapped, so that a game is read by id without loading the database
+	 */
+	class GameDatabase
+	{
+	public:
+		bool open( const std::string& name );
+
+		uint64_t getGamesNumber() const;
+		bool getGame( const uint64_t id, libChess::Position& pos, std::vector< libChess::Move >& moves, libChess::GameCodec::Result& result ) const;
+
+		static std::string getDataFileName( const std::string& name );
+		static std::string getIndexFileName( const std::string& name );
+
+		static constexpr uint32_t dataMagic = 0x31444756;	// VGD1
+		static constexpr uint32_t indexMagic = 0x31494756;	// VGI1
+		static constexpr uint32_t version = 1;
+		static constexpr size_t indexHeaderSize = 16;
+
+	private:
+		MappedFile _data;
+		MappedFile _index;
+		uint64_t _gamesNumber = 0;
+
+		uint64_t _getOffset( const uint64_t id ) const;
+	};
+
+	/*!	\brief write the games of a database, the index is written by close
+	 */
+	class GameDatabaseWriter
+	{
+	public:
+		GameDatabaseWriter() = default;
+		~GameDatabaseWriter();
+
+		GameDatabaseWriter( const GameDatabaseWriter& ) = delete;
+		GameDatabaseWriter& operator=( const GameDatabaseWriter& ) = delete;
+
+		bool open( const std::string& name );
+		void addGames( const std::vector< uint8_t >& data, const std::vector< uint64_t >& sizes );
+		bool close();
+
+		uint64_t getGamesNumber() const;
+
+	private:
+		std::string _name;
+		std::FILE* _file = nullptr;
+		std::vector< uint64_t > _offsets;
+	};
+}
+
+#endif /* GAMEDATABASE_H_ */
@@ -0,0 +1,280 @@
+/*
+	This file is part of Vajolet.
+	Copyright (C) 2013-2018 Marco Belli
+
+    Vajolet is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Vajolet is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "GameDatabase.h"
+#include "MappedFile.h"
+#include "Pgn.h"
+#include "Tools.h"
+#include "./../GameCodec.h"
+#include "./../Position.h"
+
+using namespace libChess;
+
+/*	binary game database tool
+
+	mode=build input=<pgn> output=<name> threads: encode the valid games of a pgn file, the file is split in parts that are encoded
+	by the threads a round at a time and written in order, so the game ids follow the pgn and the memory is bounded by a round.
+	mode=show db=<name> id=<n>: print a game in san.
+	mode=bench db=<name> threads: decode all the games.
+*/
+namespace
+{
+	constexpr unsigned int partsPerThread = 16;
+
+	GameCodec::Result getCodecResult( const tools::GameResult result )
+	{
+		switch( result )
+		{
+		case tools::GameResult::whiteWins:
+			return GameCodec::Result::whiteWins;
+		case tools::GameResult::blackWins:
+			return GameCodec::Result::blackWins;
+		case tools::GameResult::draw:
+			return GameCodec::Result::draw;
+		default:
+			return GameCodec::Result::unknown;
+		}
+	}
+
+	std::string to_string( const GameCodec::Result result )
+	{
+		switch( result )
+		{
+		case GameCodec::Result::whiteWins:
+			return "1-0";
+		case GameCodec::Result::blackWins:
+			return "0-1";
+		case GameCodec::Result::draw:
+			return "1/2-1/2";
+		default:
+			return "*";
+		}
+	}
+
+	/*!	\brief games of a part of the pgn, encoded one after the other
+	 */
+	struct EncodedPart
+	{
+		std::vector< uint8_t > data;
+		std::vector< uint64_t > sizes;
+		unsigned long long moves = 0;
+		unsigned long long invalidGames = 0;
+	};
+
+	void encodePart( const std::string_view text, EncodedPart& part )
+	{
+		Position pos;
+		tools::PgnGame game;
+		tools::PgnReader reader( text );
+		std::string_view gameText;
+		while( reader.getNextGame( gameText ) )
+		{
+			if( !tools::parsePgnGame( gameText, pos, game ) )
+			{
+				++part.invalidGames;
+				continue;
+			}
+			pos.setupFromFen( game.fen );
+			const size_t size = part.data.size();
+			GameCodec::encode( pos, game.moves, getCodecResult( game.result ), part.data );
+			part.sizes.push_back( part.data.size() - size );
+			part.moves += game.moves.size();
+		}
+	}
+
+	int build( const tools::Options& options )
+	{
+		const std::string input = options.getString( "input", "" );
+		const std::string output = options.getString( "output", "games" );
+		const unsigned int threadsNumber = std::max( (unsigned int)options.getInt( "threads", tools::getHardwareThreads() ), 1u );
+
+		tools::MappedFile file;
+		if( !file.open( input ) )
+		{
+			std::cerr << "unable to read " << input << std::endl;
+			return 1;
+		}
+		tools::GameDatabaseWriter writer;
+		if( !writer.open( output ) )
+		{
+			std::cerr << "unable to write " << output << std::endl;
+			return 1;
+		}
+
+		const auto start = std::chrono::steady_clock::now();
+		const std::vector< std::string_view > parts = tools::PgnReader::split( file.getText(), threadsNumber * partsPerThread );
+		unsigned long long moves = 0;
+		unsigned long long invalidGames = 0;
+		unsigned long long bytes = 0;
+		for( size_t first = 0; first < parts.size(); first += threadsNumber )
+		{
+			const size_t last = std::min( first + threadsNumber, parts.size() );
+			std::vector< EncodedPart > encoded( last - first );
+			std::vector< std::thread > threads;
+			for( size_t i = first; i < last; ++i )
+			{
+				threads.emplace_back( encodePart, parts[ i ], std::ref( encoded[ i - first ] ) );
+			}
+			for( auto& t : threads )
+			{
+				t.join();
+			}
+			for( const auto& part : encoded )
+			{
+				writer.addGames( part.data, part.sizes );
+				moves += part.moves;
+				invalidGames += part.invalidGames;
+				bytes += part.data.size();
+			}
+		}
+		const uint64_t games = writer.getGamesNumber();
+		if( !writer.close() )
+		{
+			std::cerr << "error writing " << output << std::endl;
+			return 1;
+		}
+
+		const double seconds = std::chrono::duration< double >( std::chrono::steady_clock::now() - start ).count();
+		std::cout << "games " << games << " moves " << moves << " invalid games " << invalidGames << std::endl;
+		std::cout << "pgn " << file.size() << " bytes, database " << bytes << " bytes ( " << ( moves ? bytes * 8.0 / moves : 0.0 ) << " bits per move ) in " << seconds << "s" << std::endl;
+		return 0;
+	}
+
+	int show( const tools::Options& options )
+	{
+		tools::GameDatabase db;
+		const std::string name = options.getString( "db", "games" );
+		if( !db.open( name ) )
+		{
+			std::cerr << "unable to open the database " << name << std::endl;
+			return 1;
+		}
+		const uint64_t id = options.getInt( "id", 0 );
+		Position pos;
+		std::vector< Move > moves;
+		GameCodec::Result result;
+		if( !db.getGame( id, pos, moves, result ) )
+		{
+			std::cerr << "unable to read game " << id << " of " << db.getGamesNumber() << std::endl;
+			return 1;
+		}
+
+		// replay the game from its start position to write the moves in san
+		const unsigned int plies = moves.size();
+		for( unsigned int i = 0; i < plies; ++i )
+		{
+			pos.undoMove();
+		}
+		std::cout << "[FEN \"" << pos.getFen() << "\"]" << std::endl << std::endl;
+		char san[ Position::maxSanLength ];
+		for( unsigned int i = 0; i < plies; ++i )
+		{
+			if( pos.isWhiteTurn() || i == 0 )
+			{
+				std::cout << pos.getActualStateConst().getFullMoveCounter() << ( pos.isWhiteTurn() ? ". " : "... " );
+			}
+			pos.getSan( moves[ i ], san );
+			std::cout << san << " ";
+			pos.doMove( moves[ i ] );
+		}
+		std::cout << to_string( result ) << std::endl;
+		return 0;
+	}
+
+	int bench( const tools::Options& options )
+	{
+		tools::GameDatabase db;
+		const std::string name = options.getString( "db", "games" );
+		if( !db.open( name ) )
+		{
+			std::cerr << "unable to open the database " << name << std::endl;
+			return 1;
+		}
+		const unsigned int threadsNumber = std::max( (unsigned int)options.getInt( "threads", tools::getHardwareThreads() ), 1u );
+
+		std::atomic< unsigned long long > moves( 0 );
+		std::atomic< unsigned long long > errors( 0 );
+		const auto start = std::chrono::steady_clock::now();
+		std::vector< std::thread > threads;
+		for( unsigned int t = 0; t < threadsNumber; ++t )
+		{
+			threads.emplace_back( [&, t]()
+			{
+				Position pos;
+				std::vector< Move > game;
+				GameCodec::Result result;
+				unsigned long long localMoves = 0;
+				for( uint64_t id = t; id < db.getGamesNumber(); id += threadsNumber )
+				{
+					if( db.getGame( id, pos, game, result ) )
+					{
+						localMoves += game.size();
+					}
+					else
+					{
+						++errors;
+					}
+				}
+				moves += localMoves;
+			});
+		}
+		for( auto& t : threads )
+		{
+			t.join();
+		}
+		const double seconds = std::chrono::duration< double >( std::chrono::steady_clock::now() - start ).count();
+		std::cout << "decoded " << db.getGamesNumber() << " games, " << moves << " moves, " << errors << " errors in " << seconds << "s ( "
+			<< (unsigned long long)( moves / std::max( seconds, 1e-6 ) ) << " moves/s )" << std::endl;
+		return errors ? 2 : 0;
+	}
+}
+
+int main( int argc, char** argv )
+{
+	tools::init();
+
+	const tools::Options options( argc, argv );
+	if( !options.isValid() )
+	{
+		return 1;
+	}
+
+	const std::string mode = options.getString( "mode", "" );
+	if( mode == "build" )
+	{
+		return build( options );
+	}
+	if( mode == "show" )
+	{
+		return show( options );
+	}
+	if( mode == "bench" )
+	{
+		return bench( options );
+	}
+	std::cerr << "mode shall be build, show or bench" << std::endl;
+	return 1;
+}
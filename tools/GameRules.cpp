@@ -0,0 +1,119 @@
+/*
+	This file is part of Vajolet.
+	Copyright (C) 2013-2018 Marco Belli
+
+    Vajolet is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Vajolet is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#include <cstdlib>
+#include "GameRules.h"
+#include "./../KPKBitbase.h"
+
+using namespace libChess;
+
+namespace tools
+{
+	GameResult getGameResult( const Position& pos )
+	{
+		if( pos.getNumberOfLegalMoves() == 0 )
+		{
+			if( pos.isInCheck() )
+			{
+				return pos.isWhiteTurn() ? GameResult::blackWins : GameResult::whiteWins;
+			}
+			return GameResult::draw;
+		}
+		if( pos.getActualStateConst().getFiftyMoveCnt() >= 100 || pos.isRepetition( 0 ) || isInsufficientMaterial( pos ) )
+		{
+			return GameResult::draw;
+		}
+		return GameResult::none;
+	}
+
+	/*! \brief no side can mate: bare kings or a single minor piece
+	*
+	*/
+	bool isInsufficientMaterial( const Position& pos )
+	{
+		const unsigned int heavyAndPawns = pos.getPieceCount( baseTypes::whitePawns ) + pos.getPieceCount( baseTypes::blackPawns )
+			+ pos.getPieceCount( baseTypes::whiteRooks ) + pos.getPieceCount( baseTypes::blackRooks )
+			+ pos.getPieceCount( baseTypes::whiteQueens ) + pos.getPieceCount( baseTypes::blackQueens );
+		const unsigned int minors = pos.getPieceCount( baseTypes::whiteBishops ) + pos.getPieceCount( baseTypes::blackBishops )
+			+ pos.getPieceCount( baseTypes::whiteKnights ) + pos.getPieceCount( baseTypes::blackKnights );
+		return heavyAndPawns == 0 && minors <= 1;
+	}
+
+	std::string to_string( const GameResult result )
+	{
+		switch( result )
+		{
+		case GameResult::whiteWins:
+			return "1-0";
+		case GameResult::blackWins:
+			return "0-1";
+		case GameResult::draw:
+			return "1/2-1/2";
+		default:
+			return "*";
+		}
+	}
+
+	int getResultFor( const GameResult result, const baseTypes::eTurn color )
+	{
+		if( result == GameResult::whiteWins )
+		{
+			return color == baseTypes::whiteTurn ? 1 : -1;
+		}
+		if( result == GameResult::blackWins )
+		{
+			return color == baseTypes::whiteTurn ? -1 : 1;
+		}
+		return 0;
+	}
+
+	Adjudicator::Adjudicator( const AdjudicationSettings& settings ): _settings( settings ), _whiteWinningPlies( 0 ), _blackWinningPlies( 0 ), _drawPlies( 0 )
+	{
+	}
+
+	GameResult Adjudicator::update( const Position& pos, const Score score, const unsigned int ply )
+	{
+		if( _settings.useBitbase && KPKBitbase::isKPK( pos ) )
+		{
+			if( !KPKBitbase::probe( pos ) )
+			{
+				return GameResult::draw;
+			}
+			return pos.getBitmap( baseTypes::whitePawns ).isNotEmpty() ? GameResult::whiteWins : GameResult::blackWins;
+		}
+
+		const Score whiteScore = pos.isWhiteTurn() ? score : -score;
+		_whiteWinningPlies = whiteScore >= _settings.resignScore ? _whiteWinningPlies + 1 : 0;
+		_blackWinningPlies = whiteScore <= -_settings.resignScore ? _blackWinningPlies + 1 : 0;
+		_drawPlies = ( ply >= _settings.drawMinPly && std::abs( score ) <= _settings.drawScore ) ? _drawPlies + 1 : 0;
+
+		if( _settings.resignPlies && _whiteWinningPlies >= _settings.resignPlies )
+		{
+			return GameResult::whiteWins;
+		}
+		if( _settings.resignPlies && _blackWinningPlies >= _settings.resignPlies )
+		{
+			return GameResult::blackWins;
+		}
+		if( _settings.drawPlies && _drawPlies >= _settings.drawPlies )
+		{
+			return GameResult::draw;
+		}
+		return GameResult::none;
+	}
+}
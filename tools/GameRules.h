@@ -0,0 +1,80 @@
+/*
+	This file is part of Vajolet.
+	Copyright (C) 2013-2018 Marco Belli
+
+    Vajolet is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Vajolet is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#ifndef GAMERULES_H_
+#define GAMERULES_H_
+
+#include <string>
+#include "./../Position.h"
+#include "./../Score.h"
+
+namespace tools
+{
+	enum class GameResult
+	{
+		none,
+		whiteWins,
+		blackWins,
+		draw
+	};
+
+	/*! \brief result of the game by the rules: mate, stalemate, fifty moves, threefold repetition and insufficient material
+	*
+	*/
+	GameResult getGameResult( const libChess::Position& pos );
+	bool isInsufficientMaterial( const libChess::Position& pos );
+	std::string to_string( const GameResult result );
+
+	/*! \brief result seen from a side: 1 win, 0 draw, -1 loss
+	*
+	*/
+	int getResultFor( const GameResult result, const libChess::baseTypes::eTurn color );
+
+	/*!	\brief thresholds used to end the games before the rules do
+	 */
+	struct AdjudicationSettings
+	{
+		libChess::Score resignScore = 1000;	// a side is winning when its score is at least resignScore for resignPlies plies
+		unsigned int resignPlies = 6;
+		libChess::Score drawScore = 10;		// after drawMinPly the game is drawn when the score stays within drawScore for drawPlies plies
+		unsigned int drawPlies = 10;
+		unsigned int drawMinPly = 80;
+		bool useBitbase = true;				// king and pawn vs king endings are decided by the bitbase
+	};
+
+	/*!	\brief adjudicate a game from the search scores and the bitbase
+	 */
+	class Adjudicator
+	{
+	public:
+		explicit Adjudicator( const AdjudicationSettings& settings );
+
+		/*! \brief update the adjudication with the score of the side to move, return the result when the game is decided
+		*
+		*/
+		GameResult update( const libChess::Position& pos, const libChess::Score score, const unsigned int ply );
+
+	private:
+		AdjudicationSettings _settings;
+		unsigned int _whiteWinningPlies;
+		unsigned int _blackWinningPlies;
+		unsigned int _drawPlies;
+	};
+}
+
+#endif /* GAMERULES_H_ */
@@ -0,0 +1,140 @@
+/*
+	This file is part of Vajolet.
+	Copyright (C) 2013-2018 Marco Belli
+
+    Vajolet is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Vajolet is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#include "MappedFile.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace tools
+{
+#if defined(_WIN32)
+	MappedFile::MappedFile(): _data( nullptr ), _size( 0 ), _file( INVALID_HANDLE_VALUE ), _mapping( nullptr )
+	{
+	}
+#else
+	MappedFile::MappedFile(): _data( nullptr ), _size( 0 )
+	{
+	}
+#endif
+
+	MappedFile::~MappedFile()
+	{
+		close();
+	}
+
+	/*! \brief map the file, an empty file is opened without mapping it
+	*
+	*/
+	bool MappedFile::open( const std::string& fileName )
+	{
+		close();
+#if defined(_WIN32)
+		_file = CreateFileA( fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr );
+		if( _file == INVALID_HANDLE_VALUE )
+		{
+			return false;
+		}
+		LARGE_INTEGER size;
+		if( !GetFileSizeEx( _file, &size ) )
+		{
+			close();
+			return false;
+		}
+		_size = size.QuadPart;
+		if( _size == 0 )
+		{
+			return true;
+		}
+		_mapping = CreateFileMappingA( _file, nullptr, PAGE_READONLY, 0, 0, nullptr );
+		if( !_mapping )
+		{
+			close();
+			return false;
+		}
+		_data = static_cast< const char* >( MapViewOfFile( _mapping, FILE_MAP_READ, 0, 0, 0 ) );
+		if( !_data )
+		{
+			close();
+			return false;
+		}
+#else
+		const int fd = ::open( fileName.c_str(), O_RDONLY );
+		if( fd < 0 )
+		{
+			return false;
+		}
+		struct stat st;
+		if( fstat( fd, &st ) != 0 )
+		{
+			::close( fd );
+			return false;
+		}
+		_size = st.st_size;
+		if( _size == 0 )
+		{
+			::close( fd );
+			return true;
+		}
+		void* p = mmap( nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0 );
+		// the mapping stays valid after closing the descriptor
+		::close( fd );
+		if( p == MAP_FAILED )
+		{
+			_size = 0;
+			return false;
+		}
+		madvise( p, _size, MADV_SEQUENTIAL );
+		_data = static_cast< const char* >( p );
+#endif
+		return true;
+	}
+
+	void MappedFile::close()
+	{
+#if defined(_WIN32)
+		if( _data )
+		{
+			UnmapViewOfFile( _data );
+		}
+		if( _mapping )
+		{
+			CloseHandle( _mapping );
+		}
+		if( _file != INVALID_HANDLE_VALUE )
+		{
+			CloseHandle( _file );
+		}
+		_mapping = nullptr;
+		_file = INVALID_HANDLE_VALUE;
+#else
+		if( _data )
+		{
+			munmap( const_cast< char* >( _data ), _size );
+		}
+#endif
+		_data = nullptr;
+		_size = 0;
+	}
+}
@@ -0,0 +1,71 @@
+/*
+	This file is part of Vajolet.
+	Copyright (C) 2013-2018 Marco Belli
+
+    Vajolet is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Vajolet is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#ifndef MAPPEDFILE_H_
+#define MAPPEDFILE_H_
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace tools
+{
+	/*!	\brief read only memory mapping of a whole file
+	 */
+	class MappedFile
+	{
+	public:
+		MappedFile();
+		~MappedFile();
+
+		MappedFile( const MappedFile& ) = delete;
+		MappedFile& operator=( const MappedFile& ) = delete;
+
+		bool open( const std::string& fileName );
+		void close();
+
+		const char* data() const;
+		size_t size() const;
+		std::string_view getText() const;
+
+	private:
+		const char* _data;
+		size_t _size;
+#if defined(_WIN32)
+		void* _file;
+		void* _mapping;
+#endif
+	};
+
+	inline const char* MappedFile::data() const
+	{
+		return _data;
+	}
+
+	inline size_t MappedFile::size() const
+	{
+		return _size;
+	}
+
+	inline std::string_view MappedFile::getText() const
+	{
+		return std::string_view( _data, _size );
+	}
+}
+
+#endif /* MAPPEDFILE_H_ */
@@ -0,0 +1,313 @@
+/*
+	This file is part of Vajolet.
+	Copyright (C) 2013-2018 Marco Belli
+
+    Vajolet is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Vajolet is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "GameRules.h"
+#include "Sprt.h"
+#include "Tools.h"
+#include "./../MoveSelector.h"
+#include "./../Position.h"
+#include "./../Search.h"
+#include "./../TranspositionTable.h"
+
+using namespace libChess;
+
+/*	match between two configurations of the engine
+
+	every thread plays its games with its own Position and a Search with its own transposition table for each engine,
+	so the whole match runs in this process without spawning engines. Every opening is played twice with swapped colors.
+	The games are played with fixed nodes, fixed time per move or a clock with increment, and the match stops as soon as
+	the sprt accepts one of the hypotheses.
+	options: games threads openings nodes moveTime time increment hash maxPlies elo0 elo1 alpha beta,
+	the AdjudicationSettings ones and, for each engine, first.<name> and second.<name> with name one of the
+	Search::Settings switches ( nullMovePruning singularExtension probCut lateMoveReductions lateMovePruning upcomingRepetition )
+	or nodes hash
+*/
+namespace
+{
+	struct EngineSettings
+	{
+		Search::Settings search;
+		unsigned long long nodes;
+		unsigned int hash;
+	};
+
+	struct Settings
+	{
+		unsigned long long games;
+		unsigned int threads;
+		std::vector< std::string > openings;
+		long long moveTime;
+		long long time;
+		long long increment;
+		unsigned int maxPlies;
+		double elo0;
+		double elo1;
+		double alpha;
+		double beta;
+		tools::AdjudicationSettings adjudication;
+		EngineSettings engines[ 2 ];
+	};
+
+	std::atomic< unsigned long long > nextGame( 0 );
+	std::atomic< unsigned long long > playedGames( 0 );
+	std::atomic< unsigned long long > wins( 0 );	// results of the first engine
+	std::atomic< unsigned long long > losses( 0 );
+	std::atomic< unsigned long long > draws( 0 );
+	std::atomic< unsigned long long > timeLosses( 0 );
+	std::atomic< unsigned int > runningThreads( 0 );
+	std::atomic< bool > stopMatch( false );
+
+	/*!	\brief an engine of a thread: a search with its own transposition table working on the position of the thread
+	 */
+	struct Engine
+	{
+		Engine( Position& pos, const EngineSettings& settings ): tt( settings.hash ), search( pos, tt ), nodes( settings.nodes )
+		{
+			search.getSettings() = settings.search;
+		}
+
+		TranspositionTable tt;
+		Search search;
+		unsigned long long nodes;
+	};
+
+	/*! \brief play a game, return the result from the point of view of the first engine
+	*
+	*/
+	int playGame( const Settings& settings, Position& pos, Engine* engines[ 2 ], const std::string& opening, const bool firstIsWhite )
+	{
+		pos.setupFromFen( opening );
+		engines[ 0 ]->search.clear();
+		engines[ 1 ]->search.clear();
+
+		tools::Adjudicator adjudicator( settings.adjudication );
+		long long clocks[ 2 ] = { settings.time, settings.time };	// white and black
+		tools::GameResult result = tools::GameResult::none;
+		for( unsigned int ply = 0; result == tools::GameResult::none; ++ply )
+		{
+			if( ( result = tools::getGameResult( pos ) ) != tools::GameResult::none )
+			{
+				break;
+			}
+			if( ply >= settings.maxPlies )
+			{
+				result = tools::GameResult::draw;
+				break;
+			}
+
+			const bool white = pos.isWhiteTurn();
+			Engine& engine = *engines[ white == firstIsWhite ? 0 : 1 ];
+			SearchLimits limits;
+			limits.nodes = engine.nodes;
+			limits.moveTime = settings.moveTime;
+			if( settings.time )
+			{
+				limits.wtime = clocks[ 0 ];
+				limits.btime = clocks[ 1 ];
+				limits.winc = settings.increment;
+				limits.binc = settings.increment;
+			}
+
+			const auto start = std::chrono::steady_clock::now();
+			const Score score = engine.search.search( limits );
+			const long long elapsed = std::chrono::duration_cast< std::chrono::milliseconds >( std::chrono::steady_clock::now() - start ).count();
+			if( settings.time )
+			{
+				long long& clock = clocks[ white ? 0 : 1 ];
+				clock -= elapsed;
+				if( clock < 0 )
+				{
+					++timeLosses;
+					result = white ? tools::GameResult::blackWins : tools::GameResult::whiteWins;
+					break;
+				}
+				clock += settings.increment;
+			}
+
+			const Move bestMove = engine.search.getBestMove() != Move::NOMOVE ? engine.search.getBestMove() : MoveSelector( pos ).getNextMove();
+			result = adjudicator.update( pos, score, ply );
+			pos.doMove( bestMove );
+		}
+		return tools::getResultFor( result, firstIsWhite ? baseTypes::whiteTurn : baseTypes::blackTurn );
+	}
+
+	void worker( const Settings& settings )
+	{
+		Position pos;
+		Engine first( pos, settings.engines[ 0 ] );
+		Engine second( pos, settings.engines[ 1 ] );
+		Engine* engines[ 2 ] = { &first, &second };
+
+		unsigned long long game;
+		while( !stopMatch && ( game = nextGame++ ) < settings.games )
+		{
+			const std::string& opening = settings.openings[ ( game / 2 ) % settings.openings.size() ];
+			const int result = playGame( settings, pos, engines, opening, game % 2 == 0 );
+			++( result > 0 ? wins : ( result < 0 ? losses : draws ) );
+			++playedGames;
+		}
+	}
+
+	void runWorker( const Settings& settings )
+	{
+		worker( settings );
+		--runningThreads;
+	}
+
+	EngineSettings getEngineSettings( const tools::Options& options, const std::string& prefix, const unsigned long long nodes, const unsigned int hash )
+	{
+		EngineSettings settings;
+		Search::Settings& s = settings.search;
+		s.nullMovePruning = options.getInt( prefix + "nullMovePruning", s.nullMovePruning );
+		s.singularExtension = options.getInt( prefix + "singularExtension", s.singularExtension );
+		s.probCut = options.getInt( prefix + "probCut", s.probCut );
+		s.lateMoveReductions = options.getInt( prefix + "lateMoveReductions", s.lateMoveReductions );
+		s.lateMovePruning = options.getInt( prefix + "lateMovePruning", s.lateMovePruning );
+		s.upcomingRepetition = options.getInt( prefix + "upcomingRepetition", s.upcomingRepetition );
+		settings.nodes = options.getInt( prefix + "nodes", nodes );
+		settings.hash = options.getInt( prefix + "hash", hash );
+		return settings;
+	}
+
+	/*! \brief read the openings, a fen or the first four fields of an epd line for each line
+	*
+	*/
+	bool readOpenings( const std::string& fileName, std::vector< std::string >& openings )
+	{
+		std::ifstream file( fileName );
+		if( !file )
+		{
+			return false;
+		}
+		Position pos;
+		std::string line;
+		while( std::getline( file, line ) )
+		{
+			std::istringstream ss( line );
+			std::string board, turn, castle, ep, fifty, fullMove;
+			if( !( ss >> board >> turn >> castle >> ep ) )
+			{
+				continue;
+			}
+			std::string fen = board + " " + turn + " " + castle + " " + ep;
+			fen += ( ss >> fifty >> fullMove ) && fifty.find_first_not_of( "0123456789" ) == std::string::npos ? " " + fifty + " " + fullMove : " 0 1";
+			if( pos.setupFromFen( fen ) )
+			{
+				openings.push_back( fen );
+			}
+		}
+		return true;
+	}
+
+	void printStatus( const tools::Sprt& sprt, const double seconds )
+	{
+		double errorMargin;
+		const double elo = tools::Sprt::getElo( wins, losses, draws, errorMargin );
+		std::cout << "games " << playedGames << " +" << wins << " -" << losses << " =" << draws
+			<< " elo " << elo << " +/- " << errorMargin
+			<< " llr " << sprt.getLLR( wins, losses, draws ) << " ( " << sprt.getLowerBound() << ", " << sprt.getUpperBound() << " )"
+			<< " time losses " << timeLosses << " ( " << seconds << "s )" << std::endl;
+	}
+}
+
+int main( int argc, char** argv )
+{
+	tools::init();
+
+	const tools::Options options( argc, argv );
+	if( !options.isValid() )
+	{
+		return 1;
+	}
+
+	Settings settings;
+	settings.games = options.getInt( "games", 1000 );
+	settings.threads = options.getInt( "threads", tools::getHardwareThreads() );
+	settings.moveTime = options.getInt( "moveTime", 0 );
+	settings.time = options.getInt( "time", 0 );
+	settings.increment = options.getInt( "increment", 0 );
+	settings.maxPlies = options.getInt( "maxPlies", 400 );
+	settings.elo0 = options.getDouble( "elo0", 0.0 );
+	settings.elo1 = options.getDouble( "elo1", 5.0 );
+	settings.alpha = options.getDouble( "alpha", 0.05 );
+	settings.beta = options.getDouble( "beta", 0.05 );
+	settings.adjudication.resignScore = options.getInt( "resignScore", settings.adjudication.resignScore );
+	settings.adjudication.resignPlies = options.getInt( "resignPlies", settings.adjudication.resignPlies );
+	settings.adjudication.drawScore = options.getInt( "drawScore", settings.adjudication.drawScore );
+	settings.adjudication.drawPlies = options.getInt( "drawPlies", settings.adjudication.drawPlies );
+	settings.adjudication.drawMinPly = options.getInt( "drawMinPly", settings.adjudication.drawMinPly );
+	const unsigned long long nodes = options.getInt( "nodes", 0 );
+	const unsigned int hash = options.getInt( "hash", 16 );
+	settings.engines[ 0 ] = getEngineSettings( options, "first.", nodes, hash );
+	settings.engines[ 1 ] = getEngineSettings( options, "second.", nodes, hash );
+	if( settings.engines[ 0 ].nodes == 0 && settings.engines[ 1 ].nodes == 0 && settings.moveTime == 0 && settings.time == 0 )
+	{
+		std::cerr << "a nodes, moveTime or time limit is needed" << std::endl;
+		return 1;
+	}
+
+	const std::string openingsFile = options.getString( "openings", "" );
+	if( openingsFile.empty() )
+	{
+		settings.openings.push_back( "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1" );
+	}
+	else if( !readOpenings( openingsFile, settings.openings ) || settings.openings.empty() )
+	{
+		std::cerr << "unable to read the openings from " << openingsFile << std::endl;
+		return 1;
+	}
+
+	const tools::Sprt sprt( settings.elo0, settings.elo1, settings.alpha, settings.beta );
+	std::cout << "playing " << settings.games << " games on " << settings.threads << " threads from " << settings.openings.size() << " openings, sprt elo0 "
+		<< settings.elo0 << " elo1 " << settings.elo1 << std::endl;
+	const auto start = std::chrono::steady_clock::now();
+
+	std::vector< std::thread > threads;
+	runningThreads = settings.threads;
+	for( unsigned int i = 0; i < settings.threads; ++i )
+	{
+		threads.emplace_back( runWorker, std::cref( settings ) );
+	}
+	tools::Sprt::Result result = tools::Sprt::Result::none;
+	while( runningThreads > 0 )
+	{
+		std::this_thread::sleep_for( std::chrono::seconds( 1 ) );
+		if( !stopMatch && ( result = sprt.getResult( wins, losses, draws ) ) != tools::Sprt::Result::none )
+		{
+			// the games in progress are completed, no new game is started
+			stopMatch = true;
+		}
+		printStatus( sprt, std::chrono::duration< double >( std::chrono::steady_clock::now() - start ).count() );
+	}
+	for( auto& t : threads )
+	{
+		t.join();
+	}
+	result = sprt.getResult( wins, losses, draws );
+	std::cout << "sprt: " << ( result == tools::Sprt::Result::acceptH1 ? "H1 accepted" : ( result == tools::Sprt::Result::acceptH0 ? "H0 accepted" : "inconclusive" ) ) << std::endl;
+	return 0;
+}
@@ -0,0 +1,243 @@
+/*
+	This file is part of Vajolet.
+	Copyright (C) 2013-2018 Marco Belli
+
+    Vajolet is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Vajolet is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#include <algorithm>
+#include <cctype>
+#include "Pgn.h"
+
+using namespace libChess;
+
+namespace tools
+{
+	namespace
+	{
+		const std::string_view gameStart = "[Event ";
+		const std::string_view startPosition = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+		GameResult getResult( std::string_view token )
+		{
+			if( token == "1-0" )
+			{
+				return GameResult::whiteWins;
+			}
+			if( token == "0-1" )
+			{
+				return GameResult::blackWins;
+			}
+			if( token == "1/2-1/2" )
+			{
+				return GameResult::draw;
+			}
+			return GameResult::none;
+		}
+
+		bool isResult( std::string_view token )
+		{
+			return token == "*" || getResult( token ) != GameResult::none;
+		}
+
+		/*! \brief parse a tag line [Name "value"]
+		*
+		*/
+		void parseTag( std::string_view line, PgnGame& game )
+		{
+			const size_t nameEnd = line.find( ' ' );
+			const size_t valueBegin = line.find( '"' );
+			const size_t valueEnd = line.rfind( '"' );
+			if( nameEnd == std::string_view::npos || valueBegin == std::string_view::npos || valueEnd <= valueBegin )
+			{
+				return;
+			}
+			const std::string_view name = line.substr( 1, nameEnd - 1 );
+			const std::string_view value = line.substr( valueBegin + 1, valueEnd - valueBegin - 1 );
+			if( name == "FEN" )
+			{
+				game.fen = value;
+			}
+			else if( name == "Result" )
+			{
+				game.result = getResult( value );
+			}
+		}
+	}
+
+	void PgnGame::clear()
+	{
+		fen = startPosition;
+		moves.clear();
+		result = GameResult::none;
+		error.clear();
+	}
+
+	PgnReader::PgnReader( std::string_view text ): _text( text ), _position( _findGameStart( text, 0 ) )
+	{
+	}
+
+	bool PgnReader::getNextGame( std::string_view& game )
+	{
+		if( _position >= _text.size() )
+		{
+			return false;
+		}
+		const size_t next = _findGameStart( _text, _position + 1 );
+		game = _text.substr( _position, next - _position );
+		_position = next;
+		return true;
+	}
+
+	std::vector< std::string_view > PgnReader::split( std::string_view text, const unsigned int parts )
+	{
+		std::vector< std::string_view > chunks;
+		size_t begin = _findGameStart( text, 0 );
+		for( unsigned int i = 1; i <= parts && begin < text.size(); ++i )
+		{
+			const size_t end = i == parts ? text.size() : _findGameStart( text, std::max( begin + 1, ( text.size() * i ) / parts ) );
+			if( end > begin )
+			{
+				chunks.push_back( text.substr( begin, end - begin ) );
+			}
+			begin = end;
+		}
+		return chunks;
+	}
+
+	/*! \brief position of the first game starting at or after from, the size of the text if there isn't any
+	*
+	*/
+	size_t PgnReader::_findGameStart( std::string_view text, const size_t from )
+	{
+		size_t p = from;
+		while( ( p = text.find( gameStart, p ) ) != std::string_view::npos )
+		{
+			if( p == 0 || text[ p - 1 ] == '\n' )
+			{
+				return p;
+			}
+			++p;
+		}
+		return text.size();
+	}
+
+	bool parsePgnGame( std::string_view text, Position& pos, PgnGame& game )
+	{
+		game.clear();
+
+		// tags
+		size_t p = 0;
+		while( p < text.size() )
+		{
+			while( p < text.size() && std::isspace( (unsigned char)text[ p ] ) )
+			{
+				++p;
+			}
+			if( p >= text.size() || text[ p ] != '[' )
+			{
+				break;
+			}
+			size_t end = text.find( '\n', p );
+			end = end == std::string_view::npos ? text.size() : end;
+			parseTag( text.substr( p, end - p ), game );
+			p = end;
+		}
+
+		if( !pos.setupFromFen( game.fen ) )
+		{
+			game.error = "invalid fen " + game.fen;
+			return false;
+		}
+
+		// movetext
+		unsigned int variationLevel = 0;
+		while( p < text.size() )
+		{
+			const char c = text[ p ];
+			if( std::isspace( (unsigned char)c ) )
+			{
+				++p;
+			}
+			else if( c == '{' )
+			{
+				const size_t end = text.find( '}', p );
+				p = end == std::string_view::npos ? text.size() : end + 1;
+			}
+			else if( c == ';' )
+			{
+				const size_t end = text.find( '\n', p );
+				p = end == std::string_view::npos ? text.size() : end + 1;
+			}
+			else if( c == '(' )
+			{
+				++variationLevel;
+				++p;
+			}
+			else if( c == ')' )
+			{
+				if( variationLevel > 0 )
+				{
+					--variationLevel;
+				}
+				++p;
+			}
+			else
+			{
+				size_t end = p;
+				while( end < text.size() && !std::isspace( (unsigned char)text[ end ] ) && text[ end ] != '{' && text[ end ] != '(' && text[ end ] != ')' && text[ end ] != ';' )
+				{
+					++end;
+				}
+				std::string_view token = text.substr( p, end - p );
+				p = end;
+
+				if( variationLevel > 0 || token[ 0 ] == '$' )
+				{
+					continue;
+				}
+				if( isResult( token ) )
+				{
+					break;
+				}
+				// move number, as 12. or 12... possibly attached to the move
+				size_t moveStart = 0;
+				while( moveStart < token.size() && ( std::isdigit( (unsigned char)token[ moveStart ] ) || token[ moveStart ] == '.' ) )
+				{
+					++moveStart;
+				}
+				if( moveStart > 0 && moveStart < token.size() && token[ moveStart - 1 ] != '.' )
+				{
+					// castling written with zeros
+					moveStart = 0;
+				}
+				token.remove_prefix( moveStart );
+				if( token.empty() )
+				{
+					continue;
+				}
+
+				const Move m = pos.parseSan( token );
+				if( m == Move::NOMOVE )
+				{
+					game.error = "illegal move " + std::string( token ) + " at ply " + std::to_string( game.moves.size() + 1 );
+					return false;
+				}
+				pos.doMove( m );
+				game.moves.push_back( m );
+			}
+		}
+		return true;
+	}
+}
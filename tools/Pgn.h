@@ -0,0 +1,72 @@
+/*
+	This file is part of Vajolet.
+	Copyright (C) 2013-2018 Marco Belli
+
+    Vajolet is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Vajolet is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#ifndef PGN_H_
+#define PGN_H_
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include "GameRules.h"
+#include "./../Move.h"
+#include "./../Position.h"
+
+namespace tools
+{
+	/*!	\brief a game of a pgn file, replayed on a Position
+	 */
+	struct PgnGame
+	{
+		std::string fen;	// starting position, from the FEN tag
+		std::vector< libChess::Move > moves;
+		GameResult result = GameResult::none;
+		std::string error;	// why the game is invalid, empty for valid games
+
+		void clear();
+	};
+
+	/*!	\brief iterate the games of a pgn text, every game starts with a line beginning with [Event
+	 */
+	class PgnReader
+	{
+	public:
+		explicit PgnReader( std::string_view text );
+
+		bool getNextGame( std::string_view& game );
+
+		/*! \brief split a pgn text in about equal parts starting at the beginning of a game, to be read by different threads
+		*
+		*/
+		static std::vector< std::string_view > split( std::string_view text, const unsigned int parts );
+
+	private:
+		std::string_view _text;
+		size_t _position;
+
+		static size_t _findGameStart( std::string_view text, const size_t from );
+	};
+
+	/*! \brief parse the tags and the moves of a game and replay them on pos
+	*
+	*	comments, variations, numeric annotation glyphs and move numbers are skipped.
+	*	Return false and set game.error if the game has an invalid start position or an illegal move
+	*/
+	bool parsePgnGame( std::string_view text, libChess::Position& pos, PgnGame& game );
+}
+
+#endif /* PGN_H_ */
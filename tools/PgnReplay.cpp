@@ -0,0 +1,144 @@
+/*
+	This file is part of Vajolet.
+	Copyright (C) 2013-2018 Marco Belli
+
+    Vajolet is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Vajolet is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "MappedFile.h"
+#include "Pgn.h"
+#include "Tools.h"
+#include "./../Position.h"
+
+using namespace libChess;
+
+/*	pgn validator
+
+	the file is memory mapped and split in a part per thread, every thread replays the games of its part on its own Position
+	and collects the invalid games, that are reported with their line at the end.
+	options: input threads maxErrors
+*/
+namespace
+{
+	struct InvalidGame
+	{
+		size_t offset;
+		std::string error;
+	};
+
+	/*!	\brief results of the games read by a thread
+	 */
+	struct ThreadResult
+	{
+		unsigned long long games = 0;
+		unsigned long long moves = 0;
+		unsigned long long results[ 4 ] = { 0, 0, 0, 0 };	// indexed by GameResult
+		std::vector< InvalidGame > invalidGames;
+	};
+
+	void worker( const std::string_view text, const std::string_view chunk, ThreadResult& result )
+	{
+		Position pos;
+		tools::PgnGame game;
+		tools::PgnReader reader( chunk );
+		std::string_view gameText;
+		while( reader.getNextGame( gameText ) )
+		{
+			++result.games;
+			if( !tools::parsePgnGame( gameText, pos, game ) )
+			{
+				result.invalidGames.push_back( InvalidGame{ size_t( gameText.data() - text.data() ), game.error } );
+				continue;
+			}
+			result.moves += game.moves.size();
+			++result.results[ static_cast< int >( game.result ) ];
+		}
+	}
+}
+
+int main( int argc, char** argv )
+{
+	tools::init();
+
+	const tools::Options options( argc, argv );
+	if( !options.isValid() )
+	{
+		return 1;
+	}
+	const std::string input = options.getString( "input", "" );
+	const unsigned int threadsNumber = options.getInt( "threads", tools::getHardwareThreads() );
+	const unsigned int maxErrors = options.getInt( "maxErrors", 100 );
+
+	tools::MappedFile file;
+	if( !file.open( input ) )
+	{
+		std::cerr << "unable to read " << input << std::endl;
+		return 1;
+	}
+	const std::string_view text = file.getText();
+
+	const auto start = std::chrono::steady_clock::now();
+	const std::vector< std::string_view > chunks = tools::PgnReader::split( text, std::max( threadsNumber, 1u ) );
+	std::vector< ThreadResult > results( chunks.size() );
+	std::vector< std::thread > threads;
+	for( unsigned int i = 0; i < chunks.size(); ++i )
+	{
+		threads.emplace_back( worker, text, chunks[ i ], std::ref( results[ i ] ) );
+	}
+	for( auto& t : threads )
+	{
+		t.join();
+	}
+	const double seconds = std::chrono::duration< double >( std::chrono::steady_clock::now() - start ).count();
+
+	ThreadResult total;
+	for( const auto& r : results )
+	{
+		total.games += r.games;
+		total.moves += r.moves;
+		for( unsigned int i = 0; i < 4; ++i )
+		{
+			total.results[ i ] += r.results[ i ];
+		}
+		// the chunks are in file order, so are the invalid games
+		total.invalidGames.insert( total.invalidGames.end(), r.invalidGames.begin(), r.invalidGames.end() );
+	}
+
+	size_t line = 1;
+	size_t lineOffset = 0;
+	for( unsigned int i = 0; i < std::min< size_t >( maxErrors, total.invalidGames.size() ); ++i )
+	{
+		const InvalidGame& g = total.invalidGames[ i ];
+		line += std::count( text.begin() + lineOffset, text.begin() + g.offset, '\n' );
+		lineOffset = g.offset;
+		std::cout << "game at line " << line << ": " << g.error << std::endl;
+	}
+
+	std::cout << "games " << total.games << " moves " << total.moves << " invalid " << total.invalidGames.size()
+		<< " ( +" << total.results[ static_cast< int >( tools::GameResult::whiteWins ) ]
+		<< " -" << total.results[ static_cast< int >( tools::GameResult::blackWins ) ]
+		<< " =" << total.results[ static_cast< int >( tools::GameResult::draw ) ]
+		<< " *" << total.results[ static_cast< int >( tools::GameResult::none ) ] << " )" << std::endl;
+	std::cout << "time " << seconds << "s, " << (unsigned long long)( total.games * 60 / std::max( seconds, 1e-3 ) ) << " games/min, "
+		<< (unsigned long long)( total.moves / std::max( seconds, 1e-3 ) ) << " moves/s" << std::endl;
+	return total.invalidGames.empty() ? 0 : 2;
+}
@@ -0,0 +1,404 @@
+/*
+	This file is part of Vajolet.
+	Copyright (C) 2013-2018 Marco Belli
+
+    Vajolet is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Vajolet is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <queue>
+#include <thread>
+#include "PositionIndex.h"
+
+namespace tools
+{
+	namespace
+	{
+		struct Header
+		{
+			uint32_t magic;
+			uint32_t version;
+			uint64_t entriesNumber;
+		};
+
+		static_assert( sizeof( Header ) == PositionIndex::headerSize, "wrong header size" );
+
+		bool compareKey( const PositionIndexEntry& entry, const uint64_t key )
+		{
+			return entry.key < key;
+		}
+
+		bool compareGreaterKey( const uint64_t key, const PositionIndexEntry& entry )
+		{
+			return key < entry.key;
+		}
+
+		/*! \brief sort the entries in place in threads chunks, return the bounds of the chunks
+		*
+		*/
+		std::vector< size_t > sortChunks( std::vector< PositionIndexEntry >& entries, const unsigned int threadsNumber )
+		{
+			const size_t chunksNumber = std::max( std::min< size_t >( threadsNumber, entries.size() / 1024 ), size_t( 1 ) );
+			std::vector< size_t > bounds;
+			for( size_t i = 0; i <= chunksNumber; ++i )
+			{
+				bounds.push_back( entries.size() * i / chunksNumber );
+			}
+
+			std::vector< std::thread > threads;
+			for( size_t i = 0; i < chunksNumber; ++i )
+			{
+				threads.emplace_back( [&, i](){ std::sort( entries.begin() + bounds[ i ], entries.begin() + bounds[ i + 1 ] ); } );
+			}
+			for( auto& t : threads )
+			{
+				t.join();
+			}
+			return bounds;
+		}
+
+		/*!	\brief reader of a sorted chunk of the sort buffer
+		 */
+		class ChunkReader
+		{
+		public:
+			ChunkReader( const PositionIndexEntry* begin, const PositionIndexEntry* end ): _position( begin ), _end( end ){}
+
+			bool isEmpty() const { return _position == _end; }
+			const PositionIndexEntry& get() const { return *_position; }
+			void next(){ ++_position; }
+
+		private:
+			const PositionIndexEntry* _position;
+			const PositionIndexEntry* _end;
+		};
+
+		/*!	\brief buffered reader of a sorted run
+		 */
+		class RunReader
+		{
+		public:
+			explicit RunReader( std::FILE* file ): _file( file ), _buffer( PositionIndexWriter::mergeBufferEntries ){ _fill(); }
+			~RunReader(){ std::fclose( _file ); }
+
+			RunReader( const RunReader& ) = delete;
+			RunReader& operator=( const RunReader& ) = delete;
+
+			bool isEmpty() const { return _position == _size; }
+			const PositionIndexEntry& get() const { return _buffer[ _position ]; }
+			void next()
+			{
+				if( ++_position == _size )
+				{
+					_fill();
+				}
+			}
+
+		private:
+			std::FILE* _file;
+			std::vector< PositionIndexEntry > _buffer;
+			size_t _position = 0;
+			size_t _size = 0;
+
+			void _fill()
+			{
+				_size = std::fread( _buffer.data(), sizeof( PositionIndexEntry ), _buffer.size(), _file );
+				_position = 0;
+			}
+		};
+
+		/*! \brief k-way merge of sorted sources written through a buffer of mergeBufferEntries,
+		*	the queue holds the smallest entry not yet written of every source
+		*/
+		template< class Reader > bool mergeSorted( std::vector< std::unique_ptr< Reader > >& readers, std::FILE* output, uint64_t& written )
+		{
+			auto greater = [&]( const size_t a, const size_t b ){ return readers[ b ]->get() < readers[ a ]->get(); };
+			std::priority_queue< size_t, std::vector< size_t >, decltype( greater ) > queue( greater );
+			for( size_t i = 0; i < readers.size(); ++i )
+			{
+				if( !readers[ i ]->isEmpty() )
+				{
+					queue.push( i );
+				}
+			}
+			bool ok = true;
+			std::vector< PositionIndexEntry > buffer;
+			buffer.reserve( PositionIndexWriter::mergeBufferEntries );
+			while( !queue.empty() )
+			{
+				const size_t i = queue.top();
+				queue.pop();
+				buffer.push_back( readers[ i ]->get() );
+				readers[ i ]->next();
+				if( !readers[ i ]->isEmpty() )
+				{
+					queue.push( i );
+				}
+				if( buffer.size() == PositionIndexWriter::mergeBufferEntries || queue.empty() )
+				{
+					ok = std::fwrite( buffer.data(), sizeof( PositionIndexEntry ), buffer.size(), output ) == buffer.size() && ok;
+					written += buffer.size();
+					buffer.clear();
+				}
+			}
+			return ok;
+		}
+	}
+
+	std::string PositionIndex::getFileName( const std::string& name )
+	{
+		return name + ".vpi";
+	}
+
+	bool PositionIndex::open( const std::string& name )
+	{
+		_entries = nullptr;
+		_entriesNumber = 0;
+		if( !_file.open( getFileName( name ) ) || _file.size() < headerSize )
+		{
+			return false;
+		}
+		Header header;
+		std::memcpy( &header, _file.data(), headerSize );
+		if( header.magic != magic || header.version != version || _file.size() != headerSize + header.entriesNumber * sizeof( PositionIndexEntry ) )
+		{
+			return false;
+		}
+		_entries = reinterpret_cast< const PositionIndexEntry* >( _file.data() + headerSize );
+		_entriesNumber = header.entriesNumber;
+		return true;
+	}
+
+	/*! \brief first entry whose key isn't less than key
+	*
+	*/
+	const PositionIndexEntry* PositionIndex::_lowerBound( const uint64_t key ) const
+	{
+		// the result is always in [ low, high ]: the entries before low have a smaller key, the ones from high a key not smaller
+		uint64_t low = 0;
+		uint64_t high = _entriesNumber;
+		for( unsigned int step = 0; step < maxInterpolationSteps && high - low > binarySearchSize; ++step )
+		{
+			const uint64_t lowKey = _entries[ low ].key;
+			const uint64_t highKey = _entries[ high - 1 ].key;
+			if( key <= lowKey )
+			{
+				return _entries + low;
+			}
+			if( key > highKey )
+			{
+				return _entries + high;
+			}
+			const double fraction = double( key - lowKey ) / double( highKey - lowKey );
+			const uint64_t probe = std::min( low + uint64_t( fraction * double( high - 1 - low ) ), high - 1 );
+			if( _entries[ probe ].key < key )
+			{
+				low = probe + 1;
+			}
+			else
+			{
+				high = probe;
+			}
+		}
+		return std::lower_bound( _entries + low, _entries + high, key, compareKey );
+	}
+
+	/*! \brief entries of the positions with the given key, sorted by game and ply
+	*
+	*/
+	std::pair< const PositionIndexEntry*, const PositionIndexEntry* > PositionIndex::find( const uint64_t key ) const
+	{
+		const PositionIndexEntry* first = _lowerBound( key );
+		return std::make_pair( first, std::upper_bound( first, end(), key, compareGreaterKey ) );
+	}
+
+	PositionIndexWriter::PositionIndexWriter( const size_t memoryLimit, const unsigned int threads ):
+		// the sort buffer shares the memory with the output buffer of the run
+		_capacity( std::max( ( memoryLimit - std::min( memoryLimit, mergeBufferEntries * sizeof( PositionIndexEntry ) ) ) / sizeof( PositionIndexEntry ), size_t( 1 ) ) ),
+		// the merge needs a buffer for every input run and one for the output
+		_fanIn( std::clamp( memoryLimit / ( mergeBufferEntries * sizeof( PositionIndexEntry ) ), size_t( 3 ), maxMergeFanIn + 1 ) - 1 ),
+		_threads( threads )
+	{
+	}
+
+	PositionIndexWriter::~PositionIndexWriter()
+	{
+		_removeRuns();
+	}
+
+	bool PositionIndexWriter::open( const std::string& name )
+	{
+		_removeRuns();
+		_name = name;
+		_buffer.clear();
+		_buffer.reserve( _capacity );
+		_entriesNumber = 0;
+		_runsNumber = 0;
+		_mergePasses = 0;
+		_open = true;
+		return true;
+	}
+
+	/*! \brief add entries in any order, a run is written every time the buffer is full
+	*
+	*/
+	bool PositionIndexWriter::add( const std::vector< PositionIndexEntry >& entries )
+	{
+		if( !_open )
+		{
+			return false;
+		}
+		auto it = entries.begin();
+		while( it != entries.end() )
+		{
+			const size_t count = std::min< size_t >( _capacity - _buffer.size(), entries.end() - it );
+			_buffer.insert( _buffer.end(), it, it + count );
+			it += count;
+			if( _buffer.size() == _capacity && !_writeRun() )
+			{
+				return false;
+			}
+		}
+		_entriesNumber += entries.size();
+		return true;
+	}
+
+	std::string PositionIndexWriter::_getRunName() const
+	{
+		return _name + ".run" + std::to_string( _runs.size() );
+	}
+
+	/*! \brief sort the buffer in chunks, one for every thread, and merge the chunks in a run file
+	*
+	*	the chunks are merged while writing, so no memory is needed besides the output buffer
+	*/
+	bool PositionIndexWriter::_writeRun()
+	{
+		const std::vector< size_t > bounds = sortChunks( _buffer, _threads );
+		const std::string runName = _getRunName();
+		++_runsNumber;
+		std::FILE* file = std::fopen( runName.c_str(), "wb" );
+		if( !file )
+		{
+			return false;
+		}
+		_runs.push_back( runName );
+		std::vector< std::unique_ptr< ChunkReader > > readers;
+		for( size_t i = 0; i + 1 < bounds.size(); ++i )
+		{
+			readers.emplace_back( new ChunkReader( _buffer.data() + bounds[ i ], _buffer.data() + bounds[ i + 1 ] ) );
+		}
+		uint64_t written = 0;
+		bool ok = mergeSorted( readers, file, written ) && written == _buffer.size();
+		_buffer.clear();
+		return std::fclose( file ) == 0 && ok;
+	}
+
+	/*! \brief write the remaining entries and merge all the runs in the index file
+	*
+	*/
+	bool PositionIndexWriter::close()
+	{
+		if( !_open )
+		{
+			return false;
+		}
+		_open = false;
+		bool ok = _buffer.empty() || _writeRun();
+		// the memory of the buffer is used by the merge
+		std::vector< PositionIndexEntry >().swap( _buffer );
+		ok = ok && _merge();
+		_removeRuns();
+		return ok;
+	}
+
+	bool PositionIndexWriter::_merge()
+	{
+		// merge groups of _fanIn runs until the remaining runs can be merged at once, every pass removes its input runs
+		std::vector< std::string > pending = _runs;
+		while( pending.size() > _fanIn )
+		{
+			++_mergePasses;
+			std::vector< std::string > merged;
+			for( size_t first = 0; first < pending.size(); first += _fanIn )
+			{
+				const std::vector< std::string > group( pending.begin() + first, pending.begin() + std::min( first + _fanIn, pending.size() ) );
+				if( group.size() == 1 )
+				{
+					merged.push_back( group[ 0 ] );
+					continue;
+				}
+				const std::string runName = _getRunName();
+				std::FILE* file = std::fopen( runName.c_str(), "wb" );
+				if( !file )
+				{
+					return false;
+				}
+				_runs.push_back( runName );
+				merged.push_back( runName );
+				uint64_t written = 0;
+				bool ok = _mergeRuns( group, file, written );
+				ok = std::fclose( file ) == 0 && ok;
+				if( !ok )
+				{
+					return false;
+				}
+				for( const auto& run : group )
+				{
+					std::remove( run.c_str() );
+				}
+			}
+			pending.swap( merged );
+		}
+
+		std::FILE* file = std::fopen( PositionIndex::getFileName( _name ).c_str(), "wb" );
+		if( !file )
+		{
+			return false;
+		}
+		const Header header = { PositionIndex::magic, PositionIndex::version, _entriesNumber };
+		bool ok = std::fwrite( &header, sizeof( header ), 1, file ) == 1;
+		uint64_t written = 0;
+		ok = _mergeRuns( pending, file, written ) && ok;
+		ok = std::fclose( file ) == 0 && ok;
+		return ok && written == _entriesNumber;
+	}
+
+	bool PositionIndexWriter::_mergeRuns( const std::vector< std::string >& runs, std::FILE* output, uint64_t& written ) const
+	{
+		std::vector< std::unique_ptr< RunReader > > readers;
+		for( const auto& run : runs )
+		{
+			std::FILE* runFile = std::fopen( run.c_str(), "rb" );
+			if( !runFile )
+			{
+				return false;
+			}
+			readers.emplace_back( new RunReader( runFile ) );
+		}
+		return mergeSorted( readers, output, written );
+	}
+
+	void PositionIndexWriter::_removeRuns()
+	{
+		for( const auto& run : _runs )
+		{
+			std::remove( run.c_str() );
+		}
+		_runs.clear();
+	}
+}
@@ -0,0 +1,169 @@
+/*
+	This file is part of Vajolet.
+	Copyright (C) 2013-2018 Marco Belli
+
+    Vajolet is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Vajolet is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#ifndef POSITIONINDEX_H_
+#define POSITIONINDEX_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+#include "MappedFile.h"
+
+namespace tools
+{
+	/*!	\brief a position reached in a game of a database: the hash key of the position, the game id and the ply
+	 */
+	struct PositionIndexEntry
+	{
+		uint64_t key;
+		uint32_t game;
+		uint32_t ply;
+
+		bool operator<( const PositionIndexEntry& other ) const;
+	};
+
+	static_assert( sizeof( PositionIndexEntry ) == 16, "the entries are read in place from the mapped file" );
+
+	/*!	\brief index of the positions of a game database, read only
+
+		name.vpi is a 16 bytes header ( magic, version and number of entries ) followed by the entries sorted by key, game and ply.
+		The entries are stored in the byte order of the machine, so that the mapped file is searched in place.
+		The lookup is an interpolation search, the hash keys are uniformly distributed, that falls back to a binary search
+	 */
+	class PositionIndex
+	{
+	public:
+		bool open( const std::string& name );
+
+		uint64_t getEntriesNumber() const;
+		const PositionIndexEntry* begin() const;
+		const PositionIndexEntry* end() const;
+		std::pair< const PositionIndexEntry*, const PositionIndexEntry* > find( const uint64_t key ) const;
+
+		static std::string getFileName( const std::string& name );
+
+		static constexpr uint32_t magic = 0x31495056;	// VPI1
+		static constexpr uint32_t version = 1;
+		static constexpr size_t headerSize = 16;
+		static constexpr uint64_t binarySearchSize = 64;	// ranges smaller than this are binary searched
+		static constexpr unsigned int maxInterpolationSteps = 16;
+
+	private:
+		MappedFile _file;
+		const PositionIndexEntry* _entries = nullptr;
+		uint64_t _entriesNumber = 0;
+
+		const PositionIndexEntry* _lowerBound( const uint64_t key ) const;
+	};
+
+	/*!	\brief write a position index with bounded memory
+
+		the entries are collected in a buffer of memoryLimit bytes, less an output buffer of mergeBufferEntries, when the
+		buffer is full it's sorted and written in a temporary run file. close merges the runs in the index file. The memory limit bounds the merge too: every run merged
+		at the same time needs a buffer of mergeBufferEntries, so when there are more runs than buffers they are merged in
+		several passes
+	 */
+	class PositionIndexWriter
+	{
+	public:
+		PositionIndexWriter( const size_t memoryLimit, const unsigned int threads );
+		~PositionIndexWriter();
+
+		PositionIndexWriter( const PositionIndexWriter& ) = delete;
+		PositionIndexWriter& operator=( const PositionIndexWriter& ) = delete;
+
+		bool open( const std::string& name );
+		bool add( const std::vector< PositionIndexEntry >& entries );
+		bool close();
+
+		uint64_t getEntriesNumber() const;
+		unsigned int getRunsNumber() const;
+		unsigned int getMergePassesNumber() const;
+
+		static constexpr size_t mergeBufferEntries = 4096;	// entries read at a time from every run while merging
+		static constexpr size_t maxMergeFanIn = 64;	// maximum number of runs merged at the same time, to bound the open files
+
+	private:
+		std::string _name;
+		bool _open = false;
+		size_t _capacity;
+		size_t _fanIn;
+		unsigned int _threads;
+		std::vector< PositionIndexEntry > _buffer;
+		std::vector< std::string > _runs;	// all the temporary files, removed at the end
+		uint64_t _entriesNumber = 0;
+		unsigned int _runsNumber = 0;
+		unsigned int _mergePasses = 0;
+
+		std::string _getRunName() const;
+		bool _writeRun();
+		bool _merge();
+		bool _mergeRuns( const std::vector< std::string >& runs, std::FILE* output, uint64_t& written ) const;
+		void _removeRuns();
+	};
+
+	inline bool PositionIndexEntry::operator<( const PositionIndexEntry& other ) const
+	{
+		if( key != other.key )
+		{
+			return key < other.key;
+		}
+		if( game != other.game )
+		{
+			return game < other.game;
+		}
+		return ply < other.ply;
+	}
+
+	inline uint64_t PositionIndex::getEntriesNumber() const
+	{
+		return _entriesNumber;
+	}
+
+	inline const PositionIndexEntry* PositionIndex::begin() const
+	{
+		return _entries;
+	}
+
+	inline const PositionIndexEntry* PositionIndex::end() const
+	{
+		return _entries + _entriesNumber;
+	}
+
+	inline uint64_t PositionIndexWriter::getEntriesNumber() const
+	{
+		return _entriesNumber;
+	}
+
+	inline unsigned int PositionIndexWriter::getRunsNumber() const
+	{
+		return _runsNumber;
+	}
+
+	/*! \brief merge passes done before the final one writing the index
+	*
+	*/
+	inline unsigned int PositionIndexWriter::getMergePassesNumber() const
+	{
+		return _mergePasses;
+	}
+}
+
+#endif /* POSITIONINDEX_H_ */
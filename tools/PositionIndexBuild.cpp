@@ -0,0 +1,173 @@
+/*
+	This file is part of Vajolet.
+	Copyright (C) 2013-2018 Marco Belli
+
+    Vajolet is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Vajolet is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "GameDatabase.h"
+#include "PositionIndex.h"
+#include "Tools.h"
+#include "./../Position.h"
+
+using namespace libChess;
+
+/*	build the index of the positions reached in the games of a database
+
+	db=<name>: game database written by Vajolet_gamedb
+	output=<name>: index name, the database name by default
+	threads: threads replaying the games and sorting the entries
+	memory: size in MB of the buffers, half is used by the threads replaying the games and half by the external sort.
+		Every thread needs at least the room for the positions of a game
+	maxPly: index only the first plies of the games, 0 to index the whole games
+*/
+namespace
+{
+	constexpr unsigned int maxGamePlies = 1024;	// longer games are indexed up to this ply, so that a game always fits the buffer of a thread
+
+	struct ReplayResult
+	{
+		std::vector< tools::PositionIndexEntry > entries;	// reserved for maxEntries plus the positions of a game, never reallocated
+		unsigned long long errors = 0;
+		unsigned long long truncatedGames = 0;
+	};
+
+	/*! \brief replay the next games of the database until the buffer of the thread is full, the positions are read going back from the end of the game
+	*
+	*	a game is replayed while the buffer has less than maxEntries, so the buffer never exceeds maxEntries plus the positions of a game
+	*/
+	void replayGames( const tools::GameDatabase& db, std::atomic< uint64_t >& nextGame, const size_t maxEntries, const unsigned int maxPly, ReplayResult& result )
+	{
+		Position pos;
+		std::vector< Move > moves;
+		GameCodec::Result gameResult;
+		uint64_t id;
+		while( result.entries.size() < maxEntries && ( id = nextGame++ ) < db.getGamesNumber() )
+		{
+			if( !db.getGame( id, pos, moves, gameResult ) )
+			{
+				++result.errors;
+				continue;
+			}
+			if( moves.size() > maxGamePlies )
+			{
+				++result.truncatedGames;
+			}
+			for( unsigned int ply = moves.size(); ; --ply )
+			{
+				if( ply <= maxPly )
+				{
+					result.entries.push_back( { pos.getActualStateConst().getKey().getKey(), uint32_t( id ), ply } );
+				}
+				if( ply == 0 )
+				{
+					break;
+				}
+				pos.undoMove();
+			}
+		}
+	}
+}
+
+int main( int argc, char** argv )
+{
+	tools::init();
+
+	const tools::Options options( argc, argv );
+	if( !options.isValid() )
+	{
+		return 1;
+	}
+	const std::string dbName = options.getString( "db", "games" );
+	const std::string output = options.getString( "output", dbName );
+	const unsigned int threadsNumber = std::max( (unsigned int)options.getInt( "threads", tools::getHardwareThreads() ), 1u );
+	const size_t memory = std::max( options.getInt( "memory", 256 ), 1ll ) << 20;
+	const unsigned int requestedMaxPly = std::max( options.getInt( "maxPly", 0 ), 0ll );
+	const unsigned int maxPly = requestedMaxPly == 0 ? maxGamePlies : std::min( requestedMaxPly, maxGamePlies );
+
+	tools::GameDatabase db;
+	if( !db.open( dbName ) )
+	{
+		std::cerr << "unable to open the database " << dbName << std::endl;
+		return 1;
+	}
+	if( db.getGamesNumber() > UINT32_MAX )
+	{
+		std::cerr << "too many games for the index" << std::endl;
+		return 1;
+	}
+	tools::PositionIndexWriter writer( memory / 2, threadsNumber );
+	if( !writer.open( output ) )
+	{
+		std::cerr << "unable to write " << output << std::endl;
+		return 1;
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+	unsigned long long errors = 0;
+	unsigned long long truncatedGames = 0;
+	const uint64_t gamesNumber = db.getGamesNumber();
+	const size_t gameEntries = maxPly + 1;
+	const size_t threadEntries = memory / 2 / threadsNumber / sizeof( tools::PositionIndexEntry );
+	const size_t entriesPerThread = std::max( threadEntries, gameEntries + 1 ) - gameEntries;
+	std::vector< ReplayResult > results( threadsNumber );
+	for( auto& result : results )
+	{
+		result.entries.reserve( entriesPerThread + gameEntries );
+	}
+	std::atomic< uint64_t > nextGame( 0 );
+	while( nextGame < gamesNumber )
+	{
+		// every round the threads fill their buffers, then the entries are passed to the writer
+		std::vector< std::thread > threads;
+		for( unsigned int t = 0; t < threadsNumber; ++t )
+		{
+			results[ t ].entries.clear();
+			results[ t ].errors = 0;
+			results[ t ].truncatedGames = 0;
+			threads.emplace_back( replayGames, std::cref( db ), std::ref( nextGame ), entriesPerThread, maxPly, std::ref( results[ t ] ) );
+		}
+		for( auto& t : threads )
+		{
+			t.join();
+		}
+		for( const auto& result : results )
+		{
+			if( !writer.add( result.entries ) )
+			{
+				std::cerr << "error writing the sorted runs" << std::endl;
+				return 1;
+			}
+			errors += result.errors;
+			truncatedGames += result.truncatedGames;
+		}
+	}
+	if( !writer.close() )
+	{
+		std::cerr << "error writing " << tools::PositionIndex::getFileName( output ) << std::endl;
+		return 1;
+	}
+
+	const double seconds = std::chrono::duration< double >( std::chrono::steady_clock::now() - start ).count();
+	std::cout << "indexed " << writer.getEntriesNumber() << " positions of " << gamesNumber << " games ( " << errors << " unreadable, " << truncatedGames << " longer than " << maxGamePlies << " plies ), " << writer.getRunsNumber() << " sorted runs merged in " << writer.getMergePassesNumber() + 1 << " passes, in " << seconds << "s" << std::endl;
+	return errors ? 2 : 0;
+}
@@ -0,0 +1,178 @@
+/*
+	This file is part of Vajolet.
+	Copyright (C) 2013-2018 Marco Belli
+
+    Vajolet is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Vajolet is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "GameDatabase.h"
+#include "PositionIndex.h"
+#include "Tools.h"
+#include "./../Position.h"
+
+using namespace libChess;
+
+/*	find the games of a database that reached a position
+
+	index=<name>: position index written by Vajolet_index
+	db=<name>: optional game database, used to print the result of the games and the move played
+	fen: position to search, the start position by default
+	moves: san moves played from fen, separated by spaces
+	limit: maximum number of games printed
+	bench: number of random lookups to time, the query isn't run
+*/
+namespace
+{
+	std::string to_string( const GameCodec::Result result )
+	{
+		switch( result )
+		{
+		case GameCodec::Result::whiteWins:
+			return "1-0";
+		case GameCodec::Result::blackWins:
+			return "0-1";
+		case GameCodec::Result::draw:
+			return "1/2-1/2";
+		default:
+			return "*";
+		}
+	}
+
+	int bench( const tools::PositionIndex& index, const unsigned long long lookups )
+	{
+		if( index.getEntriesNumber() == 0 )
+		{
+			std::cerr << "the index is empty" << std::endl;
+			return 1;
+		}
+		// half of the lookups search keys in the index, the others random keys that usually aren't
+		std::mt19937_64 rnd( 0x5eed );
+		std::vector< uint64_t > keys;
+		for( unsigned long long i = 0; i < lookups; ++i )
+		{
+			keys.push_back( i & 1 ? rnd() : index.begin()[ rnd() % index.getEntriesNumber() ].key );
+		}
+
+		unsigned long long found = 0;
+		const auto start = std::chrono::steady_clock::now();
+		for( const auto key : keys )
+		{
+			const auto range = index.find( key );
+			found += range.second - range.first;
+		}
+		const double seconds = std::chrono::duration< double >( std::chrono::steady_clock::now() - start ).count();
+		std::cout << lookups << " lookups in " << index.getEntriesNumber() << " entries, " << found << " entries found in " << seconds << "s ( "
+			<< seconds * 1e9 / std::max( lookups, 1ull ) << " ns per lookup )" << std::endl;
+		return 0;
+	}
+}
+
+int main( int argc, char** argv )
+{
+	tools::init();
+
+	const tools::Options options( argc, argv );
+	if( !options.isValid() )
+	{
+		return 1;
+	}
+
+	tools::PositionIndex index;
+	const std::string indexName = options.getString( "index", "games" );
+	if( !index.open( indexName ) )
+	{
+		std::cerr << "unable to open the index " << indexName << std::endl;
+		return 1;
+	}
+	const long long lookups = options.getInt( "bench", 0 );
+	if( lookups > 0 )
+	{
+		return bench( index, lookups );
+	}
+
+	Position pos;
+	const std::string fen = options.getString( "fen", "" );
+	if( !( fen.empty() ? pos.setupFromFen() : pos.setupFromFen( fen ) ) )
+	{
+		std::cerr << "invalid fen " << fen << std::endl;
+		return 1;
+	}
+	std::istringstream moves( options.getString( "moves", "" ) );
+	std::string san;
+	while( moves >> san )
+	{
+		const Move m = pos.parseSan( san );
+		if( m == Move::NOMOVE )
+		{
+			std::cerr << "illegal move " << san << std::endl;
+			return 1;
+		}
+		pos.doMove( m );
+	}
+
+	const auto range = index.find( pos.getActualStateConst().getKey().getKey() );
+	unsigned long long games = 0;
+	for( auto entry = range.first; entry != range.second; ++entry )
+	{
+		if( entry == range.first || entry->game != ( entry - 1 )->game )
+		{
+			++games;
+		}
+	}
+	std::cout << pos.getFen() << std::endl;
+	std::cout << "found in " << games << " games, " << range.second - range.first << " times" << std::endl;
+
+	tools::GameDatabase db;
+	const std::string dbName = options.getString( "db", "" );
+	const bool hasDb = !dbName.empty();
+	if( hasDb && !db.open( dbName ) )
+	{
+		std::cerr << "unable to open the database " << dbName << std::endl;
+		return 1;
+	}
+
+	const long long limit = options.getInt( "limit", 20 );
+	long long printed = 0;
+	for( auto entry = range.first; entry != range.second && printed < limit; ++entry, ++printed )
+	{
+		std::cout << "game " << entry->game << " ply " << entry->ply;
+		Position game;
+		std::vector< Move > gameMoves;
+		GameCodec::Result result;
+		if( hasDb && db.getGame( entry->game, game, gameMoves, result ) && entry->ply <= gameMoves.size() )
+		{
+			for( size_t i = gameMoves.size(); i > entry->ply; --i )
+			{
+				game.undoMove();
+			}
+			std::cout << " " << to_string( result );
+			if( entry->ply < gameMoves.size() )
+			{
+				char move[ Position::maxSanLength ];
+				game.getSan( gameMoves[ entry->ply ], move );
+				std::cout << " next " << move;
+			}
+		}
+		std::cout << std::endl;
+	}
+	return 0;
+}
@@ -0,0 +1,270 @@
+/*
+	This file is part of Vajolet.
+	Copyright (C) 2013-2018 Marco Belli
+
+    Vajolet is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Vajolet is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "GameRules.h"
+#include "Tools.h"
+#include "./../MoveGenerator.h"
+#include "./../MoveList.h"
+#include "./../MoveSelector.h"
+#include "./../PackedPosition.h"
+#include "./../Position.h"
+#include "./../Search.h"
+#include "./../TranspositionTable.h"
+
+using namespace libChess;
+
+/*	self play training data generator
+
+	every thread plays its games with its own Position, Search and transposition table and writes the records to its own file,
+	so the threads share nothing but the game counter.
+	options: games threads nodes depth randomPlies maxPlies hash seed output and the AdjudicationSettings ones
+*/
+namespace
+{
+	struct Settings
+	{
+		unsigned long long games;
+		unsigned int threads;
+		unsigned long long nodes;
+		unsigned int depth;
+		unsigned int randomPlies;
+		unsigned int maxPlies;
+		unsigned int hash;
+		unsigned int seed;
+		std::string output;
+		tools::AdjudicationSettings adjudication;
+	};
+
+	/*!	\brief buffered writer of the records of a thread
+
+		the records are collected in a buffer owned by the thread and written to its file when the buffer is full
+	 */
+	class RecordWriter
+	{
+	public:
+		explicit RecordWriter( const std::string& fileName ): _file( std::fopen( fileName.c_str(), "wb" ) )
+		{
+			_buffer.reserve( bufferSize );
+		}
+
+		~RecordWriter()
+		{
+			flush();
+			if( _file )
+			{
+				std::fclose( _file );
+			}
+		}
+
+		RecordWriter( const RecordWriter& ) = delete;
+		RecordWriter& operator=( const RecordWriter& ) = delete;
+
+		bool isOpen() const
+		{
+			return _file != nullptr;
+		}
+
+		void write( const TrainingRecord& record )
+		{
+			_buffer.push_back( record );
+			if( _buffer.size() == bufferSize )
+			{
+				flush();
+			}
+		}
+
+		void flush()
+		{
+			if( _file && !_buffer.empty() )
+			{
+				std::fwrite( _buffer.data(), sizeof( TrainingRecord ), _buffer.size(), _file );
+			}
+			_buffer.clear();
+		}
+
+		static constexpr size_t bufferSize = 1 << 16;
+
+	private:
+		std::FILE* _file;
+		std::vector< TrainingRecord > _buffer;
+	};
+
+	std::atomic< unsigned long long > nextGame( 0 );
+	std::atomic< unsigned long long > playedGames( 0 );
+	std::atomic< unsigned long long > writtenPositions( 0 );
+	std::atomic< unsigned long long > results[ 3 ];	// white wins, black wins, draws
+	std::atomic< unsigned int > runningThreads( 0 );
+
+	/*! \brief play random legal moves, return false if the game ended
+	*
+	*/
+	bool playRandomOpening( Position& pos, const unsigned int plies, std::mt19937& rnd )
+	{
+		for( unsigned int i = 0; i < plies; ++i )
+		{
+			MoveList< MoveSelector::maxMovePerPosition > ml;
+			MoveGenerator::generateMoves< MoveGenerator::allMg >( pos, ml );
+			if( ml.size() == 0 )
+			{
+				return false;
+			}
+			pos.doMove( ml.get( rnd() % ml.size() ) );
+		}
+		return tools::getGameResult( pos ) == tools::GameResult::none;
+	}
+
+	void playGame( const Settings& settings, Position& pos, Search& search, std::mt19937& rnd, RecordWriter& writer )
+	{
+		do
+		{
+			pos.setupFromFen();
+		}
+		while( !playRandomOpening( pos, settings.randomPlies, rnd ) );
+		search.clear();
+
+		SearchLimits limits;
+		limits.nodes = settings.nodes;
+		limits.depth = settings.depth;
+
+		tools::Adjudicator adjudicator( settings.adjudication );
+		std::vector< TrainingRecord > records;
+		std::vector< bool > whiteTurns;
+		tools::GameResult result = tools::GameResult::none;
+		for( unsigned int ply = settings.randomPlies; result == tools::GameResult::none; ++ply )
+		{
+			if( ( result = tools::getGameResult( pos ) ) != tools::GameResult::none )
+			{
+				break;
+			}
+			if( ply >= settings.maxPlies )
+			{
+				result = tools::GameResult::draw;
+				break;
+			}
+
+			const Score score = search.search( limits );
+			const Move bestMove = search.getBestMove() != Move::NOMOVE ? search.getBestMove() : MoveSelector( pos ).getNextMove();
+
+			// positions in check or with a mate score don't help to train the evaluation
+			if( !pos.isInCheck() && std::abs( score ) < Search::mateInMaxPly )
+			{
+				records.push_back( TrainingRecord{ PackedPosition( pos ), int16_t( score ), 0, 0, bestMove.getPacked(), uint16_t( ply ) } );
+				whiteTurns.push_back( pos.isWhiteTurn() );
+			}
+
+			result = adjudicator.update( pos, score, ply );
+			pos.doMove( bestMove );
+		}
+
+		for( unsigned int i = 0; i < records.size(); ++i )
+		{
+			records[ i ].result = tools::getResultFor( result, whiteTurns[ i ] ? baseTypes::whiteTurn : baseTypes::blackTurn );
+			writer.write( records[ i ] );
+		}
+		writtenPositions += records.size();
+		++results[ result == tools::GameResult::whiteWins ? 0 : ( result == tools::GameResult::blackWins ? 1 : 2 ) ];
+		++playedGames;
+	}
+
+	void worker( const Settings& settings, const unsigned int id )
+	{
+		RecordWriter writer( settings.output + "_" + std::to_string( id ) + ".bin" );
+		if( !writer.isOpen() )
+		{
+			std::cerr << "unable to open the output file of thread " << id << std::endl;
+			return;
+		}
+		Position pos;
+		TranspositionTable tt( settings.hash );
+		Search search( pos, tt );
+		std::mt19937 rnd( settings.seed + id );
+
+		while( nextGame++ < settings.games )
+		{
+			playGame( settings, pos, search, rnd, writer );
+		}
+	}
+
+	void runWorker( const Settings& settings, const unsigned int id )
+	{
+		worker( settings, id );
+		--runningThreads;
+	}
+}
+
+int main( int argc, char** argv )
+{
+	tools::init();
+
+	const tools::Options options( argc, argv );
+	if( !options.isValid() )
+	{
+		return 1;
+	}
+
+	Settings settings;
+	settings.games = options.getInt( "games", 100 );
+	settings.threads = options.getInt( "threads", tools::getHardwareThreads() );
+	settings.nodes = options.getInt( "nodes", 5000 );
+	settings.depth = options.getInt( "depth", 0 );
+	settings.randomPlies = options.getInt( "randomPlies", 8 );
+	settings.maxPlies = options.getInt( "maxPlies", 400 );
+	settings.hash = options.getInt( "hash", 16 );
+	settings.seed = options.getInt( "seed", 19091979 );
+	settings.output = options.getString( "output", "selfplay" );
+	settings.adjudication.resignScore = options.getInt( "resignScore", settings.adjudication.resignScore );
+	settings.adjudication.resignPlies = options.getInt( "resignPlies", settings.adjudication.resignPlies );
+	settings.adjudication.drawScore = options.getInt( "drawScore", settings.adjudication.drawScore );
+	settings.adjudication.drawPlies = options.getInt( "drawPlies", settings.adjudication.drawPlies );
+	settings.adjudication.drawMinPly = options.getInt( "drawMinPly", settings.adjudication.drawMinPly );
+	if( settings.nodes == 0 && settings.depth == 0 )
+	{
+		std::cerr << "a nodes or depth limit is needed" << std::endl;
+		return 1;
+	}
+
+	std::cout << "playing " << settings.games << " games on " << settings.threads << " threads, writing " << settings.output << "_N.bin" << std::endl;
+	const auto start = std::chrono::steady_clock::now();
+
+	std::vector< std::thread > threads;
+	runningThreads = settings.threads;
+	for( unsigned int i = 0; i < settings.threads; ++i )
+	{
+		threads.emplace_back( runWorker, std::cref( settings ), i );
+	}
+	while( runningThreads > 0 )
+	{
+		std::this_thread::sleep_for( std::chrono::seconds( 1 ) );
+		const double seconds = std::chrono::duration< double >( std::chrono::steady_clock::now() - start ).count();
+		std::cout << "games " << playedGames << " positions " << writtenPositions << " ( " << (unsigned long long)( writtenPositions / seconds ) << " pos/s )"
+			<< " +" << results[ 0 ] << " -" << results[ 1 ] << " =" << results[ 2 ] << std::endl;
+	}
+	for( auto& t : threads )
+	{
+		t.join();
+	}
+	return 0;
+}
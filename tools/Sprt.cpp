@@ -0,0 +1,99 @@
+/*
+	This file is part of Vajolet.
+	Copyright (C) 2013-2018 Marco Belli
+
+    Vajolet is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Vajolet is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#include <algorithm>
+#include <cmath>
+#include "Sprt.h"
+
+namespace tools
+{
+	namespace
+	{
+		double getScore( const double elo )
+		{
+			return 1.0 / ( 1.0 + std::pow( 10.0, -elo / 400.0 ) );
+		}
+
+		double getEloFromScore( const double score )
+		{
+			return -400.0 * std::log10( 1.0 / score - 1.0 );
+		}
+	}
+
+	Sprt::Sprt( const double elo0, const double elo1, const double alpha, const double beta ):
+		_score0( getScore( elo0 ) ), _score1( getScore( elo1 ) ),
+		_lowerBound( std::log( beta / ( 1.0 - alpha ) ) ), _upperBound( std::log( ( 1.0 - beta ) / alpha ) )
+	{
+	}
+
+	double Sprt::getLLR( const unsigned long long wins, const unsigned long long losses, const unsigned long long draws ) const
+	{
+		if( wins + losses + draws == 0 )
+		{
+			return 0.0;
+		}
+		// a pseudo count for every outcome keeps the variance positive, so that one sided results as a sweep are decided
+		const double n = double( wins + losses + draws ) + 3.0 * pseudoCount;
+		const double w = ( wins + pseudoCount ) / n;
+		const double l = ( losses + pseudoCount ) / n;
+		const double d = ( draws + pseudoCount ) / n;
+		const double s = w + d / 2.0;
+		const double variance = w * ( 1.0 - s ) * ( 1.0 - s ) + l * s * s + d * ( 0.5 - s ) * ( 0.5 - s );
+		return n * ( _score1 - _score0 ) * ( 2.0 * s - _score0 - _score1 ) / ( 2.0 * variance );
+	}
+
+	Sprt::Result Sprt::getResult( const unsigned long long wins, const unsigned long long losses, const unsigned long long draws ) const
+	{
+		const double llr = getLLR( wins, losses, draws );
+		if( llr >= _upperBound )
+		{
+			return Result::acceptH1;
+		}
+		if( llr <= _lowerBound )
+		{
+			return Result::acceptH0;
+		}
+		return Result::none;
+	}
+
+	double Sprt::getLowerBound() const
+	{
+		return _lowerBound;
+	}
+
+	double Sprt::getUpperBound() const
+	{
+		return _upperBound;
+	}
+
+	double Sprt::getElo( const unsigned long long wins, const unsigned long long losses, const unsigned long long draws, double& errorMargin )
+	{
+		const double n = double( wins + losses + draws );
+		errorMargin = 0.0;
+		if( n == 0.0 )
+		{
+			return 0.0;
+		}
+		const double s = std::clamp( ( wins + draws / 2.0 ) / n, 1e-6, 1.0 - 1e-6 );
+		const double variance = ( wins * ( 1.0 - s ) * ( 1.0 - s ) + losses * s * s + draws * ( 0.5 - s ) * ( 0.5 - s ) ) / n;
+		const double deviation = std::sqrt( variance / n );
+		const double elo = getEloFromScore( s );
+		errorMargin = ( getEloFromScore( std::min( s + 1.96 * deviation, 1.0 - 1e-6 ) ) - getEloFromScore( std::max( s - 1.96 * deviation, 1e-6 ) ) ) / 2.0;
+		return elo;
+	}
+}
@@ -0,0 +1,61 @@
+/*
+	This file is part of Vajolet.
+	Copyright (C) 2013-2018 Marco Belli
+
+    Vajolet is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Vajolet is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#ifndef SPRT_H_
+#define SPRT_H_
+
+namespace tools
+{
+	/*!	\brief sequential probability ratio test between two elo hypotheses
+
+		the log likelihood ratio is computed with the normal approximation of the game score ( win 1, draw 0.5, loss 0 ),
+		the test accepts elo1 when it's above the upper bound and elo0 when it's below the lower bound
+	 */
+	class Sprt
+	{
+	public:
+		enum class Result
+		{
+			none,
+			acceptH0,
+			acceptH1
+		};
+
+		Sprt( const double elo0, const double elo1, const double alpha, const double beta );
+
+		double getLLR( const unsigned long long wins, const unsigned long long losses, const unsigned long long draws ) const;
+		Result getResult( const unsigned long long wins, const unsigned long long losses, const unsigned long long draws ) const;
+		double getLowerBound() const;
+		double getUpperBound() const;
+
+		/*! \brief elo difference of a score, and the half width of its 95% confidence interval
+		*
+		*/
+		static double getElo( const unsigned long long wins, const unsigned long long losses, const unsigned long long draws, double& errorMargin );
+
+		static constexpr double pseudoCount = 0.5;	// added to the wins, losses and draws when computing the llr
+
+	private:
+		double _score0;
+		double _score1;
+		double _lowerBound;
+		double _upperBound;
+	};
+}
+
+#endif /* SPRT_H_ */
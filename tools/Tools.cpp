@@ -0,0 +1,86 @@
+/*
+	This file is part of Vajolet.
+	Copyright (C) 2013-2018 Marco Belli
+
+    Vajolet is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Vajolet is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#include <algorithm>
+#include <iostream>
+#include <thread>
+
+#include "Tools.h"
+#include "./../BitMap.h"
+#include "./../BitMapMoveGenerator.h"
+#include "./../Cuckoo.h"
+#include "./../HashKeys.h"
+#include "./../KPKBitbase.h"
+#include "./../tSquare.h"
+
+namespace tools
+{
+	void init()
+	{
+		libChess::baseTypes::inittSquare();
+		libChess::baseTypes::BitMap::init();
+		libChess::HashKey::init();
+		libChess::BitMapMoveGenerator::init();
+		libChess::Cuckoo::init();
+		libChess::KPKBitbase::init();
+	}
+
+	Options::Options( const int argc, const char* const* argv ): _valid( true )
+	{
+		for( int i = 1; i < argc; ++i )
+		{
+			const std::string arg( argv[ i ] );
+			const auto separator = arg.find( '=' );
+			if( separator == std::string::npos || separator == 0 )
+			{
+				std::cerr << "invalid option " << arg << ", the options shall be written as name=value" << std::endl;
+				_valid = false;
+				continue;
+			}
+			_values[ arg.substr( 0, separator ) ] = arg.substr( separator + 1 );
+		}
+	}
+
+	bool Options::isValid() const
+	{
+		return _valid;
+	}
+
+	std::string Options::getString( const std::string& name, const std::string& defaultValue ) const
+	{
+		const auto it = _values.find( name );
+		return it != _values.end() ? it->second : defaultValue;
+	}
+
+	long long Options::getInt( const std::string& name, const long long defaultValue ) const
+	{
+		const auto it = _values.find( name );
+		return it != _values.end() ? std::stoll( it->second ) : defaultValue;
+	}
+
+	double Options::getDouble( const std::string& name, const double defaultValue ) const
+	{
+		const auto it = _values.find( name );
+		return it != _values.end() ? std::stod( it->second ) : defaultValue;
+	}
+
+	unsigned int getHardwareThreads()
+	{
+		return std::max( std::thread::hardware_concurrency(), 1u );
+	}
+}
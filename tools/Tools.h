@@ -0,0 +1,55 @@
+/*
+	This file is part of Vajolet.
+	Copyright (C) 2013-2018 Marco Belli
+
+    Vajolet is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Vajolet is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#ifndef TOOLS_H_
+#define TOOLS_H_
+
+#include <map>
+#include <string>
+
+namespace tools
+{
+	/*! \brief initialize the static tables of libChess
+	*
+	*/
+	void init();
+
+	/*!	\brief options of a tool, passed on the command line as name=value
+	 */
+	class Options
+	{
+	public:
+		Options( const int argc, const char* const* argv );
+
+		bool isValid() const;
+		std::string getString( const std::string& name, const std::string& defaultValue ) const;
+		long long getInt( const std::string& name, const long long defaultValue ) const;
+		double getDouble( const std::string& name, const double defaultValue ) const;
+
+	private:
+		std::map< std::string, std::string > _values;
+		bool _valid;
+	};
+
+	/*! \brief number of hardware threads, at least 1
+	*
+	*/
+	unsigned int getHardwareThreads();
+}
+
+#endif /* TOOLS_H_ */
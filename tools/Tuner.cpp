@@ -0,0 +1,440 @@
+/*
+	This file is part of Vajolet.
+	Copyright (C) 2013-2018 Marco Belli
+
+    Vajolet is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Vajolet is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Vajolet.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Tools.h"
+#include "./../Eval.h"
+#include "./../KPKBitbase.h"
+#include "./../Move.h"
+#include "./../PackedPosition.h"
+#include "./../Position.h"
+
+using namespace libChess;
+
+/*	texel tuner of the evaluation parameters
+
+	the positions are loaded from epd files ( a fen followed by the game result, as 1-0 0-1 1/2-1/2 or [1.0] [0.0] [0.5] )
+	and from the .bin files of the self play generator, and are stored as the trace of the evaluation, that is linear
+	in the opening/endgame values of the parameters, so that an epoch doesn't need any Position.
+	The parameters are optimized with Adam minimizing the mean squared error between the game result and the
+	sigmoid of the evaluation, the gradient of every epoch is collected in parallel with a partial sum per thread.
+	options: input ( comma separated list of files ) threads epochs learningRate k reportInterval
+*/
+namespace
+{
+	constexpr unsigned int parametersNumber = Eval::parametersNumber;
+
+	/*!	\brief a position of the dataset, the result is seen from white: 0 loss, 1 draw, 2 win
+	 */
+	struct Entry
+	{
+		uint16_t phase;
+		uint8_t result;
+		std::array< int8_t, parametersNumber > coefficients;
+	};
+
+	/*!	\brief opening and endgame values of the parameters, as real numbers
+	 */
+	struct Weights
+	{
+		std::array< double, parametersNumber > mg;
+		std::array< double, parametersNumber > eg;
+	};
+
+	struct Settings
+	{
+		std::vector< std::string > inputs;
+		unsigned int threads;
+		unsigned int epochs;
+		double learningRate;
+		double k;
+		unsigned int reportInterval;
+	};
+
+	/*! \brief call fn( thread, begin, end ) on a slice of [ 0, size ) for every thread and wait for them
+	*
+	*/
+	void parallelFor( const unsigned int threadsNumber, const size_t size, const std::function< void( unsigned int, size_t, size_t ) >& fn )
+	{
+		std::vector< std::thread > threads;
+		for( unsigned int t = 0; t < threadsNumber; ++t )
+		{
+			threads.emplace_back( fn, t, ( size * t ) / threadsNumber, ( size * ( t + 1 ) ) / threadsNumber );
+		}
+		for( auto& t : threads )
+		{
+			t.join();
+		}
+	}
+
+	/*! \brief white result of an epd line, -1 if the line has no result
+	*
+	*/
+	int parseResult( const std::string& line )
+	{
+		if( line.find( "1/2-1/2" ) != std::string::npos || line.find( "[0.5]" ) != std::string::npos )
+		{
+			return 1;
+		}
+		if( line.find( "1-0" ) != std::string::npos || line.find( "[1.0]" ) != std::string::npos )
+		{
+			return 2;
+		}
+		if( line.find( "0-1" ) != std::string::npos || line.find( "[0.0]" ) != std::string::npos )
+		{
+			return 0;
+		}
+		return -1;
+	}
+
+	/*! \brief tell whether the classical evaluation of the position is described by its trace
+	*
+	*/
+	bool isTunable( const Position& pos )
+	{
+		return !pos.isInCheck() && !KPKBitbase::isKPK( pos ) && pos.getNumberOfLegalMoves() > 0;
+	}
+
+	Entry makeEntry( const Position& pos, const int result )
+	{
+		const Eval::Trace trace = Eval::getTrace( pos );
+		return Entry{ uint16_t( trace.phase ), uint8_t( result ), trace.coefficients };
+	}
+
+	/*! \brief convert the lines of an epd file, every thread converts a slice with its own Position
+	*
+	*/
+	void convertEpd( const std::vector< std::string >& lines, const unsigned int threadsNumber, std::vector< std::vector< Entry > >& entries )
+	{
+		parallelFor( threadsNumber, lines.size(), [&]( const unsigned int t, const size_t begin, const size_t end )
+		{
+			Position pos;
+			for( size_t i = begin; i < end; ++i )
+			{
+				const int result = parseResult( lines[ i ] );
+				std::istringstream ss( lines[ i ] );
+				std::string board, turn, castle, ep;
+				if( result < 0 || !( ss >> board >> turn >> castle >> ep ) )
+				{
+					continue;
+				}
+				if( pos.setupFromFen( board + " " + turn + " " + castle + " " + ep + " 0 1" ) && isTunable( pos ) )
+				{
+					entries[ t ].push_back( makeEntry( pos, result ) );
+				}
+			}
+		});
+	}
+
+	/*! \brief convert the records of the self play generator, the positions whose best move is a capture aren't quiet and are skipped
+	*
+	*/
+	void convertRecords( const std::vector< TrainingRecord >& records, const unsigned int threadsNumber, std::vector< std::vector< Entry > >& entries )
+	{
+		parallelFor( threadsNumber, records.size(), [&]( const unsigned int t, const size_t begin, const size_t end )
+		{
+			Position pos;
+			for( size_t i = begin; i < end; ++i )
+			{
+				const TrainingRecord& record = records[ i ];
+				if( !pos.setupFromFen( record.pos.getFen() ) || !isTunable( pos ) || pos.isCaptureMove( Move( record.move ) ) )
+				{
+					continue;
+				}
+				const int result = ( pos.isWhiteTurn() ? record.result : -record.result ) + 1;
+				entries[ t ].push_back( makeEntry( pos, result ) );
+			}
+		});
+	}
+
+	bool loadFile( const std::string& fileName, const unsigned int threadsNumber, std::vector< Entry >& dataset )
+	{
+		std::vector< std::vector< Entry > > entries( threadsNumber );
+		if( fileName.size() > 4 && fileName.compare( fileName.size() - 4, 4, ".bin" ) == 0 )
+		{
+			std::FILE* file = std::fopen( fileName.c_str(), "rb" );
+			if( !file )
+			{
+				return false;
+			}
+			std::vector< TrainingRecord > records;
+			TrainingRecord buffer[ 4096 ];
+			size_t read;
+			while( ( read = std::fread( buffer, sizeof( TrainingRecord ), 4096, file ) ) > 0 )
+			{
+				records.insert( records.end(), buffer, buffer + read );
+			}
+			std::fclose( file );
+			convertRecords( records, threadsNumber, entries );
+		}
+		else
+		{
+			std::ifstream file( fileName );
+			if( !file )
+			{
+				return false;
+			}
+			std::vector< std::string > lines;
+			std::string line;
+			while( std::getline( file, line ) )
+			{
+				lines.push_back( line );
+			}
+			convertEpd( lines, threadsNumber, entries );
+		}
+		for( const auto& e : entries )
+		{
+			dataset.insert( dataset.end(), e.begin(), e.end() );
+		}
+		return true;
+	}
+
+	/*! \brief white evaluation of the entry, without the rounding of Eval::evaluate
+	*
+	*/
+	inline double evaluate( const Entry& entry, const Weights& w )
+	{
+		double mg = 0.0;
+		double eg = 0.0;
+		for( unsigned int i = 0; i < parametersNumber; ++i )
+		{
+			mg += w.mg[ i ] * entry.coefficients[ i ];
+			eg += w.eg[ i ] * entry.coefficients[ i ];
+		}
+		return ( mg * entry.phase + eg * ( Eval::maxPhase - entry.phase ) ) / Eval::maxPhase;
+	}
+
+	inline double sigmoid( const double k, const double score )
+	{
+		return 1.0 / ( 1.0 + std::pow( 10.0, -k * score / 400.0 ) );
+	}
+
+	/*! \brief mean squared error of the dataset
+	*
+	*/
+	double getLoss( const std::vector< Entry >& dataset, const Weights& w, const double k, const unsigned int threadsNumber )
+	{
+		std::vector< double > sums( threadsNumber, 0.0 );
+		parallelFor( threadsNumber, dataset.size(), [&]( const unsigned int t, const size_t begin, const size_t end )
+		{
+			double sum = 0.0;
+			for( size_t i = begin; i < end; ++i )
+			{
+				const double error = dataset[ i ].result * 0.5 - sigmoid( k, evaluate( dataset[ i ], w ) );
+				sum += error * error;
+			}
+			sums[ t ] = sum;
+		});
+		double sum = 0.0;
+		for( const double s : sums )
+		{
+			sum += s;
+		}
+		return sum / dataset.size();
+	}
+
+	/*! \brief gradient of the mean squared error, every thread sums the gradient of its slice in its own Weights
+	*
+	*/
+	Weights getGradient( const std::vector< Entry >& dataset, const Weights& w, const double k, const unsigned int threadsNumber )
+	{
+		std::vector< Weights > partials( threadsNumber, Weights{} );
+		parallelFor( threadsNumber, dataset.size(), [&]( const unsigned int t, const size_t begin, const size_t end )
+		{
+			Weights g{};
+			for( size_t i = begin; i < end; ++i )
+			{
+				const Entry& entry = dataset[ i ];
+				const double s = sigmoid( k, evaluate( entry, w ) );
+				// derivative of ( result - s )^2 by the evaluation
+				const double d = -2.0 * ( entry.result * 0.5 - s ) * s * ( 1.0 - s ) * k * std::log( 10.0 ) / 400.0;
+				const double mgFactor = d * entry.phase / Eval::maxPhase;
+				const double egFactor = d * ( Eval::maxPhase - entry.phase ) / Eval::maxPhase;
+				for( unsigned int p = 0; p < parametersNumber; ++p )
+				{
+					g.mg[ p ] += mgFactor * entry.coefficients[ p ];
+					g.eg[ p ] += egFactor * entry.coefficients[ p ];
+				}
+			}
+			partials[ t ] = g;
+		});
+		Weights gradient{};
+		for( const auto& g : partials )
+		{
+			for( unsigned int p = 0; p < parametersNumber; ++p )
+			{
+				gradient.mg[ p ] += g.mg[ p ] / dataset.size();
+				gradient.eg[ p ] += g.eg[ p ] / dataset.size();
+			}
+		}
+		return gradient;
+	}
+
+	/*! \brief scaling constant of the sigmoid that best fits the results with the actual parameters, found by a golden section search
+	*
+	*/
+	double fitK( const std::vector< Entry >& dataset, const Weights& w, const unsigned int threadsNumber )
+	{
+		const double ratio = ( std::sqrt( 5.0 ) - 1.0 ) / 2.0;
+		double low = 0.0;
+		double high = 4.0;
+		for( unsigned int i = 0; i < 40; ++i )
+		{
+			const double a = high - ratio * ( high - low );
+			const double b = low + ratio * ( high - low );
+			if( getLoss( dataset, w, a, threadsNumber ) < getLoss( dataset, w, b, threadsNumber ) )
+			{
+				high = b;
+			}
+			else
+			{
+				low = a;
+			}
+		}
+		return ( low + high ) / 2.0;
+	}
+
+	/*! \brief Adam optimizer, with a moment estimate for every opening and endgame value
+	*
+	*/
+	class Adam
+	{
+	public:
+		explicit Adam( const double learningRate ): _learningRate( learningRate ), _m{}, _v{}, _step( 0 ) {}
+
+		void update( Weights& w, const Weights& gradient )
+		{
+			++_step;
+			const double correction1 = 1.0 - std::pow( beta1, _step );
+			const double correction2 = 1.0 - std::pow( beta2, _step );
+			_update( w.mg, gradient.mg, _m.mg, _v.mg, correction1, correction2 );
+			_update( w.eg, gradient.eg, _m.eg, _v.eg, correction1, correction2 );
+		}
+
+		static constexpr double beta1 = 0.9;
+		static constexpr double beta2 = 0.999;
+		static constexpr double epsilon = 1e-8;
+
+	private:
+		double _learningRate;
+		Weights _m;
+		Weights _v;
+		unsigned int _step;
+
+		void _update( std::array< double, parametersNumber >& w, const std::array< double, parametersNumber >& g,
+			std::array< double, parametersNumber >& m, std::array< double, parametersNumber >& v, const double correction1, const double correction2 )
+		{
+			for( unsigned int p = 0; p < parametersNumber; ++p )
+			{
+				m[ p ] = beta1 * m[ p ] + ( 1.0 - beta1 ) * g[ p ];
+				v[ p ] = beta2 * v[ p ] + ( 1.0 - beta2 ) * g[ p ] * g[ p ];
+				w[ p ] -= _learningRate * ( m[ p ] / correction1 ) / ( std::sqrt( v[ p ] / correction2 ) + epsilon );
+			}
+		}
+	};
+
+	void printWeights( const Weights& w )
+	{
+		for( unsigned int p = 0; p < parametersNumber; ++p )
+		{
+			std::cout << Eval::getParameterName( p ) << " { " << std::lround( w.mg[ p ] ) << ", " << std::lround( w.eg[ p ] ) << ", 0, 0 }" << std::endl;
+		}
+	}
+}
+
+int main( int argc, char** argv )
+{
+	tools::init();
+
+	const tools::Options options( argc, argv );
+	if( !options.isValid() )
+	{
+		return 1;
+	}
+
+	Settings settings;
+	std::istringstream inputs( options.getString( "input", "" ) );
+	std::string input;
+	while( std::getline( inputs, input, ',' ) )
+	{
+		settings.inputs.push_back( input );
+	}
+	settings.threads = options.getInt( "threads", tools::getHardwareThreads() );
+	settings.epochs = options.getInt( "epochs", 1000 );
+	settings.learningRate = options.getDouble( "learningRate", 1.0 );
+	settings.k = options.getDouble( "k", 0.0 );
+	settings.reportInterval = options.getInt( "reportInterval", 50 );
+	if( settings.inputs.empty() || settings.threads == 0 )
+	{
+		std::cerr << "at least an input file is needed" << std::endl;
+		return 1;
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+	std::vector< Entry > dataset;
+	for( const auto& fileName : settings.inputs )
+	{
+		if( !loadFile( fileName, settings.threads, dataset ) )
+		{
+			std::cerr << "unable to read " << fileName << std::endl;
+			return 1;
+		}
+	}
+	if( dataset.empty() )
+	{
+		std::cerr << "no positions to tune" << std::endl;
+		return 1;
+	}
+	std::cout << "loaded " << dataset.size() << " positions in " << std::chrono::duration< double >( std::chrono::steady_clock::now() - start ).count() << "s" << std::endl;
+
+	Weights w;
+	const Eval::Parameters parameters = Eval::getParameters();
+	for( unsigned int p = 0; p < parametersNumber; ++p )
+	{
+		w.mg[ p ] = parameters[ p ][ 0 ];
+		w.eg[ p ] = parameters[ p ][ 1 ];
+	}
+
+	const double k = settings.k > 0.0 ? settings.k : fitK( dataset, w, settings.threads );
+	std::cout << "k " << k << " initial loss " << getLoss( dataset, w, k, settings.threads ) << std::endl;
+
+	Adam adam( settings.learningRate );
+	for( unsigned int epoch = 1; epoch <= settings.epochs; ++epoch )
+	{
+		adam.update( w, getGradient( dataset, w, k, settings.threads ) );
+		if( epoch % settings.reportInterval == 0 || epoch == settings.epochs )
+		{
+			const double seconds = std::chrono::duration< double >( std::chrono::steady_clock::now() - start ).count();
+			std::cout << "epoch " << epoch << " loss " << getLoss( dataset, w, k, settings.threads ) << " ( " << seconds << "s )" << std::endl;
+		}
+	}
+	printWeights( w );
+	return 0;
+}